@@ -0,0 +1,93 @@
+#ifndef _ASYNCTEXTURELOADER_H_
+#define _ASYNCTEXTURELOADER_H_
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <GL\glew.h>
+#include <GL\glfw.h>
+
+// One decoded level inside a staging buffer
+struct MipLevel
+{
+	unsigned int	uiWidth;
+	unsigned int	uiHeight;
+	unsigned int	uiOffset;
+};
+
+// Appends the box filtered levels below the 32 bit level 0 already at the
+// start of a_rData, down to 1x1. a_rLevels gets one entry per level
+// including level 0.
+void BuildMipChain( std::vector<unsigned char>& a_rData, unsigned int a_uiWidth, unsigned int a_uiHeight, std::vector<MipLevel>& a_rLevels );
+
+typedef void (*TextureLoadedCallback)( GLuint a_uiTextureID, unsigned int a_uiBytes );
+
+// Request() gives back a texture straight away holding a 1x1 placeholder.
+// Worker threads decode the image with FreeImage into pooled staging memory
+// and build its mip chain, then Update() on the main thread uploads finished
+// images through a pixel unpack buffer, no more than the upload budget of
+// bytes per frame.
+class AsyncTextureLoader
+{
+public:
+							AsyncTextureLoader();
+							~AsyncTextureLoader();
+
+	// a_uiNumThreads of 0 uses one less than the processor count
+	void					Start( unsigned int a_uiNumThreads = 0 );
+	void					Stop();
+	bool					IsRunning() const						{ return !m_aiThreads.empty(); }
+
+	GLuint					Request( const char* a_szPath, unsigned int a_uiFormat = GL_RGBA );
+	// the texture is going away, drop its decode if it hasn't been uploaded
+	void					Cancel( GLuint a_uiTextureID );
+
+	void					Update();
+
+	void					SetUploadBudget( unsigned int a_uiBytes )	{ m_uiUploadBudget = a_uiBytes; }
+	void					SetLoadedCallback( TextureLoadedCallback a_pfnCallback ) { m_pfnLoaded = a_pfnCallback; }
+
+	unsigned int			GetPendingCount() const					{ return m_oPending.size(); }
+
+private:
+	struct LoadJob
+	{
+		GLuint							uiTextureID;
+		unsigned int					uiTicket;
+		unsigned int					uiFormat;
+		std::string						sPath;
+
+		std::vector<unsigned char>*		pData;		// null if the decode failed
+		std::vector<MipLevel>			aoLevels;
+	};
+
+	static void GLFWCALL	WorkerThread( void* a_pLoader );
+	void					DecodeJob( LoadJob& a_rJob );
+	void					UploadJob( LoadJob& a_rJob );
+
+	std::vector<unsigned char>*	AcquireStaging();
+	void						ReleaseStaging( std::vector<unsigned char>* a_pData );
+
+	std::vector<GLFWthread>				m_aiThreads;
+	GLFWmutex							m_oMutex;
+	GLFWcond							m_oJobReady;
+	bool								m_bQuit;
+
+	// guarded by m_oMutex
+	std::deque<LoadJob>					m_oRequests;
+	std::deque<LoadJob>					m_oCompleted;
+	std::vector<std::vector<unsigned char>*>	m_apStagingPool;
+
+	// main thread only, the ticket of the live request for each texture
+	std::map<GLuint, unsigned int>		m_oPending;
+	unsigned int						m_uiNextTicket;
+
+	GLuint								m_uiUnpackBuffer;
+	unsigned int						m_uiUploadBudget;
+	TextureLoadedCallback				m_pfnLoaded;
+};
+
+AsyncTextureLoader&	GetTextureLoader();
+
+#endif
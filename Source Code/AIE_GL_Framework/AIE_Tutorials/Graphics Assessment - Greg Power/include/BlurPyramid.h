@@ -0,0 +1,77 @@
+#ifndef _BLURPYRAMID_H_
+#define _BLURPYRAMID_H_
+
+#include <vector>
+#include <GL\glew.h>
+#include "RenderTargetPool.h"
+#include "ShaderReflection.h"
+#include "QuadMesh.h"
+
+// taps blur_fragment.glsl has room for, the centre included
+const unsigned int MAX_BLUR_TAPS = 8;
+
+// One side of a symmetric 1D kernel, index 0 is the centre. Offsets are in
+// texels and fractional once neighbouring taps have been merged.
+struct BlurKernel
+{
+	std::vector<float>	afOffsets;
+	std::vector<float>	afWeights;
+};
+
+// Discrete Gaussian out to a_uiRadius texels, normalised so the centre plus
+// twice every other weight comes to 1.
+void BuildGaussianWeights( unsigned int a_uiRadius, float a_fSigma, std::vector<float>& a_rWeights );
+
+// Folds texels 1+2, 3+4, ... of a_rWeights into one tap each, placed between
+// the pair so that bilinear filtering returns the same weighted sum. A
+// radius r kernel ends up with 1 + (r + 1) / 2 fetches a side instead of
+// 1 + r.
+void BuildLinearKernel( const std::vector<float>& a_rWeights, BlurKernel& a_rKernel );
+
+// Wide blur done at reduced resolution. The source is box filtered down to
+// 1/2, 1/4 and 1/8 of the window, each level gets a separable blur, then the
+// levels are blended back up from the smallest. Targets come from the
+// render target pool and go back to it as soon as they've been read.
+class BlurPyramid
+{
+public:
+	static const unsigned int LEVEL_COUNT = 3;
+
+						BlurPyramid();
+						~BlurPyramid();
+
+	// loads the programs, which leaves one of them bound
+	void				Init();
+
+	// radius in texels of the level being blurred, clamped to what the
+	// shader's taps can reach
+	void				SetKernel( unsigned int a_uiRadius, float a_fSigma );
+	const BlurKernel&	GetKernel() const	{ return m_oKernel; }
+
+	// how much of the coarser level replaces a level on the way back up
+	void				SetUpsampleBlend( float a_fBlend )	{ m_fUpsampleBlend = a_fBlend; }
+
+	// a_uiSource is a window sized texture. Gives back a half size target
+	// from a_rPool holding the blur, which the caller releases. Programs and
+	// frame buffer are left changed.
+	RenderTarget*		Blur( RenderTargetPool& a_rPool, GLuint a_uiSource );
+
+private:
+	RenderTarget*		Downsample( RenderTargetPool& a_rPool, GLuint a_uiSource, float a_fTexelWidth, float a_fTexelHeight, unsigned int a_uiDivisor );
+	RenderTarget*		BlurLevel( RenderTargetPool& a_rPool, RenderTarget* a_poLevel );
+	RenderTarget*		Upsample( RenderTargetPool& a_rPool, RenderTarget* a_poLevel, RenderTarget* a_poCoarser );
+
+	GLuint				m_uiDownsampleShaderID;
+	GLuint				m_uiBlurShaderID;
+	GLuint				m_uiUpsampleShaderID;
+	ShaderReflection	m_oDownsampleReflection;
+	ShaderReflection	m_oBlurReflection;
+	ShaderReflection	m_oUpsampleReflection;
+
+	QuadMesh*			m_poQuad;
+
+	BlurKernel			m_oKernel;
+	float				m_fUpsampleBlend;
+};
+
+#endif
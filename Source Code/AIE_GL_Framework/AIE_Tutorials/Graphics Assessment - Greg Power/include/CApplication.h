@@ -36,6 +36,7 @@ protected:
 	void				CloseOpenGL();
 	void				LoadAssets();
 	void				FreeAssets();
+	void				CheckWindowSize();
 	void				Update(float a_fDeltaTime);
 	void				Draw();
 
@@ -9,6 +9,9 @@
 // SomeGameState *ptrToGameStateClass = new SomeGameState(pGame);		//
 // gm->RegisterGameState(GAME_STATE_ENUM, ptrToGameStateClass);			//
 //																		//
+// or, to construct the state on its first push:						//
+// gm->RegisterGameState(GAME_STATE_ENUM, CreateGameState<SomeState>);	//
+//																		//
 // gm->PushState(GAME_STATE_ENUM);										//
 // gm->PopState();														//
 //																		//
@@ -26,6 +29,14 @@
 #include "IBaseGameState.h"
 #include <vector>
 
+typedef IBaseGameState* (*GameStateFactory)(EGameState state, CApplication* pApp);
+
+template< typename T >
+IBaseGameState* CreateGameState(EGameState state, CApplication* pApp)
+{
+	return new T( state, pApp );
+}
+
 class CGameStateManager
 {
 public:
@@ -33,6 +44,11 @@ public:
 				~CGameStateManager();
 
 	void		RegisterGameState(EGameState state, IBaseGameState* gameState);
+	// The state is created on its first push and deleted again once more
+	// than the resident budget of factory states are sitting off the stack,
+	// least recently used first.
+	void		RegisterGameState(EGameState state, GameStateFactory factory);
+	void		SetResidentBudget(unsigned int budget)	{ m_uiResidentBudget = budget; }
 	void		PushState(EGameState state);
 	void		PopState();
 	void		UpdateGameStates(float a_fDeltaTime);
@@ -54,11 +70,22 @@ private:
 		EGameState state;
 	};
 
+	IBaseGameState*	GetOrCreateState(EGameState state);
+	bool			IsOnStack(IBaseGameState* gameState);
+	void			ReleaseIdleStates();
+
+	CApplication*					m_pApp;
+
 	std::vector<SStateCommands>		m_oCommandList;
 
 	std::vector<IBaseGameState*>	m_oRegisteredStates;
+	std::vector<GameStateFactory>	m_oStateFactories;
+	std::vector<unsigned int>		m_oLastUsed;
 	std::vector<IBaseGameState*>	m_oStateStack;
 
+	unsigned int					m_uiUseCounter;
+	unsigned int					m_uiResidentBudget;
+
 };
 
 #endif
\ No newline at end of file
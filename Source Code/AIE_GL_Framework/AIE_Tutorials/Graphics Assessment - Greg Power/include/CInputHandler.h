@@ -32,6 +32,7 @@ public:
 	bool		IsDownKeyDown()		{ return m_bDownKeyDown;	}
 	bool		IsLeftShiftDown()	{ return m_bLeftShiftDown;	}
 	bool		IsSpaceDown()		{ return m_bSpaceDown;		}
+	bool		IsCaptureDown()		{ return m_bCaptureDown;	}
 
 	void		Update();
 
@@ -49,6 +50,8 @@ private:
 	bool		m_bAnyEvent;
 	bool		m_bSpaceDown;
 	bool		m_bSpaceUp;
+	bool		m_bCaptureDown;		// F12
+	bool		m_bCaptureUp;
 	
 };
 
@@ -9,6 +9,14 @@
 #include "QuadMesh.h"
 #include "Camera.h"
 #include "FBXLoader.h"
+#include "ShaderReflection.h"
+#include "RenderQueue.h"
+#include "DrawCommandList.h"
+#include "RenderTargetPool.h"
+#include "BlurPyramid.h"
+#include "Frustum.h"
+#include "FrameUniforms.h"
+#include "GLCommandStream.h"
 
 //Render data attached to each FBXMeshNode's m_userData pointer
 struct RenderObject
@@ -16,6 +24,36 @@ struct RenderObject
 	GLuint VAO;
 	GLuint VBO;
 	GLuint IBO;
+	Bounds oBounds;		// around the mesh's vertices, before m_globalTransform
+};
+
+// What the last Draw sent to GL and what the frustum kept back from it.
+// Queued nodes count once per pass they're drawn in.
+struct RenderStats
+{
+	unsigned int	uiNodesDrawn;
+	unsigned int	uiNodesCulled;
+	unsigned int	uiFBXMeshesDrawn;
+	unsigned int	uiFBXMeshesCulled;
+};
+
+// Programs a node can be queued with, also its order inside a pass
+enum ERenderShader
+{
+	RENDER_SHADER_BASIC = 0,
+	RENDER_SHADER_WATER,
+	RENDER_SHADER_LAB02,
+	RENDER_SHADER_LAB03,
+	RENDER_SHADER_LAB04,
+	RENDER_SHADER_LAB07,
+	RENDER_SHADER_LAB08,
+	RENDER_SHADER_REFRACTION,
+	RENDER_SHADER_BASIC_INSTANCED,		// InstanceBatch nodes only
+	RENDER_SHADER_LAB02_INSTANCED,
+	RENDER_SHADER_FBX,					// FBX scenes only, see SetFBXScene
+	RENDER_SHADER_FBX_SKINNED,
+
+	RENDER_SHADER_COUNT
 };
 
 class CRenderManager
@@ -38,40 +76,52 @@ public:
 	void					LoadParticle2DShader();
 	void					LoadParticle3DShader();
 	void					LoadRefractionShader();
-	void					LoadGaussianShader();
 	void					LoadFullscreenQuadShader();
+	void					LoadInstancedShaders();
 
-	void					InitFrameBuffers();
+	// window size in pixels, screen sized render targets follow it
+	void					Resize( unsigned int a_uiWidth, unsigned int a_uiHeight );
 
-	void					AddNode(	int a_iStateID, MeshNode* a_poNode );
-	void					RemoveNode( int a_iStateID, MeshNode* a_poNode );
+	RenderHandle			AddNode(	int a_iStateID, MeshNode* a_poNode, ERenderShader a_eShader, ERenderPass a_ePass = RENDER_PASS_OPAQUE );
+	void					RemoveNode( int a_iStateID, RenderHandle a_hNode );
+	// how a_iStateID draws a_eFirst to a_eLast of its passes
+	void					SetPassState( int a_iStateID, ERenderPass a_eFirst, ERenderPass a_eLast, const RenderPassState& a_rState );
 	void					AddParticleManager(		int a_iStateID, ParticleManager* a_poParticleManager );
 	void					RemoveParticleManager(	int a_iStateID, ParticleManager* a_poParticleManager );
 	void					Update( float a_fDeltaTime );
 	void					SetActiveCamera( Camera* a_poCamera ) { m_poActiveCamera = a_poCamera; }
 	void					SetShader( GLuint a_uiShaderID );
 	GLuint					GetShader() { return m_iCurrentShaderID; }
-	void					SetFBXScene(FBXScene &a_oScene) { m_oScene = a_oScene; }
+	GLint					GetUniform( UniformHandle a_eHandle ) { return m_poCurrentReflection->GetLocation( a_eHandle ); }
+	// not owned, the lab that loaded the scene clears it before unloading it.
+	// Drawn at the start of the opaque pass with a_eShader.
+	void					SetFBXScene( FBXScene* a_poScene, ERenderShader a_eShader = RENDER_SHADER_FBX ) { m_poScene = a_poScene; m_eSceneShader = a_eShader; }
+	FBXScene*				GetFBXScene() const { return m_poScene; }
 	void					Draw( int a_eStateID, AIE::mat4 a_cameraMatrix );
-	void					DrawLab01( AIE::mat4 a_cameraMatrix );
-	void					DrawLab02( AIE::mat4 a_cameraMatrix );
-	void					DrawLab03( AIE::mat4 a_cameraMatrix );
-	void					DrawLab04( AIE::mat4 a_cameraMatrix );
-	void					DrawLab05( AIE::mat4 a_cameraMatrix );
-	void					DrawLab07( AIE::mat4 a_cameraMatrix );
-	void					DrawLab08( AIE::mat4 a_cameraMatrix );
-	void					DrawLab09( AIE::mat4 a_cameraMatrix );
-	void					DrawParticles( AIE::mat4 a_cameraMatrix );
+	const RenderStats&		GetStats() const	{ return m_oStats; }
+	// records the next Draw's GL calls, saves them and plays them back timed
+	void					CaptureNextFrame()	{ m_bCaptureNextFrame = true; }
 
 private:
-	std::vector<MeshNode*>	m_apoLab01NodesToRender;
-	std::vector<MeshNode*>	m_apoLab02NodesToRender;
-	std::vector<MeshNode*>	m_apoLab03NodesToRender;
-	std::vector<MeshNode*>	m_apoLab04NodesToRender;
-	std::vector<MeshNode*>	m_apoLab05NodesToRender;
-	std::vector<MeshNode*>	m_apoLab07NodesToRender;
-	std::vector<MeshNode*>	m_apoLab08NodesToRender;
-	std::vector<MeshNode*>	m_apoLab09NodesToRender;
+	void					ReflectShader( GLuint a_uiShaderID );
+	void					DrawCommandNode( const DrawCommand& a_rCommand );
+	void					DrawPasses( ERenderPass a_eFirst, ERenderPass a_eLast );
+	void					DrawPackets( ERenderPass a_ePass );
+	void					ApplyPassState( const RenderPassState& a_rState );
+	void					DrawFBXScene();
+	void					DrawParticles();
+	// for states with refracting nodes, in place of DrawPasses
+	void					DrawRefractedFrame();
+	void					SetQueueShaderUniforms();
+	void					UpdateFrameUniforms( const AIE::mat4& a_cameraMatrix );
+	bool					IsFBXMeshVisible( FBXMeshNode* a_pMesh );
+	void					SaveCapture( int a_iStateID );
+
+	std::map<int, RenderQueue>		m_oRenderQueues;
+	RenderQueue*					m_poCurrentQueue;	// the drawing state's queue, sorted for this frame
+	DrawCommandList					m_oDrawCommands;	// one per m_poCurrentQueue packet, packed on the workers
+	Frustum							m_oFrustum;			// the active camera's, for this frame
+	RenderStats						m_oStats;
 	std::map<int, ParticleManager*> m_ParticleManagers;
 
 	QuadMesh*				m_poFullScreenQuad0;
@@ -82,11 +132,21 @@ private:
 	mat4					m_viewMatrix;
 	mat4					m_modelMatrix;
 	mat4					m_cameraMatrix;
+	bool					m_bNodeModelSet;	// Model holds a node's matrix rather than m_modelMatrix
+
+	RenderTargetPool		m_oRenderTargets;
+	BlurPyramid				m_oBlurPyramid;
+
+	// camera, time and lights for every program, uploaded once a frame
+	FrameUniforms			m_oFrameUniforms;
+	GLuint					m_uiFrameUniformBuffer;
 
-	GLuint					m_FBO0, m_FBT0, m_FBD0;
-	GLuint					m_FBO1, m_FBT1, m_FBD1;
+	bool					m_bCaptureNextFrame;
+	GLCommandStream			m_oCaptureStream;
 
 	GLuint					m_iCurrentShaderID;
+	ShaderReflection*		m_poCurrentReflection;
+	std::map<GLuint, ShaderReflection>	m_oShaderReflections;
 	GLuint					m_iBasicShaderID;
 	GLuint					m_iWaterShaderID;
 	GLuint					m_iLab02ShaderID;
@@ -99,22 +159,23 @@ private:
 	GLuint					m_iParticle3DShaderID;
 	GLuint					m_iParticle2DShaderID;
 	GLuint					m_iRefractionShaderID;
-	GLuint					m_iGaussianShaderID;
 	GLuint					m_iFullscreenQuadShaderID;
-	GLuint					m_iProjectionID;
-	GLuint					m_iViewID;
+	GLuint					m_iBasicInstancedShaderID;
+	GLuint					m_iLab02InstancedShaderID;
+	GLuint					m_aiQueueShaderIDs[ RENDER_SHADER_COUNT ];
 	GLuint					m_iModelID;		
-	GLuint					m_iTimeID;
 	GLuint					m_iColourID;
 
 	GLuint					m_iFBProjectionID;
 	GLuint					m_iFBViewID;
 	GLuint					m_iFBModelID;
 
-	FBXScene				m_oScene;
+	FBXScene*				m_poScene;
+	ERenderShader			m_eSceneShader;
 
 	float					m_fTimer;
 	AIE::vec4				m_vColour;
+	AIE::vec4				m_vCameraPos;
 	int						m_iCurrentStateID;
 
 	GLuint					m_iWaterBumpMapID;
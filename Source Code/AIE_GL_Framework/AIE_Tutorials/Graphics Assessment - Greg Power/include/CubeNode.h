@@ -10,6 +10,10 @@ public:
 					~CubeNode();
 	void			Update( float a_fDeltaTime );
 	virtual void	Draw();
+
+	// appends the 14 vertex cube CubeNode builds, the shared mesh registry
+	// makes its unit cube from this too
+	static void		BuildGeometry( float a_fSize, const AIE::vec4& a_vTranslation, std::vector<AIE::Vertex>& a_rVertices, std::vector<unsigned int>& a_rIndices );
 };
 
 #endif
\ No newline at end of file
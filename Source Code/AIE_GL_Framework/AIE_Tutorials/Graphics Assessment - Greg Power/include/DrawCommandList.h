@@ -0,0 +1,57 @@
+#ifndef _DRAWCOMMANDLIST_H_
+#define _DRAWCOMMANDLIST_H_
+
+#include <vector>
+#include <GL\glew.h>
+#include "MathHelper.h"
+#include "RenderQueue.h"
+
+// One queued node's draw as a worker packed it, all the main thread needs to
+// make the GL calls without going back to the node. Nodes whose DrawMesh
+// does more than bind and draw keep poNode and are drawn through it.
+struct DrawCommand
+{
+	AIE::mat4		mModel;				// only read with bModelMatrix
+	AIE::vec4		vColour;			// the node's, or the shared one if it has none
+	float			fDistance;			// from the camera, for programs with a Distance uniform
+	unsigned int	uiShader;			// queue shader slot
+	GLuint			auiTextures[3];		// diffuse, secondary and displacement, 0 for none
+	GLenum			eTextureTarget;
+	GLuint			uiVAO;
+	unsigned int	uiIndexCount;
+	MeshNode*		poNode;				// draws itself, or nullptr to draw uiVAO as patches
+	unsigned int	bModelMatrix;
+};
+
+// Turns a sorted queue's packets into draw commands across the job system.
+// Each range job writes the commands for its own packets and nothing else,
+// so they come out in packet order whichever thread packed them and however
+// the packets were split.
+class DrawCommandList
+{
+public:
+								DrawCommandList();
+
+	// a_rPackets come from RenderQueue::Sort, which resolved their nodes'
+	// world transforms. a_bParallel false packs on the calling thread, for
+	// checking the parallel build against
+	void						Build( const std::vector<DrawPacket>& a_rPackets, const AIE::vec4& a_vCameraPos, const AIE::vec4& a_vDefaultColour, bool a_bParallel = true );
+
+	// one per packet, valid until the next Build
+	const std::vector<DrawCommand>&	GetCommands() const		{ return m_aoCommands; }
+
+	// over every command's bytes, equal for equal lists
+	unsigned long long			GetHash() const;
+
+private:
+	static void					PackRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pList );
+
+	std::vector<DrawCommand>	m_aoCommands;
+
+	// what the running Build packs from
+	const DrawPacket*			m_poPackets;
+	AIE::vec4					m_vCameraPos;
+	AIE::vec4					m_vDefaultColour;
+};
+
+#endif
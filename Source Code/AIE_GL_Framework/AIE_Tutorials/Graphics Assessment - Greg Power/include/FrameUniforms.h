@@ -0,0 +1,56 @@
+#ifndef _FRAMEUNIFORMS_H_
+#define _FRAMEUNIFORMS_H_
+
+#include <stddef.h>
+#include <GL\glew.h>
+#include "MathHelper.h"
+
+// uniform buffer binding point the FrameData block is tied to in every program
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+// The CPU side of the FrameData block in frame_data.glsl, filled once a
+// frame and uploaded whole. std140 puts every mat4 and vec4 on a 16 byte
+// boundary and a float after them packs straight on, so the struct needs no
+// gaps until the tail, which is padded to the block's rounded up size. Keep
+// the members in the order frame_data.glsl declares them.
+struct FrameUniforms
+{
+	AIE::mat4		mProjection;
+	AIE::mat4		mView;
+	AIE::mat4		mCameraMat;			// the camera's world matrix
+	AIE::vec4		vCameraPos;
+	AIE::vec4		vAmbientColour;
+	AIE::vec4		vDirLightDir;
+	AIE::vec4		vDirLightCol;
+	AIE::vec4		vPointLightPos;
+	AIE::vec4		vPointLightCol;
+	AIE::vec4		vSpotLightPos;
+	AIE::vec4		vSpotLightDir;
+	AIE::vec4		vSpotLightCol;
+	float			fTime;
+	float			afPadding[3];
+};
+
+// the std140 offsets of FrameData, a member moving breaks the build here
+// rather than the picture
+static_assert( offsetof( FrameUniforms, mProjection		) == 0,		"FrameUniforms: Projection offset" );
+static_assert( offsetof( FrameUniforms, mView			) == 64,	"FrameUniforms: View offset" );
+static_assert( offsetof( FrameUniforms, mCameraMat		) == 128,	"FrameUniforms: CameraMat offset" );
+static_assert( offsetof( FrameUniforms, vCameraPos		) == 192,	"FrameUniforms: CameraPos offset" );
+static_assert( offsetof( FrameUniforms, vAmbientColour	) == 208,	"FrameUniforms: ambientColour offset" );
+static_assert( offsetof( FrameUniforms, vDirLightDir	) == 224,	"FrameUniforms: dirLightDir offset" );
+static_assert( offsetof( FrameUniforms, vDirLightCol	) == 240,	"FrameUniforms: dirLightCol offset" );
+static_assert( offsetof( FrameUniforms, vPointLightPos	) == 256,	"FrameUniforms: pointLightPos offset" );
+static_assert( offsetof( FrameUniforms, vPointLightCol	) == 272,	"FrameUniforms: pointLightCol offset" );
+static_assert( offsetof( FrameUniforms, vSpotLightPos	) == 288,	"FrameUniforms: spotLightPos offset" );
+static_assert( offsetof( FrameUniforms, vSpotLightDir	) == 304,	"FrameUniforms: spotLightDir offset" );
+static_assert( offsetof( FrameUniforms, vSpotLightCol	) == 320,	"FrameUniforms: spotLightCol offset" );
+static_assert( offsetof( FrameUniforms, fTime			) == 336,	"FrameUniforms: Time offset" );
+static_assert( sizeof( FrameUniforms ) == 352,						"FrameUniforms: block size" );
+
+// Ties a_uiProgram's FrameData block, if it has one, to FRAME_UNIFORM_BINDING
+// and checks the offsets the driver gave its members against FrameUniforms.
+// Prints what differs and returns false if any do.
+bool	BindFrameUniformBlock( GLuint a_uiProgram );
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _FRUSTUM_H_
+#define _FRUSTUM_H_
+
+#include "MathHelper.h"
+
+// An axis aligned box and the sphere around it, both in whatever space the
+// points they were built from are in. w is left at 1 on the points.
+struct Bounds
+{
+	AIE::vec4		vMin;
+	AIE::vec4		vMax;
+	AIE::vec4		vCentre;
+	float			fRadius;
+};
+
+// a_uiStride is in bytes, the first three floats at each step are the point
+void	ComputeBounds( const void* a_pPositions, unsigned int a_uiCount, unsigned int a_uiStride, Bounds& a_rBounds );
+// a_rIn moved by a row vector matrix, the box around the moved box
+void	TransformBounds( const Bounds& a_rIn, const AIE::mat4& a_mTransform, Bounds& a_rOut );
+void	MergeBounds( const Bounds& a_rOther, Bounds& a_rBounds );
+// grown by a_fAmount on every side
+void	PadBounds( float a_fAmount, Bounds& a_rBounds );
+
+// The six planes of a view volume, taken from View * Projection the way the
+// render manager multiplies them (row vectors, clip = v * View * Projection).
+// Normals point inwards and are normalised so the sphere test can use the
+// radius as a distance. Stored a component per array and padded out to eight
+// planes so both tests run four planes at a time with SSE, the two padding
+// planes have everything inside them.
+class Frustum
+{
+public:
+					Frustum();
+
+	void			Extract( const AIE::mat4& a_mViewProjection );
+
+	// false only when the volume is entirely outside one plane
+	bool			TestSphere( const AIE::vec4& a_vCentre, float a_fRadius ) const;
+	bool			TestAABB( const AIE::vec4& a_vMin, const AIE::vec4& a_vMax ) const;
+
+	// the sphere first as it's cheaper, then the tighter box
+	bool			IsVisible( const Bounds& a_rBounds ) const;
+
+private:
+	float			m_afX[8];
+	float			m_afY[8];
+	float			m_afZ[8];
+	float			m_afW[8];
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef _GLCOMMANDRECORDER_H_
+#define _GLCOMMANDRECORDER_H_
+
+#include "GLCommandStream.h"
+#include "GLStateCache.h"
+
+// Swaps the state cache's function table for one that writes each call into
+// a stream. Only what goes through GetGLState() is seen, objects made or
+// filled straight through GL aren't. Swapping tables clears the cache, so
+// a recording sets all the state it relies on itself.
+//
+// One recorder at a time, Begin does nothing while another is recording.
+class GLCommandRecorder
+{
+public:
+							GLCommandRecorder();
+							~GLCommandRecorder();
+
+	// a_bExecute passes each call on to the table that was in use as well,
+	// so a frame still draws while it's captured
+	void					Begin( GLCommandStream& a_rStream, bool a_bExecute = true );
+	void					End();
+
+	bool					IsRecording() const		{ return m_poStream != nullptr; }
+
+private:
+	GLCommandStream*		m_poStream;
+	const GLStateFunctions*	m_poPrevious;
+};
+
+// calls and seconds spent in each, what the CPU side of submitting costs
+struct GLCommandTimings
+{
+	unsigned int	auiCalls[ GL_COMMAND_COUNT ];
+	double			adSeconds[ GL_COMMAND_COUNT ];
+
+	void			Clear();
+	void			Print() const;
+};
+
+// Makes a_rStream's calls through a_rGL in the order they were recorded,
+// adding each one's time to a_poTimings if given. Stops and returns false
+// at a command that is cut short or unknown.
+bool	PlayCommands( const GLCommandStream& a_rStream, const GLStateFunctions& a_rGL, GLCommandTimings* a_poTimings = nullptr );
+
+#endif
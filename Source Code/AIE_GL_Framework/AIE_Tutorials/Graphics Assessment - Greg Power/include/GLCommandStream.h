@@ -0,0 +1,115 @@
+#ifndef _GLCOMMANDSTREAM_H_
+#define _GLCOMMANDSTREAM_H_
+
+#include <vector>
+
+// One per GLStateFunctions entry, in the same order. Names are in
+// g_aszGLCommandNames.
+enum EGLCommand
+{
+	GL_COMMAND_USE_PROGRAM = 0,
+	GL_COMMAND_BIND_VERTEX_ARRAY,
+	GL_COMMAND_ACTIVE_TEXTURE,
+	GL_COMMAND_BIND_TEXTURE,
+	GL_COMMAND_ENABLE,
+	GL_COMMAND_DISABLE,
+	GL_COMMAND_DEPTH_MASK,
+	GL_COMMAND_BLEND_FUNC,
+	GL_COMMAND_POLYGON_MODE,
+	GL_COMMAND_FRONT_FACE,
+	GL_COMMAND_DELETE_TEXTURES,
+	GL_COMMAND_DELETE_VERTEX_ARRAYS,
+	GL_COMMAND_CLEAR,
+	GL_COMMAND_VIEWPORT,
+	GL_COMMAND_BIND_FRAMEBUFFER,
+	GL_COMMAND_BIND_BUFFER,
+	GL_COMMAND_BIND_BUFFER_BASE,
+	GL_COMMAND_BUFFER_DATA,
+	GL_COMMAND_BUFFER_SUB_DATA,
+	GL_COMMAND_UNIFORM_1I,
+	GL_COMMAND_UNIFORM_1F,
+	GL_COMMAND_UNIFORM_2F,
+	GL_COMMAND_UNIFORM_1FV,
+	GL_COMMAND_UNIFORM_4FV,
+	GL_COMMAND_UNIFORM_MATRIX_4FV,
+	GL_COMMAND_POINT_SIZE,
+	GL_COMMAND_PATCH_PARAMETER_I,
+	GL_COMMAND_DRAW_ARRAYS,
+	GL_COMMAND_DRAW_ELEMENTS,
+	GL_COMMAND_DRAW_ELEMENTS_INSTANCED,
+
+	GL_COMMAND_COUNT
+};
+
+extern const char* g_aszGLCommandNames[ GL_COMMAND_COUNT ];
+
+// GL calls written out as 32 bit words. Each command is a header word, the
+// command in the low byte and the number of words after it in the rest,
+// then its arguments. Arrays and buffer contents are copied in and padded
+// out to a whole word, pointers into bound buffers are kept as offsets.
+//
+// Object names are written as they were, so a stream only means the same
+// thing to a context holding the same objects, or to a table that doesn't
+// care what they are.
+class GLCommandStream
+{
+public:
+	static const unsigned int	NO_DIFFERENCE = 0xffffffff;
+
+							GLCommandStream();
+
+	void					Clear();
+
+	// a command's arguments are written between its Begin and End
+	void					BeginCommand( EGLCommand a_eCommand );
+	void					Write( unsigned int a_uiValue )		{ m_auiWords.push_back( a_uiValue ); }
+	void					WriteInt( int a_iValue )			{ m_auiWords.push_back( (unsigned int)a_iValue ); }
+	void					WriteFloat( float a_fValue );
+	// a_uiBytes is written first, then the bytes
+	void					WriteBytes( const void* a_pData, unsigned int a_uiBytes );
+	void					EndCommand();
+
+	unsigned int			GetCommandCount() const		{ return m_uiCommandCount; }
+	unsigned int			GetWordCount() const		{ return m_auiWords.size(); }
+	const unsigned int*		GetWords() const			{ return m_auiWords.empty() ? nullptr : &m_auiWords[0]; }
+
+	bool					Save( const char* a_szPath ) const;
+	bool					Load( const char* a_szPath );
+
+	// index of the first command that differs, a stream that runs out first
+	// differs at its end
+	unsigned int			FindFirstDifference( const GLCommandStream& a_rOther ) const;
+
+private:
+	std::vector<unsigned int>	m_auiWords;
+	unsigned int				m_uiCommandCount;
+	unsigned int				m_uiCommandStart;	// header word of the open command
+};
+
+// Walks a stream one command at a time, the Read calls taking the current
+// command's words in the order they were written.
+class GLCommandReader
+{
+public:
+							GLCommandReader( const GLCommandStream& a_rStream );
+
+	// false at the end or if the next command is cut short or unknown
+	bool					Next( EGLCommand& a_reCommand );
+
+	unsigned int			Read();
+	int						ReadInt()		{ return (int)Read(); }
+	float					ReadFloat();
+	// a_ruiBytes is set to the byte count WriteBytes was given
+	const void*				ReadBytes( unsigned int& a_ruiBytes );
+
+	bool					IsValid() const	{ return m_bValid; }
+
+private:
+	const unsigned int*		m_puiWords;
+	unsigned int			m_uiWordCount;
+	unsigned int			m_uiPosition;
+	unsigned int			m_uiCommandEnd;
+	bool					m_bValid;
+};
+
+#endif
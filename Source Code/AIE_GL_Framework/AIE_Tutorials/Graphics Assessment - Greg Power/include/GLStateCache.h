@@ -0,0 +1,183 @@
+#ifndef _GLSTATECACHE_H_
+#define _GLSTATECACHE_H_
+
+#include <GL\glew.h>
+
+// The GL entry points the state cache passes calls on to, the state it
+// filters and the draw time calls around it that it passes straight through.
+// The default table calls straight through to GL, a different one can be
+// swapped in to watch or stand in for what reaches the driver.
+struct GLStateFunctions
+{
+	void (GLAPIENTRY *pfnUseProgram)( GLuint );
+	void (GLAPIENTRY *pfnBindVertexArray)( GLuint );
+	void (GLAPIENTRY *pfnActiveTexture)( GLenum );
+	void (GLAPIENTRY *pfnBindTexture)( GLenum, GLuint );
+	void (GLAPIENTRY *pfnEnable)( GLenum );
+	void (GLAPIENTRY *pfnDisable)( GLenum );
+	void (GLAPIENTRY *pfnDepthMask)( GLboolean );
+	void (GLAPIENTRY *pfnBlendFunc)( GLenum, GLenum );
+	void (GLAPIENTRY *pfnPolygonMode)( GLenum, GLenum );
+	void (GLAPIENTRY *pfnFrontFace)( GLenum );
+	void (GLAPIENTRY *pfnDeleteTextures)( GLsizei, const GLuint* );
+	void (GLAPIENTRY *pfnDeleteVertexArrays)( GLsizei, const GLuint* );
+
+	void (GLAPIENTRY *pfnClear)( GLbitfield );
+	void (GLAPIENTRY *pfnViewport)( GLint, GLint, GLsizei, GLsizei );
+	void (GLAPIENTRY *pfnBindFramebuffer)( GLenum, GLuint );
+	void (GLAPIENTRY *pfnBindBuffer)( GLenum, GLuint );
+	void (GLAPIENTRY *pfnBindBufferBase)( GLenum, GLuint, GLuint );
+	void (GLAPIENTRY *pfnBufferData)( GLenum, GLsizeiptr, const GLvoid*, GLenum );
+	void (GLAPIENTRY *pfnBufferSubData)( GLenum, GLintptr, GLsizeiptr, const GLvoid* );
+	void (GLAPIENTRY *pfnUniform1i)( GLint, GLint );
+	void (GLAPIENTRY *pfnUniform1f)( GLint, GLfloat );
+	void (GLAPIENTRY *pfnUniform2f)( GLint, GLfloat, GLfloat );
+	void (GLAPIENTRY *pfnUniform1fv)( GLint, GLsizei, const GLfloat* );
+	void (GLAPIENTRY *pfnUniform4fv)( GLint, GLsizei, const GLfloat* );
+	void (GLAPIENTRY *pfnUniformMatrix4fv)( GLint, GLsizei, GLboolean, const GLfloat* );
+	void (GLAPIENTRY *pfnPointSize)( GLfloat );
+	void (GLAPIENTRY *pfnPatchParameteri)( GLenum, GLint );
+	void (GLAPIENTRY *pfnDrawArrays)( GLenum, GLint, GLsizei );
+	void (GLAPIENTRY *pfnDrawElements)( GLenum, GLsizei, GLenum, const GLvoid* );
+	void (GLAPIENTRY *pfnDrawElementsInstanced)( GLenum, GLsizei, GLenum, const GLvoid*, GLsizei );
+};
+
+const GLStateFunctions&	GetDefaultGLFunctions();
+
+// what the cache was asked to do, for the issued and skipped counts
+enum EGLStateCall
+{
+	GL_STATE_CALL_PROGRAM = 0,
+	GL_STATE_CALL_VERTEX_ARRAY,
+	GL_STATE_CALL_ACTIVE_TEXTURE,
+	GL_STATE_CALL_TEXTURE,
+	GL_STATE_CALL_CAPABILITY,
+	GL_STATE_CALL_DEPTH_MASK,
+	GL_STATE_CALL_BLEND_FUNC,
+	GL_STATE_CALL_POLYGON_MODE,
+	GL_STATE_CALL_FRONT_FACE,
+
+	GL_STATE_CALL_COUNT
+};
+
+struct GLStateStats
+{
+	unsigned int	auiIssued[ GL_STATE_CALL_COUNT ];
+	unsigned int	auiSkipped[ GL_STATE_CALL_COUNT ];
+
+	unsigned int	GetIssued() const;
+	unsigned int	GetSkipped() const;
+};
+
+const unsigned int MAX_CACHED_TEXTURE_UNITS = 8;
+
+// Remembers the program, vertex array, texture bindings and the blend, depth
+// and cull state last sent to GL and drops calls that would set them to what
+// they already are. Everything starts unknown so the first call of each kind
+// always goes through.
+//
+// It only knows what went through it, so the render code binds and deletes
+// through here rather than GL. Code that can't should call Invalidate after.
+// Texture units past MAX_CACHED_TEXTURE_UNITS, texture targets other than 2D,
+// 2D array and cube map and capabilities other than blend, depth test and
+// cull face are passed on every time.
+//
+// The uniform, buffer, frame buffer and draw calls a frame makes aren't
+// filtered, they come through here only so one table sees all of a frame.
+class GLStateCache
+{
+public:
+							GLStateCache();
+
+	// a_poFunctions must outlive its use, nullptr goes back to the default
+	void					SetFunctions( const GLStateFunctions* a_poFunctions );
+	const GLStateFunctions*	GetFunctions() const		{ return m_poGL; }
+
+	void					UseProgram( GLuint a_uiProgram );
+	void					BindVertexArray( GLuint a_uiVertexArray );
+	void					ActiveTexture( GLenum a_eUnit );
+	void					BindTexture( GLenum a_eTarget, GLuint a_uiTexture );
+	void					Enable( GLenum a_eCapability );
+	void					Disable( GLenum a_eCapability );
+	void					DepthMask( GLboolean a_bWrite );
+	void					BlendFunc( GLenum a_eSource, GLenum a_eDestination );
+	void					PolygonMode( GLenum a_eFace, GLenum a_eMode );
+	void					FrontFace( GLenum a_eMode );
+
+	// GL unbinds a deleted object, so the cache has to forget it as well
+	// or a new object given the same name would be skipped
+	void					DeleteTextures( GLsizei a_iCount, const GLuint* a_puiTextures );
+	void					DeleteVertexArrays( GLsizei a_iCount, const GLuint* a_puiVertexArrays );
+
+	// passed straight on
+	void					Clear( GLbitfield a_uiMask )															{ m_poGL->pfnClear( a_uiMask ); }
+	void					Viewport( GLint a_iX, GLint a_iY, GLsizei a_iWidth, GLsizei a_iHeight )				{ m_poGL->pfnViewport( a_iX, a_iY, a_iWidth, a_iHeight ); }
+	void					BindFramebuffer( GLenum a_eTarget, GLuint a_uiFramebuffer )							{ m_poGL->pfnBindFramebuffer( a_eTarget, a_uiFramebuffer ); }
+	void					BindBuffer( GLenum a_eTarget, GLuint a_uiBuffer )										{ m_poGL->pfnBindBuffer( a_eTarget, a_uiBuffer ); }
+	void					BindBufferBase( GLenum a_eTarget, GLuint a_uiIndex, GLuint a_uiBuffer )				{ m_poGL->pfnBindBufferBase( a_eTarget, a_uiIndex, a_uiBuffer ); }
+	void					BufferData( GLenum a_eTarget, GLsizeiptr a_iSize, const GLvoid* a_pData, GLenum a_eUsage )		{ m_poGL->pfnBufferData( a_eTarget, a_iSize, a_pData, a_eUsage ); }
+	void					BufferSubData( GLenum a_eTarget, GLintptr a_iOffset, GLsizeiptr a_iSize, const GLvoid* a_pData )	{ m_poGL->pfnBufferSubData( a_eTarget, a_iOffset, a_iSize, a_pData ); }
+	void					Uniform1i( GLint a_iLocation, GLint a_iValue )											{ m_poGL->pfnUniform1i( a_iLocation, a_iValue ); }
+	void					Uniform1f( GLint a_iLocation, GLfloat a_fValue )										{ m_poGL->pfnUniform1f( a_iLocation, a_fValue ); }
+	void					Uniform2f( GLint a_iLocation, GLfloat a_fX, GLfloat a_fY )								{ m_poGL->pfnUniform2f( a_iLocation, a_fX, a_fY ); }
+	void					Uniform1fv( GLint a_iLocation, GLsizei a_iCount, const GLfloat* a_pfValues )			{ m_poGL->pfnUniform1fv( a_iLocation, a_iCount, a_pfValues ); }
+	void					Uniform4fv( GLint a_iLocation, GLsizei a_iCount, const GLfloat* a_pfValues )			{ m_poGL->pfnUniform4fv( a_iLocation, a_iCount, a_pfValues ); }
+	void					UniformMatrix4fv( GLint a_iLocation, GLsizei a_iCount, GLboolean a_bTranspose, const GLfloat* a_pfValues )	{ m_poGL->pfnUniformMatrix4fv( a_iLocation, a_iCount, a_bTranspose, a_pfValues ); }
+	void					PointSize( GLfloat a_fSize )															{ m_poGL->pfnPointSize( a_fSize ); }
+	void					PatchParameteri( GLenum a_eName, GLint a_iValue )										{ m_poGL->pfnPatchParameteri( a_eName, a_iValue ); }
+	void					DrawArrays( GLenum a_eMode, GLint a_iFirst, GLsizei a_iCount )							{ m_poGL->pfnDrawArrays( a_eMode, a_iFirst, a_iCount ); }
+	void					DrawElements( GLenum a_eMode, GLsizei a_iCount, GLenum a_eType, const GLvoid* a_pIndices )	{ m_poGL->pfnDrawElements( a_eMode, a_iCount, a_eType, a_pIndices ); }
+	void					DrawElementsInstanced( GLenum a_eMode, GLsizei a_iCount, GLenum a_eType, const GLvoid* a_pIndices, GLsizei a_iInstances )	{ m_poGL->pfnDrawElementsInstanced( a_eMode, a_iCount, a_eType, a_pIndices, a_iInstances ); }
+
+	// forget everything, the next call of each kind goes through
+	void					Invalidate();
+
+	// starts a new frame's counts, the last frame's stay readable
+	void					BeginFrame();
+	const GLStateStats&		GetFrameStats() const		{ return m_oFrameStats; }
+	const GLStateStats&		GetLastFrameStats() const	{ return m_oLastFrameStats; }
+
+private:
+	enum
+	{
+		TEXTURE_TARGET_2D = 0,
+		TEXTURE_TARGET_2D_ARRAY,
+		TEXTURE_TARGET_CUBE_MAP,
+		TEXTURE_TARGET_COUNT,
+
+		CAPABILITY_BLEND = 0,
+		CAPABILITY_DEPTH_TEST,
+		CAPABILITY_CULL_FACE,
+		CAPABILITY_COUNT,
+	};
+
+	// what a cached GLuint or GLenum holds while it isn't known
+	static const GLuint		UNKNOWN = 0xffffffff;
+
+	static int				GetTextureTargetIndex( GLenum a_eTarget );
+	static int				GetCapabilityIndex( GLenum a_eCapability );
+	void					SetCapability( GLenum a_eCapability, bool a_bEnabled );
+
+	// true if the call should go through, and counts it either way
+	bool					Changed( EGLStateCall a_eCall, GLuint& a_ruiCached, GLuint a_uiValue );
+
+	const GLStateFunctions*	m_poGL;
+
+	GLuint					m_uiProgram;
+	GLuint					m_uiVertexArray;
+	GLuint					m_uiActiveUnit;		// GL_TEXTURE0 based like glActiveTexture
+	GLuint					m_auiTextures[ MAX_CACHED_TEXTURE_UNITS ][ TEXTURE_TARGET_COUNT ];
+	GLuint					m_auiCapabilities[ CAPABILITY_COUNT ];
+	GLuint					m_uiDepthMask;
+	GLuint					m_uiBlendSource;
+	GLuint					m_uiBlendDestination;
+	GLuint					m_uiPolygonMode;	// GL_FRONT_AND_BACK only
+	GLuint					m_uiFrontFace;
+
+	GLStateStats			m_oFrameStats;
+	GLStateStats			m_oLastFrameStats;
+};
+
+GLStateCache&	GetGLState();
+
+#endif
@@ -2,8 +2,10 @@
 #define _GSLAB02_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
+#include "InstanceBatch.h"
 #include "Skybox.h"
 
 class GSLab02 : public IBaseGameState
@@ -22,13 +24,12 @@ private:
 	EGameState	m_eStateID;
 	
 	Quaternion	m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float		m_fTimer;
 
 	Skybox*		m_poRoom;
 	PlaneNode*	m_poTitle;
-	PlaneNode*	m_poPainting01;
-	PlaneNode*	m_poPainting02;
-	PlaneNode*	m_poPainting03;
+	InstanceBatch*	m_poPaintings;
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define _GSLAB03_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
 #include "IcosphereNode.h"
@@ -29,6 +30,7 @@ private:
 	PlaneNode*			m_poTitle;
 	
 	Quaternion			m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float				m_fTimer;
 };
 
@@ -2,6 +2,7 @@
 #define _GSLAB04_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
 #include "Skybox.h"
@@ -25,6 +26,7 @@ private:
 	PlaneNode*	m_poTerrain;
 	
 	Quaternion	m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float		m_fTimer;
 };
 
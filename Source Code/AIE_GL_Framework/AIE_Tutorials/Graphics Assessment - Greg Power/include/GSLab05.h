@@ -2,6 +2,7 @@
 #define _GSLAB05_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "FBXLoader.h"
 #include "PlaneNode.h"
@@ -26,6 +27,7 @@ private:
 	FBXScene	m_oScene;
 	
 	Quaternion	m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float		m_fTimer;
 };
 
@@ -2,6 +2,7 @@
 #define _GSLAB07_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
 #include "Skybox.h"
@@ -30,6 +31,7 @@ private:
 	ParticleManager*	m_pParticleManager;
 	
 	Quaternion			m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float				m_fTimer;
 };
 
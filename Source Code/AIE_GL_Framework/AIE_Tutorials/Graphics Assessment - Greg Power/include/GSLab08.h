@@ -2,6 +2,7 @@
 #define _GSLAB08_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
 #include "Skybox.h"
@@ -29,6 +30,7 @@ private:
 	IcosphereNode*	m_poIcosphere;
 	
 	Quaternion		m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float			m_fTimer;
 };
 
@@ -2,9 +2,11 @@
 #define _GSLAB09_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
 #include "FBXLoader.h"
+#include "SkeletonAnimator.h"
 
 class GSLab09 : public IBaseGameState
 {
@@ -24,7 +26,9 @@ private:
 	EGameState	m_eStateID;
 	PlaneNode*	m_poTitle;
 	FBXScene	m_oScene;
+	SkeletonAnimator	m_oAnimator;
 		
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float		m_fTimer;
 };
 
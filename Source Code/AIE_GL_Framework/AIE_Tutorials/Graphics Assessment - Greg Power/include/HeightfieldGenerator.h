@@ -0,0 +1,30 @@
+#ifndef _HEIGHTFIELDGENERATOR_H_
+#define _HEIGHTFIELDGENERATOR_H_
+
+// Batched PerlinNoise2D heightfield generation. The grid is split into row
+// tiles that run as job system jobs, and each row is evaluated 4 samples at
+// a time with SSE2 for the hashing and smoothing.
+// Results are bit-identical to calling PerlinNoise2D per vertex, which
+// GenerateHeightfieldScalar still does for comparison. No GL is involved.
+
+static const int MAX_NOISE_OCTAVES = 16;
+
+// per octave frequency and amplitude, computed once rather than with pow()
+// for every sample
+struct NoiseOctaves
+{
+	int		iNumOctaves;
+	float	afFrequency[ MAX_NOISE_OCTAVES ];
+	float	afAmplitude[ MAX_NOISE_OCTAVES ];
+};
+
+void	BuildNoiseOctaves( NoiseOctaves& a_rOctaves, float a_fPersistence, int a_iNumOctaves );
+
+// Fills a_afHeights[z * a_iVertsWidth + x] with
+// PerlinNoise2D( x / width, z / length, persistence, octaves ) * heightScale.
+// Spread over the job system's threads, on the calling thread alone if it
+// hasn't been started.
+void	GenerateHeightfield( float* a_afHeights, int a_iVertsWidth, int a_iVertsLength, float a_fPersistence, int a_iNumOctaves, float a_fHeightScale );
+void	GenerateHeightfieldScalar( float* a_afHeights, int a_iVertsWidth, int a_iVertsLength, float a_fPersistence, int a_iNumOctaves, float a_fHeightScale );
+
+#endif
@@ -36,6 +36,7 @@ public:
 	{
 		m_pApp = pApp;
 	}
+	virtual ~IBaseGameState() {}
 
 	virtual void Load()						= 0;
 	virtual void Unload()					= 0;
@@ -0,0 +1,60 @@
+#ifndef _INSTANCEBATCH_H_
+#define _INSTANCEBATCH_H_
+
+#include <vector>
+#include "MeshNode.h"
+#include "SharedMesh.h"
+
+// Attribute slots the instanced programs bind their per instance inputs to,
+// after MeshNode's Position (0) and UV (1). The model matrix takes four.
+const GLuint INSTANCE_ATTRIB_LAYERS	= 2;
+const GLuint INSTANCE_ATTRIB_MODEL	= 3;
+
+// What the instance buffer holds for each copy
+struct InstanceData
+{
+	AIE::mat4		mModel;
+	float			afLayers[4];	// texture array layer for diffuse and secondary, then padding
+};
+
+// Every copy of one shared mesh drawn with a single glDrawElementsInstanced.
+// Each instance has its own model matrix and its own layer in the batch's
+// texture arrays. Queued with the render manager like any other node, under
+// one of the instanced programs, which take their matrix from the instance
+// buffer rather than Model. Those programs skip the tessellation stages, so
+// the batch draws triangles rather than patches.
+class InstanceBatch : public MeshNode
+{
+public:
+	// takes over the caller's reference on a_poMesh
+						InstanceBatch( SharedMesh* a_poMesh );
+						~InstanceBatch();
+
+	// an instance scaled by a_vScale, moved with Rotate/TranslateInstance
+	// the way MeshNode moves through its model matrix
+	unsigned int		AddInstance( AIE::vec4 a_vScale, float a_fLayer = 0.f, float a_fSecondaryLayer = 0.f );
+	void				RotateInstance( unsigned int a_uiInstance, Quaternion& a_qRot );
+	void				TranslateInstance( unsigned int a_uiInstance, AIE::vec4 a_vTrans );
+	void				SetInstanceModel( unsigned int a_uiInstance, const AIE::mat4& a_mModel );
+	const AIE::mat4&	GetInstanceModel( unsigned int a_uiInstance ) const	{ return m_aoInstances[ a_uiInstance ].mModel; }
+	unsigned int		GetInstanceCount() const							{ return m_aoInstances.size(); }
+
+	// arrays from LoadTextureArray, the batch owns them from here on and
+	// releases any it had before
+	void				SetTextureArrays( GLuint a_uiTextureArray, GLuint a_uiSecondaryArray = 0 );
+
+	void				DrawMesh();
+	// the instance buffer may need uploading first, so the batch draws itself
+	bool				GetDrawParameters( GLuint& a_ruiVAO, unsigned int& a_ruiIndexCount )	{ return false; }
+
+private:
+	// the node's position is the middle of its instances, for sorting
+	void				InstancesChanged();
+
+	SharedMesh*					m_poMesh;
+	GLuint						m_uiInstanceVBO;
+	std::vector<InstanceData>	m_aoInstances;
+	bool						m_bInstancesDirty;	// the buffer is behind m_aoInstances
+};
+
+#endif
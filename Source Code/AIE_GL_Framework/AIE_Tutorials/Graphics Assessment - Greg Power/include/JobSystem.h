@@ -0,0 +1,124 @@
+#ifndef _JOBSYSTEM_H_
+#define _JOBSYSTEM_H_
+
+#include <vector>
+#include <GL\glfw.h>
+
+struct Job;
+
+// a_pData is the job's own copy of what CreateJob was given
+typedef void (*JobFunction)( Job* a_poJob, const void* a_pData );
+
+// ParallelFor hands each job a range [a_uiBegin, a_uiEnd) of the whole
+typedef void (*ParallelForFunction)( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pData );
+
+const unsigned int JOB_DATA_SIZE			= 44;
+const unsigned int MAX_JOBS_PER_THREAD		= 4096;	// a power of two
+const unsigned int MAX_JOB_THREADS			= 32;
+// ranges a ParallelFor splits into at most, it uses twice that many jobs
+const unsigned int MAX_PARALLEL_FOR_RANGES	= 1024;
+
+// One unit of work, a cache line each so workers finishing neighbouring
+// jobs don't fight over the line. lUnfinished counts the job itself plus
+// its children that haven't finished, it's done when that reaches 0 and
+// only then does its parent's count drop.
+struct __declspec(align(64)) Job
+{
+	JobFunction		pfnFunction;
+	Job*			poParent;
+	volatile long	lUnfinished;
+	unsigned char	aucData[ JOB_DATA_SIZE ];
+};
+
+// Chase-Lev deque of jobs. The thread that owns it pushes and pops at the
+// bottom, any other thread steals from the top, and only the last job left
+// needs a compare exchange to settle who gets it.
+class WorkStealingQueue
+{
+public:
+					WorkStealingQueue();
+
+	// owner only
+	void			Push( Job* a_poJob );
+	Job*			Pop();
+	// any thread
+	Job*			Steal();
+
+private:
+	Job*			m_apJobs[ MAX_JOBS_PER_THREAD ];
+	volatile long	m_lTop;
+	char			m_acPadding[64];	// keeps thieves off the owner's line
+	volatile long	m_lBottom;
+};
+
+// Worker threads, one per core less the main thread, that run jobs from
+// their own queue and steal from the others' when it's empty. The main
+// thread is worker 0 and runs jobs as well while it waits on them.
+//
+// Jobs come from a ring per thread that isn't freed, only reused, so no
+// thread may have more than MAX_JOBS_PER_THREAD of its jobs unfinished at
+// once. Only the main thread and the workers may create or wait on jobs.
+class JobSystem
+{
+public:
+							JobSystem();
+							~JobSystem();
+
+	// a_uiNumThreads of 0 uses one less than the processor count
+	void					Start( unsigned int a_uiNumThreads = 0 );
+	void					Stop();
+	bool					IsRunning() const		{ return m_uiNumThreads > 0; }
+	// the workers and the main thread
+	unsigned int			GetThreadCount() const	{ return m_uiNumThreads + 1; }
+
+	// up to JOB_DATA_SIZE bytes of a_pData are copied into the job
+	Job*					CreateJob( JobFunction a_pfnFunction, const void* a_pData = nullptr, unsigned int a_uiSize = 0 );
+	// a_poParent won't be finished until this job is, create children
+	// before the parent has been Run or from inside the parent
+	Job*					CreateChildJob( Job* a_poParent, JobFunction a_pfnFunction, const void* a_pData = nullptr, unsigned int a_uiSize = 0 );
+	void					Run( Job* a_poJob );
+	// runs other jobs until a_poJob and all of its children are finished
+	void					Wait( const Job* a_poJob );
+
+	// Calls a_pfnFunction over [0, a_uiCount) split into ranges of at most
+	// a_uiGrainSize, each starting on a multiple of it, and returns once
+	// they've all run. A grain size of 0 gives each thread a few ranges, and
+	// the grain grows by whole multiples past MAX_PARALLEL_FOR_RANGES.
+	// Without workers the whole range runs on the calling thread.
+	void					ParallelFor( unsigned int a_uiCount, unsigned int a_uiGrainSize, ParallelForFunction a_pfnFunction, void* a_pData );
+
+private:
+	struct WorkerStart
+	{
+		JobSystem*			poJobSystem;
+		unsigned int		uiThreadIndex;
+	};
+
+	static void GLFWCALL	WorkerThread( void* a_pStart );
+
+	Job*					AllocateJob();
+	Job*					GetJob();
+	void					Execute( Job* a_poJob );
+	void					Finish( Job* a_poJob );
+
+	// per thread, index 0 being the main thread
+	WorkStealingQueue*		m_aoQueues;
+	Job*					m_aoJobPool;		// MAX_JOBS_PER_THREAD for each thread
+	unsigned char*			m_pucJobMemory;		// m_aoJobPool's block, before aligning
+	unsigned int			m_auiAllocated[ MAX_JOB_THREADS ];
+	WorkerStart				m_aoStarts[ MAX_JOB_THREADS ];
+
+	unsigned int			m_uiNumThreads;
+	std::vector<GLFWthread>	m_aiThreads;
+
+	// idle workers sleep on m_oJobReady until something is Run
+	GLFWmutex				m_oMutex;
+	GLFWcond				m_oJobReady;
+	volatile long			m_lQueuedJobs;		// Run but not yet taken from a queue
+	volatile long			m_lSleeping;
+	volatile long			m_lQuit;
+};
+
+JobSystem&	GetJobSystem();
+
+#endif
@@ -6,6 +6,7 @@
 #include "MathHelper.h"
 #include "SceneNode.h"
 #include "Utilities.h"
+#include "Frustum.h"
 
 class MeshNode : public SceneNode
 {
@@ -17,6 +18,8 @@ public:
 	GLuint						GetTexture()				{ return m_iTextureID; }
 	GLuint						GetSecondaryTexture()		{ return m_iSecondaryTextureID; }
 	GLuint						GetDisplacementTexture()	{ return m_iDisplacementTexID; }
+	// what the textures bind to, GL_TEXTURE_2D_ARRAY for instanced batches
+	GLenum						GetTextureTarget()			{ return m_eTextureTarget; }
 	AIE::vec4					GetColour()					{ return m_vColour; }
 	void						SetTexture( GLuint a_uiTextureID )			{ m_iTextureID = a_uiTextureID; }
 	void						SetSecondaryTexture( GLuint a_uiTextureID ) { m_iSecondaryTextureID = a_uiTextureID; }
@@ -24,10 +27,27 @@ public:
 	void						SetColour( AIE::vec4 a_vColour ){ m_vColour = a_vColour; }
 	void						TranslateNode( AIE::vec4 a_vTrans );
 	void						RotateNode( Quaternion &a_qRot );
+	void						UseModelMatrix();
+	bool						UsesModelMatrix()			{ return m_bUseModelMatrix; }
+	AIE::mat4&					GetModelMatrix()			{ return m_modelMatrix; }
+	// bounds of the geometry as it's drawn, what the render manager culls with
+	void						GetWorldBounds( Bounds& a_rBounds );
+	// for shaders that move vertices further than the geometry says
+	void						SetBoundsPadding( float a_fPadding )	{ m_fBoundsPadding = a_fPadding; }
 	virtual void				Update( float a_fDeltaTime );
 	void						Draw();
+	// Draw() in two halves, for callers that track what's already bound
+	void						BindTextures();
+	virtual void				DrawMesh();
+	// what DrawMesh binds and draws, for callers that make the calls later
+	// through DrawPatches. False for nodes whose DrawMesh does more than that.
+	virtual bool				GetDrawParameters( GLuint& a_ruiVAO, unsigned int& a_ruiIndexCount );
+	static void					DrawPatches( GLuint a_uiVAO, unsigned int a_uiIndexCount );
 
 protected:
+	// from m_aoVertices, whenever they're uploaded
+	void						UpdateBounds();
+
 	GLuint						m_iVAO;
 	GLuint						m_iVBO;
 	GLuint						m_iIBO;
@@ -35,6 +55,7 @@ protected:
 	GLuint						m_iTextureID;
 	GLuint						m_iSecondaryTextureID;
 	GLuint						m_iDisplacementTexID;
+	GLenum						m_eTextureTarget;
 	GLuint						m_iShaderID;
 
 	std::vector<AIE::Vertex>	m_aoVertices;
@@ -45,6 +66,15 @@ protected:
 
 	AIE::vec4					m_vColour;
 
+	// once set, the GPU geometry is left as is and Translate/RotateNode
+	// only update m_modelMatrix, which the render manager uploads as Model
+	bool						m_bUseModelMatrix;
+	AIE::mat4					m_modelMatrix;
+
+	// around the uploaded vertices, so in model space once m_modelMatrix is used
+	Bounds						m_oBounds;
+	float						m_fBoundsPadding;
+
 };
 
 #endif
\ No newline at end of file
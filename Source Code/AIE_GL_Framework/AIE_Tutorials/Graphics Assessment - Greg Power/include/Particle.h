@@ -8,30 +8,15 @@ union PSize{
 	struct{ AIE::vec2 size;			};
 };
 
+// Interleaved layout the particle shaders read, packed from the ParticleStore
+// streams each frame. Attribute offsets are 0, 16, 24 and 32.
 struct ParticleVertex
-{
-	union
-	{
-		struct{	AIE::vec4 position;	};
-		struct{ float x, y, z, w;	};
-	};
-
-	bool operator == (const ParticleVertex& rhs)
-	{
-		return ( x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w );
-	}
-};
-
-struct Particle
 {
 	AIE::vec4	vPosition;
 	PSize		oSize;
 	float		fAlpha;
-	AIE::vec4	vOldPosition;
-	AIE::vec4	vVelocity;
+	float		fPadding;
 	AIE::vec4	vColour;
-	float		fEnergy;
-	bool		bIsDead;
 };
 
 #endif
\ No newline at end of file
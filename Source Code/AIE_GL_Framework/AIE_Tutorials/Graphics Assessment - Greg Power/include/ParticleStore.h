@@ -0,0 +1,66 @@
+#ifndef _PARTICLESTORE_H_
+#define _PARTICLESTORE_H_
+
+#include "MathHelper.h"
+
+// Structure of arrays particle storage. Each attribute lives in its own
+// 32 byte aligned float stream so the update kernel can load and store 4
+// particles per SSE step straight from it. Nothing in here touches OpenGL,
+// so the kernel can be driven headlessly, e.g. from a micro-benchmark.
+struct ParticleStore
+{
+					ParticleStore();
+					~ParticleStore();
+
+	// false, leaving the store empty, if the streams couldn't be allocated
+	bool			Allocate( unsigned int a_uiCount );
+	void			Release();
+
+	// copies every stream of particle a_uiFrom over particle a_uiTo
+	void			Copy( unsigned int a_uiFrom, unsigned int a_uiTo );
+
+	unsigned int	uiCount;
+
+	float*			afPosX;
+	float*			afPosY;
+	float*			afPosZ;
+	float*			afVelX;
+	float*			afVelY;
+	float*			afVelZ;
+	float*			afEnergy;
+	float*			afAlpha;
+	float*			afWidth;
+	float*			afHeight;
+	float*			afColourR;
+	float*			afColourG;
+	float*			afColourB;
+	float*			afColourA;
+
+private:
+	// non-copyable, the streams are owned
+					ParticleStore( const ParticleStore& );
+	ParticleStore&	operator=( const ParticleStore& );
+};
+
+// Per-update constants for IntegrateParticles
+struct ParticleStep
+{
+	AIE::vec4		vAcceleration;	// gravity + wind
+	float			fDeltaTime;
+	float			fAlphaScale;	// alpha = energy * scale
+	float			fAlphaMax;
+};
+
+// Integrates particles [a_uiFirst, a_uiFirst + a_uiCount) one step:
+//	velocity += acceleration * dt
+//	position += velocity * dt
+//	alpha     = min( energy * alphaScale, alphaMax )
+//	energy   -= dt
+// Uses aligned SSE steps when the build targets SSE, with the particles
+// either side of them done on their own.
+void				IntegrateParticles( ParticleStore& a_rStore, unsigned int a_uiFirst, unsigned int a_uiCount, const ParticleStep& a_rStep );
+
+// Plain C++ version of the same step, used for the tail and for comparison
+void				IntegrateParticlesScalar( ParticleStore& a_rStore, unsigned int a_uiFirst, unsigned int a_uiCount, const ParticleStep& a_rStep );
+
+#endif
@@ -2,6 +2,7 @@
 #define _PARTICLESYSTEM_H_
 
 #include "Particle.h"
+#include "ParticleStore.h"
 #include <vector>
 #include <string>
 
@@ -37,7 +38,13 @@ public:
 	virtual void			Draw( AIE::mat4& a_projectionMat, AIE::mat4& a_viewMat, AIE::mat4& a_modelMat, AIE::mat4& a_vCameraMat );
 
 protected:
-	GLuint					m_uiVAO, m_uiVBO;
+	void					EmitParticle( unsigned int a_uiIndex );
+	void					KillParticle( unsigned int a_uiIndex );
+	// packs [a_uiBegin, a_uiEnd), the job system's ranges come through PackRange
+	void					PackVertices( unsigned int a_uiBegin, unsigned int a_uiEnd );
+	static void				PackRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pSystem );
+
+	GLuint					m_uiVAO;			// reads the stream buffer
 	//////GLuint					m_FBO, m_FBT, m_FBD;
 	//////GLuint					m_iRenderBufferID;
 
@@ -45,10 +52,15 @@ protected:
 	AIE::vec4				m_vEmitterSize;
 	int						m_iEmissionsPerSec;
 	float					m_fNumToRelease;
-	std::vector<Particle>	m_aParticleArray;
+	ParticleStore			m_oParticles;
+	ParticleVertex*			m_pVertices;		// this frame's, in the stream buffer, while they're packed
+	unsigned int			m_uiFirstVertex;	// where this frame's vertices start in the stream buffer
+	unsigned int			m_uiNumDrawn;
+	unsigned int			m_uiFrame;			// the stream buffer's frame they were written in
 	GLuint					m_iTextureID;
 	int						m_iSystemType;
-	int						m_iNumParticlesAlive;
+	int						m_iMaxParticles;
+	unsigned int			m_uiNumAlive;		// live particles are kept packed in [0, m_uiNumAlive)
 	AIE::vec4				m_vVelocityMin;
 	AIE::vec4				m_vVelocityMax;
 	AIE::vec4				m_vGravity;
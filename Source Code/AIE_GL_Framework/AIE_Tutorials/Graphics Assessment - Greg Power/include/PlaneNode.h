@@ -11,6 +11,11 @@ public:
 	void			BuildVertsIndices();
 	void			Update( float a_fDeltaTime );
 	void			Draw();
+
+	// appends the grid PlaneNode builds, centred on a_vTranslation in the XZ
+	// plane. The shared mesh registry makes its unit planes from this too.
+	static void		BuildGeometry( float a_fWidth, float a_fHeight, int a_iVertsWidth, int a_iVertsLength, const AIE::vec4& a_vTranslation,
+								   std::vector<AIE::Vertex>& a_rVertices, std::vector<unsigned int>& a_rIndices );
 protected:
 	float			m_fWidth, m_fHeight;
 	int				m_iVertsWidth;
@@ -26,7 +26,7 @@ public:
 
 	Quaternion& Normalize()
 	{
-		float fScale = x*x + y*y * z*z + w*w;
+		float fScale = x*x + y*y + z*z + w*w;
 		float fRScale = 1.0f / sqrtf(fScale);
 		return ((*this) *= fRScale);
 	}
@@ -113,6 +113,46 @@ public:
 		return Quaternion(rhs*x, rhs*y, rhs*z, rhs*w);
 	}
 
+	// normalised linear interpolation, cheap and fine for small angles
+	static Quaternion Nlerp( const Quaternion& a_qStart, const Quaternion& a_qEnd, float a_fT )
+	{
+		// take the shortest path
+		float fSign = a_qStart.Dot( a_qEnd ) < 0.f ? -1.f : 1.f;
+		float fStart = 1.f - a_fT;
+		float fEnd = a_fT * fSign;
+
+		Quaternion quat(	a_qStart.w * fStart + a_qEnd.w * fEnd,
+							a_qStart.x * fStart + a_qEnd.x * fEnd,
+							a_qStart.y * fStart + a_qEnd.y * fEnd,
+							a_qStart.z * fStart + a_qEnd.z * fEnd	);
+		return quat.Normalize();
+	}
+
+	// spherical linear interpolation, falls back to Nlerp when the angle is tiny
+	static Quaternion Slerp( const Quaternion& a_qStart, const Quaternion& a_qEnd, float a_fT )
+	{
+		float fCosTheta = a_qStart.Dot( a_qEnd );
+		float fSign = 1.f;
+		if( fCosTheta < 0.f )
+		{
+			fCosTheta = -fCosTheta;
+			fSign = -1.f;
+		}
+
+		if( fCosTheta > 0.9995f )
+			return Nlerp( a_qStart, a_qEnd, a_fT );
+
+		float fTheta = acosf( fCosTheta );
+		float fRSinTheta = 1.f / sinf( fTheta );
+		float fStart = sinf( (1.f - a_fT) * fTheta ) * fRSinTheta;
+		float fEnd = sinf( a_fT * fTheta ) * fRSinTheta * fSign;
+
+		return Quaternion(	a_qStart.w * fStart + a_qEnd.w * fEnd,
+							a_qStart.x * fStart + a_qEnd.x * fEnd,
+							a_qStart.y * fStart + a_qEnd.y * fEnd,
+							a_qStart.z * fStart + a_qEnd.z * fEnd	);
+	}
+
 	void CreateRotation( float a_fRad, AIE::vec4 a_vAxis )
 	{
 		w = cosf( a_fRad/2 );
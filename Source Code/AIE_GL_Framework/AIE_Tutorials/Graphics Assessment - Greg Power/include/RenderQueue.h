@@ -0,0 +1,113 @@
+#ifndef _RENDERQUEUE_H_
+#define _RENDERQUEUE_H_
+
+#include <vector>
+#include <map>
+#include "MathHelper.h"
+#include "Frustum.h"
+
+class MeshNode;
+
+// Passes are drawn in this order, the pass is the top of the sort key
+enum ERenderPass
+{
+	RENDER_PASS_OPAQUE = 0,
+	RENDER_PASS_TRANSPARENT,	// back to front within a shader and texture set
+	RENDER_PASS_REFRACTION,
+	RENDER_PASS_OVERLAY,
+
+	RENDER_PASS_COUNT
+};
+
+// How a queue's pass is drawn, each game state sets up its own. Blending is
+// always on.
+struct RenderPassState
+{
+	bool	bDepthWrite;
+	bool	bCullFace;
+	bool	bWireframe;
+};
+
+typedef unsigned int RenderHandle;
+const RenderHandle INVALID_RENDER_HANDLE = 0xffffffff;
+
+// One node to draw this frame. Key bits from the top:
+// pass 4 | shader 8 | texture set 20 | depth 32
+struct DrawPacket
+{
+	unsigned long long	ulKey;
+	MeshNode*			poNode;
+	unsigned int		uiShader;
+};
+
+// The nodes of one game state. Add hands back a handle that Remove takes
+// back in constant time, Sort turns every live node inside the frustum into a
+// packet and radix sorts them so nodes sharing a program and textures come
+// out together. The frustum tests are spread over the job system, the
+// packets are made in live order after.
+class RenderQueue
+{
+public:
+								RenderQueue();
+								~RenderQueue();
+
+	// a_uiShader is the caller's own shader slot, lower slots draw first
+	RenderHandle				Add( MeshNode* a_poNode, unsigned int a_uiShader, ERenderPass a_ePass );
+	void						Remove( RenderHandle a_hNode );
+
+	unsigned int				GetCount() const	{ return m_auiLive.size(); }
+	// live nodes in a_ePass whether the frustum keeps them or not
+	unsigned int				GetPassCount( ERenderPass a_ePass ) const	{ return m_auiPassLive[ a_ePass ]; }
+
+	// every pass starts out depth written, culled and filled
+	void						SetPassState( ERenderPass a_ePass, const RenderPassState& a_rState )	{ m_aoPassStates[ a_ePass ] = a_rState; }
+	const RenderPassState&		GetPassState( ERenderPass a_ePass ) const	{ return m_aoPassStates[ a_ePass ]; }
+
+	void						Sort( const AIE::vec4& a_vCameraPos, const Frustum& a_rFrustum );
+	// live nodes the last Sort left out
+	unsigned int				GetCulledCount() const	{ return m_uiCulled; }
+
+	// valid until the next Sort
+	const std::vector<DrawPacket>&	GetPackets() const	{ return m_aoPackets; }
+	void						GetPassRange( ERenderPass a_eFirst, ERenderPass a_eLast, unsigned int& a_uiBegin, unsigned int& a_uiEnd ) const;
+
+	static unsigned long long	MakeKey( ERenderPass a_ePass, unsigned int a_uiShader, unsigned int a_uiTextureSet, float a_fDistanceSq );
+
+	// least significant byte first, a_rScratch is resized to match
+	static void					RadixSort( std::vector<DrawPacket>& a_rPackets, std::vector<DrawPacket>& a_rScratch );
+
+private:
+	struct QueueEntry
+	{
+		MeshNode*		poNode;			// null while the slot is free
+		unsigned int	uiShader;
+		ERenderPass		ePass;
+		unsigned int	uiLiveIndex;	// position in m_auiLive, or the next free slot
+	};
+
+	unsigned int				GetTextureSet( MeshNode* a_poNode );
+	// m_afDistanceSq for [a_uiBegin, a_uiEnd) of m_auiLive
+	static void					CullRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pQueue );
+
+	std::vector<QueueEntry>		m_aoEntries;
+	std::vector<unsigned int>	m_auiLive;		// slots in use, packed
+	unsigned int				m_uiFreeSlot;
+	unsigned int				m_auiPassLive[ RENDER_PASS_COUNT ];
+	RenderPassState				m_aoPassStates[ RENDER_PASS_COUNT ];
+
+	// texture sets are numbered as they're first seen
+	std::map<unsigned long long, unsigned int>	m_oTextureSets;
+
+	// per live node, its distance from the camera squared or less than 0
+	// if the frustum left it out
+	std::vector<float>			m_afDistanceSq;
+	AIE::vec4					m_vCullCameraPos;
+	const Frustum*				m_poCullFrustum;	// only during Sort
+
+	std::vector<DrawPacket>		m_aoPackets;
+	std::vector<DrawPacket>		m_aoScratch;
+	unsigned int				m_auiPassStart[ RENDER_PASS_COUNT + 1 ];
+	unsigned int				m_uiCulled;
+};
+
+#endif
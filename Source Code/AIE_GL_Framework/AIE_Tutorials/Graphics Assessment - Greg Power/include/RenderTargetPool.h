@@ -0,0 +1,80 @@
+#ifndef _RENDERTARGETPOOL_H_
+#define _RENDERTARGETPOOL_H_
+
+#include <vector>
+#include <GL\glew.h>
+
+// What a pass needs to draw into. Targets with an equal descriptor are
+// interchangeable.
+struct RenderTargetDesc
+{
+	GLenum			eFormat;		// internal format of the colour texture
+	unsigned int	uiWidth;
+	unsigned int	uiHeight;
+	bool			bDepth;			// attach a depth render buffer
+
+	bool			operator == ( const RenderTargetDesc& a_rOther ) const
+	{
+		return	eFormat == a_rOther.eFormat && uiWidth == a_rOther.uiWidth &&
+				uiHeight == a_rOther.uiHeight && bDepth == a_rOther.bDepth;
+	}
+};
+
+struct RenderTarget
+{
+	RenderTargetDesc	oDesc;
+	GLuint				uiFBO;
+	GLuint				uiTexture;
+	GLuint				uiDepth;		// 0 without a depth buffer
+
+	// one over the size, what the TexelSize uniform wants
+	float				fTexelWidth;
+	float				fTexelHeight;
+
+	bool				bInUse;
+	unsigned int		uiLastUsedFrame;
+	unsigned int		uiGeneration;	// the pool's size when it was made
+};
+
+// Frame buffers handed out by descriptor. A pass acquires what it draws
+// into and releases it once the next pass has read it, so a released
+// target goes to the next pass asking for the same descriptor rather than
+// a new allocation. Screen sized descriptors follow Resize().
+class RenderTargetPool
+{
+public:
+							RenderTargetPool();
+							~RenderTargetPool();
+
+	// drops every target, the next Acquire creates them at the new size
+	void					Resize( unsigned int a_uiWidth, unsigned int a_uiHeight );
+	unsigned int			GetWidth() const	{ return m_uiWidth; }
+	unsigned int			GetHeight() const	{ return m_uiHeight; }
+
+	// the window size divided by a_uiDivisor, never smaller than 1x1
+	RenderTargetDesc		ScreenDesc( GLenum a_eFormat, unsigned int a_uiDivisor = 1, bool a_bDepth = true ) const;
+
+	RenderTarget*			Acquire( const RenderTargetDesc& a_rDesc );
+	void					Release( RenderTarget* a_poTarget );
+
+	// binds the frame buffer and sets the viewport to cover it, null binds
+	// the back buffer at the window size
+	void					Bind( RenderTarget* a_poTarget ) const;
+
+	// destroys free targets nothing has asked for in a while
+	void					BeginFrame();
+
+	unsigned int			GetTargetCount() const	{ return m_apoTargets.size(); }
+
+private:
+	RenderTarget*			CreateTarget( const RenderTargetDesc& a_rDesc );
+	void					DestroyTarget( RenderTarget* a_poTarget );
+
+	std::vector<RenderTarget*>	m_apoTargets;
+	unsigned int				m_uiWidth;
+	unsigned int				m_uiHeight;
+	unsigned int				m_uiFrame;
+	unsigned int				m_uiGeneration;	// bumped by each Resize
+};
+
+#endif
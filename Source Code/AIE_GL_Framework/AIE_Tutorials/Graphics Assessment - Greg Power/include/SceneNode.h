@@ -16,15 +16,18 @@ public:
 						SceneNode( AIE::vec4 a_translation, SceneNode *a_pParent = nullptr );
 						~SceneNode();
 	inline SceneNode 	*GetParent() { return m_pParent; }
-	inline void 		SetParent( SceneNode *a_pParent ) { m_pParent = a_pParent; }
+	inline void 		SetParent( SceneNode *a_pParent ) { m_pParent = a_pParent; MarkWorldDirty(); }
 	virtual void		Update( float a_fDeltaTime );
 	void				RegisterChild( SceneNode* a_child );
 	void				DeregisterChild( SceneNode* a_child );
 	void				DeleteAllChildren();
-	AIE::mat4			GetWorldTransform();
-	AIE::mat4&			GetLocalTransform() { return m_localTransform; }
-	void				SetLocalTransform( AIE::mat4 a_transform )	{ m_localTransform = a_transform; }
-	virtual void		TranslateNode( AIE::vec4 a_vTrans )			{ m_localTransform.row3 = a_vTrans; }
+	const AIE::mat4&	GetWorldTransform();
+	// read only, for jobs, valid once GetWorldTransform has run since the node last moved
+	const AIE::mat4&	GetResolvedWorldTransform() const { return m_worldTransform; }
+	const AIE::mat4&	GetLocalTransform() { return m_localTransform; }
+	void				SetLocalTransform( AIE::mat4 a_transform )	{ m_localTransform = a_transform; MarkWorldDirty(); }
+	virtual void		TranslateNode( AIE::vec4 a_vTrans )			{ m_localTransform.row3 = a_vTrans; MarkWorldDirty(); }
+	void				UpdateWorldTransforms();
 	//AIE::mat4&		GetRotation() { return m_rotation; }
 	//void				SetRotation( AIE::mat4 a_rot ) { m_rotation = a_rot; }
 	AIE::mat4			GetRotationMatrix();
@@ -35,9 +38,13 @@ public:
 	//mat4				GetParentRotation();
 
 protected:
+	void				MarkWorldDirty();
+
 	eNodeType			m_eType;
 	SceneNode 			*m_pParent;
 	AIE::mat4			m_localTransform;
+	AIE::mat4			m_worldTransform;	// local * parent's world, valid while m_bWorldDirty is false
+	bool				m_bWorldDirty;		// if set, every descendant is dirty as well
 	Quaternion			m_qRotation;
 	AIE::mat4			m_rotation;
 
@@ -0,0 +1,28 @@
+#ifndef _SHADERPROGRAMCACHE_H_
+#define _SHADERPROGRAMCACHE_H_
+
+#include <GL\glew.h>
+
+// Drop in for AIE::LoadShader that keeps linked programs on disk. The key is
+// a hash of every stage's source, the attribute and output bindings and the
+// GL_VENDOR/GL_RENDERER/GL_VERSION strings, so editing a shader or changing
+// driver just misses. A hit loads the blob with glProgramBinary, a miss or a
+// blob the driver rejects compiles with AIE::LoadShader and stores the result
+// from glGetProgramBinary. Without ARB_get_program_binary it is only
+// AIE::LoadShader. Like LoadShader the program is left bound.
+//
+// Every stage has g_szShaderHeaderPath spliced in after its #version line,
+// which holds the FrameData block so no shader declares it itself.
+GLuint LoadCachedShader( unsigned int a_uiInputAttributeCount, const char** a_aszInputAttributes,
+						 unsigned int a_uiOutputAttributeCount, const char** a_aszOutputAttributes,
+						 const char* a_szVertexShader, const char* a_szPixelShader,
+						 const char* a_szGeometryShader = nullptr,
+						 const char* a_szTessellationControlShader = nullptr, const char* a_szTessellationEvaluationShader = nullptr );
+
+// where the blobs go, relative to the working directory
+extern const char* g_szShaderCacheDirectory;
+
+// code shared by every stage, relative to the working directory
+extern const char* g_szShaderHeaderPath;
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef _SHADERREFLECTION_H_
+#define _SHADERREFLECTION_H_
+
+#include <vector>
+#include <string>
+#include <GL\glew.h>
+
+// Uniforms the render manager sets by handle. Each program resolves these to
+// its own locations once, so drawing is an array index instead of a
+// glGetUniformLocation string lookup. Names are in g_aszUniformNames.
+// The camera, time and lights aren't here, they're in the FrameData block.
+enum UniformHandle
+{
+	UNIFORM_MODEL,
+	UNIFORM_COLOUR,
+	UNIFORM_DISTANCE,
+	UNIFORM_PASS_NUMBER,
+	UNIFORM_DIFFUSE_TEXTURE,
+	UNIFORM_SECONDARY_TEXTURE,
+	UNIFORM_DISPLACEMENT_TEXTURE,
+	UNIFORM_NORMAL_TEXTURE,
+	UNIFORM_SPECULAR_TEXTURE,
+	UNIFORM_TEXTURE,
+	UNIFORM_SCENE_TEXTURE,
+	UNIFORM_WATER_BUMP_MAP,
+	UNIFORM_RENDER_BUFFER,
+	UNIFORM_MATERIAL_DIFFUSE,
+	UNIFORM_BONE_ARRAY,
+	UNIFORM_TEXEL_SIZE,
+
+	UNIFORM_HANDLE_COUNT
+};
+
+extern const char* g_aszUniformNames[ UNIFORM_HANDLE_COUNT ];
+
+// One active uniform as reported by the driver, under its full GL name so
+// members of struct arrays stay apart, "lights[0].colour" and
+// "lights[1].colour". Only a trailing "[0]" is dropped, an array's first
+// element is found by its base name as well, "boneArray[0]" is "boneArray".
+struct UniformInfo
+{
+	std::string		sName;
+	unsigned int	uiHash;
+	GLenum			eType;
+	GLint			iSize;
+	GLint			iLocation;
+};
+
+// Active uniforms of one linked program, enumerated once with
+// glGetProgramiv( GL_ACTIVE_UNIFORMS ) and kept in an open addressed table
+// keyed on the name hash. Only Reflect() talks to GL.
+class ShaderReflection
+{
+public:
+							ShaderReflection();
+							~ShaderReflection();
+
+	void					Reflect( GLuint a_uiProgram );
+
+	GLuint					GetProgram() const { return m_uiProgram; }
+
+	// -1 when the program doesn't use the uniform, which glUniform* ignores
+	GLint					GetLocation( UniformHandle a_eHandle ) const { return m_aiHandleLocations[ a_eHandle ]; }
+	GLint					FindLocation( const char* a_szName ) const;
+	const UniformInfo*		FindUniform( const char* a_szName ) const;
+
+	unsigned int			GetUniformCount() const { return m_aoUniforms.size(); }
+	const UniformInfo&		GetUniform( unsigned int a_uiIndex ) const { return m_aoUniforms[ a_uiIndex ]; }
+
+	static unsigned int		HashName( const char* a_szName, unsigned int a_uiLength );
+	// a_szName's length less any trailing "[0]"
+	static unsigned int		GetBaseNameLength( const char* a_szName, unsigned int a_uiLength );
+
+private:
+	void					BuildTable();
+
+	enum : unsigned int { EMPTY_SLOT = 0xffffffff };
+
+	GLuint						m_uiProgram;
+	std::vector<UniformInfo>	m_aoUniforms;
+	std::vector<unsigned int>	m_auiTable;		// indices into m_aoUniforms, size is a power of two
+	GLint						m_aiHandleLocations[ UNIFORM_HANDLE_COUNT ];
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef _SHAREDMESH_H_
+#define _SHAREDMESH_H_
+
+#include <string>
+#include <GL\glew.h>
+#include "Frustum.h"
+
+// Geometry uploaded once and drawn by everything that asks for the same
+// primitive. The buffers are laid out like MeshNode's, Position in attribute
+// 0 and UV in 1, and never change after they're made.
+struct SharedMesh
+{
+	GLuint			uiVBO;
+	GLuint			uiIBO;
+	unsigned int	uiNumVerts;
+	unsigned int	uiNumIndices;
+	Bounds			oBounds;		// in the mesh's own space
+
+	unsigned int	uiRefCount;
+	std::string		sKey;
+};
+
+// Unit sized primitives centred on the origin, anything bigger gets there
+// through its model matrix. Each call counts a reference on the mesh it
+// hands back.
+SharedMesh*		AcquirePlaneMesh( int a_iVertsWidth, int a_iVertsLength );	// 1x1 in the XZ plane
+SharedMesh*		AcquireCubeMesh();
+void			ReleaseSharedMesh( SharedMesh* a_poMesh );
+
+// meshes currently registered
+unsigned int	GetSharedMeshCount();
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef _SKELETONANIMATOR_H_
+#define _SKELETONANIMATOR_H_
+
+#include <vector>
+
+#include "FBXLoader.h"
+#include "Quaternion.h"
+
+// Plays an FBXAnimation on an FBXSkeleton without going through the FBX SDK.
+// Each track keeps a cursor to its current keyframe pair, so playing forward
+// only ever steps to the next pair, and seeking falls back to a binary search.
+class SkeletonAnimator
+{
+public:
+					SkeletonAnimator();
+					~SkeletonAnimator();
+
+	void			SetAnimation( FBXSkeleton* a_pSkeleton, const FBXAnimation* a_pAnimation );
+	void			Evaluate( float a_fTime, bool a_bLoop = true, float a_fFPS = 24.f );
+
+private:
+	unsigned int	FindKeyFrame( const FBXTrack& a_rTrack, unsigned int a_uiCursor, unsigned int a_uiFrame ) const;
+	void			ComposeTQS( const vec4& a_vTranslation, const Quaternion& a_qRotation, const vec4& a_vScale, mat4& a_rOut ) const;
+
+	FBXSkeleton*				m_pSkeleton;
+	const FBXAnimation*			m_pAnimation;
+	std::vector<unsigned int>	m_auiCursors;
+};
+
+#endif
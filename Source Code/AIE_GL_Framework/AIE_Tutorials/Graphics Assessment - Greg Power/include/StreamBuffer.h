@@ -0,0 +1,123 @@
+#ifndef _STREAMBUFFER_H_
+#define _STREAMBUFFER_H_
+
+#include <GL\glew.h>
+
+const unsigned int STREAM_SEGMENT_COUNT	= 3;				// frames the GPU can be behind
+const unsigned int STREAM_SEGMENT_SIZE	= 2 * 1024 * 1024;
+
+// Where a ring's fences come from, GL sync objects in the game and anything
+// that can be told what has finished elsewhere
+class IFenceSource
+{
+public:
+	virtual			~IFenceSource() {}
+
+	// marks everything submitted so far, 0 on failure
+	virtual GLsync	Insert() = 0;
+	// true once the GPU is past a_pFence, waiting up to a_ulTimeout nanoseconds
+	virtual bool	Wait( GLsync a_pFence, GLuint64 a_ulTimeout ) = 0;
+	virtual void	Delete( GLsync a_pFence ) = 0;
+};
+
+class GLFenceSource : public IFenceSource
+{
+public:
+	GLsync			Insert();
+	bool			Wait( GLsync a_pFence, GLuint64 a_ulTimeout );
+	void			Delete( GLsync a_pFence );
+};
+
+// The bookkeeping of a buffer split into segments used a frame at a time in
+// turn. A segment is fenced as its frame ends and waited on before it comes
+// round again, so nothing written into it is still being read. Offsets are
+// from the start of the whole buffer.
+class RingAllocator
+{
+public:
+	static const unsigned int	NO_SPACE = 0xffffffff;
+
+								RingAllocator( IFenceSource* a_poFences );
+								~RingAllocator();
+
+	// a_uiSegmentCount is at most STREAM_SEGMENT_COUNT
+	void						Init( unsigned int a_uiSegmentSize, unsigned int a_uiSegmentCount = STREAM_SEGMENT_COUNT );
+	// deletes the fences still out, while the source can still take them
+	void						Reset();
+
+	// moves on to the next segment once the GPU is done with it, false if
+	// that took longer than a_ulTimeout, the segment is used anyway
+	bool						BeginSegment( GLuint64 a_ulTimeout = 1000000000 );
+	// a_uiSize bytes starting on a multiple of a_uiAlignment, which needn't
+	// be a power of two, or NO_SPACE if the segment hasn't room
+	unsigned int				Allocate( unsigned int a_uiSize, unsigned int a_uiAlignment );
+	void						EndSegment();
+
+	unsigned int				GetSegment() const			{ return m_uiSegment; }
+	unsigned int				GetSegmentStart() const		{ return m_uiSegment * m_uiSegmentSize; }
+	unsigned int				GetSegmentSize() const		{ return m_uiSegmentSize; }
+	unsigned int				GetSize() const				{ return m_uiSegmentSize * m_uiSegmentCount; }
+	unsigned int				GetUsed() const				{ return m_uiUsed; }
+
+	// segments that weren't free yet when they came round, and allocations
+	// turned down for want of room
+	unsigned int				GetStalls() const			{ return m_uiStalls; }
+	unsigned int				GetFailures() const			{ return m_uiFailures; }
+
+private:
+	IFenceSource*				m_poFences;
+	GLsync						m_apFences[ STREAM_SEGMENT_COUNT ];
+	unsigned int				m_uiSegmentCount;
+	unsigned int				m_uiSegmentSize;
+	unsigned int				m_uiSegment;
+	unsigned int				m_uiUsed;			// in the current segment
+	bool						m_bInSegment;
+
+	unsigned int				m_uiStalls;
+	unsigned int				m_uiFailures;
+};
+
+// Per frame vertex data written straight into a buffer that stays mapped.
+// Needs glBufferStorage, GL 4.4 or ARB_buffer_storage, for a persistent
+// coherent mapping. Without it each frame's segment is mapped unsynchronised
+// in BeginFrame and unmapped in Flush, the fences keep that safe as well.
+//
+// A frame goes BeginFrame, Allocate and write, Flush, draw, EndFrame. Data
+// allocated in a frame is only valid for that frame's draws.
+class StreamBuffer
+{
+public:
+							StreamBuffer();
+							~StreamBuffer();
+
+	// needs a context, false if the buffer couldn't be made
+	bool					Create( unsigned int a_uiSegmentSize = STREAM_SEGMENT_SIZE );
+	void					Destroy();
+
+	void					BeginFrame();
+	// somewhere to write a_uiSize bytes, at a_ruiOffset from the start of
+	// GetBuffer(), or nullptr if there's no room this frame
+	void*					Allocate( unsigned int a_uiSize, unsigned int a_uiAlignment, unsigned int& a_ruiOffset );
+	// everything allocated this frame is written
+	void					Flush();
+	void					EndFrame();
+
+	GLuint					GetBuffer() const		{ return m_uiBuffer; }
+	// counts BeginFrame, so allocations can be told apart from last frame's
+	unsigned int			GetFrame() const		{ return m_uiFrame; }
+	bool					IsPersistent() const	{ return m_bPersistent; }
+	const RingAllocator&	GetRing() const			{ return m_oRing; }
+
+private:
+	GLFenceSource			m_oFences;
+	RingAllocator			m_oRing;
+	GLuint					m_uiBuffer;
+	unsigned char*			m_pucMapped;		// the whole buffer if persistent, else the frame's segment
+	bool					m_bPersistent;
+	bool					m_bInFrame;
+	unsigned int			m_uiFrame;
+};
+
+StreamBuffer&	GetStreamBuffer();
+
+#endif
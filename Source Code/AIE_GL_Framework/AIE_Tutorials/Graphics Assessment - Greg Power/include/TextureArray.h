@@ -0,0 +1,15 @@
+#ifndef _TEXTUREARRAY_H_
+#define _TEXTUREARRAY_H_
+
+#include <GL\glew.h>
+
+// Loads a_uiCount images into the layers of one GL_TEXTURE_2D_ARRAY, layer i
+// being a_aszPaths[i]. Every layer takes the size of the first image and any
+// that differ are rescaled to it. Images that fail to load leave their layer
+// black. Decodes on the calling thread, unlike AcquireTexture, and gives
+// back 0 if the first image can't be read. ReleaseTextureArray frees it, the
+// texture cache knows nothing of arrays.
+GLuint	LoadTextureArray( const char** a_aszPaths, unsigned int a_uiCount, unsigned int a_uiFormat = GL_RGBA );
+void	ReleaseTextureArray( GLuint a_uiTextureID );
+
+#endif
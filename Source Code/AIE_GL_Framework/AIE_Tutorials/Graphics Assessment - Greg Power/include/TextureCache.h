@@ -0,0 +1,78 @@
+#ifndef _TEXTURECACHE_H_
+#define _TEXTURECACHE_H_
+
+#include <map>
+#include <string>
+#include <GL\glew.h>
+
+// Creates and destroys the actual textures for a TextureCache. The GL
+// version goes through the AsyncTextureLoader once it's running and
+// AIE::LoadTexture before that, tests can plug in one that just hands out ids.
+class ITextureBackend
+{
+public:
+	virtual			~ITextureBackend() {}
+
+	// 0 on failure, a_uiBytes is what the texture occupies once uploaded or 0
+	// if that isn't known yet
+	virtual GLuint	CreateTexture( const char* a_szPath, unsigned int a_uiFormat, unsigned int& a_uiBytes ) = 0;
+	virtual void	DestroyTexture( GLuint a_uiTextureID ) = 0;
+};
+
+class GLTextureBackend : public ITextureBackend
+{
+public:
+	GLuint			CreateTexture( const char* a_szPath, unsigned int a_uiFormat, unsigned int& a_uiBytes );
+	void			DestroyTexture( GLuint a_uiTextureID );
+};
+
+// Textures keyed by canonical path and upload format. Acquire hands back the
+// same GL id for the same image and counts a reference, Release drops one and
+// destroys the texture when none are left. Ids the cache didn't hand out are
+// left alone, whoever made them frees them.
+class TextureCache
+{
+public:
+						TextureCache( ITextureBackend* a_poBackend );
+						~TextureCache();
+
+	GLuint				Acquire( const char* a_szPath, unsigned int a_uiFormat = GL_RGBA );
+	void				Release( GLuint a_uiTextureID );
+
+	// references held on a texture, 0 if the cache doesn't own it
+	unsigned int		GetRefCount( GLuint a_uiTextureID ) const;
+
+	// for backends that only know the size once the data arrives
+	void				SetTextureBytes( GLuint a_uiTextureID, unsigned int a_uiBytes );
+
+	unsigned int		GetHits() const				{ return m_uiHits; }
+	unsigned int		GetMisses() const			{ return m_uiMisses; }
+	unsigned int		GetResidentCount() const	{ return m_oEntries.size(); }
+	unsigned int		GetResidentBytes() const	{ return m_uiResidentBytes; }
+
+	// lower case, forward slashes, "." and ".." segments folded away
+	static std::string	CanonicalPath( const char* a_szPath );
+
+private:
+	struct TextureEntry
+	{
+		GLuint			uiTextureID;
+		unsigned int	uiRefCount;
+		unsigned int	uiBytes;
+	};
+
+	ITextureBackend*					m_poBackend;
+	std::map<std::string, TextureEntry>	m_oEntries;
+	std::map<GLuint, std::string>		m_oKeysByID;
+
+	unsigned int						m_uiHits;
+	unsigned int						m_uiMisses;
+	unsigned int						m_uiResidentBytes;
+};
+
+// the application wide cache on the GL backend
+TextureCache&	GetTextureCache();
+GLuint			AcquireTexture( const char* a_szPath, unsigned int a_uiFormat = GL_RGBA );
+void			ReleaseTexture( GLuint a_uiTextureID );
+
+#endif
@@ -0,0 +1,380 @@
+#include "AsyncTextureLoader.h"
+#include "GLStateCache.h"
+
+#include <FreeImage.h>
+#include <string.h>
+#include <stdio.h>
+
+// staging buffers kept around for reuse once their upload is done
+static const unsigned int MAX_POOLED_STAGING = 4;
+
+void BuildMipChain( std::vector<unsigned char>& a_rData, unsigned int a_uiWidth, unsigned int a_uiHeight, std::vector<MipLevel>& a_rLevels )
+{
+	a_rLevels.clear();
+
+	MipLevel oLevel;
+	oLevel.uiWidth	= a_uiWidth;
+	oLevel.uiHeight	= a_uiHeight;
+	oLevel.uiOffset	= 0;
+	a_rLevels.push_back( oLevel );
+
+	// size the whole chain first so the source level doesn't move under us
+	unsigned int uiTotal = 0;
+	for( unsigned int w = a_uiWidth, h = a_uiHeight; ; w = w > 1 ? w/2 : 1, h = h > 1 ? h/2 : 1 )
+	{
+		uiTotal += w * h * 4;
+		if( w == 1 && h == 1 )
+			break;
+	}
+	a_rData.resize( uiTotal );
+
+	while( oLevel.uiWidth > 1 || oLevel.uiHeight > 1 )
+	{
+		MipLevel oNext;
+		oNext.uiWidth	= oLevel.uiWidth > 1 ? oLevel.uiWidth/2 : 1;
+		oNext.uiHeight	= oLevel.uiHeight > 1 ? oLevel.uiHeight/2 : 1;
+		oNext.uiOffset	= oLevel.uiOffset + oLevel.uiWidth * oLevel.uiHeight * 4;
+
+		const unsigned char*	pSrc = &a_rData[ oLevel.uiOffset ];
+		unsigned char*			pDst = &a_rData[ oNext.uiOffset ];
+
+		// average each 2x2 block, a 1 texel wide side just repeats itself
+		unsigned int uiStepX = oLevel.uiWidth > 1 ? 4 : 0;
+		unsigned int uiStepY = oLevel.uiHeight > 1 ? oLevel.uiWidth * 4 : 0;
+
+		for( unsigned int y = 0; y < oNext.uiHeight; ++y )
+		{
+			const unsigned char* pRow = pSrc + (y * 2) * oLevel.uiWidth * 4;
+			for( unsigned int x = 0; x < oNext.uiWidth; ++x )
+			{
+				const unsigned char* p = pRow + (x * 2) * 4;
+				for( unsigned int c = 0; c < 4; ++c )
+				{
+					unsigned int uiSum = p[c] + p[c + uiStepX] + p[c + uiStepY] + p[c + uiStepX + uiStepY];
+					*pDst++ = (unsigned char)((uiSum + 2) / 4);
+				}
+			}
+		}
+
+		a_rLevels.push_back( oNext );
+		oLevel = oNext;
+	}
+}
+
+AsyncTextureLoader::AsyncTextureLoader()
+{
+	m_oMutex			= nullptr;
+	m_oJobReady			= nullptr;
+	m_bQuit				= false;
+	m_uiNextTicket		= 1;
+	m_uiUnpackBuffer	= 0;
+	m_uiUploadBudget	= 4 * 1024 * 1024;
+	m_pfnLoaded			= nullptr;
+}
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+	// Stop() has to have been called while GL and GLFW were still up
+	for( unsigned int i = 0; i < m_apStagingPool.size(); ++i )
+	{
+		delete m_apStagingPool[i];
+	}
+}
+
+void AsyncTextureLoader::Start( unsigned int a_uiNumThreads )
+{
+	if( IsRunning() )
+		return;
+
+	if( a_uiNumThreads == 0 )
+	{
+		// leave a core for the render thread
+		int iProcessors = glfwGetNumberOfProcessors();
+		a_uiNumThreads = iProcessors > 1 ? iProcessors - 1 : 1;
+	}
+
+	m_bQuit		= false;
+	m_oMutex	= glfwCreateMutex();
+	m_oJobReady	= glfwCreateCond();
+	glGenBuffers( 1, &m_uiUnpackBuffer );
+
+	for( unsigned int i = 0; i < a_uiNumThreads; ++i )
+	{
+		GLFWthread iThread = glfwCreateThread( WorkerThread, this );
+		if( iThread >= 0 )
+			m_aiThreads.push_back( iThread );
+	}
+}
+
+void AsyncTextureLoader::Stop()
+{
+	if( !IsRunning() )
+		return;
+
+	glfwLockMutex( m_oMutex );
+	m_bQuit = true;
+	glfwBroadcastCond( m_oJobReady );
+	glfwUnlockMutex( m_oMutex );
+
+	for( unsigned int i = 0; i < m_aiThreads.size(); ++i )
+	{
+		glfwWaitThread( m_aiThreads[i], GLFW_WAIT );
+	}
+	m_aiThreads.clear();
+
+	// nobody is going to upload these now
+	for( unsigned int i = 0; i < m_oCompleted.size(); ++i )
+	{
+		ReleaseStaging( m_oCompleted[i].pData );
+	}
+	m_oCompleted.clear();
+	m_oRequests.clear();
+	m_oPending.clear();
+
+	glDeleteBuffers( 1, &m_uiUnpackBuffer );
+	m_uiUnpackBuffer = 0;
+
+	glfwDestroyCond( m_oJobReady );
+	glfwDestroyMutex( m_oMutex );
+	m_oJobReady	= nullptr;
+	m_oMutex	= nullptr;
+}
+
+GLuint AsyncTextureLoader::Request( const char* a_szPath, unsigned int a_uiFormat )
+{
+	static const unsigned char s_aucPlaceholder[4] = { 255, 255, 255, 255 };
+
+	GLuint uiTextureID;
+	glGenTextures( 1, &uiTextureID );
+	GetGLState().BindTexture( GL_TEXTURE_2D, uiTextureID );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, s_aucPlaceholder );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+	GetGLState().BindTexture( GL_TEXTURE_2D, 0 );
+
+	LoadJob oJob;
+	oJob.uiTextureID	= uiTextureID;
+	oJob.uiTicket		= m_uiNextTicket++;
+	oJob.uiFormat		= a_uiFormat;
+	oJob.sPath			= a_szPath;
+	oJob.pData			= nullptr;
+
+	m_oPending[ uiTextureID ] = oJob.uiTicket;
+
+	glfwLockMutex( m_oMutex );
+	m_oRequests.push_back( oJob );
+	glfwSignalCond( m_oJobReady );
+	glfwUnlockMutex( m_oMutex );
+
+	return uiTextureID;
+}
+
+void AsyncTextureLoader::Cancel( GLuint a_uiTextureID )
+{
+	// the job still runs, Update() just won't upload it
+	m_oPending.erase( a_uiTextureID );
+}
+
+void AsyncTextureLoader::Update()
+{
+	if( !IsRunning() )
+		return;
+
+	unsigned int uiUploaded = 0;
+
+	while( true )
+	{
+		LoadJob oJob;
+
+		glfwLockMutex( m_oMutex );
+		if( m_oCompleted.empty() )
+		{
+			glfwUnlockMutex( m_oMutex );
+			break;
+		}
+
+		// always let one through so a texture over the budget still loads
+		unsigned int uiSize = m_oCompleted.front().pData != nullptr ? m_oCompleted.front().pData->size() : 0;
+		if( uiUploaded > 0 && uiUploaded + uiSize > m_uiUploadBudget )
+		{
+			glfwUnlockMutex( m_oMutex );
+			break;
+		}
+
+		oJob = m_oCompleted.front();
+		m_oCompleted.pop_front();
+		glfwUnlockMutex( m_oMutex );
+
+		std::map<GLuint, unsigned int>::iterator iter = m_oPending.find( oJob.uiTextureID );
+		if( iter != m_oPending.end() && iter->second == oJob.uiTicket )
+		{
+			m_oPending.erase( iter );
+
+			if( oJob.pData != nullptr )
+			{
+				UploadJob( oJob );
+				uiUploaded += uiSize;
+
+				if( m_pfnLoaded != nullptr )
+					m_pfnLoaded( oJob.uiTextureID, uiSize );
+			}
+		}
+
+		ReleaseStaging( oJob.pData );
+	}
+}
+
+void AsyncTextureLoader::UploadJob( LoadJob& a_rJob )
+{
+	unsigned int uiSize = a_rJob.pData->size();
+
+	// orphan the old storage so we never wait on the previous upload
+	glBindBuffer( GL_PIXEL_UNPACK_BUFFER, m_uiUnpackBuffer );
+	glBufferData( GL_PIXEL_UNPACK_BUFFER, uiSize, nullptr, GL_STREAM_DRAW );
+	void* pMapped = glMapBufferRange( GL_PIXEL_UNPACK_BUFFER, 0, uiSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT );
+	if( pMapped != nullptr )
+	{
+		memcpy( pMapped, &(*a_rJob.pData)[0], uiSize );
+		glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER );
+	}
+	else
+	{
+		glBufferSubData( GL_PIXEL_UNPACK_BUFFER, 0, uiSize, &(*a_rJob.pData)[0] );
+	}
+
+	GetGLState().BindTexture( GL_TEXTURE_2D, a_rJob.uiTextureID );
+	for( unsigned int i = 0; i < a_rJob.aoLevels.size(); ++i )
+	{
+		const MipLevel& rLevel = a_rJob.aoLevels[i];
+		glTexImage2D( GL_TEXTURE_2D, i, GL_RGBA, rLevel.uiWidth, rLevel.uiHeight, 0, a_rJob.uiFormat, GL_UNSIGNED_BYTE, (char*)0 + rLevel.uiOffset );
+	}
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, a_rJob.aoLevels.size() - 1 );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+	GetGLState().BindTexture( GL_TEXTURE_2D, 0 );
+
+	glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+}
+
+void GLFWCALL AsyncTextureLoader::WorkerThread( void* a_pLoader )
+{
+	AsyncTextureLoader* pLoader = (AsyncTextureLoader*)a_pLoader;
+
+	glfwLockMutex( pLoader->m_oMutex );
+	while( true )
+	{
+		while( pLoader->m_oRequests.empty() && !pLoader->m_bQuit )
+		{
+			glfwWaitCond( pLoader->m_oJobReady, pLoader->m_oMutex, GLFW_INFINITY );
+		}
+
+		if( pLoader->m_bQuit )
+			break;
+
+		LoadJob oJob = pLoader->m_oRequests.front();
+		pLoader->m_oRequests.pop_front();
+		glfwUnlockMutex( pLoader->m_oMutex );
+
+		pLoader->DecodeJob( oJob );
+
+		glfwLockMutex( pLoader->m_oMutex );
+		pLoader->m_oCompleted.push_back( oJob );
+	}
+	glfwUnlockMutex( pLoader->m_oMutex );
+}
+
+void AsyncTextureLoader::DecodeJob( LoadJob& a_rJob )
+{
+	FIBITMAP* pBitmap = nullptr;
+
+	FREE_IMAGE_FORMAT fif = FreeImage_GetFileType( a_rJob.sPath.c_str(), 0 );
+	if( fif != FIF_UNKNOWN && FreeImage_FIFSupportsReading( fif ) )
+	{
+		pBitmap = FreeImage_Load( fif, a_rJob.sPath.c_str() );
+	}
+
+	if( pBitmap == nullptr )
+	{
+		printf( "Error: Failed to load image '%s'!\n", a_rJob.sPath.c_str() );
+		return;
+	}
+
+	// everything goes up as 8 bit RGBA so the mips can be built the same way
+	if( FreeImage_GetImageType( pBitmap ) != FIT_BITMAP )
+	{
+		FIBITMAP* pStandard = FreeImage_ConvertToStandardType( pBitmap );
+		FreeImage_Unload( pBitmap );
+		pBitmap = pStandard;
+	}
+	if( pBitmap != nullptr && FreeImage_GetBPP( pBitmap ) != 32 )
+	{
+		FIBITMAP* p32 = FreeImage_ConvertTo32Bits( pBitmap );
+		FreeImage_Unload( pBitmap );
+		pBitmap = p32;
+	}
+	if( pBitmap == nullptr )
+	{
+		printf( "Error: Failed to convert image '%s'!\n", a_rJob.sPath.c_str() );
+		return;
+	}
+
+	unsigned int uiWidth	= FreeImage_GetWidth( pBitmap );
+	unsigned int uiHeight	= FreeImage_GetHeight( pBitmap );
+
+	a_rJob.pData = AcquireStaging();
+	a_rJob.pData->resize( uiWidth * uiHeight * 4 );
+
+	// scanlines can be padded, copy them out tightly packed
+	for( unsigned int y = 0; y < uiHeight; ++y )
+	{
+		memcpy( &(*a_rJob.pData)[ y * uiWidth * 4 ], FreeImage_GetScanLine( pBitmap, y ), uiWidth * 4 );
+	}
+	FreeImage_Unload( pBitmap );
+
+	BuildMipChain( *a_rJob.pData, uiWidth, uiHeight, a_rJob.aoLevels );
+}
+
+std::vector<unsigned char>* AsyncTextureLoader::AcquireStaging()
+{
+	std::vector<unsigned char>* pData = nullptr;
+
+	glfwLockMutex( m_oMutex );
+	if( !m_apStagingPool.empty() )
+	{
+		pData = m_apStagingPool.back();
+		m_apStagingPool.pop_back();
+	}
+	glfwUnlockMutex( m_oMutex );
+
+	if( pData == nullptr )
+		pData = new std::vector<unsigned char>();
+	return pData;
+}
+
+void AsyncTextureLoader::ReleaseStaging( std::vector<unsigned char>* a_pData )
+{
+	if( a_pData == nullptr )
+		return;
+
+	if( m_oMutex != nullptr )
+		glfwLockMutex( m_oMutex );
+
+	if( m_apStagingPool.size() < MAX_POOLED_STAGING )
+	{
+		a_pData->clear();
+		m_apStagingPool.push_back( a_pData );
+		a_pData = nullptr;
+	}
+
+	if( m_oMutex != nullptr )
+		glfwUnlockMutex( m_oMutex );
+
+	delete a_pData;
+}
+
+AsyncTextureLoader& GetTextureLoader()
+{
+	static AsyncTextureLoader s_oLoader;
+	return s_oLoader;
+}
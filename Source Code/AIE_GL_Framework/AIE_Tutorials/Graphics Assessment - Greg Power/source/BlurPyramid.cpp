@@ -0,0 +1,217 @@
+#include "BlurPyramid.h"
+#include "GLStateCache.h"
+#include "ShaderProgramCache.h"
+
+#include <math.h>
+
+void BuildGaussianWeights( unsigned int a_uiRadius, float a_fSigma, std::vector<float>& a_rWeights )
+{
+	a_rWeights.resize( a_uiRadius + 1 );
+
+	float fTotal = 0.f;
+	for( unsigned int i = 0; i <= a_uiRadius; ++i )
+	{
+		a_rWeights[i] = expf( -(float)( i * i ) / ( 2.f * a_fSigma * a_fSigma ) );
+		fTotal += i == 0 ? a_rWeights[i] : 2.f * a_rWeights[i];
+	}
+
+	for( unsigned int i = 0; i <= a_uiRadius; ++i )
+	{
+		a_rWeights[i] /= fTotal;
+	}
+}
+
+void BuildLinearKernel( const std::vector<float>& a_rWeights, BlurKernel& a_rKernel )
+{
+	a_rKernel.afOffsets.clear();
+	a_rKernel.afWeights.clear();
+	if( a_rWeights.empty() )
+		return;
+
+	a_rKernel.afOffsets.push_back( 0.f );
+	a_rKernel.afWeights.push_back( a_rWeights[0] );
+
+	for( unsigned int i = 1; i < a_rWeights.size(); i += 2 )
+	{
+		float fWeight = a_rWeights[i];
+		float fOffset = (float)i;
+
+		// a fetch at i + t filters to (1 - t) * texel i + t * texel i+1
+		if( i + 1 < a_rWeights.size() )
+		{
+			float fNext = a_rWeights[ i + 1 ];
+			if( fWeight + fNext > 0.f )
+				fOffset = ( i * fWeight + ( i + 1 ) * fNext ) / ( fWeight + fNext );
+			fWeight += fNext;
+		}
+
+		a_rKernel.afOffsets.push_back( fOffset );
+		a_rKernel.afWeights.push_back( fWeight );
+	}
+}
+
+BlurPyramid::BlurPyramid()
+{
+	m_uiDownsampleShaderID	= 0;
+	m_uiBlurShaderID		= 0;
+	m_uiUpsampleShaderID	= 0;
+	m_poQuad				= nullptr;
+	m_fUpsampleBlend		= 0.6f;
+
+	SetKernel( 8, 3.f );
+}
+
+BlurPyramid::~BlurPyramid()
+{
+	// it only ever shows the pyramid's own render targets
+	if( m_poQuad != nullptr )
+	{
+		m_poQuad->SetTexture( 0 );
+		m_poQuad->SetSecondaryTexture( 0 );
+	}
+	delete m_poQuad;
+	m_poQuad = nullptr;
+
+	glDeleteProgram( m_uiDownsampleShaderID );
+	glDeleteProgram( m_uiBlurShaderID );
+	glDeleteProgram( m_uiUpsampleShaderID );
+}
+
+void BlurPyramid::Init()
+{
+	const char* aszStandardInputs[]		= { "Position",	"UV"	};
+	const char* aszStandardOutputs[]	= { "outColour"			};
+
+	m_uiDownsampleShaderID	= LoadCachedShader(	2, aszStandardInputs, 1, aszStandardOutputs,
+												"./shaders/fullscreen_quad_vertex.glsl",
+												"./shaders/blur_downsample_fragment.glsl");
+	m_oDownsampleReflection.Reflect( m_uiDownsampleShaderID );
+
+	m_uiBlurShaderID		= LoadCachedShader(	2, aszStandardInputs, 1, aszStandardOutputs,
+												"./shaders/fullscreen_quad_vertex.glsl",
+												"./shaders/blur_fragment.glsl");
+	m_oBlurReflection.Reflect( m_uiBlurShaderID );
+
+	m_uiUpsampleShaderID	= LoadCachedShader(	2, aszStandardInputs, 1, aszStandardOutputs,
+												"./shaders/fullscreen_quad_vertex.glsl",
+												"./shaders/blur_upsample_fragment.glsl");
+	m_oUpsampleReflection.Reflect( m_uiUpsampleShaderID );
+
+	m_poQuad = new QuadMesh();
+	m_poQuad->Init();
+}
+
+void BlurPyramid::SetKernel( unsigned int a_uiRadius, float a_fSigma )
+{
+	unsigned int uiMaxRadius = 2 * ( MAX_BLUR_TAPS - 1 );
+	if( a_uiRadius > uiMaxRadius )
+		a_uiRadius = uiMaxRadius;
+
+	std::vector<float> afWeights;
+	BuildGaussianWeights( a_uiRadius, a_fSigma, afWeights );
+	BuildLinearKernel( afWeights, m_oKernel );
+}
+
+RenderTarget* BlurPyramid::Blur( RenderTargetPool& a_rPool, GLuint a_uiSource )
+{
+	GetGLState().Disable( GL_BLEND );
+	GetGLState().Disable( GL_DEPTH_TEST );
+
+	// each level is read once to make the next and once to be blurred
+	RenderTarget* apoLevels[ LEVEL_COUNT ];
+	GLuint uiSource = a_uiSource;
+	float fTexelWidth	= 1.f / a_rPool.GetWidth();
+	float fTexelHeight	= 1.f / a_rPool.GetHeight();
+	for( unsigned int i = 0; i < LEVEL_COUNT; ++i )
+	{
+		apoLevels[i] = Downsample( a_rPool, uiSource, fTexelWidth, fTexelHeight, 2 << i );
+		uiSource		= apoLevels[i]->uiTexture;
+		fTexelWidth		= apoLevels[i]->fTexelWidth;
+		fTexelHeight	= apoLevels[i]->fTexelHeight;
+	}
+
+	for( unsigned int i = 0; i < LEVEL_COUNT; ++i )
+	{
+		apoLevels[i] = BlurLevel( a_rPool, apoLevels[i] );
+	}
+
+	RenderTarget* poResult = apoLevels[ LEVEL_COUNT - 1 ];
+	for( int i = LEVEL_COUNT - 2; i >= 0; --i )
+	{
+		poResult = Upsample( a_rPool, apoLevels[i], poResult );
+	}
+
+	GetGLState().Enable( GL_DEPTH_TEST );
+	GetGLState().Enable( GL_BLEND );
+
+	return poResult;
+}
+
+RenderTarget* BlurPyramid::Downsample( RenderTargetPool& a_rPool, GLuint a_uiSource, float a_fTexelWidth, float a_fTexelHeight, unsigned int a_uiDivisor )
+{
+	RenderTarget* poTarget = a_rPool.Acquire( a_rPool.ScreenDesc( GL_RGBA8, a_uiDivisor, false ) );
+	a_rPool.Bind( poTarget );
+
+	GetGLState().UseProgram( m_uiDownsampleShaderID );
+	GetGLState().Uniform1i( m_oDownsampleReflection.FindLocation( "SourceTexture" ), 0 );
+	GetGLState().Uniform2f( m_oDownsampleReflection.GetLocation( UNIFORM_TEXEL_SIZE ), a_fTexelWidth, a_fTexelHeight );
+
+	m_poQuad->SetTexture( a_uiSource );
+	m_poQuad->SetSecondaryTexture( 0 );
+	m_poQuad->Draw();
+
+	return poTarget;
+}
+
+// horizontal into a scratch target, then vertical back into the level's own
+// frame buffer, which the pool hands back once the level is released
+RenderTarget* BlurPyramid::BlurLevel( RenderTargetPool& a_rPool, RenderTarget* a_poLevel )
+{
+	RenderTargetDesc oDesc = a_poLevel->oDesc;
+	unsigned int uiTaps = m_oKernel.afWeights.size();
+
+	GetGLState().UseProgram( m_uiBlurShaderID );
+	GetGLState().Uniform1i( m_oBlurReflection.FindLocation( "SourceTexture" ), 0 );
+	GetGLState().Uniform1i( m_oBlurReflection.FindLocation( "TapCount" ), uiTaps );
+	GetGLState().Uniform1fv( m_oBlurReflection.FindLocation( "BlurOffsets" ), uiTaps, &m_oKernel.afOffsets[0] );
+	GetGLState().Uniform1fv( m_oBlurReflection.FindLocation( "BlurWeights" ), uiTaps, &m_oKernel.afWeights[0] );
+	GLint iStepID = m_oBlurReflection.FindLocation( "TexelStep" );
+
+	RenderTarget* poHorizontal = a_rPool.Acquire( oDesc );
+	a_rPool.Bind( poHorizontal );
+	GetGLState().Uniform2f( iStepID, a_poLevel->fTexelWidth, 0.f );
+	m_poQuad->SetTexture( a_poLevel->uiTexture );
+	m_poQuad->SetSecondaryTexture( 0 );
+	m_poQuad->Draw();
+	a_rPool.Release( a_poLevel );
+
+	RenderTarget* poBlurred = a_rPool.Acquire( oDesc );
+	a_rPool.Bind( poBlurred );
+	GetGLState().Uniform2f( iStepID, 0.f, poHorizontal->fTexelHeight );
+	m_poQuad->SetTexture( poHorizontal->uiTexture );
+	m_poQuad->Draw();
+	a_rPool.Release( poHorizontal );
+
+	return poBlurred;
+}
+
+RenderTarget* BlurPyramid::Upsample( RenderTargetPool& a_rPool, RenderTarget* a_poLevel, RenderTarget* a_poCoarser )
+{
+	RenderTarget* poTarget = a_rPool.Acquire( a_poLevel->oDesc );
+	a_rPool.Bind( poTarget );
+
+	GetGLState().UseProgram( m_uiUpsampleShaderID );
+	GetGLState().Uniform1i( m_oUpsampleReflection.FindLocation( "SourceTexture" ), 0 );
+	GetGLState().Uniform1i( m_oUpsampleReflection.FindLocation( "CoarseTexture" ), 1 );
+	GetGLState().Uniform2f( m_oUpsampleReflection.GetLocation( UNIFORM_TEXEL_SIZE ), a_poCoarser->fTexelWidth, a_poCoarser->fTexelHeight );
+	GetGLState().Uniform1f( m_oUpsampleReflection.FindLocation( "UpsampleBlend" ), m_fUpsampleBlend );
+
+	m_poQuad->SetTexture( a_poLevel->uiTexture );
+	m_poQuad->SetSecondaryTexture( a_poCoarser->uiTexture );
+	m_poQuad->Draw();
+
+	a_rPool.Release( a_poLevel );
+	a_rPool.Release( a_poCoarser );
+
+	return poTarget;
+}
@@ -8,6 +8,10 @@
 #include "CGameStateManager.h"
 #include "CInputHandler.h"
 #include "CRenderManager.h"
+#include "AsyncTextureLoader.h"
+#include "JobSystem.h"
+#include "GLStateCache.h"
+#include "StreamBuffer.h"
 #include "GSLab01.h"
 #include "GSLab02.h"
 #include "GSLab03.h"
@@ -38,6 +42,9 @@ CApplication::~CApplication()
 void CApplication::Run()
 {
 	InitOpenGL();
+	GetStreamBuffer().Create();
+	GetJobSystem().Start();
+	GetTextureLoader().Start();
 	LoadAssets();
 
 	do
@@ -46,11 +53,17 @@ void CApplication::Run()
 		if( fDeltaTime > 1/60.f )
 			fDeltaTime = 1/60.f;
 
-		glClear(GL_COLOR_BUFFER_BIT);
+		GetGLState().Clear(GL_COLOR_BUFFER_BIT);
 		m_poInputHandler->ProcessEvents();
+		CheckWindowSize();
+
+		// this frame's vertex data is written during Update and drawn after
+		GetStreamBuffer().BeginFrame();
 		Update(fDeltaTime);
+		GetStreamBuffer().Flush();
 		
 		Draw();
+		GetStreamBuffer().EndFrame();
 
 		glfwSwapBuffers();
 	} while ( glfwGetKey( GLFW_KEY_ESC ) == GLFW_RELEASE &&
@@ -58,6 +71,9 @@ void CApplication::Run()
 
 	FreeAssets();
 
+	GetTextureLoader().Stop();
+	GetJobSystem().Stop();
+	GetStreamBuffer().Destroy();
 	CloseOpenGL();
 }
 
@@ -83,8 +99,8 @@ void CApplication::InitOpenGL()
 
 	// set clear colour
 	glClearColor(0.25f,0.25f,0.25f,1);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+	GetGLState().Enable(GL_DEPTH_TEST);
+	GetGLState().Enable(GL_CULL_FACE);
 
 	// start our timer
 	AIE::ResetTimer();
@@ -95,6 +111,22 @@ void CApplication::CloseOpenGL()
 	glfwTerminate();
 }
 
+// the window can be resized or minimised, render targets follow it
+void CApplication::CheckWindowSize()
+{
+	int iWidth = 0, iHeight = 0;
+	glfwGetWindowSize( &iWidth, &iHeight );
+
+	if( iWidth <= 0 || iHeight <= 0 )
+		return;
+	if( iWidth == m_iWindowWidth && iHeight == m_iWindowHeight )
+		return;
+
+	m_iWindowWidth	= iWidth;
+	m_iWindowHeight	= iHeight;
+	m_poRenderManager->Resize( m_iWindowWidth, m_iWindowHeight );
+}
+
 AIE::vec2 CApplication::GetWindowSize()
 {
 	AIE::vec2 windowSize;
@@ -109,15 +141,16 @@ void CApplication::LoadAssets()
 	m_poInputHandler		= new CInputHandler();
 	m_poGameStateManager	= new CGameStateManager( this, NUM_GAME_STATES );
 	m_poRenderManager		= new CRenderManager();
+	m_poRenderManager->Resize( m_iWindowWidth, m_iWindowHeight );
 
-	m_poGameStateManager->RegisterGameState(LAB_01, new GSLab01(LAB_01, this) );
-	m_poGameStateManager->RegisterGameState(LAB_02, new GSLab02(LAB_02, this) );
-	m_poGameStateManager->RegisterGameState(LAB_03, new GSLab03(LAB_03, this) );
-	m_poGameStateManager->RegisterGameState(LAB_04, new GSLab04(LAB_04, this) );
-	m_poGameStateManager->RegisterGameState(LAB_05, new GSLab05(LAB_05, this) );
-	m_poGameStateManager->RegisterGameState(LAB_07, new GSLab07(LAB_07, this) );
-	m_poGameStateManager->RegisterGameState(LAB_08, new GSLab08(LAB_08, this) );
-	m_poGameStateManager->RegisterGameState(LAB_09, new GSLab09(LAB_09, this) );
+	m_poGameStateManager->RegisterGameState(LAB_01, CreateGameState<GSLab01> );
+	m_poGameStateManager->RegisterGameState(LAB_02, CreateGameState<GSLab02> );
+	m_poGameStateManager->RegisterGameState(LAB_03, CreateGameState<GSLab03> );
+	m_poGameStateManager->RegisterGameState(LAB_04, CreateGameState<GSLab04> );
+	m_poGameStateManager->RegisterGameState(LAB_05, CreateGameState<GSLab05> );
+	m_poGameStateManager->RegisterGameState(LAB_07, CreateGameState<GSLab07> );
+	m_poGameStateManager->RegisterGameState(LAB_08, CreateGameState<GSLab08> );
+	m_poGameStateManager->RegisterGameState(LAB_09, CreateGameState<GSLab09> );
 
 	m_poGameStateManager->PushState( LAB_01 );
 }
@@ -151,8 +184,11 @@ void CApplication::Update(float a_fDeltaTime)
 		m_poGameStateManager->PopState();
 		m_poGameStateManager->PushState( static_cast<EGameState>(currState+1) );
 	}
+	if( m_poInputHandler->IsCaptureDown() )
+		m_poRenderManager->CaptureNextFrame();
 
 	m_poGameStateManager->UpdateGameStates( a_fDeltaTime );
+	GetTextureLoader().Update();
 	m_poInputHandler->Update();
 	m_poRenderManager->Update( a_fDeltaTime );
 }
@@ -2,7 +2,13 @@
 
 CGameStateManager::CGameStateManager(CApplication *pApp, unsigned int maxGameStates)
 {
+	m_pApp = pApp;
 	m_oRegisteredStates = std::vector<IBaseGameState*>( maxGameStates, NULL );
+	m_oStateFactories	= std::vector<GameStateFactory>( maxGameStates, NULL );
+	m_oLastUsed			= std::vector<unsigned int>( maxGameStates, 0 );
+
+	m_uiUseCounter		= 0;
+	m_uiResidentBudget	= 1;
 }
 
 CGameStateManager::~CGameStateManager()
@@ -26,6 +32,60 @@ CGameStateManager::~CGameStateManager()
 void CGameStateManager::RegisterGameState(EGameState state, IBaseGameState* gameState)
 {
 	m_oRegisteredStates[ state ] = gameState;
+	m_oStateFactories[ state ] = NULL;
+}
+
+void CGameStateManager::RegisterGameState(EGameState state, GameStateFactory factory)
+{
+	m_oStateFactories[ state ] = factory;
+}
+
+IBaseGameState* CGameStateManager::GetOrCreateState(EGameState state)
+{
+	if( m_oRegisteredStates[ state ] == NULL && m_oStateFactories[ state ] != NULL )
+	{
+		m_oRegisteredStates[ state ] = m_oStateFactories[ state ]( state, m_pApp );
+	}
+
+	m_oLastUsed[ state ] = ++m_uiUseCounter;
+	return m_oRegisteredStates[ state ];
+}
+
+bool CGameStateManager::IsOnStack(IBaseGameState* gameState)
+{
+	for(unsigned int i = 0; i < m_oStateStack.size(); ++i)
+	{
+		if( m_oStateStack[i] == gameState )
+			return true;
+	}
+	return false;
+}
+
+void CGameStateManager::ReleaseIdleStates()
+{
+	// only states with a factory can be released, anything registered as an
+	// instance has to stay alive for the next push
+	while( true )
+	{
+		unsigned int	numIdle	= 0;
+		int				oldest	= -1;
+
+		for(unsigned int i = 0; i < m_oRegisteredStates.size(); ++i)
+		{
+			if( m_oRegisteredStates[i] == NULL || m_oStateFactories[i] == NULL || IsOnStack( m_oRegisteredStates[i] ) )
+				continue;
+
+			++numIdle;
+			if( oldest < 0 || m_oLastUsed[i] < m_oLastUsed[oldest] )
+				oldest = i;
+		}
+
+		if( numIdle <= m_uiResidentBudget )
+			break;
+
+		delete m_oRegisteredStates[ oldest ];
+		m_oRegisteredStates[ oldest ] = NULL;
+	}
 }
 
 int CGameStateManager::GetCurrentState()
@@ -65,7 +125,7 @@ void CGameStateManager::UpdateGameStates(float a_fDeltaTime)
 	{
 		if( m_oCommandList[i].cmd == PUSH )
 		{
-			IBaseGameState* state = m_oRegisteredStates[ m_oCommandList[i].state ];
+			IBaseGameState* state = GetOrCreateState( m_oCommandList[i].state );
 			if( state != NULL )
 			{
 				state->Load();
@@ -74,11 +134,15 @@ void CGameStateManager::UpdateGameStates(float a_fDeltaTime)
 		}
 		else if( m_oCommandList[i].cmd == POP && m_oStateStack.size() > 0)
 		{
+			m_oLastUsed[ m_oStateStack.back()->GetStateID() ] = ++m_uiUseCounter;
 			m_oStateStack.back()->Unload();
 			m_oStateStack.pop_back();
 		}
 	}
 
+	if( !m_oCommandList.empty() )
+		ReleaseIdleStates();
+
 	m_oCommandList.clear();
 }
 
@@ -21,6 +21,9 @@ CInputHandler::CInputHandler()
 	m_bSpaceUp		= true;
 	m_bSpaceDown	= false;
 
+	m_bCaptureUp	= true;
+	m_bCaptureDown	= false;
+
 }
 
 CInputHandler::~CInputHandler()
@@ -44,6 +47,14 @@ void CInputHandler::ProcessEvents()
 	}
 	if( glfwGetKey(GLFW_KEY_SPACE) == GLFW_RELEASE )
 		m_bSpaceUp = true;
+
+	if( glfwGetKey(GLFW_KEY_F12) == GLFW_PRESS && m_bCaptureUp == true )
+	{
+		m_bCaptureDown = true;
+		m_bCaptureUp = false;
+	}
+	if( glfwGetKey(GLFW_KEY_F12) == GLFW_RELEASE )
+		m_bCaptureUp = true;
 }
 
 bool CInputHandler::IsDirKeyDown()
@@ -56,6 +67,7 @@ void CInputHandler::Update()
 	m_bAnyKeyDown	= false;
 	m_bAnyEvent		= false;
 	m_bSpaceDown	= false;
+	m_bCaptureDown	= false;
 	//Reset all event bools
 	//m_bIsLMBClicked = false;
 }
\ No newline at end of file
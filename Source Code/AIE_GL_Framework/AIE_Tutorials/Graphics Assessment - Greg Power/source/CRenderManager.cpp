@@ -1,25 +1,48 @@
 #include "CRenderManager.h"
+#include "GLStateCache.h"
+#include "TextureCache.h"
+#include "ShaderProgramCache.h"
+#include "GLCommandRecorder.h"
+#include <stdio.h>
+#include <string.h>
 
 CRenderManager::CRenderManager()
 {
 	m_iCurrentStateID = 0;
+	m_iCurrentShaderID = 0;
+	m_poCurrentReflection = nullptr;
+	m_poCurrentQueue = nullptr;
+	m_bNodeModelSet = false;
+	m_uiFrameUniformBuffer = 0;
+	m_bCaptureNextFrame = false;
+	memset( &m_oStats, 0, sizeof(m_oStats) );
+	memset( &m_oFrameUniforms, 0, sizeof(m_oFrameUniforms) );
 
 	m_fTimer = 0.f;
+	m_poScene = nullptr;
+	m_eSceneShader = RENDER_SHADER_FBX;
 	m_vColour = AIE::vec4( 0.02f, 0.02f, 0.02f, 1.0f );
 
-	m_iWaterBumpMapID = LoadTexture( "./images/water_bump_map.jpg" );
+	m_iWaterBumpMapID = AcquireTexture( "./images/water_bump_map.jpg" );
 	
 	Init();
 }
 
 CRenderManager::~CRenderManager()
 {
+	// the quads show render targets, which they don't own
+	m_poFullScreenQuad0->SetTexture( 0 );
+	m_poFullScreenQuad0->SetSecondaryTexture( 0 );
+	m_poFullScreenQuad1->SetTexture( 0 );
+	m_poFullScreenQuad1->SetSecondaryTexture( 0 );
 	delete m_poFullScreenQuad1;
 	m_poFullScreenQuad1 = nullptr;
 	delete m_poFullScreenQuad0;
 	m_poFullScreenQuad0 = nullptr;
 
-	glDeleteTextures( 1, &m_iWaterBumpMapID );
+	ReleaseTexture( m_iWaterBumpMapID );
+
+	glDeleteBuffers( 1, &m_uiFrameUniformBuffer );
 
 	glDeleteShader( m_iBasicShaderID );
 	glDeleteShader( m_iWaterShaderID );
@@ -33,8 +56,9 @@ CRenderManager::~CRenderManager()
 	glDeleteShader( m_iParticle2DShaderID );
 	glDeleteShader( m_iParticle3DShaderID );
 	glDeleteShader( m_iRefractionShaderID );
-	glDeleteShader( m_iGaussianShaderID );
 	glDeleteShader( m_iFullscreenQuadShaderID );
+	glDeleteShader( m_iBasicInstancedShaderID );
+	glDeleteShader( m_iLab02InstancedShaderID );
 
 }
 
@@ -44,13 +68,19 @@ void CRenderManager::Init()
 	m_cameraMatrix.SetFrame(	vec4( 0.f, 0.f, -50.f,	1.f ), 
 								vec4( 0.f, 0.f, 0.5f,	1.f ), 
 								vec4( 0.f, 1.f,	0.f,	0.f )	);
-	m_projectionMatrix.Perspective(	PI/6.f, 1280.f/720.0f, 0.1f, 1500.f);
+	m_projectionMatrix.Perspective(	PI/6.f, (float)m_oRenderTargets.GetWidth() / m_oRenderTargets.GetHeight(), 0.1f, 1500.f);
 	m_viewMatrix	= m_cameraMatrix.ToViewMatrix();
 	m_modelMatrix	= mat4(	1.f, 0.f, 0.f, 0.f,
 							0.f, 1.f, 0.f, 0.f,
 							0.f, 0.f, 1.f, 0.f,
 							0.f, 0.f, 0.f, 1.f	);
 
+	// every program's FrameData block reads from this one buffer
+	glGenBuffers( 1, &m_uiFrameUniformBuffer );
+	glBindBuffer( GL_UNIFORM_BUFFER, m_uiFrameUniformBuffer );
+	glBufferData( GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW );
+	glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+
 	///////////////////////////////////////////
 	//	LOAD SHADERS
 	///////////////////////////////////////////
@@ -67,15 +97,30 @@ void CRenderManager::Init()
 	LoadParticle2DShader();
 	LoadParticle3DShader();
 	LoadRefractionShader();
-	LoadGaussianShader();
 	LoadFullscreenQuadShader();
-
-	InitFrameBuffers();
+	LoadInstancedShaders();
+
+	m_aiQueueShaderIDs[ RENDER_SHADER_BASIC ]		= m_iBasicShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_WATER ]		= m_iWaterShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_LAB02 ]		= m_iLab02ShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_LAB03 ]		= m_iLab03ShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_LAB04 ]		= m_iLab04ShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_LAB07 ]		= m_iLab07ShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_LAB08 ]		= m_iLab08ShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_REFRACTION ]	= m_iRefractionShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_BASIC_INSTANCED ]	= m_iBasicInstancedShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_LAB02_INSTANCED ]	= m_iLab02InstancedShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_FBX ]				= m_iFBXShaderID;
+	m_aiQueueShaderIDs[ RENDER_SHADER_FBX_SKINNED ]		= m_iLab09ShaderID;
+
+	m_oBlurPyramid.Init();
+	// the blur's programs aren't tracked here, don't trust the bound one
+	m_iCurrentShaderID = 0;
 
 	//Set clear colour
 	glClearColor(0.25f,0.25f,0.25f,1.f);
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+	GetGLState().Enable(GL_DEPTH_TEST);
+	GetGLState().Enable(GL_CULL_FACE);
 
 	m_poFullScreenQuad0 = new QuadMesh();
 	m_poFullScreenQuad0->Init();
@@ -88,25 +133,22 @@ void CRenderManager::LoadBasicShader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iBasicShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iBasicShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/basic_vertex.glsl",
 												"./shaders/basic_fragment.glsl",
 												"./shaders/basic_geometry.glsl",
 												"./shaders/basic_tess_control.glsl",
 												"./shaders/basic_tess_eval.glsl");
 
+	ReflectShader( m_iBasicShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iBasicShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iBasicShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iBasicShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iBasicShaderID,	"Time"			);
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
 
-	GLuint texUniformID = glGetUniformLocation( m_iBasicShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID,0);
+	GLuint texUniformID = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID,0);
 
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
 }
 
 void CRenderManager::LoadWaterShader()
@@ -114,25 +156,22 @@ void CRenderManager::LoadWaterShader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iWaterShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iWaterShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/lab01_water_vertex.glsl",
 												"./shaders/lab01_water_fragment.glsl",
 												"./shaders/lab01_water_geometry.glsl",
 												"./shaders/lab01_water_tess_control.glsl",
 												"./shaders/lab01_water_tess_eval.glsl");
 
+	ReflectShader( m_iWaterShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iWaterShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iWaterShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iWaterShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iWaterShaderID,	"Time"			);
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
 
-	GLuint texUniformID = glGetUniformLocation( m_iWaterShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID,0);
+	GLuint texUniformID = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID,0);
 
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
 }
 
 void CRenderManager::LoadLab02Shader()
@@ -140,29 +179,26 @@ void CRenderManager::LoadLab02Shader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iLab02ShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iLab02ShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/lab02_vertex.glsl",
 												"./shaders/lab02_fragment.glsl",
 												"./shaders/lab02_geometry.glsl",
 												"./shaders/lab02_tess_control.glsl",
 												"./shaders/lab02_tess_eval.glsl");
 
+	ReflectShader( m_iLab02ShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iLab02ShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iLab02ShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iLab02ShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iLab02ShaderID,	"Time"			);
-	m_iColourID			= glGetUniformLocation( m_iLab02ShaderID,	"Colour"		);
-
-	GLuint texUniformID = glGetUniformLocation( m_iLab02ShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID,0);
-	GLuint texUniformID2 = glGetUniformLocation( m_iLab02ShaderID, "secondaryTexture" );
-	glUniform1i(texUniformID,1);
-
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
-	glUniform4fv( m_iColourID, 1, m_vColour );
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
+	m_iColourID			= GetUniform( UNIFORM_COLOUR );
+
+	GLuint texUniformID = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID,0);
+	GLuint texUniformID2 = GetUniform( UNIFORM_SECONDARY_TEXTURE );
+	GetGLState().Uniform1i(texUniformID,1);
+
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().Uniform4fv( m_iColourID, 1, m_vColour );
 }
 
 void CRenderManager::LoadLab03Shader()
@@ -170,31 +206,28 @@ void CRenderManager::LoadLab03Shader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iLab03ShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iLab03ShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/lab03_vertex.glsl",
 												"./shaders/lab03_fragment.glsl",
 												"./shaders/lab03_geometry.glsl",
 												"./shaders/lab03_tess_control.glsl",
 												"./shaders/lab03_tess_eval.glsl");
 
+	ReflectShader( m_iLab03ShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iLab03ShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iLab03ShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iLab03ShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iLab03ShaderID,	"Time"			);
-	m_iColourID			= glGetUniformLocation( m_iLab03ShaderID,	"Colour"		);
-
-	GLuint texUniformID0 = glGetUniformLocation( m_iLab03ShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID0,0);
-	GLuint texUniformID1 = glGetUniformLocation( m_iLab03ShaderID, "secondaryTexture" );
-	glUniform1i(texUniformID1,1);
-	GLuint texUniformID2 = glGetUniformLocation( m_iLab03ShaderID, "displacementTexture" );
-	glUniform1i(texUniformID2,2);
-
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
-	glUniform4fv( m_iColourID, 1, m_vColour );
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
+	m_iColourID			= GetUniform( UNIFORM_COLOUR );
+
+	GLuint texUniformID0 = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID0,0);
+	GLuint texUniformID1 = GetUniform( UNIFORM_SECONDARY_TEXTURE );
+	GetGLState().Uniform1i(texUniformID1,1);
+	GLuint texUniformID2 = GetUniform( UNIFORM_DISPLACEMENT_TEXTURE );
+	GetGLState().Uniform1i(texUniformID2,2);
+
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().Uniform4fv( m_iColourID, 1, m_vColour );
 }
 
 void CRenderManager::LoadLab04Shader()
@@ -202,31 +235,28 @@ void CRenderManager::LoadLab04Shader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iLab04ShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iLab04ShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/lab04_vertex.glsl",
 												"./shaders/lab04_fragment.glsl",
 												"./shaders/lab04_geometry.glsl",
 												"./shaders/lab04_tess_control.glsl",
 												"./shaders/lab04_tess_eval.glsl");
 
+	ReflectShader( m_iLab04ShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iLab04ShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iLab04ShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iLab04ShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iLab04ShaderID,	"Time"			);
-	m_iColourID			= glGetUniformLocation( m_iLab04ShaderID,	"Colour"		);
-
-	GLuint texUniformID0 = glGetUniformLocation( m_iLab04ShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID0,0);
-	GLuint texUniformID1 = glGetUniformLocation( m_iLab04ShaderID, "secondaryTexture" );
-	glUniform1i(texUniformID1,1);
-	GLuint texUniformID2 = glGetUniformLocation( m_iLab04ShaderID, "displacementTexture" );
-	glUniform1i(texUniformID2,2);
-
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
-	glUniform4fv( m_iColourID, 1, m_vColour );
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
+	m_iColourID			= GetUniform( UNIFORM_COLOUR );
+
+	GLuint texUniformID0 = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID0,0);
+	GLuint texUniformID1 = GetUniform( UNIFORM_SECONDARY_TEXTURE );
+	GetGLState().Uniform1i(texUniformID1,1);
+	GLuint texUniformID2 = GetUniform( UNIFORM_DISPLACEMENT_TEXTURE );
+	GetGLState().Uniform1i(texUniformID2,2);
+
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().Uniform4fv( m_iColourID, 1, m_vColour );
 }
 
 void CRenderManager::LoadLab07Shader()
@@ -234,25 +264,22 @@ void CRenderManager::LoadLab07Shader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iLab07ShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iLab07ShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/lab07_vertex.glsl",
 												"./shaders/lab07_fragment.glsl",
 												"./shaders/lab07_geometry.glsl",
 												"./shaders/lab07_tess_control.glsl",
 												"./shaders/lab07_tess_eval.glsl");
 
+	ReflectShader( m_iLab07ShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iLab07ShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iLab07ShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iLab07ShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iLab07ShaderID,	"Time"			);
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
 
-	GLuint texUniformID = glGetUniformLocation( m_iLab07ShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID,0);
+	GLuint texUniformID = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID,0);
 
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
 }
 
 void CRenderManager::LoadLab08Shader()
@@ -260,25 +287,22 @@ void CRenderManager::LoadLab08Shader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iLab08ShaderID			= LoadShader(	2, aszStandardInputs, 0, aszStandardOutputs,
+	m_iLab08ShaderID			= LoadCachedShader(	2, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/lab08_vertex.glsl",
 												"./shaders/lab08_fragment.glsl",
 												"./shaders/lab08_geometry.glsl",
 												"./shaders/lab08_tess_control.glsl",
 												"./shaders/lab08_tess_eval.glsl");
 
+	ReflectShader( m_iLab08ShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iLab08ShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iLab08ShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iLab08ShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iLab08ShaderID,	"Time"			);
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
 
-	GLuint texUniformID = glGetUniformLocation( m_iLab08ShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID,0);
+	GLuint texUniformID = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID,0);
 
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
 }
 
 void CRenderManager::LoadLab09Shader()
@@ -294,9 +318,11 @@ void CRenderManager::LoadLab09Shader()
 
 	const char* aszOutputs[] = { "outColour" };
 
-	m_iLab09ShaderID			= LoadShader(	7, aszInputs, 0, aszOutputs,
+	m_iLab09ShaderID			= LoadCachedShader(	7, aszInputs, 0, aszOutputs,
 												"./shaders/lab09_vertex.glsl",
 												"./shaders/lab09_fragment.glsl" );
+
+	ReflectShader( m_iLab09ShaderID );
 }
 
 void CRenderManager::LoadFBXShader()
@@ -313,9 +339,11 @@ void CRenderManager::LoadFBXShader()
 	const char* aszOutputs[] = { "outColour" };
 
 	// load shader
-	m_iFBXShaderID = LoadShader( 7, aszInputs, 1, aszOutputs,
+	m_iFBXShaderID = LoadCachedShader( 7, aszInputs, 1, aszOutputs,
 		"./shaders/normalmap_vertex.glsl",
 		"./shaders/normalmap_pixel.glsl");
+
+	ReflectShader( m_iFBXShaderID );
 }
 
 void CRenderManager::LoadParticle2DShader()
@@ -323,25 +351,22 @@ void CRenderManager::LoadParticle2DShader()
 	const char* aszStandardInputs[]		= { "Position",	"Size", "Alpha" };
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iParticle2DShaderID			= LoadShader(	3, aszStandardInputs, 0, aszStandardOutputs,
+	m_iParticle2DShaderID			= LoadCachedShader(	3, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/particle_2d_vertex.glsl",
 												"./shaders/particle_2d_fragment.glsl",
 												"./shaders/particle_2d_geometry.glsl" );
 
+	ReflectShader( m_iParticle2DShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iParticle2DShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iParticle2DShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iParticle2DShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iParticle2DShaderID,	"Time"			);
-	m_iColourID			= glGetUniformLocation( m_iParticle2DShaderID,	"Colour"		);
-
-	GLuint texUniformID0 = glGetUniformLocation( m_iParticle2DShaderID, "diffuseTexture" );
-	glUniform1i(texUniformID0,0);
-
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
-	glUniform4fv( m_iColourID, 1, m_vColour );
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
+	m_iColourID			= GetUniform( UNIFORM_COLOUR );
+
+	GLuint texUniformID0 = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+	GetGLState().Uniform1i(texUniformID0,0);
+
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	GetGLState().Uniform4fv( m_iColourID, 1, m_vColour );
 }
 
 void CRenderManager::LoadParticle3DShader()
@@ -349,20 +374,17 @@ void CRenderManager::LoadParticle3DShader()
 	const char* aszStandardInputs[]		= { "Position",	"Size", "Alpha", "Colour" };
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iParticle3DShaderID			= LoadShader(	4, aszStandardInputs, 0, aszStandardOutputs,
+	m_iParticle3DShaderID			= LoadCachedShader(	4, aszStandardInputs, 0, aszStandardOutputs,
 												"./shaders/particle_3d_vertex.glsl",
 												"./shaders/particle_3d_fragment.glsl",
 												"./shaders/particle_3d_geometry.glsl" );
 
+	ReflectShader( m_iParticle3DShaderID );
+
 	//Set matrix uniforms in the shader
-	m_iProjectionID		= glGetUniformLocation( m_iParticle3DShaderID,	"Projection"	);
-	m_iViewID			= glGetUniformLocation( m_iParticle3DShaderID,	"View"			);
-	m_iModelID			= glGetUniformLocation( m_iParticle3DShaderID,	"Model"			);
-	m_iTimeID			= glGetUniformLocation( m_iParticle3DShaderID,	"Time"			);
-
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	m_iModelID			= GetUniform( UNIFORM_MODEL );
+
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
 }
 
 void CRenderManager::LoadRefractionShader()
@@ -370,22 +392,14 @@ void CRenderManager::LoadRefractionShader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iRefractionShaderID			= LoadShader(	2, aszStandardInputs, 1, aszStandardOutputs,
+	m_iRefractionShaderID			= LoadCachedShader(	2, aszStandardInputs, 1, aszStandardOutputs,
 												"./shaders/refraction_vertex.glsl",
 												"./shaders/refraction_fragment.glsl",
 												"./shaders/refraction_geometry.glsl",
 												"./shaders/refraction_tess_control.glsl",
 												"./shaders/refraction_tess_eval.glsl");
-}
-
-void CRenderManager::LoadGaussianShader()
-{
-	const char* aszStandardInputs[]		= { "Position",	"UV"	};
-	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iGaussianShaderID			= LoadShader(	2, aszStandardInputs, 1, aszStandardOutputs,
-												"./shaders/gaussian_vertex.glsl",
-												"./shaders/gaussian_fragment.glsl");
+	ReflectShader( m_iRefractionShaderID );
 }
 
 void CRenderManager::LoadFullscreenQuadShader()
@@ -393,153 +407,60 @@ void CRenderManager::LoadFullscreenQuadShader()
 	const char* aszStandardInputs[]		= { "Position",	"UV"	};
 	const char* aszStandardOutputs[]	= { "outColour"			};
 
-	m_iFullscreenQuadShaderID			= LoadShader(	2, aszStandardInputs, 1, aszStandardOutputs,
+	m_iFullscreenQuadShaderID			= LoadCachedShader(	2, aszStandardInputs, 1, aszStandardOutputs,
 												"./shaders/fullscreen_quad_vertex.glsl",
 												"./shaders/fullscreen_quad_fragment.glsl");
+
+	ReflectShader( m_iFullscreenQuadShaderID );
 }
 
-void CRenderManager::InitFrameBuffers()
+// vertex and fragment only, InstanceBatch draws triangles rather than
+// patches. The per instance inputs follow Position and UV in the slots
+// InstanceBatch.h gives them, InstanceModel taking four.
+void CRenderManager::LoadInstancedShaders()
 {
-	///////////////////////////////////////////
-	//	FIRST RENDER BUFFER INITIALISATION
-	///////////////////////////////////////////
+	const char* aszInstancedInputs[]	= { "Position",	"UV", "InstanceLayers", "InstanceModel"	};
+	const char* aszStandardOutputs[]	= { "outColour"											};
 
-	// create render buffer to hold frame buffer's depth info
-	glGenRenderbuffers			( 1, &m_FBD0 );
-	glBindRenderbuffer			( GL_RENDERBUFFER, m_FBD0 );
-	glRenderbufferStorage		( GL_RENDERBUFFER, GL_DEPTH_COMPONENT, 1280, 720 );
-	glFramebufferRenderbuffer	( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_FBD0 );
-	glBindRenderbuffer			( GL_RENDERBUFFER, 0 );
-
-	// create Texture object to hold Frame Buffer's rendered data (output from pixel shader)
-	glGenTextures	( 1, &m_FBT0 );
-	glBindTexture	( GL_TEXTURE_2D, m_FBT0 );
-	glTexImage2D	( GL_TEXTURE_2D, 0, GL_RGBA, 1280, 720, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0 );
-	glTexParameterf	( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
-	glTexParameterf	( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
-	glTexParameteri	( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-	glTexParameteri	( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-	glBindTexture	( GL_TEXTURE_2D, 0 );
-
-	// create Frame Buffer Object and attach the render buffer and texture object
-	glGenFramebuffers			( 1, &m_FBO0 );
-	glBindFramebuffer			( GL_FRAMEBUFFER, m_FBO0 );
-	glFramebufferTexture2D		( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_FBT0, 0 );
-	glFramebufferRenderbuffer	( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_FBD0 );
-
-	if( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE )
-		printf( "Error creating frame buffer!\n" );
+	m_iBasicInstancedShaderID	= LoadCachedShader(	4, aszInstancedInputs, 1, aszStandardOutputs,
+												"./shaders/basic_instanced_vertex.glsl",
+												"./shaders/basic_instanced_fragment.glsl");
+	ReflectShader( m_iBasicInstancedShaderID );
 
-	///////////////////////////////////////////
-	//	SECOND RENDER BUFFER INITIALISATION
-	///////////////////////////////////////////
-
-	// create render buffer to hold frame buffer's depth info
-	glGenRenderbuffers			( 1, &m_FBD1 );
-	glBindRenderbuffer			( GL_RENDERBUFFER, m_FBD1 );
-	glRenderbufferStorage		( GL_RENDERBUFFER, GL_DEPTH_COMPONENT, 1280, 720 );
-	glFramebufferRenderbuffer	( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_FBD1 );
-	glBindRenderbuffer			( GL_RENDERBUFFER, 0 );
-
-	// create Texture object to hold Frame Buffer's rendered data (output from pixel shader)
-	glGenTextures	( 1, &m_FBT1 );
-	glBindTexture	( GL_TEXTURE_2D, m_FBT1 );
-	glTexImage2D	( GL_TEXTURE_2D, 0, GL_RGBA, 1280, 720, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0 );
-	glTexParameterf	( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
-	glTexParameterf	( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
-	glTexParameteri	( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-	glTexParameteri	( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
-	glBindTexture	( GL_TEXTURE_2D, 0 );
-
-	// create Frame Buffer Object and attach the render buffer and texture object
-	glGenFramebuffers			( 1, &m_FBO1 );
-	glBindFramebuffer			( GL_FRAMEBUFFER, m_FBO1 );
-	glFramebufferTexture2D		( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_FBT1, 0 );
-	glFramebufferRenderbuffer	( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_FBD1 );
-
-	if( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE )
-		printf( "Error creating frame buffer!\n" );
-
-	// reset back to using the default Frame Buffer, aka the Back Buffer
-	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+	m_iLab02InstancedShaderID	= LoadCachedShader(	4, aszInstancedInputs, 1, aszStandardOutputs,
+												"./shaders/lab02_instanced_vertex.glsl",
+												"./shaders/lab02_instanced_fragment.glsl");
+	ReflectShader( m_iLab02InstancedShaderID );
 }
 
-void CRenderManager::AddNode( int a_iStateID, MeshNode* a_poNode )
-{	 
-	switch( a_iStateID )
-	{
-	case 0:
-		m_apoLab01NodesToRender.push_back( a_poNode );
-		break;
-	case 1:
-		m_apoLab02NodesToRender.push_back( a_poNode );
-		break;
-	case 2:
-		m_apoLab03NodesToRender.push_back( a_poNode );
-		break;
-	case 3:
-		m_apoLab04NodesToRender.push_back( a_poNode );
-		break;
-	case 4:
-		m_apoLab05NodesToRender.push_back( a_poNode );
-		break;
-	case 5:
-		m_apoLab07NodesToRender.push_back( a_poNode );
-		break;
-	case 6:
-		m_apoLab08NodesToRender.push_back( a_poNode );
-		break;
-	case 7:
-		m_apoLab09NodesToRender.push_back( a_poNode );
-		break;
-	default:
+void CRenderManager::Resize( unsigned int a_uiWidth, unsigned int a_uiHeight )
+{
+	if( a_uiWidth == 0 || a_uiHeight == 0 )
 		return;
-	};
+
+	m_oRenderTargets.Resize( a_uiWidth, a_uiHeight );
+	m_projectionMatrix.Perspective(	PI/6.f, (float)a_uiWidth / a_uiHeight, 0.1f, 1500.f);
+	GetGLState().Viewport( 0, 0, a_uiWidth, a_uiHeight );
 }
-	 
-void CRenderManager::RemoveNode( int a_iStateID, MeshNode* a_poNode )
-{	 
-	std::vector<MeshNode*>* nodes;
 
-	switch( a_iStateID )
-	{
-	case 0:
-		nodes = &m_apoLab01NodesToRender;
-		break;
-	case 1:
-		nodes = &m_apoLab02NodesToRender;
-		break;
-	case 2:
-		nodes = &m_apoLab03NodesToRender;
-		break;
-	case 3:
-		nodes = &m_apoLab04NodesToRender;
-		break;
-	case 4:
-		nodes = &m_apoLab05NodesToRender;
-		break;
-	case 5:
-		nodes = &m_apoLab07NodesToRender;
-		break;
-	case 6:
-		nodes = &m_apoLab08NodesToRender;
-		break;
-	case 7:
-		nodes = &m_apoLab09NodesToRender;
-		break;
-	};
-
-	std::vector<MeshNode*>::iterator iter;
-	iter = nodes->begin();
-
-	while( iter != nodes->end() )
+RenderHandle CRenderManager::AddNode( int a_iStateID, MeshNode* a_poNode, ERenderShader a_eShader, ERenderPass a_ePass )
+{
+	return m_oRenderQueues[ a_iStateID ].Add( a_poNode, a_eShader, a_ePass );
+}
+
+void CRenderManager::RemoveNode( int a_iStateID, RenderHandle a_hNode )
+{
+	auto iter = m_oRenderQueues.find( a_iStateID );
+	if( iter != m_oRenderQueues.end() )
+		iter->second.Remove( a_hNode );
+}
+
+void CRenderManager::SetPassState( int a_iStateID, ERenderPass a_eFirst, ERenderPass a_eLast, const RenderPassState& a_rState )
+{
+	RenderQueue& rQueue = m_oRenderQueues[ a_iStateID ];
+	for( int iPass = a_eFirst; iPass <= a_eLast; ++iPass )
 	{
-		if( (*iter) == a_poNode )
-		{
-			nodes->erase( iter );
-			break;
-		}
-		++iter;
+		rQueue.SetPassState( (ERenderPass)iPass, a_rState );
 	}
 }
 
@@ -564,525 +485,397 @@ void CRenderManager::SetShader( GLuint a_uiShaderID )
 	{
 		m_iCurrentShaderID = a_uiShaderID;
 		// set active shader
-		glUseProgram(a_uiShaderID);
-	}
+		GetGLState().UseProgram(a_uiShaderID);
 
-	// convert camera's world matrix to a view matrix
-	m_viewMatrix = m_poActiveCamera->GetViewMatrix().ToViewMatrix();
+		auto iter = m_oShaderReflections.find( a_uiShaderID );
+		if( iter == m_oShaderReflections.end() )
+		{
+			ReflectShader( a_uiShaderID );
+		}
+		else
+		{
+			m_poCurrentReflection = &iter->second;
+		}
+	}
 
-	// set current transforms in the shader
-	m_iProjectionID = glGetUniformLocation( a_uiShaderID, "Projection"	);
-	m_iViewID		= glGetUniformLocation( a_uiShaderID, "View"		);
-	m_iModelID		= glGetUniformLocation( a_uiShaderID, "Model"		);
-	m_iTimeID		= glGetUniformLocation( a_uiShaderID, "Time"		);
+	// the camera and time come from the FrameData block, only the model
+	// matrix is the program's own
+	m_iModelID		= GetUniform( UNIFORM_MODEL			);
 
-	glUniformMatrix4fv( m_iProjectionID,	1, false, m_projectionMatrix	);
-	glUniformMatrix4fv( m_iViewID,			1, false, m_viewMatrix			);
-	glUniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
-	glUniform1f( m_iTimeID, m_fTimer );
+	GetGLState().UniformMatrix4fv( m_iModelID,			1, false, m_modelMatrix			);
+	m_bNodeModelSet = false;
 }
-	 
-void CRenderManager::Draw( int a_iStateID, AIE::mat4 a_cameraMatrix )
-{
-	// clear the backbuffer to our clear colour and clear the depth
-	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
-	m_iCurrentStateID = a_iStateID;
-
-	switch( a_iStateID )
+// nodes that move through a model matrix upload it in place of the shared
+// one, the shared one goes back once a node without one is drawn
+void CRenderManager::DrawCommandNode( const DrawCommand& a_rCommand )
+{
+	if( a_rCommand.bModelMatrix )
 	{
-	case 0:
-		DrawLab01( a_cameraMatrix );
-		break;
-	case 1:
-		DrawLab02( a_cameraMatrix );
-		break;
-	case 2:
-		DrawLab03( a_cameraMatrix );
-		break;
-	case 3:
-		DrawLab04( a_cameraMatrix );
-		break;
-	case 4:
-		DrawLab05( a_cameraMatrix );
-		break;
-	case 5:
-		DrawLab07( a_cameraMatrix );
-		break;
-	case 6:
-		DrawLab08( a_cameraMatrix );
-		break;
-	case 7:
-		DrawLab09( a_cameraMatrix );
-		break;
-	default:
-		return;
-	};
+		GetGLState().UniformMatrix4fv( m_iModelID, 1, false, a_rCommand.mModel );
+		m_bNodeModelSet = true;
+	}
+	else if( m_bNodeModelSet )
+	{
+		GetGLState().UniformMatrix4fv( m_iModelID, 1, false, m_modelMatrix );
+		m_bNodeModelSet = false;
+	}
+
+	if( a_rCommand.poNode != nullptr )
+		a_rCommand.poNode->DrawMesh();
+	else
+		MeshNode::DrawPatches( a_rCommand.uiVAO, a_rCommand.uiIndexCount );
 }
 
-void CRenderManager::DrawLab01( AIE::mat4 a_cameraMatrix )
+// the uniforms every queued program takes from the render manager rather
+// than the node, set once each time the queue changes program
+void CRenderManager::SetQueueShaderUniforms()
 {
-	SetShader(m_iBasicShaderID);
+	GetGLState().Uniform1i( GetUniform( UNIFORM_DIFFUSE_TEXTURE		), 0 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_SECONDARY_TEXTURE		), 1 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_DISPLACEMENT_TEXTURE	), 2 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_TEXTURE				), 0 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_SCENE_TEXTURE			), 1 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_WATER_BUMP_MAP		), 2 );
 
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab01NodesToRender.begin();
+	m_iColourID = GetUniform( UNIFORM_COLOUR );
+}
 
-	glEnable(GL_BLEND);
-	glDepthMask(GL_FALSE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+// draws a_eFirst to a_eLast of the current queue, each with the GL state
+// its game state gave it. The FBX scene goes in at the start of the opaque
+// pass and the particles after the refraction pass, both with their own
+// programs.
+void CRenderManager::DrawPasses( ERenderPass a_eFirst, ERenderPass a_eLast )
+{
+	if( m_poCurrentQueue == nullptr )
+		return;
 
-	int i = 0;
-	while( iter != m_apoLab01NodesToRender.end() )
+	for( int iPass = a_eFirst; iPass <= a_eLast; ++iPass )
 	{
-		if( i == 4 )		SetShader(m_iWaterShaderID);
-		(*iter)->Draw();
-		++iter;
-		++i;
-	}
+		ERenderPass ePass = (ERenderPass)iPass;
+		ApplyPassState( m_poCurrentQueue->GetPassState( ePass ) );
 
-	auto pIter = m_ParticleManagers.find( m_iCurrentStateID );
-	if( pIter != m_ParticleManagers.end() )
-		(*pIter).second->Draw( m_projectionMatrix, m_viewMatrix, m_modelMatrix, a_cameraMatrix );
+		if( ePass == RENDER_PASS_OPAQUE )
+			DrawFBXScene();
+
+		DrawPackets( ePass );
+
+		if( ePass == RENDER_PASS_REFRACTION )
+			DrawParticles();
+	}
 }
 
-void CRenderManager::DrawLab02( AIE::mat4 a_cameraMatrix )
+void CRenderManager::ApplyPassState( const RenderPassState& a_rState )
 {
-	SetShader(m_iLab02ShaderID);
-	AIE::vec4 camPos = a_cameraMatrix.row3;
+	GetGLState().Enable( GL_BLEND );
+	GetGLState().BlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	GetGLState().DepthMask( a_rState.bDepthWrite ? GL_TRUE : GL_FALSE );
+	if( a_rState.bCullFace )
+		GetGLState().Enable( GL_CULL_FACE );
+	else
+		GetGLState().Disable( GL_CULL_FACE );
+	GetGLState().PolygonMode( GL_FRONT_AND_BACK, a_rState.bWireframe ? GL_LINE : GL_FILL );
+}
 
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab02NodesToRender.begin();
+// draws the current queue's packets in a_ePass out of the commands the
+// workers packed for them, so only GL calls are left to make here. They come
+// sorted by program then textures, so each is only bound when it changes.
+// Nothing is assumed bound on the way in, the FBX scene and particles in
+// between bind their own.
+void CRenderManager::DrawPackets( ERenderPass a_ePass )
+{
+	unsigned int uiBegin, uiEnd;
+	m_poCurrentQueue->GetPassRange( a_ePass, a_ePass, uiBegin, uiEnd );
+	const std::vector<DrawCommand>& aoCommands = m_oDrawCommands.GetCommands();
 
-	glEnable(GL_BLEND);
-	glDepthMask(GL_FALSE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	unsigned int uiShader = RENDER_SHADER_COUNT;
+	GLint iDistanceID = -1;
+	GLuint aiBound[3] = { 0xffffffff, 0xffffffff, 0xffffffff };
 
-	int i = 0;
-	while( iter != m_apoLab02NodesToRender.end() )
+	for( unsigned int i = uiBegin; i < uiEnd; ++i )
 	{
-		//if( i == 4 )
-			//SetShader(m_iBasicShaderID);
-		GLuint texUniformID = glGetUniformLocation( m_iLab02ShaderID, "diffuseTexture" );
-		glUniform1i(texUniformID,0);
-		GLuint texUniformID2 = glGetUniformLocation( m_iLab02ShaderID, "secondaryTexture" );
-		glUniform1i(texUniformID2,1);
-		m_iColourID		= glGetUniformLocation( m_iLab02ShaderID,	"Colour"		);
-		glUniform4fv( m_iColourID, 1, m_vColour );
-
-		float dist = AIE::vec4( camPos - (*iter)->GetWorldTransform().row3 ).Magnitude();
-		GLuint distUniformID = glGetUniformLocation( m_iLab02ShaderID, "Distance" );
-		glUniform1f( distUniformID,	dist);
-
-		(*iter)->Draw();
-		++iter;
-		++i;
-	}
+		const DrawCommand& rCommand = aoCommands[i];
 
-	auto pIter = m_ParticleManagers.find( m_iCurrentStateID );
-	if( pIter != m_ParticleManagers.end() )
-		(*pIter).second->Draw( m_projectionMatrix, m_viewMatrix, m_modelMatrix, a_cameraMatrix );
-}
+		if( rCommand.uiShader != uiShader )
+		{
+			uiShader = rCommand.uiShader;
+			SetShader( m_aiQueueShaderIDs[ uiShader ] );
+			SetQueueShaderUniforms();
+			iDistanceID = GetUniform( UNIFORM_DISTANCE );
+		}
 
-void CRenderManager::DrawLab03( AIE::mat4 a_cameraMatrix )
-{
-	SetShader(m_iBasicShaderID);
-	AIE::vec4 camPos = a_cameraMatrix.row3;
+		GetGLState().Uniform4fv( m_iColourID, 1, rCommand.vColour );
+		if( iDistanceID != -1 )
+			GetGLState().Uniform1f( iDistanceID, rCommand.fDistance );
 
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab03NodesToRender.begin();
+		// units 1 and 2 are left alone by nodes without those textures
+		for( unsigned int uiUnit = 0; uiUnit < 3; ++uiUnit )
+		{
+			GLuint uiTexture = rCommand.auiTextures[ uiUnit ];
+			if( uiTexture == aiBound[ uiUnit ] || ( uiUnit > 0 && uiTexture == 0 ) )
+				continue;
 
-	glEnable(GL_BLEND);
-	glDisable(GL_CULL_FACE);
-	glDepthMask(GL_TRUE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-	//glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
+			GetGLState().ActiveTexture( GL_TEXTURE0 + uiUnit );
+			GetGLState().BindTexture( rCommand.eTextureTarget, uiTexture );
+			aiBound[ uiUnit ] = uiTexture;
+		}
 
-	int i = 0;
-	while( iter != m_apoLab03NodesToRender.end() )
-	{
-		if( i > 1 )
-			SetShader(m_iLab03ShaderID);
-		GLuint texUniformID = glGetUniformLocation( m_iLab03ShaderID, "diffuseTexture" );
-		glUniform1i(texUniformID,0);
-		GLuint texUniformID2 = glGetUniformLocation( m_iLab03ShaderID, "secondaryTexture" );
-		glUniform1i(texUniformID2,1);
-		m_iColourID		= glGetUniformLocation( m_iLab03ShaderID,	"Colour"		);
-		glUniform4fv( m_iColourID, 1, m_vColour );
-
-		float dist = AIE::vec4( camPos - (*iter)->GetWorldTransform().row3 ).Magnitude();
-		GLuint distUniformID = glGetUniformLocation( m_iLab03ShaderID, "Distance" );
-		glUniform1f( distUniformID,	dist);
-		GLuint camPosUniformID = glGetUniformLocation( m_iLab03ShaderID, "CameraPos" );
-		glUniform4fv( camPosUniformID, 1, camPos);
-
-		(*iter)->Draw();
-		++iter;
-		++i;
+		DrawCommandNode( rCommand );
 	}
 
-	auto pIter = m_ParticleManagers.find( m_iCurrentStateID );
-	if( pIter != m_ParticleManagers.end() )
-	{
-		std::vector<ParticleSystem*> systems = (*pIter).second->GetActiveEmitters();
-		auto sIter = systems.begin();
-		while ( sIter != systems.end() )
-		{
-			if ( (*sIter)->Is3D() )
-			{
-				SetShader(m_iParticle3DShaderID);
-				GLuint ProjectionID = glGetUniformLocation(	m_iParticle3DShaderID, "Projection" );
-				glUniformMatrix4fv( ProjectionID, 1, false, m_projectionMatrix );
-				GLuint ViewID = glGetUniformLocation(	m_iParticle3DShaderID, "View" );
-				glUniformMatrix4fv( ViewID, 1, false, m_viewMatrix );
-				GLuint ModelID = glGetUniformLocation(	m_iParticle3DShaderID, "Model" );
-				glUniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
-				GLuint CameraPosID = glGetUniformLocation( m_iParticle3DShaderID,	"CameraMat"	);
-				glUniformMatrix4fv( CameraPosID, 1, false, a_cameraMatrix	);
-			}
-			else
-			{
-				SetShader(m_iParticle2DShaderID);
-				GLuint texUniformID = glGetUniformLocation( m_iParticle2DShaderID, "diffuseTexture" );
-				glUniform1i(texUniformID,0);
-				GLuint ProjectionID = glGetUniformLocation(	m_iParticle2DShaderID, "Projection" );
-				glUniformMatrix4fv( ProjectionID, 1, false, m_projectionMatrix );
-				GLuint ViewID = glGetUniformLocation(	m_iParticle2DShaderID, "View" );
-				glUniformMatrix4fv( ViewID, 1, false, m_viewMatrix );
-				GLuint ModelID = glGetUniformLocation(	m_iParticle2DShaderID, "Model" );
-				glUniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
-				GLuint CameraPosID = glGetUniformLocation( m_iParticle2DShaderID,	"CameraMat"	);
-				glUniformMatrix4fv( CameraPosID, 1, false, a_cameraMatrix	);
-			}
+	m_oStats.uiNodesDrawn += uiEnd - uiBegin;
+}
 
-			(*sIter)->Draw(  m_projectionMatrix, m_viewMatrix, m_modelMatrix, a_cameraMatrix );
+// the mesh's import time bounds moved to where it's drawn this frame
+bool CRenderManager::IsFBXMeshVisible( FBXMeshNode* a_pMesh )
+{
+	RenderObject* ro = (RenderObject*)a_pMesh->m_userData;
 
-			++sIter;
-		}
+	Bounds oBounds;
+	TransformBounds( ro->oBounds, a_pMesh->m_globalTransform, oBounds );
+	if( !m_oFrustum.IsVisible( oBounds ) )
+	{
+		++m_oStats.uiFBXMeshesCulled;
+		return false;
 	}
+
+	++m_oStats.uiFBXMeshesDrawn;
+	return true;
 }
+	 
+// enumerates the program's active uniforms once and makes it the current
+// program, LoadShader leaves the new program bound
+void CRenderManager::ReflectShader( GLuint a_uiShaderID )
+{
+	ShaderReflection& rReflection = m_oShaderReflections[ a_uiShaderID ];
+	rReflection.Reflect( a_uiShaderID );
+	BindFrameUniformBlock( a_uiShaderID );
 
-void CRenderManager::DrawLab04( AIE::mat4 a_cameraMatrix )
+	m_iCurrentShaderID		= a_uiShaderID;
+	m_poCurrentReflection	= &rReflection;
+}
+
+// fills the FrameData block for this frame and sends it in one upload, the
+// lights are Lab05's, the only state whose programs read them
+void CRenderManager::UpdateFrameUniforms( const AIE::mat4& a_cameraMatrix )
 {
-	SetShader(m_iLab04ShaderID);
-	AIE::vec4 camPos = a_cameraMatrix.row3;
+	m_oFrameUniforms.mProjection	= m_projectionMatrix;
+	m_oFrameUniforms.mView			= m_viewMatrix;
+	m_oFrameUniforms.mCameraMat		= a_cameraMatrix;
+	m_oFrameUniforms.vCameraPos		= m_vCameraPos;
+	m_oFrameUniforms.fTime			= m_fTimer;
+
+	m_oFrameUniforms.vAmbientColour	= AIE::vec4( 0.1f, 0.1f, 0.1f, 1.f );
 
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab04NodesToRender.begin();
+	//Directional Light
+	m_oFrameUniforms.vDirLightDir	= AIE::vec4( 0.f, 1.f, -1.f, 0.f );
+	m_oFrameUniforms.vDirLightCol	= AIE::vec4( 1.f, 1.f, 1.f, 0.f );
 
-	glEnable(GL_BLEND);
-	glDepthMask(GL_TRUE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-	glEnable(GL_CULL_FACE);
+	//Point Light
+	m_oFrameUniforms.vPointLightPos	= AIE::vec4( 0.f, 2.f, -20.f, 1.f );
+	m_oFrameUniforms.vPointLightCol	= AIE::vec4( 1.f, 0.f, 0.f, 1.f );
 
-	glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
+	//Spot Light
+	float y = 3.0f + sin( m_fTimer );
+	m_oFrameUniforms.vSpotLightPos	= AIE::vec4( 0.f, y, -2.f, 1.f );
+	m_oFrameUniforms.vSpotLightDir	= AIE::vec4( 0.f, 0.f, 1.f, 1.f );
+	m_oFrameUniforms.vSpotLightCol	= AIE::vec4( 1.f, 1.f, 1.f, 1.f );
 
-	int i = 0;
-	while( iter != m_apoLab04NodesToRender.end() )
+	GetGLState().BindBuffer( GL_UNIFORM_BUFFER, m_uiFrameUniformBuffer );
+	GetGLState().BufferSubData( GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &m_oFrameUniforms );
+	GetGLState().BindBuffer( GL_UNIFORM_BUFFER, 0 );
+	GetGLState().BindBufferBase( GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, m_uiFrameUniformBuffer );
+}
+	 
+void CRenderManager::Draw( int a_iStateID, AIE::mat4 a_cameraMatrix )
+{
+	// the calls still reach GL while they're recorded
+	GLCommandRecorder oRecorder;
+	if( m_bCaptureNextFrame )
 	{
-		if( i > 0 )
-		{
-			SetShader(m_iBasicShaderID);
-			glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
-		}
-		GLuint texUniformID0 = glGetUniformLocation( m_iLab04ShaderID, "diffuseTexture" );
-		glUniform1i(texUniformID0,0);
-		GLuint texUniformID1 = glGetUniformLocation( m_iLab04ShaderID, "secondaryTexture" );
-		glUniform1i(texUniformID1,1);
-		GLuint texUniformID2 = glGetUniformLocation( m_iLab04ShaderID, "displacementTexture" );
-		glUniform1i(texUniformID2,2);
-		m_iColourID		= glGetUniformLocation( m_iLab04ShaderID,	"Colour"		);
-		glUniform4fv( m_iColourID, 1, m_vColour );
-
-		GLuint camPosUniformID = glGetUniformLocation( m_iLab04ShaderID, "CameraPos" );
-		glUniform4fv( camPosUniformID, 1, camPos);
-
-		(*iter)->Draw();
-		++iter;
-		++i;
+		m_oCaptureStream.Clear();
+		oRecorder.Begin( m_oCaptureStream );
 	}
 
-	auto pIter = m_ParticleManagers.find( m_iCurrentStateID );
-	if( pIter != m_ParticleManagers.end() )
-		(*pIter).second->Draw( m_projectionMatrix, m_viewMatrix, m_modelMatrix, a_cameraMatrix );
+	// clear the backbuffer to our clear colour and clear the depth
+	GetGLState().Clear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+
+	m_iCurrentStateID = a_iStateID;
+	m_cameraMatrix = a_cameraMatrix;
+	m_vCameraPos = a_cameraMatrix.row3;
+	GetGLState().BeginFrame();
+	m_oRenderTargets.BeginFrame();
+
+	m_viewMatrix = a_cameraMatrix.ToViewMatrix();
+	m_oFrustum.Extract( m_viewMatrix * m_projectionMatrix );
+	UpdateFrameUniforms( a_cameraMatrix );
+	memset( &m_oStats, 0, sizeof(m_oStats) );
+
+	// a state that hasn't queued anything still has pass states, the FBX
+	// scene and particles draw with them
+	m_poCurrentQueue = &m_oRenderQueues[ a_iStateID ];
+	m_poCurrentQueue->Sort( m_vCameraPos, m_oFrustum );
+	m_oStats.uiNodesCulled = m_poCurrentQueue->GetCulledCount();
+	m_oDrawCommands.Build( m_poCurrentQueue->GetPackets(), m_vCameraPos, m_vColour );
+
+	// culled glass still refracts next frame, so it's the nodes queued in
+	// the pass rather than the ones drawn that pick the frame's targets
+	if( m_poCurrentQueue->GetPassCount( RENDER_PASS_REFRACTION ) > 0 )
+		DrawRefractedFrame();
+	else
+		DrawPasses( RENDER_PASS_OPAQUE, RENDER_PASS_OVERLAY );
+
+	if( oRecorder.IsRecording() )
+	{
+		oRecorder.End();
+		SaveCapture( a_iStateID );
+		m_bCaptureNextFrame = false;
+	}
 }
 
-void CRenderManager::DrawLab05( AIE::mat4 a_cameraMatrix )
+void CRenderManager::SaveCapture( int a_iStateID )
 {
-	SetShader(m_iBasicShaderID);
+	char szPath[64];
+	sprintf( szPath, "./capture_state%i.glcmd", a_iStateID );
 
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab05NodesToRender.begin();
+	if( m_oCaptureStream.Save( szPath ) )
+		printf( "Captured %u GL calls, %u bytes, to %s\n", m_oCaptureStream.GetCommandCount(), (unsigned int)( m_oCaptureStream.GetWordCount() * sizeof(unsigned int) ), szPath );
+	else
+		printf( "Couldn't write %s\n", szPath );
 
-	glEnable(GL_BLEND);
-	glDepthMask(GL_FALSE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	// The frame starts with a clear and sets all its own state, so playing it
+	// straight back draws the same picture and times what each call costs to
+	// submit. It goes round the state cache, which has to forget after.
+	GLCommandTimings oTimings;
+	oTimings.Clear();
+	PlayCommands( m_oCaptureStream, GetDefaultGLFunctions(), &oTimings );
+	GetGLState().Invalidate();
+	oTimings.Print();
+}
 
-	while( iter != m_apoLab05NodesToRender.end() )
-	{
-		(*iter)->Draw();
-		++iter;
-	}
+// uploads the skeleton when the scene's program skins, the meshes come out
+// of the frustum the same as queued nodes
+void CRenderManager::DrawFBXScene()
+{
+	if( m_poScene == nullptr )
+		return;
 
-	SetShader(m_iFBXShaderID);
-
-	GLuint ProjectionID = glGetUniformLocation(	m_iFBXShaderID, "Projection" );
-	glUniformMatrix4fv( ProjectionID, 1, false, m_projectionMatrix );
-	GLuint ViewID = glGetUniformLocation(	m_iFBXShaderID, "View" );
-	glUniformMatrix4fv( ViewID, 1, false, m_viewMatrix );
-	GLuint ModelID = glGetUniformLocation(	m_iFBXShaderID, "Model" );
-	glUniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
-
-	AIE::vec4 camPos = a_cameraMatrix.row3;
-	GLuint camPosUniformID = glGetUniformLocation( m_iFBXShaderID, "CamPos" );
-	glUniform4fv( camPosUniformID, 1, camPos);
-
-	AIE::vec4 materialDiffuseCol = AIE::vec4( 1.f, 0.9f, 0.03f, 1.f );
-	GLuint MaterialID = glGetUniformLocation( m_iFBXShaderID,"materialDiffuse" );
-	glUniform4fv( MaterialID, 1, materialDiffuseCol);
-	AIE::vec4 ambientCol = AIE::vec4( 0.1f, 0.1f, 0.1f, 1.f );
-	GLuint AmbientID = glGetUniformLocation( m_iFBXShaderID,"ambientColour" );
-	glUniform4fv( AmbientID, 1, ambientCol);
-
-	GLuint diffuseTextureID = glGetUniformLocation( m_iFBXShaderID, "diffuseTexture" );
-	glUniform1i( diffuseTextureID, 0 );
-	GLuint normalTextureID = glGetUniformLocation( m_iFBXShaderID, "normalTexture" );
-	glUniform1i( normalTextureID, 1 );
-	GLuint specularTextureID = glGetUniformLocation( m_iFBXShaderID, "specularTexture" );
-	glUniform1i( specularTextureID, 2 );
-
-	//Directional Light Uniforms
-	AIE::vec4 lightDirection(0,1,-1,0);
-	AIE::vec4 lightColour(1,1,1,0);
-
-	GLuint dirLightDirID = glGetUniformLocation( m_iFBXShaderID, "dirLightDir" );
-	glUniform4fv( dirLightDirID, 1, lightDirection);
-	GLuint dirLightColID = glGetUniformLocation( m_iFBXShaderID, "dirLightCol" );
-	glUniform4fv( dirLightColID, 1, lightColour);
-
-	//Point Light Uniforms
-	AIE::vec4 pointLightPos( 0.f, 2.f, -20.f, 1.f );
-	AIE::vec4 pointLightCol( 1.f, 0.f, 0.f, 1.f );
-
-	GLuint pointLightPosID = glGetUniformLocation( m_iFBXShaderID, "pointLightPos" );
-	glUniform4fv( pointLightPosID, 1, pointLightPos);
-	GLuint pointLightColID = glGetUniformLocation( m_iFBXShaderID, "pointLightCol" );
-	glUniform4fv( pointLightColID, 1, pointLightCol);
-
-	//Spot Light Uniforms
-	float y = 3.0f + sin( m_fTimer );
-	AIE::vec4 spotLightPos( 0.f, y, -2.f, 1.f );
-	AIE::vec4 spotLightDir( 0.f, 0.f, 1.f, 1.f );
-	AIE::vec4 spotLightCol( 1.f, 1.f, 1.f, 1.f );
+	SetShader( m_aiQueueShaderIDs[ m_eSceneShader ] );
 
-	GLuint spotLightPosID = glGetUniformLocation( m_iFBXShaderID, "spotLightPos" );
-	glUniform4fv( spotLightPosID, 1, spotLightPos);
-	GLuint spotLightDirID = glGetUniformLocation( m_iFBXShaderID, "spotLightDir" );
-	glUniform4fv( spotLightDirID, 1, spotLightDir);
-	GLuint spotLightColID = glGetUniformLocation( m_iFBXShaderID, "spotLightCol" );
-	glUniform4fv( spotLightColID, 1, spotLightCol);
+	GLuint MaterialID = GetUniform( UNIFORM_MATERIAL_DIFFUSE );
 
-	GLuint timeID = glGetUniformLocation( m_iFBXShaderID, "time" );
-	glUniform1f( timeID, m_fTimer );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_DIFFUSE_TEXTURE	), 0 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_NORMAL_TEXTURE	), 1 );
+	GetGLState().Uniform1i( GetUniform( UNIFORM_SPECULAR_TEXTURE	), 2 );
 
-	for(unsigned int i = 0; i < m_oScene.GetMeshCount(); ++i)
+	GLint boneID = GetUniform( UNIFORM_BONE_ARRAY );
+	if( boneID != -1 && m_poScene->GetSkeletonCount() > 0 )
 	{
-		FBXMeshNode* pMesh = m_oScene.GetMeshByIndex(i);
+		FBXSkeleton* pSkeleton = m_poScene->GetSkeletonByIndex(0);
+		GetGLState().UniformMatrix4fv( boneID, pSkeleton->m_boneCount, true, *pSkeleton->m_bones );
+	}
+
+	for(unsigned int i = 0; i < m_poScene->GetMeshCount(); ++i)
+	{
+		FBXMeshNode* pMesh = m_poScene->GetMeshByIndex(i);
+		if( !IsFBXMeshVisible( pMesh ) )
+			continue;
 
 		// get the render object IDs stored in the mesh's user data
 		RenderObject* ro = (RenderObject*)pMesh->m_userData;
 
 		// set the mesh's material in the shader
-		glUniform4fv(MaterialID, 1, &(pMesh->m_material->diffuse.x));
+		GetGLState().Uniform4fv(MaterialID, 1, &(pMesh->m_material->diffuse.x));
 
 		// set the mesh's textures
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::DiffuseTexture] );
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::NormalTexture] );
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::SpecularTexture] );
+		GetGLState().ActiveTexture(GL_TEXTURE0);
+		GetGLState().BindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::DiffuseTexture] );
+		GetGLState().ActiveTexture(GL_TEXTURE1);
+		GetGLState().BindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::NormalTexture] );
+		GetGLState().ActiveTexture(GL_TEXTURE2);
+		GetGLState().BindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::SpecularTexture] );
 
 		// apply the meshes global transform
-		glUniformMatrix4fv( ModelID, 1, false, pMesh->m_globalTransform );
+		GetGLState().UniformMatrix4fv( m_iModelID, 1, false, pMesh->m_globalTransform );
 
 		// bind buffers and draw
-		glBindVertexArray(ro->VAO);
-		glDrawElements(GL_TRIANGLES, pMesh->m_indices.size(), GL_UNSIGNED_INT, 0);
+		GetGLState().BindVertexArray(ro->VAO);
+		GetGLState().DrawElements(GL_TRIANGLES, pMesh->m_indices.size(), GL_UNSIGNED_INT, 0);
 	}
+
+	// the next node drawn with this program needs the shared model matrix back
+	m_bNodeModelSet = true;
 }
 
-void CRenderManager::DrawLab07( AIE::mat4 a_cameraMatrix )
+// The queue's passes twice, once into a target for the refracting nodes to
+// sample and once with them, then blurred onto the back buffer
+void CRenderManager::DrawRefractedFrame()
 {
+	RenderTargetDesc oScreenDesc = m_oRenderTargets.ScreenDesc( GL_RGBA8 );
+
 	///////////////////////////////////////////
 	////////BIND FIRST FRAME BUFFER////////////
 	///////////////////////////////////////////
 
-	//Set to render to the Frame Buffer
-	glBindFramebuffer( GL_FRAMEBUFFER, m_FBO0 );
-
-	//Set the viewport to the size of the Frame Buffer
-	glViewport( 0, 0, 1280, 720 );
+	//Render the scene on its own for the glass to refract
+	RenderTarget* poScene = m_oRenderTargets.Acquire( oScreenDesc );
+	m_oRenderTargets.Bind( poScene );
 
 	//Clear the Frame Buffer's depth and colour targets
-	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+	GetGLState().Clear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
 	//////////////////////////////////////////////
 	////////DRAW TO FIRST FRAME BUFFER////////////
 	//////////////////////////////////////////////
-	SetShader(m_iBasicShaderID);
-
-	glEnable(GL_BLEND);
-	glEnable(GL_CULL_FACE);
-	glDepthMask(GL_TRUE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-
-	int i = 0;
-	auto iter = m_apoLab07NodesToRender.begin();
-	while( iter != m_apoLab07NodesToRender.end() )
-	{
-		if( i > 1 )
-			break;
-		if( i == 1 )
-			SetShader(m_iLab07ShaderID);
-		GLuint ColourID = glGetUniformLocation(	m_iLab07ShaderID, "Colour" );
-		glUniform4fv( ColourID, 1, (*iter)->GetColour() );
-		float passNum = 1;
-		GLuint PassNumID = glGetUniformLocation( m_iLab07ShaderID, "PassNumber" );
-		glUniform1fv( PassNumID, 1, &passNum );
-
-		(*iter)->Draw();
-		++iter;
-		++i;
-	}
 
-	DrawParticles( a_cameraMatrix );
+	// everything the glass refracts, particles included
+	DrawPasses( RENDER_PASS_OPAQUE, RENDER_PASS_TRANSPARENT );
+	DrawParticles();
 
 	////////////////////////////////////////////
 	////////BIND FINAL FRAME BUFFER/////////////
 	////////////////////////////////////////////
 
-	//Set to render to the second frame Buffer
-	glBindFramebuffer( GL_FRAMEBUFFER, m_FBO1 );
-
-	//Set the viewport to the size of the Frame Buffer
-	glViewport( 0, 0, 1280, 720 );
+	RenderTarget* poFinal = m_oRenderTargets.Acquire( oScreenDesc );
+	m_oRenderTargets.Bind( poFinal );
 
 	//Clear the Frame Buffer's depth and colour targets
-	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+	GetGLState().Clear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
 	//////////////////////////////////////////////
 	//////DRAW TO FINAL FRAME BUFFER/////////////
 	//////////////////////////////////////////////
 
-	SetShader(m_iBasicShaderID);
-
-	glEnable(GL_BLEND);
-	glEnable(GL_CULL_FACE);
-	glDepthMask(GL_TRUE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-
-	i = 0;
-	iter = m_apoLab07NodesToRender.begin();
-	while( iter != m_apoLab07NodesToRender.end() )
-	{
-		if( i > 1 )
-			break;
-		if( i == 1 )
-			SetShader(m_iLab07ShaderID);
-		GLuint ColourID = glGetUniformLocation(	m_iLab07ShaderID, "Colour" );
-		glUniform4fv( ColourID, 1, (*iter)->GetColour() );
-		(*iter)->Draw();
-		++iter;
-		++i;
-	}
-
-	SetShader( m_iRefractionShaderID );
-	GLuint TimeID = glGetUniformLocation( m_iRefractionShaderID,	"Time"	);
-	glUniform1f( TimeID, m_fTimer	);
-	GLuint TextureID = glGetUniformLocation( m_iRefractionShaderID, "Texture" );
-	glUniform1i( TextureID, 0 );
-	GLuint SceneID = glGetUniformLocation( m_iRefractionShaderID, "SceneTexture" );
-	glUniform1i( SceneID, 1 );
-	GLuint BumpMapID = glGetUniformLocation( m_iRefractionShaderID, "WaterBumpMap" );
-	glUniform1i( BumpMapID, 2 );
-
-	(*iter)->SetSecondaryTexture( m_FBT0 );
-	(*iter)->SetDisplacementTexture( m_iWaterBumpMapID );
-	(*iter)->Draw();
-
-	DrawParticles( a_cameraMatrix );
-
-	SetShader(m_iBasicShaderID);
-	glEnable(GL_BLEND);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-	++iter;
-	(*iter)->Draw();
-
-	////////////////////////////////////////////
-	////////FIRST GAUSSIAN BLUR PASS////////////
-	////////////////////////////////////////////
-
-	//Set to render to the second frame Buffer
-	glBindFramebuffer( GL_FRAMEBUFFER, m_FBO0 );
+	DrawPasses( RENDER_PASS_OPAQUE, RENDER_PASS_TRANSPARENT );
 
-	//Set the viewport to the size of the Frame Buffer
-	glViewport( 0, 0, 1280, 720 );
+	// refracting nodes sample the first pass and the bump map. Bound here
+	// rather than set on the node, which would release both with it.
+	GetGLState().ActiveTexture( GL_TEXTURE1 );
+	GetGLState().BindTexture( GL_TEXTURE_2D, poScene->uiTexture );
+	GetGLState().ActiveTexture( GL_TEXTURE2 );
+	GetGLState().BindTexture( GL_TEXTURE_2D, m_iWaterBumpMapID );
+	DrawPasses( RENDER_PASS_REFRACTION, RENDER_PASS_OVERLAY );
 
-	//Clear the Frame Buffer's depth and colour targets
-	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-
-	////////////////////////////////////////////////
-	////////DRAW TO FRAME BUFFER/////////////
-	////////////////////////////////////////////////
-
-	SetShader(m_iGaussianShaderID);
-	GLuint PassNumID = glGetUniformLocation( m_iGaussianShaderID, "PassNumber" );
-	glUniform1i( PassNumID, 1 );
-
-	TextureID = glGetUniformLocation( m_iGaussianShaderID, "RenderBuffer" );
-	glUniform1i( TextureID, 0 );
-
-	m_poFullScreenQuad0->SetTexture( m_FBT1 );
-	m_poFullScreenQuad0->Draw();
+	// the scene has been refracted, its target can take the blur
+	m_oRenderTargets.Release( poScene );
 
 	////////////////////////////////////////////
-	////////SECOND GAUSSIAN BLUR PASS////////////
+	////////BLUR AT 1/2, 1/4 AND 1/8 SIZE///////
 	////////////////////////////////////////////
 
-	//Set to render to the second frame Buffer
-	glBindFramebuffer( GL_FRAMEBUFFER, m_FBO1 );
-
-	//Set the viewport to the size of the Frame Buffer
-	glViewport( 0, 0, 1280, 720 );
-
-	//Clear the Frame Buffer's depth and colour targets
-	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-
-	////////////////////////////////////////////////
-	////////DRAW TO FRAME BUFFER/////////////
-	////////////////////////////////////////////////
-
-	SetShader(m_iGaussianShaderID);
-	glUniform1i( PassNumID, 2 );
-
-	TextureID = glGetUniformLocation( m_iGaussianShaderID, "RenderBuffer" );
-	glUniform1i( TextureID, 0 );
-
-	m_poFullScreenQuad0->SetTexture( m_FBT0 );
-	m_poFullScreenQuad0->Draw();
+	RenderTarget* poBlurred = m_oBlurPyramid.Blur( m_oRenderTargets, poFinal->uiTexture );
+	m_oRenderTargets.Release( poFinal );
+	m_iCurrentShaderID = 0;
 
 	///////////////////////////////////////
 	//////////BIND BACK BUFFER/////////////
 	///////////////////////////////////////
 
 	// Set the target back to the Back Buffer (default Frame Buffer)
-	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
-
-	//Set the viewport to the size of the screen
-	glViewport( 0, 0, 1280, 720 );
+	m_oRenderTargets.Bind( nullptr );
 
 	//Clear the Back Buffer's depth and colour
-	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+	GetGLState().Clear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
 	////////////////////////////////////////
 	////////DRAW TO BACK BUFFER/////////////
@@ -1090,110 +883,14 @@ void CRenderManager::DrawLab07( AIE::mat4 a_cameraMatrix )
 
 	SetShader( m_iFullscreenQuadShaderID );
 
-	//TextureID = glGetUniformLocation( m_iFullscreenQuadShaderID, "SceneTexture" );
-	//glUniform1i( TextureID, 0 );
-	//BumpMapID = glGetUniformLocation( m_iFullscreenQuadShaderID, "SecondaryTexture" );
-	//glUniform1i( BumpMapID, 1 );
-
-	m_poFullScreenQuad0->SetTexture( m_FBT0 );
-	m_poFullScreenQuad0->SetSecondaryTexture( m_FBT1 );
+	m_poFullScreenQuad0->SetTexture( poBlurred->uiTexture );
+	m_poFullScreenQuad0->SetSecondaryTexture( poBlurred->uiTexture );
 	m_poFullScreenQuad0->Draw();
-}
-
-void CRenderManager::DrawLab08( AIE::mat4 a_cameraMatrix )
-{
-	SetShader(m_iBasicShaderID);
-
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab08NodesToRender.begin();
-
-	glEnable(GL_BLEND);
-	glEnable(GL_CULL_FACE);
-	glDepthMask(GL_TRUE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-
-	int i = 0;
-	while( iter != m_apoLab08NodesToRender.end() )
-	{
-		if( i > 0 )
-			SetShader(m_iLab08ShaderID);
-		if( i == 3 )
-			SetShader(m_iBasicShaderID);
-		(*iter)->Draw();
-		++iter;
-		++i;
-	}
-}
-
-void CRenderManager::DrawLab09( AIE::mat4 a_cameraMatrix )
-{
-	//Drawing the FBX model
-	SetShader(m_iLab09ShaderID);
-
-	GLuint ProjectionID = glGetUniformLocation(	m_iLab09ShaderID, "Projection" );
-	glUniformMatrix4fv( ProjectionID, 1, false, m_projectionMatrix );
-	GLuint ViewID = glGetUniformLocation(	m_iLab09ShaderID, "View" );
-	glUniformMatrix4fv( ViewID, 1, false, m_viewMatrix );
-	GLuint ModelID = glGetUniformLocation(	m_iLab09ShaderID, "Model" );
-	glUniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
-
-	AIE::vec4 camPos = a_cameraMatrix.row3;
-	GLuint camPosUniformID = glGetUniformLocation( m_iLab09ShaderID, "CamPos" );
-	glUniform4fv( camPosUniformID, 1, camPos);
-
-	GLuint MaterialID = glGetUniformLocation( m_iLab09ShaderID,"materialDiffuse" );
-
-	int iNumBones	= m_oScene.GetSkeletonByIndex(0)->m_boneCount;
-	GLuint boneID	= glGetUniformLocation( m_iLab09ShaderID, "boneArray" );
-	glUniformMatrix4fv(boneID, iNumBones, true, *m_oScene.GetSkeletonByIndex(0)->m_bones );
-
-	for(unsigned int i = 0; i < m_oScene.GetMeshCount(); ++i)
-	{
-		FBXMeshNode* pMesh = m_oScene.GetMeshByIndex(i);
-
-		// get the render object IDs stored in the mesh's user data
-		RenderObject* ro = (RenderObject*)pMesh->m_userData;
-
-		// set the mesh's material in the shader
-		glUniform4fv(MaterialID, 1, &(pMesh->m_material->diffuse.x));
-
-		// set the mesh's textures
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::DiffuseTexture] );
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::NormalTexture] );
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture( GL_TEXTURE_2D, pMesh->m_material->textureIDs[FBXMaterial::SpecularTexture] );
-
-		// apply the meshes global transform
-		glUniformMatrix4fv( ModelID, 1, false, pMesh->m_globalTransform );
-
-		// bind buffers and draw
-		glBindVertexArray(ro->VAO);
-		glDrawElements(GL_TRIANGLES, pMesh->m_indices.size(), GL_UNSIGNED_INT, 0);
-	}
-
-	//Draw the Plane
-	SetShader(m_iBasicShaderID);
 
-	std::vector<MeshNode*>::iterator iter;
-	iter = m_apoLab09NodesToRender.begin();
-
-	glEnable(GL_BLEND);
-	glEnable(GL_CULL_FACE);
-	glDepthMask(GL_TRUE);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-
-	int i = 0;
-	while( iter != m_apoLab09NodesToRender.end() )
-	{
-		(*iter)->Draw();
-		++iter;
-		++i;
-	}
+	m_oRenderTargets.Release( poBlurred );
 }
 
-void CRenderManager::DrawParticles( AIE::mat4 a_cameraMatrix )
+void CRenderManager::DrawParticles()
 {
 	auto pIter = m_ParticleManagers.find( m_iCurrentStateID );
 	if( pIter != m_ParticleManagers.end() )
@@ -1205,39 +902,25 @@ void CRenderManager::DrawParticles( AIE::mat4 a_cameraMatrix )
 			if ( (*sIter)->Is3D() )
 			{
 				SetShader(m_iParticle3DShaderID);
-				GLuint ProjectionID = glGetUniformLocation(	m_iParticle3DShaderID, "Projection" );
-				glUniformMatrix4fv( ProjectionID, 1, false, m_projectionMatrix );
-				GLuint ViewID = glGetUniformLocation(	m_iParticle3DShaderID, "View" );
-				glUniformMatrix4fv( ViewID, 1, false, m_viewMatrix );
-				GLuint ModelID = glGetUniformLocation(	m_iParticle3DShaderID, "Model" );
-				glUniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
-				GLuint CameraPosID = glGetUniformLocation( m_iParticle3DShaderID,	"CameraMat"	);
-				glUniformMatrix4fv( CameraPosID, 1, false, a_cameraMatrix	);
-				GLuint TimeID = glGetUniformLocation( m_iParticle3DShaderID,	"Time"	);
-				glUniform1f( CameraPosID, m_fTimer	);
-
-				glFrontFace( GL_CW );
+				GLuint ModelID = GetUniform( UNIFORM_MODEL );
+				GetGLState().UniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
+
+				GetGLState().FrontFace( GL_CW );
 			}
 			else
 			{
 				SetShader(m_iParticle2DShaderID);
-				GLuint texUniformID = glGetUniformLocation( m_iParticle2DShaderID, "diffuseTexture" );
-				glUniform1i(texUniformID,0);
-				GLuint ProjectionID = glGetUniformLocation(	m_iParticle2DShaderID, "Projection" );
-				glUniformMatrix4fv( ProjectionID, 1, false, m_projectionMatrix );
-				GLuint ViewID = glGetUniformLocation(	m_iParticle2DShaderID, "View" );
-				glUniformMatrix4fv( ViewID, 1, false, m_viewMatrix );
-				GLuint ModelID = glGetUniformLocation(	m_iParticle2DShaderID, "Model" );
-				glUniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
-				GLuint CameraPosID = glGetUniformLocation( m_iParticle2DShaderID,	"CameraMat"	);
-				glUniformMatrix4fv( CameraPosID, 1, false, a_cameraMatrix	);
+				GLuint texUniformID = GetUniform( UNIFORM_DIFFUSE_TEXTURE );
+				GetGLState().Uniform1i(texUniformID,0);
+				GLuint ModelID = GetUniform( UNIFORM_MODEL );
+				GetGLState().UniformMatrix4fv( ModelID, 1, false, m_modelMatrix );
 			}
 
-			(*sIter)->Draw(  m_projectionMatrix, m_viewMatrix, m_modelMatrix, a_cameraMatrix );
+			(*sIter)->Draw(  m_projectionMatrix, m_viewMatrix, m_modelMatrix, m_cameraMatrix );
 
 			++sIter;
 		}
 
-		glFrontFace( GL_CCW );
+		GetGLState().FrontFace( GL_CCW );
 	}
-}
\ No newline at end of file
+}
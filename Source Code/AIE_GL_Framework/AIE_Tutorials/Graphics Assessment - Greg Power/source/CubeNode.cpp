@@ -3,44 +3,66 @@
 CubeNode::CubeNode( float a_fSize, AIE::vec4 a_translation, SceneNode *a_pParent )
 	: MeshNode( a_translation, a_pParent )
 {
-	float fHalfSize = a_fSize * 0.5f;
 	m_iNumVerts		= 14;
 	m_iNumIndices	= 36;
 
-	for( unsigned int i = 0; i < m_iNumVerts; ++i )
+	BuildGeometry( a_fSize, a_translation, m_aoVertices, m_auiIndex );
+
+	CreateBuffers();
+}
+
+CubeNode::~CubeNode()
+{
+}
+
+void CubeNode::Update( float a_fDeltaTime )
+{
+}
+
+void CubeNode::Draw()
+{
+	MeshNode::Draw();
+}
+
+void CubeNode::BuildGeometry( float a_fSize, const AIE::vec4& a_vTranslation, std::vector<AIE::Vertex>& a_rVertices, std::vector<unsigned int>& a_rIndices )
+{
+	float fHalfSize = a_fSize * 0.5f;
+	unsigned int uiFirst = a_rVertices.size();
+	for( unsigned int i = 0; i < 14; ++i )
 	{
 		AIE::Vertex vert;	
-		m_aoVertices.push_back( vert );
+		a_rVertices.push_back( vert );
 	}
+	AIE::Vertex* aoVerts = &a_rVertices[ uiFirst ];
 
-	m_aoVertices[0].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + fHalfSize, a_translation.z + fHalfSize, 1.f );
-	m_aoVertices[0].uv		= AIE::vec2( 0.2501f, 0.7499f );
-	m_aoVertices[1].position	= AIE::vec4( a_translation.x + fHalfSize, a_translation.y + fHalfSize, a_translation.z + fHalfSize, 1.f );
-	m_aoVertices[1].uv		= AIE::vec2( 0.499f, 0.7499f );
-	m_aoVertices[2].position	= AIE::vec4( a_translation.x + fHalfSize, a_translation.y + -fHalfSize, a_translation.z + fHalfSize, 1.f );
-	m_aoVertices[2].uv		= AIE::vec2( 0.499f, 0.5001f );
-	m_aoVertices[3].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + -fHalfSize, a_translation.z + fHalfSize, 1.f );
-	m_aoVertices[3].uv		= AIE::vec2( 0.2501f, 0.5001f );
-	m_aoVertices[4].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[4].uv		= AIE::vec2( 0.9999f, 0.7499f );
-	m_aoVertices[5].position	= AIE::vec4( a_translation.x + fHalfSize, a_translation.y + fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[5].uv		= AIE::vec2( 0.75f, 0.7499f );
-	m_aoVertices[6].position	= AIE::vec4( a_translation.x + fHalfSize, a_translation.y + -fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[6].uv		= AIE::vec2( 0.75f, 0.5001f );
-	m_aoVertices[7].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + -fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[7].uv		= AIE::vec2( 0.9999f, 0.5001f );
-	m_aoVertices[8].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[8].uv		= AIE::vec2( 0.2501f, 0.9999f );
-	m_aoVertices[9].position	= AIE::vec4( a_translation.x + fHalfSize, a_translation.y + fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[9].uv		= AIE::vec2( 0.4999f, 0.9999f );
-	m_aoVertices[10].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + -fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[10].uv		= AIE::vec2( 0.2501f, 0.2501f );
-	m_aoVertices[11].position	= AIE::vec4( a_translation.x + fHalfSize, a_translation.y + -fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[11].uv		= AIE::vec2( 0.4999f, 0.2501f );
-	m_aoVertices[12].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[12].uv		= AIE::vec2( 0.0001f, 0.7499f );
-	m_aoVertices[13].position	= AIE::vec4( a_translation.x + -fHalfSize, a_translation.y + -fHalfSize, a_translation.z + -fHalfSize, 1.f );
-	m_aoVertices[13].uv		= AIE::vec2( 0.0001f, 0.5001f );
+	aoVerts[0].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + fHalfSize, 1.f );
+	aoVerts[0].uv		= AIE::vec2( 0.2501f, 0.7499f );
+	aoVerts[1].position	= AIE::vec4( a_vTranslation.x + fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + fHalfSize, 1.f );
+	aoVerts[1].uv		= AIE::vec2( 0.499f, 0.7499f );
+	aoVerts[2].position	= AIE::vec4( a_vTranslation.x + fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + fHalfSize, 1.f );
+	aoVerts[2].uv		= AIE::vec2( 0.499f, 0.5001f );
+	aoVerts[3].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + fHalfSize, 1.f );
+	aoVerts[3].uv		= AIE::vec2( 0.2501f, 0.5001f );
+	aoVerts[4].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[4].uv		= AIE::vec2( 0.9999f, 0.7499f );
+	aoVerts[5].position	= AIE::vec4( a_vTranslation.x + fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[5].uv		= AIE::vec2( 0.75f, 0.7499f );
+	aoVerts[6].position	= AIE::vec4( a_vTranslation.x + fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[6].uv		= AIE::vec2( 0.75f, 0.5001f );
+	aoVerts[7].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[7].uv		= AIE::vec2( 0.9999f, 0.5001f );
+	aoVerts[8].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[8].uv		= AIE::vec2( 0.2501f, 0.9999f );
+	aoVerts[9].position	= AIE::vec4( a_vTranslation.x + fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[9].uv		= AIE::vec2( 0.4999f, 0.9999f );
+	aoVerts[10].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[10].uv		= AIE::vec2( 0.2501f, 0.2501f );
+	aoVerts[11].position	= AIE::vec4( a_vTranslation.x + fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[11].uv		= AIE::vec2( 0.4999f, 0.2501f );
+	aoVerts[12].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[12].uv		= AIE::vec2( 0.0001f, 0.7499f );
+	aoVerts[13].position	= AIE::vec4( a_vTranslation.x + -fHalfSize, a_vTranslation.y + -fHalfSize, a_vTranslation.z + -fHalfSize, 1.f );
+	aoVerts[13].uv		= AIE::vec2( 0.0001f, 0.5001f );
 
 	unsigned int indices[36] = {
 		0,1,3,
@@ -57,20 +79,8 @@ CubeNode::CubeNode( float a_fSize, AIE::vec4 a_translation, SceneNode *a_pParent
 		9,1,0
 	};
 
-	m_auiIndex.insert(m_auiIndex.begin(), indices, indices+36);
-
-	CreateBuffers();
-}
-
-CubeNode::~CubeNode()
-{
-}
-
-void CubeNode::Update( float a_fDeltaTime )
-{
+	for( unsigned int i = 0; i < 36; ++i )
+	{
+		a_rIndices.push_back( uiFirst + indices[i] );
+	}
 }
-
-void CubeNode::Draw()
-{
-	MeshNode::Draw();
-}
\ No newline at end of file
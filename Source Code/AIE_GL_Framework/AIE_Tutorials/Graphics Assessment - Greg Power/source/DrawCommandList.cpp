@@ -0,0 +1,79 @@
+#include "DrawCommandList.h"
+#include "MeshNode.h"
+#include "JobSystem.h"
+
+#include <string.h>
+
+static const unsigned int DRAW_COMMAND_JOB_SIZE = 64;
+
+DrawCommandList::DrawCommandList()
+{
+	m_poPackets = nullptr;
+}
+
+void DrawCommandList::Build( const std::vector<DrawPacket>& a_rPackets, const AIE::vec4& a_vCameraPos, const AIE::vec4& a_vDefaultColour, bool a_bParallel )
+{
+	m_aoCommands.resize( a_rPackets.size() );
+	if( a_rPackets.empty() )
+		return;
+
+	m_poPackets			= &a_rPackets[0];
+	m_vCameraPos		= a_vCameraPos;
+	m_vDefaultColour	= a_vDefaultColour;
+
+	if( a_bParallel )
+		GetJobSystem().ParallelFor( a_rPackets.size(), DRAW_COMMAND_JOB_SIZE, PackRange, this );
+	else
+		PackRange( 0, a_rPackets.size(), this );
+
+	m_poPackets = nullptr;
+}
+
+void DrawCommandList::PackRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pList )
+{
+	DrawCommandList* poList = (DrawCommandList*)a_pList;
+
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		const DrawPacket& rPacket = poList->m_poPackets[i];
+		MeshNode* poNode = rPacket.poNode;
+
+		// padding included, so equal commands hash the same
+		DrawCommand& rCommand = poList->m_aoCommands[i];
+		memset( &rCommand, 0, sizeof(rCommand) );
+
+		rCommand.uiShader		= rPacket.uiShader;
+		rCommand.vColour		= poNode->GetColour();
+		if( rCommand.vColour.w == 0.f )
+			rCommand.vColour = poList->m_vDefaultColour;
+		rCommand.fDistance		= AIE::vec4( poList->m_vCameraPos - poNode->GetResolvedWorldTransform().row3 ).Magnitude();
+
+		rCommand.auiTextures[0]	= poNode->GetTexture();
+		rCommand.auiTextures[1]	= poNode->GetSecondaryTexture();
+		rCommand.auiTextures[2]	= poNode->GetDisplacementTexture();
+		rCommand.eTextureTarget	= poNode->GetTextureTarget();
+
+		if( poNode->UsesModelMatrix() )
+		{
+			rCommand.mModel			= poNode->GetModelMatrix();
+			rCommand.bModelMatrix	= 1;
+		}
+
+		if( !poNode->GetDrawParameters( rCommand.uiVAO, rCommand.uiIndexCount ) )
+			rCommand.poNode = poNode;
+	}
+}
+
+unsigned long long DrawCommandList::GetHash() const
+{
+	// FNV-1a
+	unsigned long long ulHash = 14695981039346656037ULL;
+	const unsigned char* pBytes = m_aoCommands.empty() ? nullptr : (const unsigned char*)&m_aoCommands[0];
+	size_t uiLength = m_aoCommands.size() * sizeof(DrawCommand);
+	for( size_t i = 0; i < uiLength; ++i )
+	{
+		ulHash ^= pBytes[i];
+		ulHash *= 1099511628211ULL;
+	}
+	return ulHash;
+}
@@ -0,0 +1,85 @@
+#include "FrameUniforms.h"
+
+#include <stdio.h>
+
+static const char*	s_aszFrameMemberNames[] =
+{
+	"Projection",
+	"View",
+	"CameraMat",
+	"CameraPos",
+	"ambientColour",
+	"dirLightDir",
+	"dirLightCol",
+	"pointLightPos",
+	"pointLightCol",
+	"spotLightPos",
+	"spotLightDir",
+	"spotLightCol",
+	"Time",
+};
+
+static const GLint	s_aiFrameMemberOffsets[] =
+{
+	offsetof( FrameUniforms, mProjection	),
+	offsetof( FrameUniforms, mView			),
+	offsetof( FrameUniforms, mCameraMat		),
+	offsetof( FrameUniforms, vCameraPos		),
+	offsetof( FrameUniforms, vAmbientColour	),
+	offsetof( FrameUniforms, vDirLightDir	),
+	offsetof( FrameUniforms, vDirLightCol	),
+	offsetof( FrameUniforms, vPointLightPos	),
+	offsetof( FrameUniforms, vPointLightCol	),
+	offsetof( FrameUniforms, vSpotLightPos	),
+	offsetof( FrameUniforms, vSpotLightDir	),
+	offsetof( FrameUniforms, vSpotLightCol	),
+	offsetof( FrameUniforms, fTime			),
+};
+
+static const unsigned int FRAME_MEMBER_COUNT = sizeof(s_aszFrameMemberNames) / sizeof(s_aszFrameMemberNames[0]);
+
+bool BindFrameUniformBlock( GLuint a_uiProgram )
+{
+	GLuint uiBlock = glGetUniformBlockIndex( a_uiProgram, "FrameData" );
+	if( uiBlock == GL_INVALID_INDEX )
+	{
+		return true;
+	}
+	glUniformBlockBinding( a_uiProgram, uiBlock, FRAME_UNIFORM_BINDING );
+
+	bool bMatches = true;
+
+	GLint iBlockSize = 0;
+	glGetActiveUniformBlockiv( a_uiProgram, uiBlock, GL_UNIFORM_BLOCK_DATA_SIZE, &iBlockSize );
+	if( iBlockSize != sizeof(FrameUniforms) )
+	{
+		printf( "FrameData in program %u is %i bytes, FrameUniforms is %u\n", a_uiProgram, iBlockSize, (unsigned int)sizeof(FrameUniforms) );
+		bMatches = false;
+	}
+
+	// members a stage doesn't read are still active in a std140 block, so
+	// every name resolves
+	GLuint auiIndices[ FRAME_MEMBER_COUNT ];
+	glGetUniformIndices( a_uiProgram, FRAME_MEMBER_COUNT, s_aszFrameMemberNames, auiIndices );
+
+	for( unsigned int i = 0; i < FRAME_MEMBER_COUNT; ++i )
+	{
+		if( auiIndices[i] == GL_INVALID_INDEX )
+		{
+			printf( "FrameData in program %u has no %s\n", a_uiProgram, s_aszFrameMemberNames[i] );
+			bMatches = false;
+			continue;
+		}
+
+		GLint iOffset = -1;
+		glGetActiveUniformsiv( a_uiProgram, 1, &auiIndices[i], GL_UNIFORM_OFFSET, &iOffset );
+		if( iOffset != s_aiFrameMemberOffsets[i] )
+		{
+			printf( "FrameData.%s in program %u is at %i, FrameUniforms has it at %i\n",
+					s_aszFrameMemberNames[i], a_uiProgram, iOffset, s_aiFrameMemberOffsets[i] );
+			bMatches = false;
+		}
+	}
+
+	return bMatches;
+}
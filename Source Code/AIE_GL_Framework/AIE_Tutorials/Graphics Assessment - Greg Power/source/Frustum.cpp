@@ -0,0 +1,247 @@
+#include "Frustum.h"
+
+#include <xmmintrin.h>
+#include <math.h>
+#include <float.h>
+
+void ComputeBounds( const void* a_pPositions, unsigned int a_uiCount, unsigned int a_uiStride, Bounds& a_rBounds )
+{
+	a_rBounds.vMin		= AIE::vec4( 0.f, 0.f, 0.f, 1.f );
+	a_rBounds.vMax		= AIE::vec4( 0.f, 0.f, 0.f, 1.f );
+	a_rBounds.vCentre	= AIE::vec4( 0.f, 0.f, 0.f, 1.f );
+	a_rBounds.fRadius	= 0.f;
+	if( a_uiCount == 0 )
+		return;
+
+	const char* pPoint = (const char*)a_pPositions;
+
+	a_rBounds.vMin = AIE::vec4(  FLT_MAX,  FLT_MAX,  FLT_MAX, 1.f );
+	a_rBounds.vMax = AIE::vec4( -FLT_MAX, -FLT_MAX, -FLT_MAX, 1.f );
+	for( unsigned int i = 0; i < a_uiCount; ++i )
+	{
+		const float* pfPoint = (const float*)( pPoint + i * a_uiStride );
+		a_rBounds.vMin.x = pfPoint[0] < a_rBounds.vMin.x ? pfPoint[0] : a_rBounds.vMin.x;
+		a_rBounds.vMin.y = pfPoint[1] < a_rBounds.vMin.y ? pfPoint[1] : a_rBounds.vMin.y;
+		a_rBounds.vMin.z = pfPoint[2] < a_rBounds.vMin.z ? pfPoint[2] : a_rBounds.vMin.z;
+		a_rBounds.vMax.x = pfPoint[0] > a_rBounds.vMax.x ? pfPoint[0] : a_rBounds.vMax.x;
+		a_rBounds.vMax.y = pfPoint[1] > a_rBounds.vMax.y ? pfPoint[1] : a_rBounds.vMax.y;
+		a_rBounds.vMax.z = pfPoint[2] > a_rBounds.vMax.z ? pfPoint[2] : a_rBounds.vMax.z;
+	}
+
+	// centred on the box, but only as wide as the furthest point needs
+	a_rBounds.vCentre.x = ( a_rBounds.vMin.x + a_rBounds.vMax.x ) * 0.5f;
+	a_rBounds.vCentre.y = ( a_rBounds.vMin.y + a_rBounds.vMax.y ) * 0.5f;
+	a_rBounds.vCentre.z = ( a_rBounds.vMin.z + a_rBounds.vMax.z ) * 0.5f;
+
+	float fRadiusSq = 0.f;
+	for( unsigned int i = 0; i < a_uiCount; ++i )
+	{
+		const float* pfPoint = (const float*)( pPoint + i * a_uiStride );
+		float fX = pfPoint[0] - a_rBounds.vCentre.x;
+		float fY = pfPoint[1] - a_rBounds.vCentre.y;
+		float fZ = pfPoint[2] - a_rBounds.vCentre.z;
+		float fDistSq = fX * fX + fY * fY + fZ * fZ;
+		if( fDistSq > fRadiusSq )
+			fRadiusSq = fDistSq;
+	}
+	a_rBounds.fRadius = sqrtf( fRadiusSq );
+}
+
+void TransformBounds( const Bounds& a_rIn, const AIE::mat4& a_mTransform, Bounds& a_rOut )
+{
+	float afCentre[3] = {	( a_rIn.vMin.x + a_rIn.vMax.x ) * 0.5f,
+							( a_rIn.vMin.y + a_rIn.vMax.y ) * 0.5f,
+							( a_rIn.vMin.z + a_rIn.vMax.z ) * 0.5f };
+	float afExtent[3] = {	( a_rIn.vMax.x - a_rIn.vMin.x ) * 0.5f,
+							( a_rIn.vMax.y - a_rIn.vMin.y ) * 0.5f,
+							( a_rIn.vMax.z - a_rIn.vMin.z ) * 0.5f };
+	float afSphere[3] = { a_rIn.vCentre.x, a_rIn.vCentre.y, a_rIn.vCentre.z };
+
+	// the box's centre moves like a point, its extent along each new axis is
+	// the sum of the old extents projected onto it
+	float afNewCentre[3], afNewExtent[3], afNewSphere[3];
+	for( int j = 0; j < 3; ++j )
+	{
+		afNewCentre[j] = a_mTransform.mm[3][j];
+		afNewExtent[j] = 0.f;
+		afNewSphere[j] = a_mTransform.mm[3][j];
+		for( int i = 0; i < 3; ++i )
+		{
+			afNewCentre[j] += afCentre[i] * a_mTransform.mm[i][j];
+			afNewExtent[j] += afExtent[i] * fabsf( a_mTransform.mm[i][j] );
+			afNewSphere[j] += afSphere[i] * a_mTransform.mm[i][j];
+		}
+	}
+
+	// the sphere grows by the largest scale on any axis
+	float fScaleSq = 0.f;
+	for( int i = 0; i < 3; ++i )
+	{
+		float fRowSq =	a_mTransform.mm[i][0] * a_mTransform.mm[i][0] +
+						a_mTransform.mm[i][1] * a_mTransform.mm[i][1] +
+						a_mTransform.mm[i][2] * a_mTransform.mm[i][2];
+		if( fRowSq > fScaleSq )
+			fScaleSq = fRowSq;
+	}
+
+	a_rOut.vMin		= AIE::vec4( afNewCentre[0] - afNewExtent[0], afNewCentre[1] - afNewExtent[1], afNewCentre[2] - afNewExtent[2], 1.f );
+	a_rOut.vMax		= AIE::vec4( afNewCentre[0] + afNewExtent[0], afNewCentre[1] + afNewExtent[1], afNewCentre[2] + afNewExtent[2], 1.f );
+	a_rOut.vCentre	= AIE::vec4( afNewSphere[0], afNewSphere[1], afNewSphere[2], 1.f );
+	a_rOut.fRadius	= a_rIn.fRadius * sqrtf( fScaleSq );
+}
+
+void MergeBounds( const Bounds& a_rOther, Bounds& a_rBounds )
+{
+	a_rBounds.vMin.x = a_rOther.vMin.x < a_rBounds.vMin.x ? a_rOther.vMin.x : a_rBounds.vMin.x;
+	a_rBounds.vMin.y = a_rOther.vMin.y < a_rBounds.vMin.y ? a_rOther.vMin.y : a_rBounds.vMin.y;
+	a_rBounds.vMin.z = a_rOther.vMin.z < a_rBounds.vMin.z ? a_rOther.vMin.z : a_rBounds.vMin.z;
+	a_rBounds.vMax.x = a_rOther.vMax.x > a_rBounds.vMax.x ? a_rOther.vMax.x : a_rBounds.vMax.x;
+	a_rBounds.vMax.y = a_rOther.vMax.y > a_rBounds.vMax.y ? a_rOther.vMax.y : a_rBounds.vMax.y;
+	a_rBounds.vMax.z = a_rOther.vMax.z > a_rBounds.vMax.z ? a_rOther.vMax.z : a_rBounds.vMax.z;
+
+	// smallest sphere holding both spheres
+	float fX = a_rOther.vCentre.x - a_rBounds.vCentre.x;
+	float fY = a_rOther.vCentre.y - a_rBounds.vCentre.y;
+	float fZ = a_rOther.vCentre.z - a_rBounds.vCentre.z;
+	float fDist = sqrtf( fX * fX + fY * fY + fZ * fZ );
+
+	if( fDist + a_rOther.fRadius <= a_rBounds.fRadius )
+		return;
+	if( fDist + a_rBounds.fRadius <= a_rOther.fRadius )
+	{
+		a_rBounds.vCentre	= a_rOther.vCentre;
+		a_rBounds.fRadius	= a_rOther.fRadius;
+		return;
+	}
+
+	float fRadius = ( fDist + a_rBounds.fRadius + a_rOther.fRadius ) * 0.5f;
+	float fMove = ( fRadius - a_rBounds.fRadius ) / fDist;
+	a_rBounds.vCentre.x += fX * fMove;
+	a_rBounds.vCentre.y += fY * fMove;
+	a_rBounds.vCentre.z += fZ * fMove;
+	a_rBounds.fRadius = fRadius;
+}
+
+void PadBounds( float a_fAmount, Bounds& a_rBounds )
+{
+	a_rBounds.vMin.x -= a_fAmount;
+	a_rBounds.vMin.y -= a_fAmount;
+	a_rBounds.vMin.z -= a_fAmount;
+	a_rBounds.vMax.x += a_fAmount;
+	a_rBounds.vMax.y += a_fAmount;
+	a_rBounds.vMax.z += a_fAmount;
+	a_rBounds.fRadius += a_fAmount;
+}
+
+//////////////////////////////////////////////////////////////////////////
+Frustum::Frustum()
+{
+	// with no planes yet nothing is culled
+	for( int i = 0; i < 8; ++i )
+	{
+		m_afX[i] = 0.f;
+		m_afY[i] = 0.f;
+		m_afZ[i] = 0.f;
+		m_afW[i] = 1.f;
+	}
+}
+
+void Frustum::Extract( const AIE::mat4& a_mViewProjection )
+{
+	// clip = v * M, so clip.x is v dotted with M's first column and so on.
+	// GL keeps -w <= x,y,z <= w, each side of that is a plane w +/- column
+	const AIE::mat4& m = a_mViewProjection;
+	for( int i = 0; i < 3; ++i )
+	{
+		for( int iSide = 0; iSide < 2; ++iSide )
+		{
+			float fSign = iSide == 0 ? 1.f : -1.f;
+			int iPlane = i * 2 + iSide;
+
+			m_afX[ iPlane ] = m.mm[0][3] + fSign * m.mm[0][i];
+			m_afY[ iPlane ] = m.mm[1][3] + fSign * m.mm[1][i];
+			m_afZ[ iPlane ] = m.mm[2][3] + fSign * m.mm[2][i];
+			m_afW[ iPlane ] = m.mm[3][3] + fSign * m.mm[3][i];
+
+			float fLength = sqrtf(	m_afX[ iPlane ] * m_afX[ iPlane ] +
+									m_afY[ iPlane ] * m_afY[ iPlane ] +
+									m_afZ[ iPlane ] * m_afZ[ iPlane ] );
+			if( fLength > 0.f )
+			{
+				float fInvLength = 1.f / fLength;
+				m_afX[ iPlane ] *= fInvLength;
+				m_afY[ iPlane ] *= fInvLength;
+				m_afZ[ iPlane ] *= fInvLength;
+				m_afW[ iPlane ] *= fInvLength;
+			}
+		}
+	}
+
+	// 0x + 0y + 0z + 1, always in front
+	for( int i = 6; i < 8; ++i )
+	{
+		m_afX[i] = 0.f;
+		m_afY[i] = 0.f;
+		m_afZ[i] = 0.f;
+		m_afW[i] = 1.f;
+	}
+}
+
+bool Frustum::TestSphere( const AIE::vec4& a_vCentre, float a_fRadius ) const
+{
+	__m128 vCX			= _mm_set1_ps( a_vCentre.x );
+	__m128 vCY			= _mm_set1_ps( a_vCentre.y );
+	__m128 vCZ			= _mm_set1_ps( a_vCentre.z );
+	__m128 vNegRadius	= _mm_set1_ps( -a_fRadius );
+
+	int iOutside = 0;
+	for( int i = 0; i < 8; i += 4 )
+	{
+		// signed distance from four planes at once
+		__m128 vDist = _mm_add_ps(	_mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m_afX[i] ), vCX ),
+												_mm_mul_ps( _mm_loadu_ps( &m_afY[i] ), vCY ) ),
+									_mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m_afZ[i] ), vCZ ),
+												_mm_loadu_ps( &m_afW[i] ) ) );
+		iOutside |= _mm_movemask_ps( _mm_cmplt_ps( vDist, vNegRadius ) );
+	}
+
+	return iOutside == 0;
+}
+
+bool Frustum::TestAABB( const AIE::vec4& a_vMin, const AIE::vec4& a_vMax ) const
+{
+	__m128 vHalf	= _mm_set1_ps( 0.5f );
+	__m128 vCX		= _mm_mul_ps( _mm_set1_ps( a_vMax.x + a_vMin.x ), vHalf );
+	__m128 vCY		= _mm_mul_ps( _mm_set1_ps( a_vMax.y + a_vMin.y ), vHalf );
+	__m128 vCZ		= _mm_mul_ps( _mm_set1_ps( a_vMax.z + a_vMin.z ), vHalf );
+	__m128 vEX		= _mm_mul_ps( _mm_set1_ps( a_vMax.x - a_vMin.x ), vHalf );
+	__m128 vEY		= _mm_mul_ps( _mm_set1_ps( a_vMax.y - a_vMin.y ), vHalf );
+	__m128 vEZ		= _mm_mul_ps( _mm_set1_ps( a_vMax.z - a_vMin.z ), vHalf );
+	__m128 vSign	= _mm_set1_ps( -0.f );
+	__m128 vZero	= _mm_setzero_ps();
+
+	int iOutside = 0;
+	for( int i = 0; i < 8; i += 4 )
+	{
+		__m128 vNX = _mm_loadu_ps( &m_afX[i] );
+		__m128 vNY = _mm_loadu_ps( &m_afY[i] );
+		__m128 vNZ = _mm_loadu_ps( &m_afZ[i] );
+
+		// the centre's distance, plus how far the box reaches towards the
+		// plane's inside, is the distance of the corner furthest inside
+		__m128 vDist = _mm_add_ps(	_mm_add_ps( _mm_mul_ps( vNX, vCX ), _mm_mul_ps( vNY, vCY ) ),
+									_mm_add_ps( _mm_mul_ps( vNZ, vCZ ), _mm_loadu_ps( &m_afW[i] ) ) );
+		__m128 vReach = _mm_add_ps(	_mm_add_ps( _mm_mul_ps( _mm_andnot_ps( vSign, vNX ), vEX ),
+												_mm_mul_ps( _mm_andnot_ps( vSign, vNY ), vEY ) ),
+									_mm_mul_ps( _mm_andnot_ps( vSign, vNZ ), vEZ ) );
+		iOutside |= _mm_movemask_ps( _mm_cmplt_ps( _mm_add_ps( vDist, vReach ), vZero ) );
+	}
+
+	return iOutside == 0;
+}
+
+bool Frustum::IsVisible( const Bounds& a_rBounds ) const
+{
+	return	TestSphere( a_rBounds.vCentre, a_rBounds.fRadius ) &&
+			TestAABB( a_rBounds.vMin, a_rBounds.vMax );
+}
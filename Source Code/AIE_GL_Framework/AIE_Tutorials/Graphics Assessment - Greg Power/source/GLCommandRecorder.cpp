@@ -0,0 +1,662 @@
+#include "GLCommandRecorder.h"
+
+#include <GL\glfw.h>
+#include <stdio.h>
+#include <string.h>
+
+// the recording table's functions are plain function pointers, so what they
+// write to lives here while a recorder is running
+static GLCommandStream*			s_poStream	= nullptr;
+static const GLStateFunctions*	s_poForward	= nullptr;
+
+static unsigned int GetFloatBytes( GLsizei a_iCount, unsigned int a_uiFloatsEach )
+{
+	return a_iCount > 0 ? (unsigned int)a_iCount * a_uiFloatsEach * sizeof(GLfloat) : 0;
+}
+
+static void GLAPIENTRY RecordUseProgram( GLuint a_uiProgram )
+{
+	s_poStream->BeginCommand( GL_COMMAND_USE_PROGRAM );
+	s_poStream->Write( a_uiProgram );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUseProgram( a_uiProgram );
+}
+
+static void GLAPIENTRY RecordBindVertexArray( GLuint a_uiVertexArray )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BIND_VERTEX_ARRAY );
+	s_poStream->Write( a_uiVertexArray );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBindVertexArray( a_uiVertexArray );
+}
+
+static void GLAPIENTRY RecordActiveTexture( GLenum a_eUnit )
+{
+	s_poStream->BeginCommand( GL_COMMAND_ACTIVE_TEXTURE );
+	s_poStream->Write( a_eUnit );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnActiveTexture( a_eUnit );
+}
+
+static void GLAPIENTRY RecordBindTexture( GLenum a_eTarget, GLuint a_uiTexture )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BIND_TEXTURE );
+	s_poStream->Write( a_eTarget );
+	s_poStream->Write( a_uiTexture );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBindTexture( a_eTarget, a_uiTexture );
+}
+
+static void GLAPIENTRY RecordEnable( GLenum a_eCapability )
+{
+	s_poStream->BeginCommand( GL_COMMAND_ENABLE );
+	s_poStream->Write( a_eCapability );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnEnable( a_eCapability );
+}
+
+static void GLAPIENTRY RecordDisable( GLenum a_eCapability )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DISABLE );
+	s_poStream->Write( a_eCapability );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDisable( a_eCapability );
+}
+
+static void GLAPIENTRY RecordDepthMask( GLboolean a_bWrite )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DEPTH_MASK );
+	s_poStream->Write( a_bWrite );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDepthMask( a_bWrite );
+}
+
+static void GLAPIENTRY RecordBlendFunc( GLenum a_eSource, GLenum a_eDestination )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BLEND_FUNC );
+	s_poStream->Write( a_eSource );
+	s_poStream->Write( a_eDestination );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBlendFunc( a_eSource, a_eDestination );
+}
+
+static void GLAPIENTRY RecordPolygonMode( GLenum a_eFace, GLenum a_eMode )
+{
+	s_poStream->BeginCommand( GL_COMMAND_POLYGON_MODE );
+	s_poStream->Write( a_eFace );
+	s_poStream->Write( a_eMode );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnPolygonMode( a_eFace, a_eMode );
+}
+
+static void GLAPIENTRY RecordFrontFace( GLenum a_eMode )
+{
+	s_poStream->BeginCommand( GL_COMMAND_FRONT_FACE );
+	s_poStream->Write( a_eMode );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnFrontFace( a_eMode );
+}
+
+static void GLAPIENTRY RecordDeleteTextures( GLsizei a_iCount, const GLuint* a_puiTextures )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DELETE_TEXTURES );
+	s_poStream->WriteBytes( a_puiTextures, a_iCount > 0 ? a_iCount * sizeof(GLuint) : 0 );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDeleteTextures( a_iCount, a_puiTextures );
+}
+
+static void GLAPIENTRY RecordDeleteVertexArrays( GLsizei a_iCount, const GLuint* a_puiVertexArrays )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DELETE_VERTEX_ARRAYS );
+	s_poStream->WriteBytes( a_puiVertexArrays, a_iCount > 0 ? a_iCount * sizeof(GLuint) : 0 );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDeleteVertexArrays( a_iCount, a_puiVertexArrays );
+}
+
+static void GLAPIENTRY RecordClear( GLbitfield a_uiMask )
+{
+	s_poStream->BeginCommand( GL_COMMAND_CLEAR );
+	s_poStream->Write( a_uiMask );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnClear( a_uiMask );
+}
+
+static void GLAPIENTRY RecordViewport( GLint a_iX, GLint a_iY, GLsizei a_iWidth, GLsizei a_iHeight )
+{
+	s_poStream->BeginCommand( GL_COMMAND_VIEWPORT );
+	s_poStream->WriteInt( a_iX );
+	s_poStream->WriteInt( a_iY );
+	s_poStream->WriteInt( a_iWidth );
+	s_poStream->WriteInt( a_iHeight );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnViewport( a_iX, a_iY, a_iWidth, a_iHeight );
+}
+
+static void GLAPIENTRY RecordBindFramebuffer( GLenum a_eTarget, GLuint a_uiFramebuffer )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BIND_FRAMEBUFFER );
+	s_poStream->Write( a_eTarget );
+	s_poStream->Write( a_uiFramebuffer );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBindFramebuffer( a_eTarget, a_uiFramebuffer );
+}
+
+static void GLAPIENTRY RecordBindBuffer( GLenum a_eTarget, GLuint a_uiBuffer )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BIND_BUFFER );
+	s_poStream->Write( a_eTarget );
+	s_poStream->Write( a_uiBuffer );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBindBuffer( a_eTarget, a_uiBuffer );
+}
+
+static void GLAPIENTRY RecordBindBufferBase( GLenum a_eTarget, GLuint a_uiIndex, GLuint a_uiBuffer )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BIND_BUFFER_BASE );
+	s_poStream->Write( a_eTarget );
+	s_poStream->Write( a_uiIndex );
+	s_poStream->Write( a_uiBuffer );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBindBufferBase( a_eTarget, a_uiIndex, a_uiBuffer );
+}
+
+static void GLAPIENTRY RecordBufferData( GLenum a_eTarget, GLsizeiptr a_iSize, const GLvoid* a_pData, GLenum a_eUsage )
+{
+	// the size goes in on its own, a buffer made without data records none
+	s_poStream->BeginCommand( GL_COMMAND_BUFFER_DATA );
+	s_poStream->Write( a_eTarget );
+	s_poStream->Write( (unsigned int)a_iSize );
+	s_poStream->Write( a_eUsage );
+	s_poStream->WriteBytes( a_pData, a_pData != nullptr ? (unsigned int)a_iSize : 0 );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBufferData( a_eTarget, a_iSize, a_pData, a_eUsage );
+}
+
+static void GLAPIENTRY RecordBufferSubData( GLenum a_eTarget, GLintptr a_iOffset, GLsizeiptr a_iSize, const GLvoid* a_pData )
+{
+	s_poStream->BeginCommand( GL_COMMAND_BUFFER_SUB_DATA );
+	s_poStream->Write( a_eTarget );
+	s_poStream->Write( (unsigned int)a_iOffset );
+	s_poStream->WriteBytes( a_pData, (unsigned int)a_iSize );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnBufferSubData( a_eTarget, a_iOffset, a_iSize, a_pData );
+}
+
+static void GLAPIENTRY RecordUniform1i( GLint a_iLocation, GLint a_iValue )
+{
+	s_poStream->BeginCommand( GL_COMMAND_UNIFORM_1I );
+	s_poStream->WriteInt( a_iLocation );
+	s_poStream->WriteInt( a_iValue );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUniform1i( a_iLocation, a_iValue );
+}
+
+static void GLAPIENTRY RecordUniform1f( GLint a_iLocation, GLfloat a_fValue )
+{
+	s_poStream->BeginCommand( GL_COMMAND_UNIFORM_1F );
+	s_poStream->WriteInt( a_iLocation );
+	s_poStream->WriteFloat( a_fValue );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUniform1f( a_iLocation, a_fValue );
+}
+
+static void GLAPIENTRY RecordUniform2f( GLint a_iLocation, GLfloat a_fX, GLfloat a_fY )
+{
+	s_poStream->BeginCommand( GL_COMMAND_UNIFORM_2F );
+	s_poStream->WriteInt( a_iLocation );
+	s_poStream->WriteFloat( a_fX );
+	s_poStream->WriteFloat( a_fY );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUniform2f( a_iLocation, a_fX, a_fY );
+}
+
+static void GLAPIENTRY RecordUniform1fv( GLint a_iLocation, GLsizei a_iCount, const GLfloat* a_pfValues )
+{
+	s_poStream->BeginCommand( GL_COMMAND_UNIFORM_1FV );
+	s_poStream->WriteInt( a_iLocation );
+	s_poStream->WriteInt( a_iCount );
+	s_poStream->WriteBytes( a_pfValues, GetFloatBytes( a_iCount, 1 ) );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUniform1fv( a_iLocation, a_iCount, a_pfValues );
+}
+
+static void GLAPIENTRY RecordUniform4fv( GLint a_iLocation, GLsizei a_iCount, const GLfloat* a_pfValues )
+{
+	s_poStream->BeginCommand( GL_COMMAND_UNIFORM_4FV );
+	s_poStream->WriteInt( a_iLocation );
+	s_poStream->WriteInt( a_iCount );
+	s_poStream->WriteBytes( a_pfValues, GetFloatBytes( a_iCount, 4 ) );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUniform4fv( a_iLocation, a_iCount, a_pfValues );
+}
+
+static void GLAPIENTRY RecordUniformMatrix4fv( GLint a_iLocation, GLsizei a_iCount, GLboolean a_bTranspose, const GLfloat* a_pfValues )
+{
+	s_poStream->BeginCommand( GL_COMMAND_UNIFORM_MATRIX_4FV );
+	s_poStream->WriteInt( a_iLocation );
+	s_poStream->WriteInt( a_iCount );
+	s_poStream->Write( a_bTranspose );
+	s_poStream->WriteBytes( a_pfValues, GetFloatBytes( a_iCount, 16 ) );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnUniformMatrix4fv( a_iLocation, a_iCount, a_bTranspose, a_pfValues );
+}
+
+static void GLAPIENTRY RecordPointSize( GLfloat a_fSize )
+{
+	s_poStream->BeginCommand( GL_COMMAND_POINT_SIZE );
+	s_poStream->WriteFloat( a_fSize );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnPointSize( a_fSize );
+}
+
+static void GLAPIENTRY RecordPatchParameteri( GLenum a_eName, GLint a_iValue )
+{
+	s_poStream->BeginCommand( GL_COMMAND_PATCH_PARAMETER_I );
+	s_poStream->Write( a_eName );
+	s_poStream->WriteInt( a_iValue );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnPatchParameteri( a_eName, a_iValue );
+}
+
+static void GLAPIENTRY RecordDrawArrays( GLenum a_eMode, GLint a_iFirst, GLsizei a_iCount )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DRAW_ARRAYS );
+	s_poStream->Write( a_eMode );
+	s_poStream->WriteInt( a_iFirst );
+	s_poStream->WriteInt( a_iCount );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDrawArrays( a_eMode, a_iFirst, a_iCount );
+}
+
+// indices always come from the bound element buffer here, so the pointer is
+// an offset into it
+static void GLAPIENTRY RecordDrawElements( GLenum a_eMode, GLsizei a_iCount, GLenum a_eType, const GLvoid* a_pIndices )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DRAW_ELEMENTS );
+	s_poStream->Write( a_eMode );
+	s_poStream->WriteInt( a_iCount );
+	s_poStream->Write( a_eType );
+	s_poStream->Write( (unsigned int)(size_t)a_pIndices );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDrawElements( a_eMode, a_iCount, a_eType, a_pIndices );
+}
+
+static void GLAPIENTRY RecordDrawElementsInstanced( GLenum a_eMode, GLsizei a_iCount, GLenum a_eType, const GLvoid* a_pIndices, GLsizei a_iInstances )
+{
+	s_poStream->BeginCommand( GL_COMMAND_DRAW_ELEMENTS_INSTANCED );
+	s_poStream->Write( a_eMode );
+	s_poStream->WriteInt( a_iCount );
+	s_poStream->Write( a_eType );
+	s_poStream->Write( (unsigned int)(size_t)a_pIndices );
+	s_poStream->WriteInt( a_iInstances );
+	s_poStream->EndCommand();
+	if( s_poForward ) s_poForward->pfnDrawElementsInstanced( a_eMode, a_iCount, a_eType, a_pIndices, a_iInstances );
+}
+
+static const GLStateFunctions s_oRecordFunctions =
+{
+	RecordUseProgram,
+	RecordBindVertexArray,
+	RecordActiveTexture,
+	RecordBindTexture,
+	RecordEnable,
+	RecordDisable,
+	RecordDepthMask,
+	RecordBlendFunc,
+	RecordPolygonMode,
+	RecordFrontFace,
+	RecordDeleteTextures,
+	RecordDeleteVertexArrays,
+
+	RecordClear,
+	RecordViewport,
+	RecordBindFramebuffer,
+	RecordBindBuffer,
+	RecordBindBufferBase,
+	RecordBufferData,
+	RecordBufferSubData,
+	RecordUniform1i,
+	RecordUniform1f,
+	RecordUniform2f,
+	RecordUniform1fv,
+	RecordUniform4fv,
+	RecordUniformMatrix4fv,
+	RecordPointSize,
+	RecordPatchParameteri,
+	RecordDrawArrays,
+	RecordDrawElements,
+	RecordDrawElementsInstanced,
+};
+
+GLCommandRecorder::GLCommandRecorder()
+	: m_poStream( nullptr ),
+	  m_poPrevious( nullptr )
+{
+}
+
+GLCommandRecorder::~GLCommandRecorder()
+{
+	End();
+}
+
+void GLCommandRecorder::Begin( GLCommandStream& a_rStream, bool a_bExecute )
+{
+	if( s_poStream != nullptr )
+		return;
+
+	m_poStream = &a_rStream;
+	m_poPrevious = GetGLState().GetFunctions();
+
+	s_poStream = m_poStream;
+	s_poForward = a_bExecute ? m_poPrevious : nullptr;
+	GetGLState().SetFunctions( &s_oRecordFunctions );
+}
+
+void GLCommandRecorder::End()
+{
+	if( m_poStream == nullptr )
+		return;
+
+	GetGLState().SetFunctions( m_poPrevious );
+	s_poStream = nullptr;
+	s_poForward = nullptr;
+	m_poStream = nullptr;
+	m_poPrevious = nullptr;
+}
+
+void GLCommandTimings::Clear()
+{
+	memset( auiCalls, 0, sizeof(auiCalls) );
+	memset( adSeconds, 0, sizeof(adSeconds) );
+}
+
+void GLCommandTimings::Print() const
+{
+	for( unsigned int i = 0; i < GL_COMMAND_COUNT; ++i )
+	{
+		if( auiCalls[i] == 0 )
+			continue;
+		printf( "%-24s %6u calls %10.3f us %8.3f us each\n", g_aszGLCommandNames[i], auiCalls[i],
+				adSeconds[i] * 1000000.0, adSeconds[i] * 1000000.0 / auiCalls[i] );
+	}
+}
+
+// whether a_uiBytes is exactly a_iCount things of a_uiSize bytes, or none
+// for a count the call won't read any with
+static bool IsPayloadFor( unsigned int a_uiBytes, GLsizei a_iCount, unsigned int a_uiSize )
+{
+	if( a_iCount <= 0 )
+		return a_uiBytes == 0;
+	return a_uiBytes % a_uiSize == 0 && a_uiBytes / a_uiSize == (unsigned int)a_iCount;
+}
+
+// reads one command's arguments and makes the call, false if it ran short
+// or a payload isn't the size the call will read
+static bool PlayCommand( EGLCommand a_eCommand, GLCommandReader& a_roReader, const GLStateFunctions& a_rGL )
+{
+	unsigned int uiBytes = 0;
+
+	switch( a_eCommand )
+	{
+	case GL_COMMAND_USE_PROGRAM:
+		{
+			GLuint uiProgram = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnUseProgram( uiProgram );
+		}
+		break;
+	case GL_COMMAND_BIND_VERTEX_ARRAY:
+		{
+			GLuint uiVertexArray = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnBindVertexArray( uiVertexArray );
+		}
+		break;
+	case GL_COMMAND_ACTIVE_TEXTURE:
+		{
+			GLenum eUnit = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnActiveTexture( eUnit );
+		}
+		break;
+	case GL_COMMAND_BIND_TEXTURE:
+		{
+			GLenum eTarget = a_roReader.Read();
+			GLuint uiTexture = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnBindTexture( eTarget, uiTexture );
+		}
+		break;
+	case GL_COMMAND_ENABLE:
+		{
+			GLenum eCapability = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnEnable( eCapability );
+		}
+		break;
+	case GL_COMMAND_DISABLE:
+		{
+			GLenum eCapability = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnDisable( eCapability );
+		}
+		break;
+	case GL_COMMAND_DEPTH_MASK:
+		{
+			GLboolean bWrite = (GLboolean)a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnDepthMask( bWrite );
+		}
+		break;
+	case GL_COMMAND_BLEND_FUNC:
+		{
+			GLenum eSource = a_roReader.Read();
+			GLenum eDestination = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnBlendFunc( eSource, eDestination );
+		}
+		break;
+	case GL_COMMAND_POLYGON_MODE:
+		{
+			GLenum eFace = a_roReader.Read();
+			GLenum eMode = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnPolygonMode( eFace, eMode );
+		}
+		break;
+	case GL_COMMAND_FRONT_FACE:
+		{
+			GLenum eMode = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnFrontFace( eMode );
+		}
+		break;
+	case GL_COMMAND_DELETE_TEXTURES:
+		{
+			const GLuint* puiTextures = (const GLuint*)a_roReader.ReadBytes( uiBytes );
+			if( uiBytes % sizeof(GLuint) != 0 )
+				return false;
+			if( a_roReader.IsValid() ) a_rGL.pfnDeleteTextures( uiBytes / sizeof(GLuint), puiTextures );
+		}
+		break;
+	case GL_COMMAND_DELETE_VERTEX_ARRAYS:
+		{
+			const GLuint* puiVertexArrays = (const GLuint*)a_roReader.ReadBytes( uiBytes );
+			if( uiBytes % sizeof(GLuint) != 0 )
+				return false;
+			if( a_roReader.IsValid() ) a_rGL.pfnDeleteVertexArrays( uiBytes / sizeof(GLuint), puiVertexArrays );
+		}
+		break;
+	case GL_COMMAND_CLEAR:
+		{
+			GLbitfield uiMask = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnClear( uiMask );
+		}
+		break;
+	case GL_COMMAND_VIEWPORT:
+		{
+			GLint iX = a_roReader.ReadInt();
+			GLint iY = a_roReader.ReadInt();
+			GLsizei iWidth = a_roReader.ReadInt();
+			GLsizei iHeight = a_roReader.ReadInt();
+			if( a_roReader.IsValid() ) a_rGL.pfnViewport( iX, iY, iWidth, iHeight );
+		}
+		break;
+	case GL_COMMAND_BIND_FRAMEBUFFER:
+		{
+			GLenum eTarget = a_roReader.Read();
+			GLuint uiFramebuffer = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnBindFramebuffer( eTarget, uiFramebuffer );
+		}
+		break;
+	case GL_COMMAND_BIND_BUFFER:
+		{
+			GLenum eTarget = a_roReader.Read();
+			GLuint uiBuffer = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnBindBuffer( eTarget, uiBuffer );
+		}
+		break;
+	case GL_COMMAND_BIND_BUFFER_BASE:
+		{
+			GLenum eTarget = a_roReader.Read();
+			GLuint uiIndex = a_roReader.Read();
+			GLuint uiBuffer = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnBindBufferBase( eTarget, uiIndex, uiBuffer );
+		}
+		break;
+	case GL_COMMAND_BUFFER_DATA:
+		{
+			GLenum eTarget = a_roReader.Read();
+			GLsizeiptr iSize = a_roReader.Read();
+			GLenum eUsage = a_roReader.Read();
+			const GLvoid* pData = a_roReader.ReadBytes( uiBytes );
+			// data, when there is any, fills the whole buffer
+			if( uiBytes != 0 && uiBytes != (unsigned int)iSize )
+				return false;
+			if( a_roReader.IsValid() ) a_rGL.pfnBufferData( eTarget, iSize, pData, eUsage );
+		}
+		break;
+	case GL_COMMAND_BUFFER_SUB_DATA:
+		{
+			GLenum eTarget = a_roReader.Read();
+			GLintptr iOffset = a_roReader.Read();
+			const GLvoid* pData = a_roReader.ReadBytes( uiBytes );
+			if( a_roReader.IsValid() ) a_rGL.pfnBufferSubData( eTarget, iOffset, uiBytes, pData );
+		}
+		break;
+	case GL_COMMAND_UNIFORM_1I:
+		{
+			GLint iLocation = a_roReader.ReadInt();
+			GLint iValue = a_roReader.ReadInt();
+			if( a_roReader.IsValid() ) a_rGL.pfnUniform1i( iLocation, iValue );
+		}
+		break;
+	case GL_COMMAND_UNIFORM_1F:
+		{
+			GLint iLocation = a_roReader.ReadInt();
+			GLfloat fValue = a_roReader.ReadFloat();
+			if( a_roReader.IsValid() ) a_rGL.pfnUniform1f( iLocation, fValue );
+		}
+		break;
+	case GL_COMMAND_UNIFORM_2F:
+		{
+			GLint iLocation = a_roReader.ReadInt();
+			GLfloat fX = a_roReader.ReadFloat();
+			GLfloat fY = a_roReader.ReadFloat();
+			if( a_roReader.IsValid() ) a_rGL.pfnUniform2f( iLocation, fX, fY );
+		}
+		break;
+	case GL_COMMAND_UNIFORM_1FV:
+		{
+			GLint iLocation = a_roReader.ReadInt();
+			GLsizei iCount = a_roReader.ReadInt();
+			const GLfloat* pfValues = (const GLfloat*)a_roReader.ReadBytes( uiBytes );
+			if( !IsPayloadFor( uiBytes, iCount, sizeof(GLfloat) ) )
+				return false;
+			if( a_roReader.IsValid() ) a_rGL.pfnUniform1fv( iLocation, iCount, pfValues );
+		}
+		break;
+	case GL_COMMAND_UNIFORM_4FV:
+		{
+			GLint iLocation = a_roReader.ReadInt();
+			GLsizei iCount = a_roReader.ReadInt();
+			const GLfloat* pfValues = (const GLfloat*)a_roReader.ReadBytes( uiBytes );
+			if( !IsPayloadFor( uiBytes, iCount, 4 * sizeof(GLfloat) ) )
+				return false;
+			if( a_roReader.IsValid() ) a_rGL.pfnUniform4fv( iLocation, iCount, pfValues );
+		}
+		break;
+	case GL_COMMAND_UNIFORM_MATRIX_4FV:
+		{
+			GLint iLocation = a_roReader.ReadInt();
+			GLsizei iCount = a_roReader.ReadInt();
+			GLboolean bTranspose = (GLboolean)a_roReader.Read();
+			const GLfloat* pfValues = (const GLfloat*)a_roReader.ReadBytes( uiBytes );
+			if( !IsPayloadFor( uiBytes, iCount, 16 * sizeof(GLfloat) ) )
+				return false;
+			if( a_roReader.IsValid() ) a_rGL.pfnUniformMatrix4fv( iLocation, iCount, bTranspose, pfValues );
+		}
+		break;
+	case GL_COMMAND_POINT_SIZE:
+		{
+			GLfloat fSize = a_roReader.ReadFloat();
+			if( a_roReader.IsValid() ) a_rGL.pfnPointSize( fSize );
+		}
+		break;
+	case GL_COMMAND_PATCH_PARAMETER_I:
+		{
+			GLenum eName = a_roReader.Read();
+			GLint iValue = a_roReader.ReadInt();
+			if( a_roReader.IsValid() ) a_rGL.pfnPatchParameteri( eName, iValue );
+		}
+		break;
+	case GL_COMMAND_DRAW_ARRAYS:
+		{
+			GLenum eMode = a_roReader.Read();
+			GLint iFirst = a_roReader.ReadInt();
+			GLsizei iCount = a_roReader.ReadInt();
+			if( a_roReader.IsValid() ) a_rGL.pfnDrawArrays( eMode, iFirst, iCount );
+		}
+		break;
+	case GL_COMMAND_DRAW_ELEMENTS:
+		{
+			GLenum eMode = a_roReader.Read();
+			GLsizei iCount = a_roReader.ReadInt();
+			GLenum eType = a_roReader.Read();
+			size_t uiOffset = a_roReader.Read();
+			if( a_roReader.IsValid() ) a_rGL.pfnDrawElements( eMode, iCount, eType, (const GLvoid*)uiOffset );
+		}
+		break;
+	case GL_COMMAND_DRAW_ELEMENTS_INSTANCED:
+		{
+			GLenum eMode = a_roReader.Read();
+			GLsizei iCount = a_roReader.ReadInt();
+			GLenum eType = a_roReader.Read();
+			size_t uiOffset = a_roReader.Read();
+			GLsizei iInstances = a_roReader.ReadInt();
+			if( a_roReader.IsValid() ) a_rGL.pfnDrawElementsInstanced( eMode, iCount, eType, (const GLvoid*)uiOffset, iInstances );
+		}
+		break;
+	default:
+		return false;
+	}
+
+	return a_roReader.IsValid();
+}
+
+bool PlayCommands( const GLCommandStream& a_rStream, const GLStateFunctions& a_rGL, GLCommandTimings* a_poTimings )
+{
+	GLCommandReader oReader( a_rStream );
+	EGLCommand eCommand;
+
+	while( oReader.Next( eCommand ) )
+	{
+		if( a_poTimings == nullptr )
+		{
+			if( !PlayCommand( eCommand, oReader, a_rGL ) )
+				return false;
+			continue;
+		}
+
+		double dStart = glfwGetTime();
+		bool bPlayed = PlayCommand( eCommand, oReader, a_rGL );
+		a_poTimings->adSeconds[ eCommand ] += glfwGetTime() - dStart;
+		++a_poTimings->auiCalls[ eCommand ];
+
+		if( !bPlayed )
+			return false;
+	}
+
+	// Next stops at the end or at a command it can't read
+	return oReader.IsValid();
+}
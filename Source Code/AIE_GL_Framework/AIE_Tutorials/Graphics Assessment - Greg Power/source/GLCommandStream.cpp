@@ -0,0 +1,252 @@
+#include "GLCommandStream.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// disable the warning for microsoft "safe" functions
+#pragma warning( disable : 4996 )
+
+const char* g_aszGLCommandNames[ GL_COMMAND_COUNT ] =
+{
+	"glUseProgram",
+	"glBindVertexArray",
+	"glActiveTexture",
+	"glBindTexture",
+	"glEnable",
+	"glDisable",
+	"glDepthMask",
+	"glBlendFunc",
+	"glPolygonMode",
+	"glFrontFace",
+	"glDeleteTextures",
+	"glDeleteVertexArrays",
+	"glClear",
+	"glViewport",
+	"glBindFramebuffer",
+	"glBindBuffer",
+	"glBindBufferBase",
+	"glBufferData",
+	"glBufferSubData",
+	"glUniform1i",
+	"glUniform1f",
+	"glUniform2f",
+	"glUniform1fv",
+	"glUniform4fv",
+	"glUniformMatrix4fv",
+	"glPointSize",
+	"glPatchParameteri",
+	"glDrawArrays",
+	"glDrawElements",
+	"glDrawElementsInstanced",
+};
+
+static const unsigned int STREAM_MAGIC		= 0x43454941;	// "AIEC"
+static const unsigned int STREAM_VERSION	= 1;
+
+struct CommandStreamHeader
+{
+	unsigned int	uiMagic;
+	unsigned int	uiVersion;
+	unsigned int	uiCommandCount;
+	unsigned int	uiWordCount;
+};
+
+static const unsigned int COMMAND_MASK		= 0xff;
+static const unsigned int LENGTH_SHIFT		= 8;
+static const unsigned int NO_COMMAND		= 0xffffffff;
+
+// rounded up without adding first, so a byte count near the top can't wrap
+static unsigned int GetWordsForBytes( unsigned int a_uiBytes )
+{
+	return a_uiBytes / sizeof(unsigned int) + ( a_uiBytes % sizeof(unsigned int) != 0 ? 1 : 0 );
+}
+
+GLCommandStream::GLCommandStream()
+	: m_uiCommandCount( 0 ),
+	  m_uiCommandStart( NO_COMMAND )
+{
+}
+
+void GLCommandStream::Clear()
+{
+	m_auiWords.clear();
+	m_uiCommandCount = 0;
+	m_uiCommandStart = NO_COMMAND;
+}
+
+void GLCommandStream::BeginCommand( EGLCommand a_eCommand )
+{
+	m_uiCommandStart = m_auiWords.size();
+	m_auiWords.push_back( (unsigned int)a_eCommand );
+}
+
+void GLCommandStream::WriteFloat( float a_fValue )
+{
+	unsigned int uiValue;
+	memcpy( &uiValue, &a_fValue, sizeof(uiValue) );
+	m_auiWords.push_back( uiValue );
+}
+
+void GLCommandStream::WriteBytes( const void* a_pData, unsigned int a_uiBytes )
+{
+	m_auiWords.push_back( a_uiBytes );
+	if( a_uiBytes == 0 )
+		return;
+
+	unsigned int uiStart = m_auiWords.size();
+	m_auiWords.resize( uiStart + GetWordsForBytes( a_uiBytes ), 0 );
+	memcpy( &m_auiWords[ uiStart ], a_pData, a_uiBytes );
+}
+
+void GLCommandStream::EndCommand()
+{
+	if( m_uiCommandStart == NO_COMMAND )
+		return;
+
+	unsigned int uiLength = m_auiWords.size() - m_uiCommandStart - 1;
+	m_auiWords[ m_uiCommandStart ] |= uiLength << LENGTH_SHIFT;
+	m_uiCommandStart = NO_COMMAND;
+	++m_uiCommandCount;
+}
+
+bool GLCommandStream::Save( const char* a_szPath ) const
+{
+	FILE* pFile = fopen( a_szPath, "wb" );
+	if( pFile == nullptr )
+		return false;
+
+	CommandStreamHeader oHeader;
+	oHeader.uiMagic			= STREAM_MAGIC;
+	oHeader.uiVersion		= STREAM_VERSION;
+	oHeader.uiCommandCount	= m_uiCommandCount;
+	oHeader.uiWordCount		= m_auiWords.size();
+
+	bool bWritten = fwrite( &oHeader, sizeof(oHeader), 1, pFile ) == 1 &&
+					( m_auiWords.empty() || fwrite( &m_auiWords[0], sizeof(unsigned int), m_auiWords.size(), pFile ) == m_auiWords.size() );
+	fclose( pFile );
+
+	return bWritten;
+}
+
+bool GLCommandStream::Load( const char* a_szPath )
+{
+	Clear();
+
+	FILE* pFile = fopen( a_szPath, "rb" );
+	if( pFile == nullptr )
+		return false;
+
+	CommandStreamHeader oHeader;
+	bool bValid = fread( &oHeader, sizeof(oHeader), 1, pFile ) == 1 &&
+				  oHeader.uiMagic == STREAM_MAGIC &&
+				  oHeader.uiVersion == STREAM_VERSION;
+
+	if( bValid && oHeader.uiWordCount > 0 )
+	{
+		m_auiWords.resize( oHeader.uiWordCount );
+		bValid = fread( &m_auiWords[0], sizeof(unsigned int), oHeader.uiWordCount, pFile ) == oHeader.uiWordCount;
+	}
+	fclose( pFile );
+
+	if( !bValid )
+	{
+		Clear();
+		return false;
+	}
+	m_uiCommandCount = oHeader.uiCommandCount;
+	return true;
+}
+
+unsigned int GLCommandStream::FindFirstDifference( const GLCommandStream& a_rOther ) const
+{
+	unsigned int uiPosition = 0;
+	unsigned int uiCommand = 0;
+
+	while( uiPosition < m_auiWords.size() && uiPosition < a_rOther.m_auiWords.size() )
+	{
+		// the header holds the command and its length, so once they match
+		// both commands cover the same words
+		unsigned int uiLength = ( m_auiWords[ uiPosition ] >> LENGTH_SHIFT ) + 1;
+		if( uiPosition + uiLength > m_auiWords.size() ||
+			uiPosition + uiLength > a_rOther.m_auiWords.size() ||
+			memcmp( &m_auiWords[ uiPosition ], &a_rOther.m_auiWords[ uiPosition ], uiLength * sizeof(unsigned int) ) != 0 )
+		{
+			return uiCommand;
+		}
+		uiPosition += uiLength;
+		++uiCommand;
+	}
+
+	if( m_auiWords.size() != a_rOther.m_auiWords.size() )
+		return uiCommand;
+
+	return NO_DIFFERENCE;
+}
+
+GLCommandReader::GLCommandReader( const GLCommandStream& a_rStream )
+	: m_puiWords( a_rStream.GetWords() ),
+	  m_uiWordCount( a_rStream.GetWordCount() ),
+	  m_uiPosition( 0 ),
+	  m_uiCommandEnd( 0 ),
+	  m_bValid( true )
+{
+}
+
+bool GLCommandReader::Next( EGLCommand& a_reCommand )
+{
+	// skip whatever the last command's reader left
+	m_uiPosition = m_uiCommandEnd;
+	if( !m_bValid || m_uiPosition >= m_uiWordCount )
+		return false;
+
+	unsigned int uiHeader = m_puiWords[ m_uiPosition++ ];
+	unsigned int uiCommand = uiHeader & COMMAND_MASK;
+	unsigned int uiLength = uiHeader >> LENGTH_SHIFT;
+
+	if( uiCommand >= GL_COMMAND_COUNT || uiLength > m_uiWordCount - m_uiPosition )
+	{
+		m_bValid = false;
+		return false;
+	}
+
+	m_uiCommandEnd = m_uiPosition + uiLength;
+	a_reCommand = (EGLCommand)uiCommand;
+	return true;
+}
+
+unsigned int GLCommandReader::Read()
+{
+	if( m_uiPosition >= m_uiCommandEnd )
+	{
+		m_bValid = false;
+		return 0;
+	}
+	return m_puiWords[ m_uiPosition++ ];
+}
+
+float GLCommandReader::ReadFloat()
+{
+	unsigned int uiValue = Read();
+	float fValue;
+	memcpy( &fValue, &uiValue, sizeof(fValue) );
+	return fValue;
+}
+
+const void* GLCommandReader::ReadBytes( unsigned int& a_ruiBytes )
+{
+	a_ruiBytes = Read();
+	if( a_ruiBytes == 0 )
+		return nullptr;
+
+	unsigned int uiWords = GetWordsForBytes( a_ruiBytes );
+	if( !m_bValid || uiWords > m_uiCommandEnd - m_uiPosition )
+	{
+		m_bValid = false;
+		a_ruiBytes = 0;
+		return nullptr;
+	}
+
+	const void* pData = &m_puiWords[ m_uiPosition ];
+	m_uiPosition += uiWords;
+	return pData;
+}
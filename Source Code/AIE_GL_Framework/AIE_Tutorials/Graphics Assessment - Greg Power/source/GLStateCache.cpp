@@ -0,0 +1,308 @@
+#include "GLStateCache.h"
+
+#include <string.h>
+
+// glew's entry points are only loaded by glewInit, so the default table
+// calls through these rather than holding the pointers themselves
+static void GLAPIENTRY CallUseProgram( GLuint a_uiProgram )							{ glUseProgram( a_uiProgram ); }
+static void GLAPIENTRY CallBindVertexArray( GLuint a_uiVertexArray )				{ glBindVertexArray( a_uiVertexArray ); }
+static void GLAPIENTRY CallActiveTexture( GLenum a_eUnit )							{ glActiveTexture( a_eUnit ); }
+static void GLAPIENTRY CallBindTexture( GLenum a_eTarget, GLuint a_uiTexture )		{ glBindTexture( a_eTarget, a_uiTexture ); }
+static void GLAPIENTRY CallEnable( GLenum a_eCapability )							{ glEnable( a_eCapability ); }
+static void GLAPIENTRY CallDisable( GLenum a_eCapability )							{ glDisable( a_eCapability ); }
+static void GLAPIENTRY CallDepthMask( GLboolean a_bWrite )							{ glDepthMask( a_bWrite ); }
+static void GLAPIENTRY CallBlendFunc( GLenum a_eSource, GLenum a_eDestination )		{ glBlendFunc( a_eSource, a_eDestination ); }
+static void GLAPIENTRY CallPolygonMode( GLenum a_eFace, GLenum a_eMode )			{ glPolygonMode( a_eFace, a_eMode ); }
+static void GLAPIENTRY CallFrontFace( GLenum a_eMode )								{ glFrontFace( a_eMode ); }
+static void GLAPIENTRY CallDeleteTextures( GLsizei a_iCount, const GLuint* a_puiTextures )			{ glDeleteTextures( a_iCount, a_puiTextures ); }
+static void GLAPIENTRY CallDeleteVertexArrays( GLsizei a_iCount, const GLuint* a_puiVertexArrays )	{ glDeleteVertexArrays( a_iCount, a_puiVertexArrays ); }
+static void GLAPIENTRY CallClear( GLbitfield a_uiMask )								{ glClear( a_uiMask ); }
+static void GLAPIENTRY CallViewport( GLint a_iX, GLint a_iY, GLsizei a_iWidth, GLsizei a_iHeight )	{ glViewport( a_iX, a_iY, a_iWidth, a_iHeight ); }
+static void GLAPIENTRY CallBindFramebuffer( GLenum a_eTarget, GLuint a_uiFramebuffer )	{ glBindFramebuffer( a_eTarget, a_uiFramebuffer ); }
+static void GLAPIENTRY CallBindBuffer( GLenum a_eTarget, GLuint a_uiBuffer )			{ glBindBuffer( a_eTarget, a_uiBuffer ); }
+static void GLAPIENTRY CallBindBufferBase( GLenum a_eTarget, GLuint a_uiIndex, GLuint a_uiBuffer )	{ glBindBufferBase( a_eTarget, a_uiIndex, a_uiBuffer ); }
+static void GLAPIENTRY CallBufferData( GLenum a_eTarget, GLsizeiptr a_iSize, const GLvoid* a_pData, GLenum a_eUsage )		{ glBufferData( a_eTarget, a_iSize, a_pData, a_eUsage ); }
+static void GLAPIENTRY CallBufferSubData( GLenum a_eTarget, GLintptr a_iOffset, GLsizeiptr a_iSize, const GLvoid* a_pData )	{ glBufferSubData( a_eTarget, a_iOffset, a_iSize, a_pData ); }
+static void GLAPIENTRY CallUniform1i( GLint a_iLocation, GLint a_iValue )			{ glUniform1i( a_iLocation, a_iValue ); }
+static void GLAPIENTRY CallUniform1f( GLint a_iLocation, GLfloat a_fValue )			{ glUniform1f( a_iLocation, a_fValue ); }
+static void GLAPIENTRY CallUniform2f( GLint a_iLocation, GLfloat a_fX, GLfloat a_fY )	{ glUniform2f( a_iLocation, a_fX, a_fY ); }
+static void GLAPIENTRY CallUniform1fv( GLint a_iLocation, GLsizei a_iCount, const GLfloat* a_pfValues )	{ glUniform1fv( a_iLocation, a_iCount, a_pfValues ); }
+static void GLAPIENTRY CallUniform4fv( GLint a_iLocation, GLsizei a_iCount, const GLfloat* a_pfValues )	{ glUniform4fv( a_iLocation, a_iCount, a_pfValues ); }
+static void GLAPIENTRY CallUniformMatrix4fv( GLint a_iLocation, GLsizei a_iCount, GLboolean a_bTranspose, const GLfloat* a_pfValues )	{ glUniformMatrix4fv( a_iLocation, a_iCount, a_bTranspose, a_pfValues ); }
+static void GLAPIENTRY CallPointSize( GLfloat a_fSize )								{ glPointSize( a_fSize ); }
+static void GLAPIENTRY CallPatchParameteri( GLenum a_eName, GLint a_iValue )		{ glPatchParameteri( a_eName, a_iValue ); }
+static void GLAPIENTRY CallDrawArrays( GLenum a_eMode, GLint a_iFirst, GLsizei a_iCount )	{ glDrawArrays( a_eMode, a_iFirst, a_iCount ); }
+static void GLAPIENTRY CallDrawElements( GLenum a_eMode, GLsizei a_iCount, GLenum a_eType, const GLvoid* a_pIndices )	{ glDrawElements( a_eMode, a_iCount, a_eType, a_pIndices ); }
+static void GLAPIENTRY CallDrawElementsInstanced( GLenum a_eMode, GLsizei a_iCount, GLenum a_eType, const GLvoid* a_pIndices, GLsizei a_iInstances )	{ glDrawElementsInstanced( a_eMode, a_iCount, a_eType, a_pIndices, a_iInstances ); }
+
+const GLStateFunctions& GetDefaultGLFunctions()
+{
+	static const GLStateFunctions s_oFunctions =
+	{
+		CallUseProgram,
+		CallBindVertexArray,
+		CallActiveTexture,
+		CallBindTexture,
+		CallEnable,
+		CallDisable,
+		CallDepthMask,
+		CallBlendFunc,
+		CallPolygonMode,
+		CallFrontFace,
+		CallDeleteTextures,
+		CallDeleteVertexArrays,
+		CallClear,
+		CallViewport,
+		CallBindFramebuffer,
+		CallBindBuffer,
+		CallBindBufferBase,
+		CallBufferData,
+		CallBufferSubData,
+		CallUniform1i,
+		CallUniform1f,
+		CallUniform2f,
+		CallUniform1fv,
+		CallUniform4fv,
+		CallUniformMatrix4fv,
+		CallPointSize,
+		CallPatchParameteri,
+		CallDrawArrays,
+		CallDrawElements,
+		CallDrawElementsInstanced,
+	};
+	return s_oFunctions;
+}
+
+unsigned int GLStateStats::GetIssued() const
+{
+	unsigned int uiTotal = 0;
+	for( unsigned int i = 0; i < GL_STATE_CALL_COUNT; ++i )
+	{
+		uiTotal += auiIssued[i];
+	}
+	return uiTotal;
+}
+
+unsigned int GLStateStats::GetSkipped() const
+{
+	unsigned int uiTotal = 0;
+	for( unsigned int i = 0; i < GL_STATE_CALL_COUNT; ++i )
+	{
+		uiTotal += auiSkipped[i];
+	}
+	return uiTotal;
+}
+
+GLStateCache::GLStateCache()
+{
+	m_poGL = &GetDefaultGLFunctions();
+	memset( &m_oFrameStats, 0, sizeof(m_oFrameStats) );
+	memset( &m_oLastFrameStats, 0, sizeof(m_oLastFrameStats) );
+	Invalidate();
+}
+
+void GLStateCache::SetFunctions( const GLStateFunctions* a_poFunctions )
+{
+	m_poGL = a_poFunctions != nullptr ? a_poFunctions : &GetDefaultGLFunctions();
+	Invalidate();
+}
+
+void GLStateCache::Invalidate()
+{
+	m_uiProgram			= UNKNOWN;
+	m_uiVertexArray		= UNKNOWN;
+	m_uiActiveUnit		= UNKNOWN;
+	m_uiDepthMask		= UNKNOWN;
+	m_uiBlendSource		= UNKNOWN;
+	m_uiBlendDestination = UNKNOWN;
+	m_uiPolygonMode		= UNKNOWN;
+	m_uiFrontFace		= UNKNOWN;
+
+	for( unsigned int uiUnit = 0; uiUnit < MAX_CACHED_TEXTURE_UNITS; ++uiUnit )
+	{
+		for( unsigned int uiTarget = 0; uiTarget < TEXTURE_TARGET_COUNT; ++uiTarget )
+		{
+			m_auiTextures[ uiUnit ][ uiTarget ] = UNKNOWN;
+		}
+	}
+	for( unsigned int i = 0; i < CAPABILITY_COUNT; ++i )
+	{
+		m_auiCapabilities[i] = UNKNOWN;
+	}
+}
+
+void GLStateCache::BeginFrame()
+{
+	m_oLastFrameStats = m_oFrameStats;
+	memset( &m_oFrameStats, 0, sizeof(m_oFrameStats) );
+}
+
+bool GLStateCache::Changed( EGLStateCall a_eCall, GLuint& a_ruiCached, GLuint a_uiValue )
+{
+	if( a_ruiCached == a_uiValue )
+	{
+		++m_oFrameStats.auiSkipped[ a_eCall ];
+		return false;
+	}
+	a_ruiCached = a_uiValue;
+	++m_oFrameStats.auiIssued[ a_eCall ];
+	return true;
+}
+
+void GLStateCache::UseProgram( GLuint a_uiProgram )
+{
+	if( Changed( GL_STATE_CALL_PROGRAM, m_uiProgram, a_uiProgram ) )
+		m_poGL->pfnUseProgram( a_uiProgram );
+}
+
+void GLStateCache::BindVertexArray( GLuint a_uiVertexArray )
+{
+	if( Changed( GL_STATE_CALL_VERTEX_ARRAY, m_uiVertexArray, a_uiVertexArray ) )
+		m_poGL->pfnBindVertexArray( a_uiVertexArray );
+}
+
+void GLStateCache::ActiveTexture( GLenum a_eUnit )
+{
+	if( Changed( GL_STATE_CALL_ACTIVE_TEXTURE, m_uiActiveUnit, a_eUnit ) )
+		m_poGL->pfnActiveTexture( a_eUnit );
+}
+
+void GLStateCache::BindTexture( GLenum a_eTarget, GLuint a_uiTexture )
+{
+	int iTarget = GetTextureTargetIndex( a_eTarget );
+	GLuint uiUnit = m_uiActiveUnit - GL_TEXTURE0;
+
+	// the active unit not being known is the same as any binding not being
+	// known, and it stays unknown until ActiveTexture is called
+	if( iTarget < 0 || m_uiActiveUnit == UNKNOWN || uiUnit >= MAX_CACHED_TEXTURE_UNITS )
+	{
+		++m_oFrameStats.auiIssued[ GL_STATE_CALL_TEXTURE ];
+		m_poGL->pfnBindTexture( a_eTarget, a_uiTexture );
+		return;
+	}
+
+	if( Changed( GL_STATE_CALL_TEXTURE, m_auiTextures[ uiUnit ][ iTarget ], a_uiTexture ) )
+		m_poGL->pfnBindTexture( a_eTarget, a_uiTexture );
+}
+
+void GLStateCache::Enable( GLenum a_eCapability )
+{
+	SetCapability( a_eCapability, true );
+}
+
+void GLStateCache::Disable( GLenum a_eCapability )
+{
+	SetCapability( a_eCapability, false );
+}
+
+void GLStateCache::SetCapability( GLenum a_eCapability, bool a_bEnabled )
+{
+	int iCapability = GetCapabilityIndex( a_eCapability );
+	if( iCapability >= 0 && !Changed( GL_STATE_CALL_CAPABILITY, m_auiCapabilities[ iCapability ], a_bEnabled ? 1 : 0 ) )
+		return;
+
+	if( iCapability < 0 )
+		++m_oFrameStats.auiIssued[ GL_STATE_CALL_CAPABILITY ];
+
+	if( a_bEnabled )
+		m_poGL->pfnEnable( a_eCapability );
+	else
+		m_poGL->pfnDisable( a_eCapability );
+}
+
+void GLStateCache::DepthMask( GLboolean a_bWrite )
+{
+	if( Changed( GL_STATE_CALL_DEPTH_MASK, m_uiDepthMask, a_bWrite ? 1 : 0 ) )
+		m_poGL->pfnDepthMask( a_bWrite );
+}
+
+void GLStateCache::BlendFunc( GLenum a_eSource, GLenum a_eDestination )
+{
+	if( m_uiBlendSource == a_eSource && m_uiBlendDestination == a_eDestination )
+	{
+		++m_oFrameStats.auiSkipped[ GL_STATE_CALL_BLEND_FUNC ];
+		return;
+	}
+	m_uiBlendSource			= a_eSource;
+	m_uiBlendDestination	= a_eDestination;
+	++m_oFrameStats.auiIssued[ GL_STATE_CALL_BLEND_FUNC ];
+	m_poGL->pfnBlendFunc( a_eSource, a_eDestination );
+}
+
+void GLStateCache::PolygonMode( GLenum a_eFace, GLenum a_eMode )
+{
+	if( a_eFace != GL_FRONT_AND_BACK )
+	{
+		// one side changing leaves the pair unknown
+		m_uiPolygonMode = UNKNOWN;
+		++m_oFrameStats.auiIssued[ GL_STATE_CALL_POLYGON_MODE ];
+		m_poGL->pfnPolygonMode( a_eFace, a_eMode );
+		return;
+	}
+
+	if( Changed( GL_STATE_CALL_POLYGON_MODE, m_uiPolygonMode, a_eMode ) )
+		m_poGL->pfnPolygonMode( a_eFace, a_eMode );
+}
+
+void GLStateCache::FrontFace( GLenum a_eMode )
+{
+	if( Changed( GL_STATE_CALL_FRONT_FACE, m_uiFrontFace, a_eMode ) )
+		m_poGL->pfnFrontFace( a_eMode );
+}
+
+void GLStateCache::DeleteTextures( GLsizei a_iCount, const GLuint* a_puiTextures )
+{
+	for( GLsizei i = 0; i < a_iCount; ++i )
+	{
+		if( a_puiTextures[i] == 0 )
+			continue;
+
+		for( unsigned int uiUnit = 0; uiUnit < MAX_CACHED_TEXTURE_UNITS; ++uiUnit )
+		{
+			for( unsigned int uiTarget = 0; uiTarget < TEXTURE_TARGET_COUNT; ++uiTarget )
+			{
+				if( m_auiTextures[ uiUnit ][ uiTarget ] == a_puiTextures[i] )
+					m_auiTextures[ uiUnit ][ uiTarget ] = 0;
+			}
+		}
+	}
+	m_poGL->pfnDeleteTextures( a_iCount, a_puiTextures );
+}
+
+void GLStateCache::DeleteVertexArrays( GLsizei a_iCount, const GLuint* a_puiVertexArrays )
+{
+	for( GLsizei i = 0; i < a_iCount; ++i )
+	{
+		if( a_puiVertexArrays[i] != 0 && m_uiVertexArray == a_puiVertexArrays[i] )
+			m_uiVertexArray = 0;
+	}
+	m_poGL->pfnDeleteVertexArrays( a_iCount, a_puiVertexArrays );
+}
+
+int GLStateCache::GetTextureTargetIndex( GLenum a_eTarget )
+{
+	switch( a_eTarget )
+	{
+	case GL_TEXTURE_2D:			return TEXTURE_TARGET_2D;
+	case GL_TEXTURE_2D_ARRAY:	return TEXTURE_TARGET_2D_ARRAY;
+	case GL_TEXTURE_CUBE_MAP:	return TEXTURE_TARGET_CUBE_MAP;
+	default:					return -1;
+	}
+}
+
+int GLStateCache::GetCapabilityIndex( GLenum a_eCapability )
+{
+	switch( a_eCapability )
+	{
+	case GL_BLEND:				return CAPABILITY_BLEND;
+	case GL_DEPTH_TEST:			return CAPABILITY_DEPTH_TEST;
+	case GL_CULL_FACE:			return CAPABILITY_CULL_FACE;
+	default:					return -1;
+	}
+}
+
+GLStateCache& GetGLState()
+{
+	static GLStateCache s_oGLState;
+	return s_oGLState;
+}
@@ -1,6 +1,8 @@
 #include "GSLab01.h"
 #include "CApplication.h"
 #include "CRenderManager.h"
+#include "TextureCache.h"
+#include "TextureArray.h"
 
 GSLab01::GSLab01(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -11,68 +13,63 @@ GSLab01::GSLab01(EGameState a_eStateID, CApplication* a_pApp)
 	m_poCamera = new Camera();
 
 	m_poTitlePlane = new PlaneNode(20.f, 20.f, 2, 2, AIE::vec4(0.f, 0.f, 0.f, 1.f));
-	m_poTitlePlane->SetTexture( LoadTexture("./images/lab01.png") );
+	m_poTitlePlane->SetTexture( AcquireTexture("./images/lab01.png") );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitlePlane->RotateNode( m_qPlaneRot );
 	m_poTitlePlane->TranslateNode( AIE::vec4(0.f, 8.f, -40.f, 0.f) );
 	m_poTitlePlane->UpdateBuffers();
+	m_poTitlePlane->UseModelMatrix();
 
 	m_poWaterPlane = new PlaneNode(100.f, 100.f, 100, 100, AIE::vec4(0.f, 0.f, 0.f, 1.f));
-	m_poWaterPlane->SetTexture( LoadTexture("./images/water.png") );
+	m_poWaterPlane->SetTexture( AcquireTexture("./images/water.png") );
+	m_poWaterPlane->SetBoundsPadding( 0.3f );	// the ripples in the vertex shader
 	
 	m_poCobbleStonePlane = new PlaneNode(100.f, 100.f, 100, 100, AIE::vec4(0.f, -3.f, 0.f, 1.f));
-	m_poCobbleStonePlane->SetTexture( LoadTexture("./images/cobblestone.jpg") );
+	m_poCobbleStonePlane->SetTexture( AcquireTexture("./images/cobblestone.jpg") );
 
-	m_poWallPlane01 = new PlaneNode(100.f, 45.f, 2, 2, AIE::vec4(0.f, 0.f, 0.f, 1.f));
-	m_poWallPlane01->SetTexture( LoadTexture("./images/dungeon_wall2.png") );
+	// the three walls are one unit plane drawn three times
+	const char* aszWallTextures[] = { "./images/dungeon_wall2.png" };
+	m_poWalls = new InstanceBatch( AcquirePlaneMesh( 2, 2 ) );
+	m_poWalls->SetTextureArrays( LoadTextureArray( aszWallTextures, 1 ) );
+
+	unsigned int uiWall = m_poWalls->AddInstance( AIE::vec4(100.f, 1.f, 45.f, 0.f) );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
-	m_poWallPlane01->RotateNode( m_qPlaneRot );
-	m_poWallPlane01->TranslateNode( AIE::vec4(0.f, 19.5f, 50.f, 0.f) );
-	m_poWallPlane01->UpdateBuffers();
+	m_poWalls->RotateInstance( uiWall, m_qPlaneRot );
+	m_poWalls->TranslateInstance( uiWall, AIE::vec4(0.f, 19.5f, 50.f, 0.f) );
 
-	m_poWallPlane02 = new PlaneNode(100.f, 45.f, 2, 2, AIE::vec4(0.f, 0.f, 0.f, 1.f));
-	m_poWallPlane02->SetTexture( LoadTexture("./images/dungeon_wall2.png") );
+	uiWall = m_poWalls->AddInstance( AIE::vec4(100.f, 1.f, 45.f, 0.f) );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(0.f, 1.f, 0.f, 0.f) );
-	m_poWallPlane02->RotateNode( m_qPlaneRot );
+	m_poWalls->RotateInstance( uiWall, m_qPlaneRot );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(0.f, 0.f, 1.f, 0.f) );
-	m_poWallPlane02->RotateNode( m_qPlaneRot );
-	m_poWallPlane02->TranslateNode( AIE::vec4(-50.f, 19.5f, 0.f, 0.f) );
-	m_poWallPlane02->UpdateBuffers();
+	m_poWalls->RotateInstance( uiWall, m_qPlaneRot );
+	m_poWalls->TranslateInstance( uiWall, AIE::vec4(-50.f, 19.5f, 0.f, 0.f) );
 
-	m_poWallPlane03 = new PlaneNode(100.f, 45.f, 2, 2, AIE::vec4(0.f, 0.f, 0.f, 1.f));
-	m_poWallPlane03->SetTexture( LoadTexture("./images/dungeon_wall2.png") );
+	uiWall = m_poWalls->AddInstance( AIE::vec4(100.f, 1.f, 45.f, 0.f) );
 	m_qPlaneRot.CreateRotation(PI/2, AIE::vec4(0.f, 1.f, 0.f, 0.f) );
-	m_poWallPlane03->RotateNode( m_qPlaneRot );
+	m_poWalls->RotateInstance( uiWall, m_qPlaneRot );
 	m_qPlaneRot.CreateRotation(PI/2, AIE::vec4(0.f, 0.f, 1.f, 0.f) );
-	m_poWallPlane03->RotateNode( m_qPlaneRot );
-	m_poWallPlane03->TranslateNode( AIE::vec4(50.f, 19.5f, 0.f, 0.f) );
-	m_poWallPlane03->UpdateBuffers();
-
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poWallPlane01		);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poWallPlane02		);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poWallPlane03		);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitlePlane			);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poWaterPlane			);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poCobbleStonePlane	);
+	m_poWalls->RotateInstance( uiWall, m_qPlaneRot );
+	m_poWalls->TranslateInstance( uiWall, AIE::vec4(50.f, 19.5f, 0.f, 0.f) );
+
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poWalls,				RENDER_SHADER_BASIC_INSTANCED, RENDER_PASS_TRANSPARENT ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitlePlane,			RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poWaterPlane,			RENDER_SHADER_WATER, RENDER_PASS_TRANSPARENT ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poCobbleStonePlane,	RENDER_SHADER_WATER, RENDER_PASS_TRANSPARENT ) );
+
+	// see through, nothing writes depth or is culled
+	RenderPassState oPassState = { false, false, false };
+	m_pApp->GetRenderManager()->SetPassState( m_eStateID, RENDER_PASS_OPAQUE, RENDER_PASS_OVERLAY, oPassState );
 }
 
 GSLab01::~GSLab01()
 {
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poWallPlane01			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poWallPlane02			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poWallPlane03			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poTitlePlane			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poWaterPlane			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poCobbleStonePlane	);
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
 
-	delete m_poWallPlane03;
-	m_poWallPlane03 = nullptr;
-
-	delete m_poWallPlane02;
-	m_poWallPlane02 = nullptr;
-
-	delete m_poWallPlane01;
-	m_poWallPlane01 = nullptr;
+	delete m_poWalls;
+	m_poWalls = nullptr;
 
 	delete m_poCobbleStonePlane;
 	m_poCobbleStonePlane = nullptr;
@@ -100,7 +97,7 @@ void GSLab01::Load()
 			"PlaneNode.h & .cpp\n"
 			"GSLab01.h & .cpp\n"
 			"'lab01_water' shaders\n"
-			"DrawLab01() in CRenderManager.cpp\n" 
+			"DrawPasses() function in CRenderManager.cpp\n" 
 			"------------------------------------------------\n");
 }	 
 	 
@@ -116,7 +113,6 @@ void GSLab01::Update(float a_fDeltaTime)
 	AIE::vec4 trans = AIE::vec4(0.f,0.f,0.f,0.f);
 	trans.y += cos( m_fTimer ) / 620.f;
 	m_poTitlePlane->TranslateNode( trans );
-	m_poTitlePlane->UpdateBuffers();
 }	 
 	 
 void GSLab01::Draw()
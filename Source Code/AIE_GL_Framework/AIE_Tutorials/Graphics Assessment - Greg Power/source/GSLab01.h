@@ -2,8 +2,10 @@
 #define _GSLAB01_H_
 
 #include "IBaseGameState.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "PlaneNode.h"
+#include "InstanceBatch.h"
 #include "Skybox.h"
 
 class GSLab01 : public IBaseGameState
@@ -23,12 +25,11 @@ private:
 	PlaneNode*	m_poTitlePlane;
 	PlaneNode*	m_poWaterPlane;
 	PlaneNode*	m_poCobbleStonePlane;
-	PlaneNode*	m_poWallPlane01;
-	PlaneNode*	m_poWallPlane02;
-	PlaneNode*	m_poWallPlane03;
+	InstanceBatch*	m_poWalls;
 	Skybox*		m_poSkybox;
 	
 	Quaternion	m_qPlaneRot;
+	std::vector<RenderHandle>	m_ahRenderNodes;
 	float		m_fTimer;
 
 };
@@ -1,6 +1,8 @@
 #include "GSLab02.h"
 #include "CApplication.h"
 #include "CRenderManager.h"
+#include "TextureCache.h"
+#include "TextureArray.h"
 
 GSLab02::GSLab02(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -9,62 +11,61 @@ GSLab02::GSLab02(EGameState a_eStateID, CApplication* a_pApp)
 	m_fTimer = 0.f;
 
 	m_poRoom = new Skybox(60.f );
-	m_poRoom->SetTexture( LoadTexture( "./images/wallpaper1.png" ) );
-	m_poRoom->SetSecondaryTexture( LoadTexture( "./images/wallpaper_hidden1.png" ) );
+	m_poRoom->SetTexture( AcquireTexture( "./images/wallpaper1.png" ) );
+	m_poRoom->SetSecondaryTexture( AcquireTexture( "./images/wallpaper_hidden1.png" ) );
 
 	m_poTitle = new PlaneNode( 30.f, 20.f, 20, 20, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab02.png") );
-	m_poTitle->SetSecondaryTexture( LoadTexture("./images/lab02_hidden.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab02.png") );
+	m_poTitle->SetSecondaryTexture( AcquireTexture("./images/lab02_hidden.png") );
 	m_qPlaneRot.CreateRotation( -PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitle->RotateNode(m_qPlaneRot);
 	m_poTitle->TranslateNode( AIE::vec4(0.f, -12.f, 0.f, 0.f) );
 	m_poTitle->UpdateBuffers();
+	m_poTitle->SetBoundsPadding( 1.f );	// the wave in the vertex shader
+
+	// one unit plane for all three paintings, each with its own layer of the
+	// texture arrays
+	const char* aszPaintings[]	= {	"./images/spainPlane011.png",
+									"./images/spainPlane021.png",
+									"./images/spainPlane031.png" };
+	const char* aszHidden[]		= {	"./images/spainPlane01_hidden1.png",
+									"./images/spainPlane02_hidden1.png",
+									"./images/spainPlane03_hidden1.png" };
+	m_poPaintings = new InstanceBatch( AcquirePlaneMesh( 20, 20 ) );
+	m_poPaintings->SetTextureArrays( LoadTextureArray( aszPaintings, 3 ), LoadTextureArray( aszHidden, 3 ) );
+	m_poPaintings->SetBoundsPadding( 1.f );
 
-	m_poPainting01 = new PlaneNode( 10.f, 7.2f, 20, 20, AIE::vec4(0.f, 0.f, 0.f, 1.f) );
-	m_poPainting01->SetTexture( LoadTexture("./images/spainPlane011.png") );
-	m_poPainting01->SetSecondaryTexture( LoadTexture("./images/spainPlane01_hidden1.png") );
 	m_qPlaneRot.CreateRotation( -PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
-	m_poPainting01->RotateNode(m_qPlaneRot);
-	m_poPainting01->TranslateNode( AIE::vec4(-16.f, 0.f, 0.f, 0.f) );
-	m_poPainting01->UpdateBuffers();
-
-	m_poPainting02 = new PlaneNode( 10.f, 8.9f, 20, 20, AIE::vec4(0.f, 0.f, 0.f, 1.f) );
-	m_poPainting02->SetTexture( LoadTexture("./images/spainPlane021.png") );
-	m_poPainting02->SetSecondaryTexture( LoadTexture("./images/spainPlane02_hidden1.png") );
-	m_poPainting02->RotateNode(m_qPlaneRot);
-	m_poPainting02->TranslateNode( AIE::vec4(16.f, 0.f, 0.f, 0.f) );
-	m_poPainting02->UpdateBuffers();
-
-	m_poPainting03 = new PlaneNode( 10.f, 11.7f, 20, 20, AIE::vec4(0.f, 0.f, 0.f, 1.f) );
-	m_poPainting03->SetTexture( LoadTexture("./images/spainPlane031.png") );
-	m_poPainting03->SetSecondaryTexture( LoadTexture("./images/spainPlane03_hidden1.png") );
-	m_poPainting03->RotateNode(m_qPlaneRot);
-	m_poPainting03->TranslateNode( AIE::vec4(0.f, 0.f, 0.f, 0.f) );
-	m_poPainting03->UpdateBuffers();
+
+	unsigned int uiPainting = m_poPaintings->AddInstance( AIE::vec4(10.f, 1.f, 7.2f, 0.f), 0.f, 0.f );
+	m_poPaintings->RotateInstance( uiPainting, m_qPlaneRot );
+	m_poPaintings->TranslateInstance( uiPainting, AIE::vec4(-16.f, 0.f, 0.f, 0.f) );
+
+	uiPainting = m_poPaintings->AddInstance( AIE::vec4(10.f, 1.f, 8.9f, 0.f), 1.f, 1.f );
+	m_poPaintings->RotateInstance( uiPainting, m_qPlaneRot );
+	m_poPaintings->TranslateInstance( uiPainting, AIE::vec4(16.f, 0.f, 0.f, 0.f) );
+
+	uiPainting = m_poPaintings->AddInstance( AIE::vec4(10.f, 1.f, 11.7f, 0.f), 2.f, 2.f );
+	m_poPaintings->RotateInstance( uiPainting, m_qPlaneRot );
 	
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poRoom );
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle );
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poPainting01 );
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poPainting02 );
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poPainting03 );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poRoom, RENDER_SHADER_LAB02, RENDER_PASS_TRANSPARENT ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle, RENDER_SHADER_LAB02, RENDER_PASS_OVERLAY ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poPaintings, RENDER_SHADER_LAB02_INSTANCED, RENDER_PASS_TRANSPARENT ) );
+
+	// see through, nothing writes depth or is culled
+	RenderPassState oPassState = { false, false, false };
+	m_pApp->GetRenderManager()->SetPassState( m_eStateID, RENDER_PASS_OPAQUE, RENDER_PASS_OVERLAY, oPassState );
 }
 
 GSLab02::~GSLab02()
 {
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poRoom			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poTitle			);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poPainting01		);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poPainting02		);
-	m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_poPainting03		);
-
-	delete m_poPainting03;
-	m_poPainting03 = nullptr;
-
-	delete m_poPainting02;
-	m_poPainting02 = nullptr;
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
 
-	delete m_poPainting01;
-	m_poPainting01 = nullptr;
+	delete m_poPaintings;
+	m_poPaintings = nullptr;
 
 	delete m_poTitle;
 	m_poTitle = nullptr;
@@ -94,9 +95,10 @@ void GSLab02::Load()
 			"Relevant code can be found in:\n\n"
 			
 			"PlaneNode.h & .cpp\n"
+			"InstanceBatch.h & .cpp\n"
 			"GSLab02.h & .cpp\n"
-			"'lab02' shaders\n"
-			"DrawLab02() function in CRenderManager.cpp\n"
+			"'lab02' and 'lab02_instanced' shaders\n"
+			"DrawPasses() function in CRenderManager.cpp\n"
 			"------------------------------------------------\n");
 }	 
 	 
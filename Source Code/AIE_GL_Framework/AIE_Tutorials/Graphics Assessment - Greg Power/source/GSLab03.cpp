@@ -2,6 +2,7 @@
 #include "CApplication.h"
 #include "CRenderManager.h"
 #include "ParticleSystem.h"
+#include "TextureCache.h"
 
 GSLab03::GSLab03(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -10,10 +11,10 @@ GSLab03::GSLab03(EGameState a_eStateID, CApplication* a_pApp)
 	m_fTimer = 0.f;
 
 	m_poSkyBox = new Skybox( 300.f );
-	m_poSkyBox->SetTexture( LoadTexture("./images/skybox_purple.png") );
+	m_poSkyBox->SetTexture( AcquireTexture("./images/skybox_purple.png") );
 
 	m_poTitle = new PlaneNode( 10.f, 10.f, 2, 2, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab03.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab03.png") );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitle->RotateNode( m_qPlaneRot );
 	m_poTitle->TranslateNode( AIE::vec4(-8.f, 0.f, 10.f, 0.f) );
@@ -24,15 +25,26 @@ GSLab03::GSLab03(EGameState a_eStateID, CApplication* a_pApp)
 	m_poParticleManager->CreateSystem( "MANA" );
 
 	m_poSphere		= new IcosphereNode( 1.0f, AIE::vec4(0.f,0.f,0.f,1.f) );
+	m_poSphere->UseModelMatrix();
 
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSkyBox			);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle			);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSphere			);
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSkyBox,			RENDER_SHADER_BASIC, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle,			RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSphere,			RENDER_SHADER_LAB03, RENDER_PASS_OPAQUE ) );
 	m_pApp->GetRenderManager()->AddParticleManager( m_eStateID, m_poParticleManager );
+
+	// the sky box is seen from inside
+	RenderPassState oPassState = { true, false, false };
+	m_pApp->GetRenderManager()->SetPassState( m_eStateID, RENDER_PASS_OPAQUE, RENDER_PASS_OVERLAY, oPassState );
 }
 
 GSLab03::~GSLab03()
 {
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
+	m_pApp->GetRenderManager()->RemoveParticleManager( m_eStateID, m_poParticleManager );
+
 	delete m_poSkyBox;
 	m_poSkyBox = nullptr;
 
@@ -65,7 +77,7 @@ void GSLab03::Load()
 			"GSLab03.h & .cpp\n"
 			"'lab03' shaders\n"
 			"'particle_2d' shaders\n"
-			"DrawLab03() function in CRenderManager.cpp\n"
+			"DrawPasses() function in CRenderManager.cpp\n"
 			"------------------------------------------------\n" );
 
 }
@@ -84,7 +96,6 @@ void GSLab03::Update(float a_fDeltaTime)
 	Quaternion quat;
 	quat.CreateRotation( PI/8 * a_fDeltaTime, AIE::vec4(0.f,1.f,0.f,1.f) );
 	m_poSphere->RotateNode( quat );
-	m_poSphere->UpdateBuffers();
 
 	m_poParticleManager->Update( a_fDeltaTime );
 }	 
@@ -1,6 +1,7 @@
 #include "GSLab04.h"
 #include "CApplication.h"
 #include "CRenderManager.h"
+#include "TextureCache.h"
 
 GSLab04::GSLab04(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -9,22 +10,32 @@ GSLab04::GSLab04(EGameState a_eStateID, CApplication* a_pApp)
 	m_fTimer = 0.f;
 
 	m_poTitle = new PlaneNode( 10.f, 10.f, 2, 2, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab04.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab04.png") );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitle->RotateNode( m_qPlaneRot );
 	m_poTitle->TranslateNode( AIE::vec4(0.f, 190.f, -180.f, 0.f) );
 	m_poTitle->UpdateBuffers();
 
 	m_poTerrain = new PlaneNode( 500.f, 500.f, 100, 100, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTerrain->SetTexture( LoadTexture("./images/perlin_noise.png") );
-	m_poTerrain->SetDisplacementTexture( LoadTexture("./images/perlin_noise.png") );
+	m_poTerrain->SetTexture( AcquireTexture("./images/perlin_noise.png") );
+	m_poTerrain->SetDisplacementTexture( AcquireTexture("./images/perlin_noise.png") );
+	m_poTerrain->SetBoundsPadding( 60.f );	// as high as the tessellation shader raises it
 
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTerrain );
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTerrain, RENDER_SHADER_LAB04, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle, RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
+
+	// the terrain in wireframe, the title over it filled
+	RenderPassState oPassState = { true, true, true };
+	m_pApp->GetRenderManager()->SetPassState( m_eStateID, RENDER_PASS_OPAQUE, RENDER_PASS_REFRACTION, oPassState );
 }
 
 GSLab04::~GSLab04()
 {
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
+
 	delete m_poTerrain;
 	m_poTerrain = nullptr;
 
@@ -52,7 +63,7 @@ void GSLab04::Load()
 
 			"GSLab04.h & .cpp\n"
 			"'lab04' shaders\n"
-			"DrawLab04() function in CRenderManager.cpp\n"
+			"DrawPasses() function in CRenderManager.cpp\n"
 			"------------------------------------------------\n" );
 }
 
@@ -1,6 +1,8 @@
 #include "GSLab05.h"
+#include "GLStateCache.h"
 #include "CApplication.h"
 #include "CRenderManager.h"
+#include "TextureCache.h"
 
 #include "Utilities.h"
 
@@ -15,17 +17,31 @@ GSLab05::GSLab05(EGameState a_eStateID, CApplication* a_pApp)
 	InitFBXSceneResources(&m_oScene);
 
 	m_poTitle = new PlaneNode( 4.f, 4.f, 2, 2, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab05.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab05.png") );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitle->RotateNode( m_qPlaneRot );
 	m_poTitle->TranslateNode( AIE::vec4(3.f, 2.f, 1.f, 0.f) );
 	m_poTitle->UpdateBuffers();
 
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle, RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
+
+	// nothing writes depth or is culled
+	RenderPassState oPassState = { false, false, false };
+	m_pApp->GetRenderManager()->SetPassState( m_eStateID, RENDER_PASS_OPAQUE, RENDER_PASS_OVERLAY, oPassState );
 }
 
 GSLab05::~GSLab05()
 {
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
+
+	// Unload should have let go of it, but don't leave the render manager
+	// pointing at a scene that's about to go
+	if( m_pApp->GetRenderManager()->GetFBXScene() == &m_oScene )
+		m_pApp->GetRenderManager()->SetFBXScene( nullptr );
+
 	DestroyFBXSceneResources(&m_oScene);
 	m_oScene.Unload();
 
@@ -37,7 +53,7 @@ void GSLab05::Load()
 {
 	m_poCamera = new Camera( AIE::vec4(0.f,2.f,-10.f,1.f), AIE::vec4(0.f,0.f,1.f,1.f), AIE::vec4(0.f,1.f,0.f,0.f) );
 	m_pApp->GetRenderManager()->SetActiveCamera( m_poCamera );
-	m_pApp->GetRenderManager()->SetFBXScene( m_oScene );
+	m_pApp->GetRenderManager()->SetFBXScene( &m_oScene );
 
 	printf( "\n\n------------------------------------------------\n"
 		"Lab 05 and 06 - Diffuse and Specular Lighting\n\n"
@@ -56,12 +72,14 @@ void GSLab05::Load()
 
 		"GSLab05.h & .cpp\n"
 		"'normalmap' shaders\n"
-		"DrawLab05() function in CRenderManager.cpp\n"
+		"DrawFBXScene() function in CRenderManager.cpp\n"
 		"------------------------------------------------\n" );
 }
 
 void GSLab05::Unload()
 {
+	m_pApp->GetRenderManager()->SetFBXScene( nullptr );
+
 	delete m_poCamera;
 	m_poCamera = nullptr;
 }
@@ -90,11 +108,13 @@ void GSLab05::InitFBXSceneResources(FBXScene* a_pScene)
 		RenderObject* ro = new RenderObject;
 		pMesh->m_userData = ro;
 
+		ComputeBounds( pMesh->m_vertices.data(), pMesh->m_vertices.size(), sizeof(FBXVertex), ro->oBounds );
+
 		glGenBuffers(		1, &ro->VBO);
 		glGenBuffers(		1, &ro->IBO);
 		glGenVertexArrays(	1, &ro->VAO);
 
-		glBindVertexArray(ro->VAO);
+		GetGLState().BindVertexArray(ro->VAO);
 		glBindBuffer(GL_ARRAY_BUFFER, ro->VBO);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ro->IBO);
 
@@ -115,7 +135,7 @@ void GSLab05::InitFBXSceneResources(FBXScene* a_pScene)
 		glVertexAttribPointer( 4, 4, GL_FLOAT, GL_FALSE, sizeof(FBXVertex), (char*)FBXVertex::IndicesOffset		);
 		glVertexAttribPointer( 5, 4, GL_FLOAT, GL_FALSE, sizeof(FBXVertex), (char*)FBXVertex::WeightsOffset		);
 		glVertexAttribPointer( 6, 2, GL_FLOAT, GL_FALSE, sizeof(FBXVertex), (char*)FBXVertex::UVOffset			);
-		glBindVertexArray(0);
+		GetGLState().BindVertexArray(0);
 	}
 
 	for(unsigned int i = 0; i < matCount; ++i)
@@ -128,7 +148,7 @@ void GSLab05::InitFBXSceneResources(FBXScene* a_pScene)
 			{
 				std::string path = a_pScene->GetPath();
 				path += pMaterial->textureFilenames[j];
-				pMaterial->textureIDs[j] = LoadTexture(path.c_str(),GL_BGRA);
+				pMaterial->textureIDs[j] = AcquireTexture(path.c_str(),GL_BGRA);
 
 				printf("Loading texture %i: %s - ID: %i\n",j, path.c_str(),pMaterial->textureIDs[j]);
 			}
@@ -146,7 +166,7 @@ void GSLab05::DestroyFBXSceneResources(FBXScene* a_pScene)
 
 		RenderObject* ro = (RenderObject*)pMesh->m_userData;
 
-		glDeleteVertexArrays(1, &ro->VAO);
+		GetGLState().DeleteVertexArrays(1, &ro->VAO);
 		glDeleteBuffers(1, &ro->VBO);
 		glDeleteBuffers(1, &ro->IBO);
 	}
@@ -159,7 +179,7 @@ void GSLab05::DestroyFBXSceneResources(FBXScene* a_pScene)
 		for ( int j = 0 ; j < FBXMaterial::TextureTypes_Count ; ++j )
 		{
 			if (pMaterial->textureIDs[j] != 0)
-				glDeleteTextures(1,&pMaterial->textureIDs[j]);
+				ReleaseTexture( pMaterial->textureIDs[j] );
 		}
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "GSLab07.h"
 #include "CApplication.h"
 #include "CRenderManager.h"
+#include "TextureCache.h"
 
 GSLab07::GSLab07(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -9,14 +10,14 @@ GSLab07::GSLab07(EGameState a_eStateID, CApplication* a_pApp)
 	m_fTimer = 0.f;
 
 	m_poSkybox = new Skybox( 900.f );
-	m_poSkybox->SetTexture( LoadTexture("./images/skybox_purple.png") );
+	m_poSkybox->SetTexture( AcquireTexture("./images/skybox_purple.png") );
 	m_poSkybox->SetColour( AIE::vec4( 1.0f, 0.4f, 0.f, 1.0f) );
 
 	m_poTerrain = new TerrainNode(400.f, 400.f, 160.f, 100, 100, AIE::vec4(0.f,0.f,0.f,1.f) );
 	m_poTerrain->SetColour( AIE::vec4( 0.45f, 0.f, .2f, 1.f ) );
 
 	m_poTitle = new PlaneNode( 30.f, 30.f, 2, 2, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab07.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab07.png") );
 	m_qPlaneRot.CreateRotation( PI/2, AIE::vec4(1.f,0.f,0.f,0.f) );
 	m_poTitle->RotateNode( m_qPlaneRot );
 	m_qPlaneRot.CreateRotation( PI, AIE::vec4(0.f,0.f,1.f,0.f) );
@@ -31,10 +32,10 @@ GSLab07::GSLab07(EGameState a_eStateID, CApplication* a_pApp)
 	m_poGlass->TranslateNode( AIE::vec4( 0.f, 0.f, 180.f, 0.f ) );
 	m_poGlass->UpdateBuffers();
 
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSkybox		);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTerrain	);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poGlass		);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle		);
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSkybox,		RENDER_SHADER_BASIC, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTerrain,	RENDER_SHADER_LAB07, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poGlass,		RENDER_SHADER_REFRACTION, RENDER_PASS_REFRACTION ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle,		RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
 
 	m_pParticleManager = new ParticleManager();
 	m_pParticleManager->Init();
@@ -45,6 +46,12 @@ GSLab07::GSLab07(EGameState a_eStateID, CApplication* a_pApp)
 
 GSLab07::~GSLab07()
 {
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
+	m_pApp->GetRenderManager()->RemoveParticleManager( m_eStateID, m_pParticleManager );
+
 	delete m_pParticleManager;
 	m_pParticleManager = nullptr;
 
@@ -73,7 +80,8 @@ void GSLab07::Load()
 			"is applied to create the refracted glass of the window\n\n"
 
 			"The entire scene is then blurred using Gaussian Blur,\n"
-			"which requires two passes.\n\n"
+			"run over a pyramid of half, quarter and eighth sized\n"
+			"copies and blended back up.\n\n"
 
 			"All light properties are passed into the shader as uniforms.\n\n"
 
@@ -81,9 +89,10 @@ void GSLab07::Load()
 
 			"GSLab07.h & .cpp\n"
 			"'refraction' shaders\n"
-			"'gaussian' shaders\n"
+			"'blur' shaders\n"
+			"BlurPyramid.h & .cpp\n"
 			"'fullscreen_quad' shaders\n"
-			"DrawLab07() function in CRenderManager.cpp\n"
+			"DrawRefractedFrame() function in CRenderManager.cpp\n"
 			"------------------------------------------------\n" );
 }
 
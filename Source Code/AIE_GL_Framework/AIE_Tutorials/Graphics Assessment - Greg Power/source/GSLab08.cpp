@@ -2,6 +2,7 @@
 #include "CApplication.h"
 #include "CRenderManager.h"
 #include "FBXLoader.h"
+#include "TextureCache.h"
 
 GSLab08::GSLab08(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -10,28 +11,34 @@ GSLab08::GSLab08(EGameState a_eStateID, CApplication* a_pApp)
 	m_fTimer = 0.f;
 
 	m_poSkyBox = new Skybox( 1000.f );
-	m_poSkyBox->SetTexture( LoadTexture("./images/skybox_mars.png") );
+	m_poSkyBox->SetTexture( AcquireTexture("./images/skybox_mars.png") );
 
 	m_poTerrain = new TerrainNode( 1000.f, 1000.f, 100.f, 500, 500, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTerrain->SetTexture( LoadTexture("./images/cracked_mud.jpg") );
+	m_poTerrain->SetTexture( AcquireTexture("./images/cracked_mud.jpg") );
 
 	m_poIcosphere = new IcosphereNode( 5.f, AIE::vec4(0.f,10.f,0.f,1.f) );
+	m_poIcosphere->UseModelMatrix();
 
 	m_poTitle = new PlaneNode( 40.f, 40.f, 2, 2, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab08.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab08.png") );
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitle->RotateNode( m_qPlaneRot );
 	m_poTitle->TranslateNode( AIE::vec4(0.f, 20.f, 0.f, 0.f) );
 	m_poTitle->UpdateBuffers();
 
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSkyBox		);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTerrain	);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poIcosphere	);
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle		);
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poSkyBox,		RENDER_SHADER_BASIC, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTerrain,	RENDER_SHADER_LAB08, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poIcosphere,	RENDER_SHADER_LAB08, RENDER_PASS_OPAQUE ) );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle,		RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
 }
 
 GSLab08::~GSLab08()
 {
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
+
 	delete m_poIcosphere;
 	m_poIcosphere = nullptr;
 
@@ -60,7 +67,7 @@ void GSLab08::Load()
 			"TerrainNode.h & .cpp\n"
 			"PerlinNoise2D.h\n"
 			"GSLab08.h & .cpp\n"
-			"DrawLab08() function in CRenderManager.cpp\n"
+			"DrawPasses() function in CRenderManager.cpp\n"
 			"------------------------------------------------\n" );
 }
 
@@ -79,7 +86,6 @@ void GSLab08::Update(float a_fDeltaTime)
 	quat.CreateRotation( PI/16 * a_fDeltaTime, AIE::vec4(0.f,1.f,0.f,1.f) );
 
 	m_poIcosphere->RotateNode( quat );
-	m_poIcosphere->UpdateBuffers();
 }	 
 
 void GSLab08::Draw()
@@ -1,6 +1,8 @@
 #include "GSLab09.h"
+#include "GLStateCache.h"
 #include "CApplication.h"
 #include "CRenderManager.h"
+#include "TextureCache.h"
 
 GSLab09::GSLab09(EGameState a_eStateID, CApplication* a_pApp)
 	: IBaseGameState(a_pApp)
@@ -12,19 +14,31 @@ GSLab09::GSLab09(EGameState a_eStateID, CApplication* a_pApp)
 	m_oScene.LoadAIE("scenes/Marv/Marv.aie");
 	InitFBXSceneResources(&m_oScene);
 
+	m_oAnimator.SetAnimation( m_oScene.GetSkeletonByIndex(0), m_oScene.GetAnimationByIndex( 8 ) );
+
 	m_poTitle = new PlaneNode( 5.f, 5.f, 2, 2, AIE::vec4(0.f,0.f,0.f,1.f) );
-	m_poTitle->SetTexture( LoadTexture("./images/lab09.png") );
+	m_poTitle->SetTexture( AcquireTexture("./images/lab09.png") );
 	Quaternion m_qPlaneRot;
 	m_qPlaneRot.CreateRotation(-PI/2, AIE::vec4(1.f, 0.f, 0.f, 0.f) );
 	m_poTitle->RotateNode( m_qPlaneRot );
 	m_poTitle->TranslateNode( AIE::vec4(5.f, 100.f, -580.f, 0.f) );
 	m_poTitle->UpdateBuffers();
 
-	m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle );
+	m_ahRenderNodes.push_back( m_pApp->GetRenderManager()->AddNode( m_eStateID, m_poTitle, RENDER_SHADER_BASIC, RENDER_PASS_OVERLAY ) );
 }
 
 GSLab09::~GSLab09()
 {
+	for( unsigned int i = 0; i < m_ahRenderNodes.size(); ++i )
+	{
+		m_pApp->GetRenderManager()->RemoveNode( m_eStateID, m_ahRenderNodes[i] );
+	}
+
+	// Unload should have let go of it, but don't leave the render manager
+	// pointing at a scene that's about to go
+	if( m_pApp->GetRenderManager()->GetFBXScene() == &m_oScene )
+		m_pApp->GetRenderManager()->SetFBXScene( nullptr );
+
 	DestroyFBXSceneResources(&m_oScene);
 	m_oScene.Unload();
 
@@ -36,7 +50,7 @@ void GSLab09::Load()
 {
 	m_poCamera = new Camera( AIE::vec4(0.f,100.f,-600.f,1.f), AIE::vec4(0.f,0.f,1.f,1.f), AIE::vec4(0.f,1.f,0.f,0.f) );
 	m_pApp->GetRenderManager()->SetActiveCamera( m_poCamera );
-	m_pApp->GetRenderManager()->SetFBXScene( m_oScene );
+	m_pApp->GetRenderManager()->SetFBXScene( &m_oScene, RENDER_SHADER_FBX_SKINNED );
 
 	printf( "\n\n------------------------------------------------\n"
 			"Lab 09 - Animation - Skinning\n\n"
@@ -45,12 +59,14 @@ void GSLab09::Load()
 
 			"'lab09' shaders\n"
 			"GSLab09.h & .cpp\n"
-			"DrawLab09() function in CRenderManager.cpp\n"
+			"DrawFBXScene() function in CRenderManager.cpp\n"
 			"------------------------------------------------\n" );
 }
 
 void GSLab09::Unload()
 {
+	m_pApp->GetRenderManager()->SetFBXScene( nullptr );
+
 	delete m_poCamera;
 	m_poCamera = nullptr;
 }
@@ -60,8 +76,7 @@ void GSLab09::Update(float a_fDeltaTime)
 	m_fTimer += a_fDeltaTime;
 	m_poCamera->Update( a_fDeltaTime );
 
-	FBXAnimation* anim	= m_oScene.GetAnimationByIndex( 8 );
-	m_oScene.GetSkeletonByIndex(0)->Evaluate( anim, m_fTimer );
+	m_oAnimator.Evaluate( m_fTimer );
 }	 
 
 void GSLab09::Draw()
@@ -82,11 +97,16 @@ void GSLab09::InitFBXSceneResources(FBXScene* a_pScene)
 		RenderObject* ro = new RenderObject;
 		pMesh->m_userData = ro;
 
+		ComputeBounds( pMesh->m_vertices.data(), pMesh->m_vertices.size(), sizeof(FBXVertex), ro->oBounds );
+		// skinning moves the vertices away from the bind pose they were
+		// measured in, leave them room
+		PadBounds( ro->oBounds.fRadius * 0.5f, ro->oBounds );
+
 		glGenBuffers(		1, &ro->VBO);
 		glGenBuffers(		1, &ro->IBO);
 		glGenVertexArrays(	1, &ro->VAO);
 
-		glBindVertexArray(ro->VAO);
+		GetGLState().BindVertexArray(ro->VAO);
 		glBindBuffer(GL_ARRAY_BUFFER, ro->VBO);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ro->IBO);
 
@@ -107,7 +127,7 @@ void GSLab09::InitFBXSceneResources(FBXScene* a_pScene)
 		glVertexAttribPointer( 4, 4, GL_FLOAT, GL_FALSE, sizeof(FBXVertex), (char*)FBXVertex::IndicesOffset		);
 		glVertexAttribPointer( 5, 4, GL_FLOAT, GL_FALSE, sizeof(FBXVertex), (char*)FBXVertex::WeightsOffset		);
 		glVertexAttribPointer( 6, 2, GL_FLOAT, GL_FALSE, sizeof(FBXVertex), (char*)FBXVertex::UVOffset			);
-		glBindVertexArray(0);
+		GetGLState().BindVertexArray(0);
 	}
 
 	for(unsigned int i = 0; i < matCount; ++i)
@@ -120,7 +140,7 @@ void GSLab09::InitFBXSceneResources(FBXScene* a_pScene)
 			{
 				std::string path = a_pScene->GetPath();
 				path += pMaterial->textureFilenames[j];
-				pMaterial->textureIDs[j] = LoadTexture(path.c_str(),GL_BGRA);
+				pMaterial->textureIDs[j] = AcquireTexture(path.c_str(),GL_BGRA);
 
 				printf("Loading texture %i: %s - ID: %i\n",j, path.c_str(),pMaterial->textureIDs[j]);
 			}
@@ -138,7 +158,7 @@ void GSLab09::DestroyFBXSceneResources(FBXScene* a_pScene)
 
 		RenderObject* ro = (RenderObject*)pMesh->m_userData;
 
-		glDeleteVertexArrays(1, &ro->VAO);
+		GetGLState().DeleteVertexArrays(1, &ro->VAO);
 		glDeleteBuffers(1, &ro->VBO);
 		glDeleteBuffers(1, &ro->IBO);
 	}
@@ -151,7 +171,7 @@ void GSLab09::DestroyFBXSceneResources(FBXScene* a_pScene)
 		for ( int j = 0 ; j < FBXMaterial::TextureTypes_Count ; ++j )
 		{
 			if (pMaterial->textureIDs[j] != 0)
-				glDeleteTextures(1,&pMaterial->textureIDs[j]);
+				ReleaseTexture( pMaterial->textureIDs[j] );
 		}
 	}
 }
\ No newline at end of file
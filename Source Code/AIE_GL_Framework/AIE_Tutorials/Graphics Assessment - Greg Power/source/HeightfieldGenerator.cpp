@@ -0,0 +1,201 @@
+#include "HeightfieldGenerator.h"
+#include "PerlinNoise2D.h"
+
+#include "JobSystem.h"
+
+#include <emmintrin.h>
+
+// rows handed to a job at a time
+static const int TILE_ROWS = 8;
+
+void BuildNoiseOctaves( NoiseOctaves& a_rOctaves, float a_fPersistence, int a_iNumOctaves )
+{
+	if( a_iNumOctaves > MAX_NOISE_OCTAVES )
+		a_iNumOctaves = MAX_NOISE_OCTAVES;
+
+	a_rOctaves.iNumOctaves = a_iNumOctaves;
+
+	// the same expressions PerlinNoise2D uses, so the values match exactly
+	for( int i = 0; i < a_iNumOctaves; ++i )
+	{
+		float frequency = pow( 2.0f, i );
+		float amplitude = pow( a_fPersistence, i );
+
+		a_rOctaves.afFrequency[i] = frequency;
+		a_rOctaves.afAmplitude[i] = amplitude;
+	}
+}
+
+// low 32 bits of a 32 bit multiply, SSE2 only has the unsigned 64 bit one
+static inline __m128i Mul32( __m128i a_a, __m128i a_b )
+{
+#if defined(__AVX__) || defined(__SSE4_1__)
+	return _mm_mullo_epi32( a_a, a_b );
+#else
+	__m128i even	= _mm_mul_epu32( a_a, a_b );
+	__m128i odd		= _mm_mul_epu32( _mm_srli_si128( a_a, 4 ), _mm_srli_si128( a_b, 4 ) );
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE(0,0,2,0) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE(0,0,2,0) ) );
+#endif
+}
+
+// Noise() for 4 points, integer maths wraps the same way as the scalar version
+static inline __m128 Noise4( __m128i a_x, __m128i a_y )
+{
+	__m128i n = _mm_add_epi32( a_x, Mul32( a_y, _mm_set1_epi32( 57 ) ) );
+	n = _mm_xor_si128( _mm_slli_epi32( n, 13 ), n );
+
+	__m128i t = _mm_add_epi32( Mul32( Mul32( n, n ), _mm_set1_epi32( 15485863 ) ), _mm_set1_epi32( 982451653 ) );
+	t = _mm_add_epi32( Mul32( n, t ), _mm_set1_epi32( 899809343 ) );
+	t = _mm_and_si128( t, _mm_set1_epi32( 0x7fffffff ) );
+
+	return _mm_sub_ps( _mm_set1_ps( 1.0f ), _mm_div_ps( _mm_cvtepi32_ps( t ), _mm_set1_ps( 1073741824.0f ) ) );
+}
+
+// SmoothedNoise() at (cx, cy) of a 4x4 grid of Noise4 results, where
+// a_aNoise[j][i] holds Noise(x+i-1, y+j-1). Sums in the same order as the
+// scalar version.
+static inline __m128 Smoothed4( const __m128 a_aNoise[4][4], int cx, int cy )
+{
+	__m128 corners	= _mm_add_ps( _mm_add_ps( _mm_add_ps( a_aNoise[cy][cx], a_aNoise[cy][cx+2] ), a_aNoise[cy+2][cx] ), a_aNoise[cy+2][cx+2] );
+	corners			= _mm_div_ps( corners, _mm_set1_ps( 16.f ) );
+	__m128 sides	= _mm_add_ps( _mm_add_ps( _mm_add_ps( a_aNoise[cy+1][cx], a_aNoise[cy+1][cx+2] ), a_aNoise[cy][cx+1] ), a_aNoise[cy+2][cx+1] );
+	sides			= _mm_div_ps( sides, _mm_set1_ps( 8.f ) );
+	__m128 centre	= _mm_div_ps( a_aNoise[cy+1][cx+1], _mm_set1_ps( 4.f ) );
+
+	return _mm_add_ps( _mm_add_ps( corners, sides ), centre );
+}
+
+// PerlinNoise2D for 4 points. The hashing and smoothing run on all 4 lanes,
+// the 16 Noise values around each cell are shared by its 4 SmoothedNoise
+// calls instead of the 36 the scalar version makes. The cosine
+// interpolation stays scalar so it goes through the same CosInterpolate.
+static void PerlinNoise2D4( const float* a_afX, const float* a_afY, const NoiseOctaves& a_rOctaves, float* a_afOut )
+{
+	float afTotal[4] = { 0, 0, 0, 0 };
+
+	__m128 vX = _mm_loadu_ps( a_afX );
+	__m128 vY = _mm_loadu_ps( a_afY );
+
+	for( int o = 0; o < a_rOctaves.iNumOctaves; ++o )
+	{
+		__m128 vFrequency	= _mm_set1_ps( a_rOctaves.afFrequency[o] );
+		__m128 vSampleX		= _mm_mul_ps( vX, vFrequency );
+		__m128 vSampleY		= _mm_mul_ps( vY, vFrequency );
+		__m128i viX			= _mm_cvttps_epi32( vSampleX );
+		__m128i viY			= _mm_cvttps_epi32( vSampleY );
+
+		__m128 aNoise[4][4];
+		for( int j = 0; j < 4; ++j )
+		{
+			__m128i vRow = _mm_add_epi32( viY, _mm_set1_epi32( j - 1 ) );
+			for( int i = 0; i < 4; ++i )
+			{
+				aNoise[j][i] = Noise4( _mm_add_epi32( viX, _mm_set1_epi32( i - 1 ) ), vRow );
+			}
+		}
+
+		float af1[4], af2[4], af3[4], af4[4], afSampleX[4], afSampleY[4];
+		_mm_storeu_ps( af1, Smoothed4( aNoise, 0, 0 ) );
+		_mm_storeu_ps( af2, Smoothed4( aNoise, 1, 0 ) );
+		_mm_storeu_ps( af3, Smoothed4( aNoise, 0, 1 ) );
+		_mm_storeu_ps( af4, Smoothed4( aNoise, 1, 1 ) );
+		_mm_storeu_ps( afSampleX, vSampleX );
+		_mm_storeu_ps( afSampleY, vSampleY );
+
+		float amplitude = a_rOctaves.afAmplitude[o];
+		for( int l = 0; l < 4; ++l )
+		{
+			int		intX	= (int)afSampleX[l];
+			float	fracX	= afSampleX[l] - intX;
+			int		intY	= (int)afSampleY[l];
+			float	fracY	= afSampleY[l] - intY;
+
+			float i1 = CosInterpolate( af1[l], af2[l], fracX );
+			float i2 = CosInterpolate( af3[l], af4[l], fracX );
+			float fNoise = CosInterpolate( i1, i2, fracY );
+
+			afTotal[l] = afTotal[l] + fNoise * amplitude;
+		}
+	}
+
+	for( int l = 0; l < 4; ++l )
+	{
+		a_afOut[l] = afTotal[l];
+	}
+}
+
+static void GenerateRows( float* a_afHeights, int a_iVertsWidth, int a_iVertsLength, int a_iFirstRow, int a_iEndRow, float a_fPersistence, const NoiseOctaves& a_rOctaves, float a_fHeightScale )
+{
+	float afX[4], afY[4], afNoise[4];
+
+	for( int z = a_iFirstRow; z < a_iEndRow; ++z )
+	{
+		float* afRow	= a_afHeights + z * a_iVertsWidth;
+		float fY		= z*(1.f/a_iVertsLength);
+
+		int x = 0;
+		for( ; x + 4 <= a_iVertsWidth; x += 4 )
+		{
+			for( int l = 0; l < 4; ++l )
+			{
+				afX[l] = (x + l)*(1.f/a_iVertsWidth);
+				afY[l] = fY;
+			}
+
+			PerlinNoise2D4( afX, afY, a_rOctaves, afNoise );
+
+			for( int l = 0; l < 4; ++l )
+			{
+				afRow[x + l] = afNoise[l] * a_fHeightScale;
+			}
+		}
+
+		for( ; x < a_iVertsWidth; ++x )
+		{
+			afRow[x] = PerlinNoise2D( x*(1.f/a_iVertsWidth), fY, a_fPersistence, a_rOctaves.iNumOctaves ) * a_fHeightScale;
+		}
+	}
+}
+
+struct HeightfieldData
+{
+	float*			afHeights;
+	int				iVertsWidth;
+	int				iVertsLength;
+	float			fPersistence;
+	float			fHeightScale;
+	NoiseOctaves	oOctaves;
+};
+
+static void GenerateRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pData )
+{
+	const HeightfieldData* pData = (const HeightfieldData*)a_pData;
+	GenerateRows( pData->afHeights, pData->iVertsWidth, pData->iVertsLength, a_uiBegin, a_uiEnd, pData->fPersistence, pData->oOctaves, pData->fHeightScale );
+}
+
+void GenerateHeightfield( float* a_afHeights, int a_iVertsWidth, int a_iVertsLength, float a_fPersistence, int a_iNumOctaves, float a_fHeightScale )
+{
+	if( a_iVertsWidth <= 0 || a_iVertsLength <= 0 )
+		return;
+
+	HeightfieldData oData;
+	oData.afHeights		= a_afHeights;
+	oData.iVertsWidth	= a_iVertsWidth;
+	oData.iVertsLength	= a_iVertsLength;
+	oData.fPersistence	= a_fPersistence;
+	oData.fHeightScale	= a_fHeightScale;
+	BuildNoiseOctaves( oData.oOctaves, a_fPersistence, a_iNumOctaves );
+
+	GetJobSystem().ParallelFor( a_iVertsLength, TILE_ROWS, GenerateRange, &oData );
+}
+
+void GenerateHeightfieldScalar( float* a_afHeights, int a_iVertsWidth, int a_iVertsLength, float a_fPersistence, int a_iNumOctaves, float a_fHeightScale )
+{
+	for( int z = 0; z < a_iVertsLength; ++z )
+	{
+		for( int x = 0; x < a_iVertsWidth; ++x )
+		{
+			a_afHeights[z * a_iVertsWidth + x] = PerlinNoise2D( x*(1.f/a_iVertsWidth), z*(1.f/a_iVertsLength), a_fPersistence, a_iNumOctaves ) * a_fHeightScale;
+		}
+	}
+}
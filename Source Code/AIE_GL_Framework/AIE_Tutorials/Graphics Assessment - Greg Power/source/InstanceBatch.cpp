@@ -0,0 +1,144 @@
+#include "InstanceBatch.h"
+#include "GLStateCache.h"
+#include "TextureArray.h"
+
+InstanceBatch::InstanceBatch( SharedMesh* a_poMesh )
+	: MeshNode( AIE::vec4( 0.f, 0.f, 0.f, 1.f ) )
+{
+	m_poMesh			= a_poMesh;
+	m_iNumVerts			= a_poMesh->uiNumVerts;
+	m_iNumIndices		= a_poMesh->uiNumIndices;
+	m_iShaderID			= 0;
+	m_bInstancesDirty	= false;
+
+	// the instances carry the transforms, Model stays at identity
+	m_bUseModelMatrix = true;
+
+	glGenBuffers(		1, &m_uiInstanceVBO );
+	glGenVertexArrays(	1, &m_iVAO );
+
+	GetGLState().BindVertexArray( m_iVAO );
+
+	// the shared mesh's buffers, laid out as CreateBuffers does
+	glBindBuffer( GL_ARRAY_BUFFER,			m_poMesh->uiVBO );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER,	m_poMesh->uiIBO );
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), 0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), ((char*)0) + 16);
+
+	// then one InstanceData per instance
+	glBindBuffer( GL_ARRAY_BUFFER, m_uiInstanceVBO );
+	glEnableVertexAttribArray( INSTANCE_ATTRIB_LAYERS );
+	glVertexAttribPointer( INSTANCE_ATTRIB_LAYERS, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), ((char*)0) + sizeof(AIE::mat4) );
+	glVertexAttribDivisor( INSTANCE_ATTRIB_LAYERS, 1 );
+	for( GLuint i = 0; i < 4; ++i )
+	{
+		glEnableVertexAttribArray( INSTANCE_ATTRIB_MODEL + i );
+		glVertexAttribPointer( INSTANCE_ATTRIB_MODEL + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), ((char*)0) + i * sizeof(AIE::vec4) );
+		glVertexAttribDivisor( INSTANCE_ATTRIB_MODEL + i, 1 );
+	}
+
+	GetGLState().BindVertexArray(0);
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+InstanceBatch::~InstanceBatch()
+{
+	glDeleteBuffers( 1, &m_uiInstanceVBO );
+
+	// the arrays aren't the texture cache's, MeshNode would hand them to it
+	SetTextureArrays( 0, 0 );
+
+	ReleaseSharedMesh( m_poMesh );
+	m_poMesh = nullptr;
+}
+
+unsigned int InstanceBatch::AddInstance( AIE::vec4 a_vScale, float a_fLayer, float a_fSecondaryLayer )
+{
+	InstanceData oInstance;
+	oInstance.mModel.SetIdentity();
+	oInstance.mModel.row0.x = a_vScale.x;
+	oInstance.mModel.row1.y = a_vScale.y;
+	oInstance.mModel.row2.z = a_vScale.z;
+	oInstance.afLayers[0] = a_fLayer;
+	oInstance.afLayers[1] = a_fSecondaryLayer;
+	oInstance.afLayers[2] = 0.f;
+	oInstance.afLayers[3] = 0.f;
+
+	m_aoInstances.push_back( oInstance );
+	InstancesChanged();
+
+	return m_aoInstances.size() - 1;
+}
+
+void InstanceBatch::RotateInstance( unsigned int a_uiInstance, Quaternion& a_qRot )
+{
+	AIE::mat4& rModel = m_aoInstances[ a_uiInstance ].mModel;
+	rModel = rModel * a_qRot.ToMatrix().Transpose();
+	InstancesChanged();
+}
+
+void InstanceBatch::TranslateInstance( unsigned int a_uiInstance, AIE::vec4 a_vTrans )
+{
+	m_aoInstances[ a_uiInstance ].mModel.row3 += a_vTrans;
+	InstancesChanged();
+}
+
+void InstanceBatch::SetInstanceModel( unsigned int a_uiInstance, const AIE::mat4& a_mModel )
+{
+	m_aoInstances[ a_uiInstance ].mModel = a_mModel;
+	InstancesChanged();
+}
+
+void InstanceBatch::SetTextureArrays( GLuint a_uiTextureArray, GLuint a_uiSecondaryArray )
+{
+	if( m_iTextureID != a_uiTextureArray )
+		ReleaseTextureArray( m_iTextureID );
+	if( m_iSecondaryTextureID != a_uiSecondaryArray )
+		ReleaseTextureArray( m_iSecondaryTextureID );
+
+	m_eTextureTarget		= GL_TEXTURE_2D_ARRAY;
+	m_iTextureID			= a_uiTextureArray;
+	m_iSecondaryTextureID	= a_uiSecondaryArray;
+}
+
+void InstanceBatch::InstancesChanged()
+{
+	m_bInstancesDirty = true;
+
+	AIE::vec4 vCentre( 0.f, 0.f, 0.f, 0.f );
+	for( unsigned int i = 0; i < m_aoInstances.size(); ++i )
+	{
+		vCentre += m_aoInstances[i].mModel.row3;
+	}
+	vCentre = vCentre * ( 1.f / m_aoInstances.size() );
+
+	SceneNode::TranslateNode( vCentre );
+
+	// Model is identity, so bounds around every placed copy are world bounds
+	TransformBounds( m_poMesh->oBounds, m_aoInstances[0].mModel, m_oBounds );
+	for( unsigned int i = 1; i < m_aoInstances.size(); ++i )
+	{
+		Bounds oInstance;
+		TransformBounds( m_poMesh->oBounds, m_aoInstances[i].mModel, oInstance );
+		MergeBounds( oInstance, m_oBounds );
+	}
+}
+
+void InstanceBatch::DrawMesh()
+{
+	if( m_aoInstances.empty() )
+		return;
+
+	if( m_bInstancesDirty )
+	{
+		GetGLState().BindBuffer( GL_ARRAY_BUFFER, m_uiInstanceVBO );
+		GetGLState().BufferData( GL_ARRAY_BUFFER, m_aoInstances.size() * sizeof(InstanceData), &m_aoInstances[0], GL_DYNAMIC_DRAW );
+		GetGLState().BindBuffer( GL_ARRAY_BUFFER, 0 );
+		m_bInstancesDirty = false;
+	}
+
+	GetGLState().BindVertexArray( m_iVAO );
+	GetGLState().DrawElementsInstanced( GL_TRIANGLES, m_iNumIndices, GL_UNSIGNED_INT, 0, m_aoInstances.size() );
+}
@@ -0,0 +1,359 @@
+#include "JobSystem.h"
+
+#include <intrin.h>
+#include <string.h>
+
+#pragma intrinsic( _InterlockedCompareExchange, _InterlockedExchange, _InterlockedIncrement, _InterlockedDecrement, _ReadWriteBarrier )
+
+// which of the job system's threads this is, the main thread and anything
+// else that isn't a worker being 0
+static __declspec(thread) unsigned int s_uiThreadIndex = 0;
+
+static const unsigned int JOB_INDEX_MASK = MAX_JOBS_PER_THREAD - 1;
+
+WorkStealingQueue::WorkStealingQueue()
+{
+	m_lTop		= 0;
+	m_lBottom	= 0;
+}
+
+void WorkStealingQueue::Push( Job* a_poJob )
+{
+	long lBottom = m_lBottom;
+	m_apJobs[ lBottom & JOB_INDEX_MASK ] = a_poJob;
+
+	// x86 keeps stores in order, the job only has to be written before
+	// bottom says it's there as far as the compiler's concerned
+	_ReadWriteBarrier();
+	m_lBottom = lBottom + 1;
+}
+
+Job* WorkStealingQueue::Pop()
+{
+	// taking bottom before reading top has to be a full fence, a thief could
+	// otherwise read the old bottom after we've read the old top
+	long lBottom = m_lBottom - 1;
+	_InterlockedExchange( &m_lBottom, lBottom );
+
+	long lTop = m_lTop;
+	if( lTop > lBottom )
+	{
+		// already empty
+		m_lBottom = lTop;
+		return nullptr;
+	}
+
+	Job* poJob = m_apJobs[ lBottom & JOB_INDEX_MASK ];
+	if( lTop != lBottom )
+		return poJob;
+
+	// the last job, a thief may be after it too
+	if( _InterlockedCompareExchange( &m_lTop, lTop + 1, lTop ) != lTop )
+		poJob = nullptr;
+
+	m_lBottom = lTop + 1;
+	return poJob;
+}
+
+Job* WorkStealingQueue::Steal()
+{
+	long lTop = m_lTop;
+	_ReadWriteBarrier();
+	long lBottom = m_lBottom;
+
+	if( lTop >= lBottom )
+		return nullptr;
+
+	Job* poJob = m_apJobs[ lTop & JOB_INDEX_MASK ];
+
+	// someone else got it first, the owner or another thief
+	if( _InterlockedCompareExchange( &m_lTop, lTop + 1, lTop ) != lTop )
+		return nullptr;
+
+	return poJob;
+}
+
+//////////////////////////////////////////////////////////////////////////
+JobSystem::JobSystem()
+{
+	m_aoQueues		= nullptr;
+	m_aoJobPool		= nullptr;
+	m_pucJobMemory	= nullptr;
+	m_uiNumThreads	= 0;
+	m_oMutex		= nullptr;
+	m_oJobReady		= nullptr;
+	m_lQueuedJobs	= 0;
+	m_lSleeping		= 0;
+	m_lQuit			= 0;
+	memset( m_auiAllocated, 0, sizeof(m_auiAllocated) );
+}
+
+JobSystem::~JobSystem()
+{
+	// Stop() has to have been called while GLFW was still up
+}
+
+void JobSystem::Start( unsigned int a_uiNumThreads )
+{
+	if( IsRunning() )
+		return;
+
+	if( a_uiNumThreads == 0 )
+	{
+		// the main thread makes up the last core
+		int iProcessors = glfwGetNumberOfProcessors();
+		a_uiNumThreads = iProcessors > 1 ? iProcessors - 1 : 1;
+	}
+	if( a_uiNumThreads > MAX_JOB_THREADS - 1 )
+		a_uiNumThreads = MAX_JOB_THREADS - 1;
+
+	unsigned int uiTotalThreads = a_uiNumThreads + 1;
+
+	m_aoQueues		= new WorkStealingQueue[ uiTotalThreads ];
+	m_pucJobMemory	= new unsigned char[ uiTotalThreads * MAX_JOBS_PER_THREAD * sizeof(Job) + 63 ];
+	m_aoJobPool		= (Job*)( ( (size_t)m_pucJobMemory + 63 ) & ~(size_t)63 );
+	memset( m_auiAllocated, 0, sizeof(m_auiAllocated) );
+
+	m_lQueuedJobs	= 0;
+	m_lSleeping		= 0;
+	m_lQuit			= 0;
+	m_oMutex		= glfwCreateMutex();
+	m_oJobReady		= glfwCreateCond();
+
+	// counted before the workers start so they can look at every queue
+	m_uiNumThreads = a_uiNumThreads;
+	for( unsigned int i = 1; i < uiTotalThreads; ++i )
+	{
+		m_aoStarts[i].poJobSystem	= this;
+		m_aoStarts[i].uiThreadIndex	= i;
+
+		GLFWthread iThread = glfwCreateThread( WorkerThread, &m_aoStarts[i] );
+		if( iThread >= 0 )
+			m_aiThreads.push_back( iThread );
+	}
+}
+
+void JobSystem::Stop()
+{
+	if( !IsRunning() )
+		return;
+
+	glfwLockMutex( m_oMutex );
+	_InterlockedExchange( &m_lQuit, 1 );
+	glfwBroadcastCond( m_oJobReady );
+	glfwUnlockMutex( m_oMutex );
+
+	for( unsigned int i = 0; i < m_aiThreads.size(); ++i )
+	{
+		glfwWaitThread( m_aiThreads[i], GLFW_WAIT );
+	}
+	m_aiThreads.clear();
+
+	glfwDestroyCond( m_oJobReady );
+	glfwDestroyMutex( m_oMutex );
+	m_oJobReady	= nullptr;
+	m_oMutex	= nullptr;
+
+	delete[] m_aoQueues;
+	delete[] m_pucJobMemory;
+	m_aoQueues		= nullptr;
+	m_aoJobPool		= nullptr;
+	m_pucJobMemory	= nullptr;
+	m_uiNumThreads	= 0;
+}
+
+Job* JobSystem::AllocateJob()
+{
+	unsigned int uiIndex = m_auiAllocated[ s_uiThreadIndex ]++ & JOB_INDEX_MASK;
+	return &m_aoJobPool[ s_uiThreadIndex * MAX_JOBS_PER_THREAD + uiIndex ];
+}
+
+Job* JobSystem::CreateJob( JobFunction a_pfnFunction, const void* a_pData, unsigned int a_uiSize )
+{
+	Job* poJob = AllocateJob();
+	poJob->pfnFunction	= a_pfnFunction;
+	poJob->poParent		= nullptr;
+	poJob->lUnfinished	= 1;
+
+	if( a_pData != nullptr )
+		memcpy( poJob->aucData, a_pData, a_uiSize < JOB_DATA_SIZE ? a_uiSize : JOB_DATA_SIZE );
+
+	return poJob;
+}
+
+Job* JobSystem::CreateChildJob( Job* a_poParent, JobFunction a_pfnFunction, const void* a_pData, unsigned int a_uiSize )
+{
+	_InterlockedIncrement( &a_poParent->lUnfinished );
+
+	Job* poJob = CreateJob( a_pfnFunction, a_pData, a_uiSize );
+	poJob->poParent = a_poParent;
+	return poJob;
+}
+
+void JobSystem::Run( Job* a_poJob )
+{
+	if( !IsRunning() )
+	{
+		Execute( a_poJob );
+		return;
+	}
+
+	m_aoQueues[ s_uiThreadIndex ].Push( a_poJob );
+
+	// both sides of this and the worker's check in WorkerThread are full
+	// fences, so either it sees the job or we see it sleeping
+	_InterlockedIncrement( &m_lQueuedJobs );
+	if( m_lSleeping > 0 )
+	{
+		glfwLockMutex( m_oMutex );
+		glfwSignalCond( m_oJobReady );
+		glfwUnlockMutex( m_oMutex );
+	}
+}
+
+void JobSystem::Wait( const Job* a_poJob )
+{
+	while( a_poJob->lUnfinished > 0 )
+	{
+		Job* poJob = GetJob();
+		if( poJob != nullptr )
+			Execute( poJob );
+		else
+			glfwSleep( 0.0 );
+	}
+}
+
+// our own queue first, then the others' starting from the next thread along
+Job* JobSystem::GetJob()
+{
+	if( !IsRunning() )
+		return nullptr;
+
+	unsigned int uiTotalThreads = m_uiNumThreads + 1;
+
+	Job* poJob = m_aoQueues[ s_uiThreadIndex ].Pop();
+	for( unsigned int i = 1; poJob == nullptr && i < uiTotalThreads; ++i )
+	{
+		poJob = m_aoQueues[ ( s_uiThreadIndex + i ) % uiTotalThreads ].Steal();
+	}
+
+	if( poJob != nullptr )
+		_InterlockedDecrement( &m_lQueuedJobs );
+
+	return poJob;
+}
+
+void JobSystem::Execute( Job* a_poJob )
+{
+	a_poJob->pfnFunction( a_poJob, a_poJob->aucData );
+	Finish( a_poJob );
+}
+
+void JobSystem::Finish( Job* a_poJob )
+{
+	if( _InterlockedDecrement( &a_poJob->lUnfinished ) == 0 && a_poJob->poParent != nullptr )
+		Finish( a_poJob->poParent );
+}
+
+void GLFWCALL JobSystem::WorkerThread( void* a_pStart )
+{
+	WorkerStart* pStart = (WorkerStart*)a_pStart;
+	JobSystem* poSystem = pStart->poJobSystem;
+	s_uiThreadIndex = pStart->uiThreadIndex;
+
+	while( poSystem->m_lQuit == 0 )
+	{
+		Job* poJob = poSystem->GetJob();
+		if( poJob != nullptr )
+		{
+			poSystem->Execute( poJob );
+			continue;
+		}
+
+		// nothing anywhere, sleep until Run has something
+		glfwLockMutex( poSystem->m_oMutex );
+		_InterlockedIncrement( &poSystem->m_lSleeping );
+		while( poSystem->m_lQueuedJobs <= 0 && poSystem->m_lQuit == 0 )
+		{
+			glfwWaitCond( poSystem->m_oJobReady, poSystem->m_oMutex, GLFW_INFINITY );
+		}
+		_InterlockedDecrement( &poSystem->m_lSleeping );
+		glfwUnlockMutex( poSystem->m_oMutex );
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+struct ParallelForRange
+{
+	ParallelForFunction	pfnFunction;
+	void*				pData;
+	unsigned int		uiBegin;
+	unsigned int		uiEnd;
+	unsigned int		uiGrainSize;
+};
+
+// halves the range on a grain boundary until it's no bigger than a grain,
+// so the work spreads out through stealing rather than from one queue
+static void ParallelForJob( Job* a_poJob, const void* a_pData )
+{
+	const ParallelForRange& rRange = *(const ParallelForRange*)a_pData;
+
+	unsigned int uiCount = rRange.uiEnd - rRange.uiBegin;
+	if( uiCount <= rRange.uiGrainSize )
+	{
+		rRange.pfnFunction( rRange.uiBegin, rRange.uiEnd, rRange.pData );
+		return;
+	}
+
+	unsigned int uiGrains = ( uiCount + rRange.uiGrainSize - 1 ) / rRange.uiGrainSize;
+
+	ParallelForRange oLeft	= rRange;
+	ParallelForRange oRight	= rRange;
+	oLeft.uiEnd		= rRange.uiBegin + ( uiGrains / 2 ) * rRange.uiGrainSize;
+	oRight.uiBegin	= oLeft.uiEnd;
+
+	JobSystem& rJobs = GetJobSystem();
+	rJobs.Run( rJobs.CreateChildJob( a_poJob, ParallelForJob, &oLeft, sizeof(oLeft) ) );
+	rJobs.Run( rJobs.CreateChildJob( a_poJob, ParallelForJob, &oRight, sizeof(oRight) ) );
+}
+
+void JobSystem::ParallelFor( unsigned int a_uiCount, unsigned int a_uiGrainSize, ParallelForFunction a_pfnFunction, void* a_pData )
+{
+	if( a_uiCount == 0 )
+		return;
+
+	if( a_uiGrainSize == 0 )
+	{
+		a_uiGrainSize = a_uiCount / ( GetThreadCount() * 4 );
+		if( a_uiGrainSize == 0 )
+			a_uiGrainSize = 1;
+	}
+
+	// too many ranges would wrap the job rings onto jobs still running
+	unsigned int uiRanges = ( a_uiCount + a_uiGrainSize - 1 ) / a_uiGrainSize;
+	if( uiRanges > MAX_PARALLEL_FOR_RANGES )
+		a_uiGrainSize *= ( uiRanges + MAX_PARALLEL_FOR_RANGES - 1 ) / MAX_PARALLEL_FOR_RANGES;
+
+	if( !IsRunning() || a_uiCount <= a_uiGrainSize )
+	{
+		a_pfnFunction( 0, a_uiCount, a_pData );
+		return;
+	}
+
+	ParallelForRange oRange;
+	oRange.pfnFunction	= a_pfnFunction;
+	oRange.pData		= a_pData;
+	oRange.uiBegin		= 0;
+	oRange.uiEnd		= a_uiCount;
+	oRange.uiGrainSize	= a_uiGrainSize;
+
+	Job* poRoot = CreateJob( ParallelForJob, &oRange, sizeof(oRange) );
+	Run( poRoot );
+	Wait( poRoot );
+}
+
+JobSystem& GetJobSystem()
+{
+	static JobSystem s_oJobSystem;
+	return s_oJobSystem;
+}
@@ -1,4 +1,6 @@
 #include "MeshNode.h"
+#include "GLStateCache.h"
+#include "TextureCache.h"
 
 MeshNode::MeshNode( AIE::vec4 a_translation, SceneNode *a_pParent )
 	: SceneNode( a_translation, a_pParent )
@@ -7,20 +9,30 @@ MeshNode::MeshNode( AIE::vec4 a_translation, SceneNode *a_pParent )
 	m_iTextureID = 0;
 	m_iSecondaryTextureID = 0;
 	m_iDisplacementTexID = 0;
+	m_eTextureTarget = GL_TEXTURE_2D;
+	m_iVAO = 0;
+	m_iVBO = 0;
+	m_iIBO = 0;
 
 	m_vColour = AIE::vec4( 0.f, 0.f, 0.f, 0.f );
+
+	m_bUseModelMatrix = false;
+	m_modelMatrix.SetIdentity();
+
+	ComputeBounds( nullptr, 0, 0, m_oBounds );
+	m_fBoundsPadding = 0.f;
 }
 
 MeshNode::~MeshNode()
 {
 	if( m_iTextureID != 0 )
-		glDeleteTextures(	1, &m_iTextureID);
+		ReleaseTexture( m_iTextureID );
 	if( m_iSecondaryTextureID != 0 ) 
-		glDeleteTextures(	1, &m_iSecondaryTextureID);
+		ReleaseTexture( m_iSecondaryTextureID );
 	if( m_iDisplacementTexID != 0 ) 
-		glDeleteTextures(	1, &m_iDisplacementTexID);
+		ReleaseTexture( m_iDisplacementTexID );
 
-	glDeleteVertexArrays(	1, &m_iVAO);
+	GetGLState().DeleteVertexArrays(	1, &m_iVAO);
 	glDeleteBuffers(		1, &m_iVBO);
 	glDeleteBuffers(		1, &m_iIBO);
 	glDeleteShader(			m_iShaderID);
@@ -32,7 +44,7 @@ void MeshNode::CreateBuffers()
 	glGenBuffers(		1, &m_iIBO );
 	glGenVertexArrays(	1, &m_iVAO );
 	
-	glBindVertexArray( m_iVAO );
+	GetGLState().BindVertexArray( m_iVAO );
 	glBindBuffer( GL_ARRAY_BUFFER,			m_iVBO );
 	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER,	m_iIBO );
 
@@ -44,12 +56,18 @@ void MeshNode::CreateBuffers()
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), 0);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), ((char*)0) + 16);
 
-	glBindVertexArray(0);
+	GetGLState().BindVertexArray(0);
+
+	UpdateBounds();
 }
 
 void MeshNode::UpdateBuffers()
 {
-	glBindVertexArray( m_iVAO );
+	// geometry is immutable once the node moves through its model matrix
+	if( m_bUseModelMatrix )
+		return;
+
+	GetGLState().BindVertexArray( m_iVAO );
 	glBindBuffer( GL_ARRAY_BUFFER,			m_iVBO );
 	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER,	m_iIBO );
 
@@ -61,13 +79,38 @@ void MeshNode::UpdateBuffers()
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), 0);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), ((char*)0) + 16);
 
-	glBindVertexArray(0);
+	GetGLState().BindVertexArray(0);
+
+	UpdateBounds();
+}
+
+void MeshNode::UpdateBounds()
+{
+	ComputeBounds( m_aoVertices.empty() ? nullptr : &m_aoVertices[0].position, m_aoVertices.size(), sizeof(AIE::Vertex), m_oBounds );
+}
+
+void MeshNode::GetWorldBounds( Bounds& a_rBounds )
+{
+	if( m_bUseModelMatrix )
+		TransformBounds( m_oBounds, m_modelMatrix, a_rBounds );
+	else
+		a_rBounds = m_oBounds;
+
+	if( m_fBoundsPadding > 0.f )
+		PadBounds( m_fBoundsPadding, a_rBounds );
 }
 
 void MeshNode::TranslateNode( AIE::vec4 a_vTrans )
 {
 	SceneNode::TranslateNode( a_vTrans );
 
+	if( m_bUseModelMatrix )
+	{
+		// same as offsetting every vertex
+		m_modelMatrix.row3 += a_vTrans;
+		return;
+	}
+
 	auto iter = m_aoVertices.begin();
 	while( iter != m_aoVertices.end() )
 	{
@@ -80,6 +123,14 @@ void MeshNode::RotateNode( Quaternion &a_qRot )
 {
 	SceneNode::RotateNode( a_qRot );
 
+	if( m_bUseModelMatrix )
+	{
+		// same as rotating every vertex about the origin, ToMatrix is built
+		// for column vectors so it's transposed to match the row3 translation
+		m_modelMatrix = m_modelMatrix * a_qRot.ToMatrix().Transpose();
+		return;
+	}
+
 	auto vertIter = m_aoVertices.begin();
 	while( vertIter != m_aoVertices.end() )
 	{
@@ -88,6 +139,22 @@ void MeshNode::RotateNode( Quaternion &a_qRot )
 	}
 }
 
+// Uploads the vertices as they are now and switches the node over to moving
+// through its model matrix. The CPU copy isn't needed after that.
+void MeshNode::UseModelMatrix()
+{
+	if( m_bUseModelMatrix )
+		return;
+
+	UpdateBuffers();
+
+	m_bUseModelMatrix = true;
+	m_modelMatrix.SetIdentity();
+
+	std::vector<AIE::Vertex>().swap( m_aoVertices );
+	std::vector<unsigned int>().swap( m_auiIndex );
+}
+
 void MeshNode::Update( float a_fDeltaTime )
 {
 	SceneNode::Update( a_fDeltaTime );
@@ -98,19 +165,41 @@ void MeshNode::Draw()
 	//a_modelMatrix = GetWorldTransform();//m_localTransform * m_qRotation.ToMatrix();
 	//glPolygonMode(GL_FRONT_AND_BACK, GL_LINES);
 
-	glActiveTexture( GL_TEXTURE0 );
-	glBindTexture( GL_TEXTURE_2D, m_iTextureID );
+	BindTextures();
+	DrawMesh();
+}
+
+void MeshNode::BindTextures()
+{
+	GetGLState().ActiveTexture( GL_TEXTURE0 );
+	GetGLState().BindTexture( m_eTextureTarget, m_iTextureID );
 	if( m_iSecondaryTextureID != 0 )
 	{
-		glActiveTexture( GL_TEXTURE1 );
-		glBindTexture( GL_TEXTURE_2D, m_iSecondaryTextureID );
+		GetGLState().ActiveTexture( GL_TEXTURE1 );
+		GetGLState().BindTexture( m_eTextureTarget, m_iSecondaryTextureID );
 	}
 	if( m_iDisplacementTexID != 0 )
 	{
-		glActiveTexture( GL_TEXTURE2 );
-		glBindTexture( GL_TEXTURE_2D, m_iDisplacementTexID );
+		GetGLState().ActiveTexture( GL_TEXTURE2 );
+		GetGLState().BindTexture( m_eTextureTarget, m_iDisplacementTexID );
 	}
-	glBindVertexArray( m_iVAO );
-	glPatchParameteri(GL_PATCH_VERTICES, 3);
-	glDrawElements( GL_PATCHES, m_iNumIndices, GL_UNSIGNED_INT, 0 );
+}
+
+void MeshNode::DrawMesh()
+{
+	DrawPatches( m_iVAO, m_iNumIndices );
+}
+
+bool MeshNode::GetDrawParameters( GLuint& a_ruiVAO, unsigned int& a_ruiIndexCount )
+{
+	a_ruiVAO		= m_iVAO;
+	a_ruiIndexCount	= m_iNumIndices;
+	return true;
+}
+
+void MeshNode::DrawPatches( GLuint a_uiVAO, unsigned int a_uiIndexCount )
+{
+	GetGLState().BindVertexArray( a_uiVAO );
+	GetGLState().PatchParameteri(GL_PATCH_VERTICES, 3);
+	GetGLState().DrawElements( GL_PATCHES, a_uiIndexCount, GL_UNSIGNED_INT, 0 );
 }
@@ -0,0 +1,164 @@
+#include "ParticleStore.h"
+
+#include <malloc.h>
+#include <string.h>
+
+// the projects build with /arch:SSE2, the scalar path is for anything else
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+	#include <xmmintrin.h>
+	#define PARTICLE_SIMD_WIDTH 4
+#else
+	#define PARTICLE_SIMD_WIDTH 1
+#endif
+
+static const unsigned int	STREAM_COUNT		= 14;
+static const size_t			STREAM_ALIGNMENT	= 32;
+
+ParticleStore::ParticleStore()
+{
+	uiCount = 0;
+	afPosX = afPosY = afPosZ = nullptr;
+	afVelX = afVelY = afVelZ = nullptr;
+	afEnergy = afAlpha = afWidth = afHeight = nullptr;
+	afColourR = afColourG = afColourB = afColourA = nullptr;
+}
+
+ParticleStore::~ParticleStore()
+{
+	Release();
+}
+
+bool ParticleStore::Allocate( unsigned int a_uiCount )
+{
+	Release();
+
+	// pad each stream to a whole number of 32 byte lines so they stay aligned
+	// when carved out of one block
+	size_t uiStride = ((a_uiCount * sizeof(float) + STREAM_ALIGNMENT - 1) / STREAM_ALIGNMENT) * STREAM_ALIGNMENT;
+	char* pBlock	= (char*)_aligned_malloc( uiStride * STREAM_COUNT + STREAM_ALIGNMENT, STREAM_ALIGNMENT );
+	if( pBlock == nullptr )
+	{
+		return false;
+	}
+	memset( pBlock, 0, uiStride * STREAM_COUNT );
+
+	float** apStreams[STREAM_COUNT] = {
+		&afPosX, &afPosY, &afPosZ,
+		&afVelX, &afVelY, &afVelZ,
+		&afEnergy, &afAlpha,
+		&afWidth, &afHeight,
+		&afColourR, &afColourG, &afColourB, &afColourA
+	};
+
+	for( unsigned int i = 0; i < STREAM_COUNT; ++i )
+	{
+		*apStreams[i] = (float*)(pBlock + uiStride * i);
+	}
+
+	uiCount = a_uiCount;
+	return true;
+}
+
+void ParticleStore::Release()
+{
+	// afPosX is the start of the single allocation
+	if( afPosX != nullptr )
+	{
+		_aligned_free( afPosX );
+	}
+
+	uiCount = 0;
+	afPosX = afPosY = afPosZ = nullptr;
+	afVelX = afVelY = afVelZ = nullptr;
+	afEnergy = afAlpha = afWidth = afHeight = nullptr;
+	afColourR = afColourG = afColourB = afColourA = nullptr;
+}
+
+void ParticleStore::Copy( unsigned int a_uiFrom, unsigned int a_uiTo )
+{
+	afPosX[a_uiTo]		= afPosX[a_uiFrom];
+	afPosY[a_uiTo]		= afPosY[a_uiFrom];
+	afPosZ[a_uiTo]		= afPosZ[a_uiFrom];
+	afVelX[a_uiTo]		= afVelX[a_uiFrom];
+	afVelY[a_uiTo]		= afVelY[a_uiFrom];
+	afVelZ[a_uiTo]		= afVelZ[a_uiFrom];
+	afEnergy[a_uiTo]	= afEnergy[a_uiFrom];
+	afAlpha[a_uiTo]		= afAlpha[a_uiFrom];
+	afWidth[a_uiTo]		= afWidth[a_uiFrom];
+	afHeight[a_uiTo]	= afHeight[a_uiFrom];
+	afColourR[a_uiTo]	= afColourR[a_uiFrom];
+	afColourG[a_uiTo]	= afColourG[a_uiFrom];
+	afColourB[a_uiTo]	= afColourB[a_uiFrom];
+	afColourA[a_uiTo]	= afColourA[a_uiFrom];
+}
+
+void IntegrateParticlesScalar( ParticleStore& a_rStore, unsigned int a_uiFirst, unsigned int a_uiCount, const ParticleStep& a_rStep )
+{
+	float fDeltaTime	= a_rStep.fDeltaTime;
+	float fAccelX		= a_rStep.vAcceleration.x * fDeltaTime;
+	float fAccelY		= a_rStep.vAcceleration.y * fDeltaTime;
+	float fAccelZ		= a_rStep.vAcceleration.z * fDeltaTime;
+
+	unsigned int uiEnd = a_uiFirst + a_uiCount;
+	for( unsigned int i = a_uiFirst; i < uiEnd; ++i )
+	{
+		a_rStore.afVelX[i] += fAccelX;
+		a_rStore.afVelY[i] += fAccelY;
+		a_rStore.afVelZ[i] += fAccelZ;
+
+		a_rStore.afPosX[i] += a_rStore.afVelX[i] * fDeltaTime;
+		a_rStore.afPosY[i] += a_rStore.afVelY[i] * fDeltaTime;
+		a_rStore.afPosZ[i] += a_rStore.afVelZ[i] * fDeltaTime;
+
+		float fAlpha = a_rStore.afEnergy[i] * a_rStep.fAlphaScale;
+		a_rStore.afAlpha[i] = fAlpha < a_rStep.fAlphaMax ? fAlpha : a_rStep.fAlphaMax;
+
+		a_rStore.afEnergy[i] -= fDeltaTime;
+	}
+}
+
+void IntegrateParticles( ParticleStore& a_rStore, unsigned int a_uiFirst, unsigned int a_uiCount, const ParticleStep& a_rStep )
+{
+	unsigned int i		= a_uiFirst;
+	unsigned int uiEnd	= a_uiFirst + a_uiCount;
+
+#if PARTICLE_SIMD_WIDTH == 4
+
+	// the streams start aligned, so a range starting part way through a
+	// step does the particles before the next whole one on their own
+	unsigned int uiAligned = ( ( a_uiFirst + 3 ) / 4 ) * 4;
+	if( uiAligned > uiEnd )
+		uiAligned = uiEnd;
+	IntegrateParticlesScalar( a_rStore, i, uiAligned - i, a_rStep );
+	i = uiAligned;
+
+	__m128 vDeltaTime	= _mm_set1_ps( a_rStep.fDeltaTime );
+	__m128 vAccelX		= _mm_set1_ps( a_rStep.vAcceleration.x * a_rStep.fDeltaTime );
+	__m128 vAccelY		= _mm_set1_ps( a_rStep.vAcceleration.y * a_rStep.fDeltaTime );
+	__m128 vAccelZ		= _mm_set1_ps( a_rStep.vAcceleration.z * a_rStep.fDeltaTime );
+	__m128 vAlphaScale	= _mm_set1_ps( a_rStep.fAlphaScale );
+	__m128 vAlphaMax	= _mm_set1_ps( a_rStep.fAlphaMax );
+
+	for( ; i + 4 <= uiEnd; i += 4 )
+	{
+		__m128 vVelX = _mm_add_ps( _mm_load_ps( a_rStore.afVelX + i ), vAccelX );
+		__m128 vVelY = _mm_add_ps( _mm_load_ps( a_rStore.afVelY + i ), vAccelY );
+		__m128 vVelZ = _mm_add_ps( _mm_load_ps( a_rStore.afVelZ + i ), vAccelZ );
+		_mm_store_ps( a_rStore.afVelX + i, vVelX );
+		_mm_store_ps( a_rStore.afVelY + i, vVelY );
+		_mm_store_ps( a_rStore.afVelZ + i, vVelZ );
+
+		_mm_store_ps( a_rStore.afPosX + i, _mm_add_ps( _mm_load_ps( a_rStore.afPosX + i ), _mm_mul_ps( vVelX, vDeltaTime ) ) );
+		_mm_store_ps( a_rStore.afPosY + i, _mm_add_ps( _mm_load_ps( a_rStore.afPosY + i ), _mm_mul_ps( vVelY, vDeltaTime ) ) );
+		_mm_store_ps( a_rStore.afPosZ + i, _mm_add_ps( _mm_load_ps( a_rStore.afPosZ + i ), _mm_mul_ps( vVelZ, vDeltaTime ) ) );
+
+		__m128 vEnergy = _mm_load_ps( a_rStore.afEnergy + i );
+		_mm_store_ps( a_rStore.afAlpha + i, _mm_min_ps( _mm_mul_ps( vEnergy, vAlphaScale ), vAlphaMax ) );
+		_mm_store_ps( a_rStore.afEnergy + i, _mm_sub_ps( vEnergy, vDeltaTime ) );
+	}
+
+#endif
+
+	// whatever doesn't fill a whole SIMD step
+	IntegrateParticlesScalar( a_rStore, i, uiEnd - i, a_rStep );
+}
@@ -1,20 +1,44 @@
 #include "ParticleSystem.h"
+#include "GLStateCache.h"
+#include "TextureCache.h"
+#include "JobSystem.h"
+#include "StreamBuffer.h"
 
 #include "MathHelper.h"
 #include "Utilities.h"
 #include <random>
+#include <float.h>
+#include <stdio.h>
+
+// particles per job, a multiple of the widest SIMD step in IntegrateParticles
+static const unsigned int PARTICLE_JOB_SIZE = 1024;
+
+struct IntegrateData
+{
+	ParticleStore*	pStore;
+	ParticleStep	oStep;
+};
+
+static void IntegrateRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pData )
+{
+	IntegrateData* pData = (IntegrateData*)a_pData;
+	IntegrateParticles( *pData->pStore, a_uiBegin, a_uiEnd - a_uiBegin, pData->oStep );
+}
 
 ParticleSystem::ParticleSystem()
 {
 	m_fTimer = 0.f;
+	m_pVertices = nullptr;
+	m_uiFirstVertex = 0;
+	m_uiNumDrawn = 0;
+	m_uiFrame = 0;
 }
 
 ParticleSystem::~ParticleSystem()
 {
 	if( m_iTextureID != 0 )
-		glDeleteTextures(1,&m_iTextureID);
-	glDeleteVertexArrays(1, &m_uiVAO);
-	glDeleteBuffers(1, &m_uiVBO);
+		ReleaseTexture( m_iTextureID );
+	GetGLState().DeleteVertexArrays(1, &m_uiVAO);
 }
 
 void ParticleSystem::Init( SystemData* a_oData )
@@ -24,7 +48,8 @@ void ParticleSystem::Init( SystemData* a_oData )
 	m_iEmissionsPerSec		= a_oData->iEmissionRate;
 	m_fNumToRelease			= 0.f;
 	m_iSystemType			= 0;
-	m_iNumParticlesAlive	= a_oData->iNumParticles;
+	m_iMaxParticles			= a_oData->iNumParticles;
+	m_uiNumAlive			= 0;
 	m_vVelocityMin			= a_oData->vPVelocityMin;
 	m_vVelocityMax			= a_oData->vPVelocityMax;
 	m_vGravity				= a_oData->vGravity;
@@ -37,22 +62,35 @@ void ParticleSystem::Init( SystemData* a_oData )
 	m_bIs3D					= a_oData->b3D;
 	std::string filename	= "./images/";
 	filename				+= a_oData->sFilename;
-	m_iTextureID			= AIE::LoadTexture( filename.c_str() );
+	m_iTextureID			= AcquireTexture( filename.c_str() );
 
-	for( int i = 0; i < m_iNumParticlesAlive; ++i )
+	// all particles start dead and are emitted over time, a system that
+	// couldn't get its streams has no particles and never emits
+	if( !m_oParticles.Allocate( m_iMaxParticles ) )
 	{
-		Particle p;
-		p.vPosition		= m_vEmitterPosition + AIE::v4Rand( -m_vEmitterSize/2, m_vEmitterSize/2 );
-		p.vOldPosition	= m_vEmitterPosition;
-		p.vVelocity		= AIE::v4Rand(m_vVelocityMin, m_vVelocityMax );
-		p.oSize.width	= AIE::fRand( m_oPSizeMin.width, m_oPSizeMax.width );
-		p.oSize.height	= AIE::fRand( m_oPSizeMin.height, m_oPSizeMax.height );
-		p.fEnergy		= 0.f;
-		p.fAlpha		= (1.0f / m_fEnergyMax ) * p.fEnergy;
-		p.vColour		= m_vColour;
-		p.bIsDead		= true;
-		
-		m_aParticleArray.push_back( p );
+		printf( "Unable to allocate %i particles for %s\n", m_iMaxParticles, a_oData->sFilename.c_str() );
+		m_iMaxParticles = 0;
+	}
+
+	for( int i = 0; i < m_iMaxParticles; ++i )
+	{
+		AIE::vec4 vPosition			= m_vEmitterPosition + AIE::v4Rand( -m_vEmitterSize/2, m_vEmitterSize/2 );
+		AIE::vec4 vVelocity			= AIE::v4Rand(m_vVelocityMin, m_vVelocityMax );
+
+		m_oParticles.afPosX[i]		= vPosition.x;
+		m_oParticles.afPosY[i]		= vPosition.y;
+		m_oParticles.afPosZ[i]		= vPosition.z;
+		m_oParticles.afVelX[i]		= vVelocity.x;
+		m_oParticles.afVelY[i]		= vVelocity.y;
+		m_oParticles.afVelZ[i]		= vVelocity.z;
+		m_oParticles.afWidth[i]		= AIE::fRand( m_oPSizeMin.width, m_oPSizeMax.width );
+		m_oParticles.afHeight[i]	= AIE::fRand( m_oPSizeMin.height, m_oPSizeMax.height );
+		m_oParticles.afEnergy[i]	= 0.f;
+		m_oParticles.afAlpha[i]		= 0.f;
+		m_oParticles.afColourR[i]	= m_vColour.x;
+		m_oParticles.afColourG[i]	= m_vColour.y;
+		m_oParticles.afColourB[i]	= m_vColour.z;
+		m_oParticles.afColourA[i]	= m_vColour.w;
 	}
 
 	//// load shader
@@ -72,15 +110,27 @@ void ParticleSystem::Init( SystemData* a_oData )
 	//GLuint texUniformID0 = glGetUniformLocation( m_iShaderID, "diffuseTexture" );
 	//glUniform1i(texUniformID0,0);
 
-	// create and bind buffers to a vertex array object
-	glGenBuffers		(1, &m_uiVBO);
+	// the attributes read from the start of the stream buffer, each frame's
+	// vertices land on a whole vertex from there and are drawn from that one
 	glGenVertexArrays	(1, &m_uiVAO);
 
-	glBindVertexArray	(m_uiVAO);
-	glBindBuffer		(GL_ARRAY_BUFFER, m_uiVBO);
+	GetGLState().BindVertexArray(m_uiVAO);
+	glBindBuffer		(GL_ARRAY_BUFFER, GetStreamBuffer().GetBuffer());
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex), 0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex), ((char*)0) + 16);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex), ((char*)0) + 24);
+	if( m_bIs3D )
+	{
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex), ((char*)0) + 32);
+	}
 
 	// unbind vertex array
-	glBindVertexArray(0);
+	GetGLState().BindVertexArray(0);
 }
 
 void ParticleSystem::Update( float a_fDeltaTime )
@@ -91,105 +141,146 @@ void ParticleSystem::Update( float a_fDeltaTime )
 
 	m_fNumToRelease += m_iEmissionsPerSec * a_fDeltaTime;
 
-	std::vector<Particle>::iterator iter = m_aParticleArray.begin();
-
-	while( iter != m_aParticleArray.end() )
+	// emit into the free slots straight after the live ones
+	while( m_uiNumAlive < m_oParticles.uiCount && m_fNumToRelease >= 1 )
 	{
-		if( iter->bIsDead && m_fNumToRelease >= 1 )
-		{
-			iter->bIsDead	= false;
-			iter->vPosition	= m_vEmitterPosition + AIE::v4Rand( -m_vEmitterSize/2, m_vEmitterSize/2 );
-			iter->fEnergy	= AIE::fRand( m_fEnergyMin, m_fEnergyMax );
-			iter->vVelocity	= AIE::v4Rand(m_vVelocityMin, m_vVelocityMax );
-
-			--m_fNumToRelease;
-		}
+		EmitParticle( m_uiNumAlive++ );
+		--m_fNumToRelease;
+	}
 
-		iter->vOldPosition	= iter->vPosition;
-		iter->vVelocity		+= m_vGravity * a_fDeltaTime;
-		iter->vVelocity		+= m_vWind * a_fDeltaTime;
-		iter->vPosition		+= iter->vVelocity * a_fDeltaTime;
-		iter->fAlpha		= (1.0f / m_fEnergyMax) * iter->fEnergy;
-		if( !m_bIs3D && iter->fAlpha > 0.4f )
-			iter->fAlpha = 0.4f;
+	IntegrateData oIntegrate;
+	oIntegrate.pStore				= &m_oParticles;
+	oIntegrate.oStep.vAcceleration	= m_vGravity + m_vWind;
+	oIntegrate.oStep.fDeltaTime		= a_fDeltaTime;
+	oIntegrate.oStep.fAlphaScale	= 1.0f / m_fEnergyMax;
+	oIntegrate.oStep.fAlphaMax		= m_bIs3D ? FLT_MAX : 0.4f;
 
-		iter->fEnergy -= a_fDeltaTime;
-		if( iter->fEnergy <= 0 )
-			iter->bIsDead	= true;
+	GetJobSystem().ParallelFor( m_uiNumAlive, PARTICLE_JOB_SIZE, IntegrateRange, &oIntegrate );
 
-		++iter;
+	// a particle is dead once its energy runs out
+	unsigned int i = 0;
+	while( i < m_uiNumAlive )
+	{
+		if( m_oParticles.afEnergy[i] <= 0 )
+		{
+			// the last live particle moves into this slot, so check it again
+			KillParticle( i );
+		}
+		else
+		{
+			++i;
+		}
 	}
 
-	if( m_bIs3D )
+	m_uiNumDrawn = 0;
+	if( m_uiNumAlive == 0 )
 	{
-		glBindVertexArray(m_uiVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, m_uiVBO);
+		return;
+	}
 
-		glBufferData(GL_ARRAY_BUFFER, m_aParticleArray.size() * sizeof(Particle),	&m_aParticleArray[0], GL_STATIC_DRAW);
+	// packed straight into this frame's part of the stream buffer, nothing
+	// is drawn if it's full
+	unsigned int uiOffset = 0;
+	m_pVertices = (ParticleVertex*)GetStreamBuffer().Allocate( m_uiNumAlive * sizeof(ParticleVertex), sizeof(ParticleVertex), uiOffset );
+	if( m_pVertices == nullptr )
+	{
+		return;
+	}
 
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), 0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Particle), ((char*)0) + 16);
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), ((char*)0) + 24);
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), ((char*)0) + 60);
+	GetJobSystem().ParallelFor( m_uiNumAlive, PARTICLE_JOB_SIZE, PackRange, this );
 
-		glBindVertexArray(0);
-	}
-	else
-	{
-		glBindVertexArray(m_uiVAO);
-		glBindBuffer(GL_ARRAY_BUFFER, m_uiVBO);
+	m_pVertices = nullptr;
+	m_uiFirstVertex = uiOffset / sizeof(ParticleVertex);
+	m_uiNumDrawn = m_uiNumAlive;
+	m_uiFrame = GetStreamBuffer().GetFrame();
+}
 
-		glBufferData(GL_ARRAY_BUFFER, m_aParticleArray.size() * sizeof(Particle),	&m_aParticleArray[0], GL_STATIC_DRAW);
+void ParticleSystem::EmitParticle( unsigned int a_uiIndex )
+{
+	AIE::vec4 vPosition	= m_vEmitterPosition + AIE::v4Rand( -m_vEmitterSize/2, m_vEmitterSize/2 );
+	AIE::vec4 vVelocity	= AIE::v4Rand(m_vVelocityMin, m_vVelocityMax );
+
+	m_oParticles.afPosX[a_uiIndex]		= vPosition.x;
+	m_oParticles.afPosY[a_uiIndex]		= vPosition.y;
+	m_oParticles.afPosZ[a_uiIndex]		= vPosition.z;
+	m_oParticles.afVelX[a_uiIndex]		= vVelocity.x;
+	m_oParticles.afVelY[a_uiIndex]		= vVelocity.y;
+	m_oParticles.afVelZ[a_uiIndex]		= vVelocity.z;
+	m_oParticles.afEnergy[a_uiIndex]	= AIE::fRand( m_fEnergyMin, m_fEnergyMax );
+}
 
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), 0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Particle), ((char*)0) + 16);
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), ((char*)0) + 24);
+// swap-removes a particle, keeping the live ones packed at the front
+void ParticleSystem::KillParticle( unsigned int a_uiIndex )
+{
+	--m_uiNumAlive;
+	if( a_uiIndex != m_uiNumAlive )
+	{
+		m_oParticles.Copy( m_uiNumAlive, a_uiIndex );
+	}
+}
 
-		glBindVertexArray(0);
+// interleaves the live streams into the layout the particle shaders expect
+void ParticleSystem::PackVertices( unsigned int a_uiBegin, unsigned int a_uiEnd )
+{
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		// built here and stored whole, the mapping is write combined
+		ParticleVertex oVertex;
+		oVertex.vPosition		= AIE::vec4( m_oParticles.afPosX[i], m_oParticles.afPosY[i], m_oParticles.afPosZ[i], 1 );
+		oVertex.oSize.width		= m_oParticles.afWidth[i];
+		oVertex.oSize.height	= m_oParticles.afHeight[i];
+		oVertex.fAlpha			= m_oParticles.afAlpha[i];
+		oVertex.fPadding		= 0.f;
+		oVertex.vColour			= AIE::vec4( m_oParticles.afColourR[i], m_oParticles.afColourG[i], m_oParticles.afColourB[i], m_oParticles.afColourA[i] );
+		m_pVertices[i]			= oVertex;
 	}
-	
+}
+
+void ParticleSystem::PackRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pSystem )
+{
+	( (ParticleSystem*)a_pSystem )->PackVertices( a_uiBegin, a_uiEnd );
 }
 
 void ParticleSystem::Draw( AIE::mat4& a_projectionMat, AIE::mat4& a_viewMat, AIE::mat4& a_modelMat, AIE::mat4& a_vCameraMat )
 {
+	// without an Update this frame the vertices are in a segment that may
+	// since have been handed out again
+	if( m_uiNumDrawn == 0 || m_uiFrame != GetStreamBuffer().GetFrame() )
+	{
+		return;
+	}
+
 	if( m_bIs3D )
 	{
-		glEnable(GL_POINTS);
-		glPointSize( 2.0f );
+		GetGLState().Enable(GL_POINTS);
+		GetGLState().PointSize( 2.0f );
 
-		glEnable(GL_BLEND);
-		glDepthMask(GL_FALSE);
-		glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+		GetGLState().Enable(GL_BLEND);
+		GetGLState().DepthMask(GL_FALSE);
+		GetGLState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
-		glBindVertexArray( m_uiVAO );
-		glDrawArrays( GL_POINTS, 0, m_aParticleArray.size() );
+		GetGLState().BindVertexArray( m_uiVAO );
+		GetGLState().DrawArrays( GL_POINTS, m_uiFirstVertex, m_uiNumDrawn );
 
-		glDepthMask(GL_TRUE);
-		glDisable(GL_BLEND);
+		GetGLState().DepthMask(GL_TRUE);
+		GetGLState().Disable(GL_BLEND);
 	}
 	else
 	{
-		glActiveTexture( GL_TEXTURE0 );
-		glBindTexture( GL_TEXTURE_2D, m_iTextureID );
+		GetGLState().ActiveTexture( GL_TEXTURE0 );
+		GetGLState().BindTexture( GL_TEXTURE_2D, m_iTextureID );
 
-		glEnable(GL_POINTS);
-		glPointSize( 2.0f );
+		GetGLState().Enable(GL_POINTS);
+		GetGLState().PointSize( 2.0f );
 
-		glEnable(GL_BLEND);
-		glDepthMask(GL_FALSE);
-		glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+		GetGLState().Enable(GL_BLEND);
+		GetGLState().DepthMask(GL_FALSE);
+		GetGLState().BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
-		glBindVertexArray( m_uiVAO );
-		glDrawArrays( GL_POINTS, 0, m_aParticleArray.size() );
+		GetGLState().BindVertexArray( m_uiVAO );
+		GetGLState().DrawArrays( GL_POINTS, m_uiFirstVertex, m_uiNumDrawn );
 
-		glDepthMask(GL_TRUE);
-		glDisable(GL_BLEND);
+		GetGLState().DepthMask(GL_TRUE);
+		GetGLState().Disable(GL_BLEND);
 	}
 }
\ No newline at end of file
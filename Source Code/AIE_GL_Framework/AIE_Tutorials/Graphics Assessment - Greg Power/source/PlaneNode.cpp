@@ -23,50 +23,53 @@ PlaneNode::~PlaneNode()
 
 void PlaneNode::BuildVertsIndices()
 {
-	float fHalfWidth	= m_fWidth/2;
-	float fHalfHeight	=	m_fHeight/2;
-	AIE::vec4 translation = GetWorldTransform().row3;
+	m_iNumVerts		= m_iVertsWidth * m_iVertsLength;
+	m_iNumIndices	= ((m_iVertsWidth-1) * (m_iVertsLength-1)) * 6;
 
-	m_iNumVerts = m_iVertsWidth * m_iVertsLength;
+	BuildGeometry( m_fWidth, m_fHeight, m_iVertsWidth, m_iVertsLength, GetWorldTransform().row3, m_aoVertices, m_auiIndex );
 
-	int iNumTris = ((m_iVertsWidth-1) * (m_iVertsLength-1)) * 2;
-	m_iNumIndices = iNumTris * 3;
+	CreateBuffers();
+}
+
+void PlaneNode::BuildGeometry( float a_fWidth, float a_fHeight, int a_iVertsWidth, int a_iVertsLength, const AIE::vec4& a_vTranslation,
+							   std::vector<AIE::Vertex>& a_rVertices, std::vector<unsigned int>& a_rIndices )
+{
+	float fHalfWidth	= a_fWidth/2;
+	float fHalfHeight	= a_fHeight/2;
 
-	for( int z = 0; z < m_iVertsLength; ++z )
+	for( int z = 0; z < a_iVertsLength; ++z )
 	{
-		for( int x = 0; x < m_iVertsWidth; ++x )
+		for( int x = 0; x < a_iVertsWidth; ++x )
 		{
-			m_aoVertices.push_back( AIE::Vertex() );
+			a_rVertices.push_back( AIE::Vertex() );
 
-			float xPos = translation.x;
-			float yPos = translation.y;
-			float zPos = translation.z;
+			float xPos = a_vTranslation.x;
+			float yPos = a_vTranslation.y;
+			float zPos = a_vTranslation.z;
 
-			xPos += x == 0 ? 0 : m_fWidth * (static_cast<float>(x)/static_cast<float>(m_iVertsWidth-1));
-			zPos += z == 0 ? 0 : m_fHeight * (static_cast<float>(z)/static_cast<float>(m_iVertsLength-1));
-			m_aoVertices[z*m_iVertsLength + x].position = AIE::vec4( xPos-fHalfWidth, yPos, zPos-fHalfHeight, 1.0f );
+			xPos += x == 0 ? 0 : a_fWidth * (static_cast<float>(x)/static_cast<float>(a_iVertsWidth-1));
+			zPos += z == 0 ? 0 : a_fHeight * (static_cast<float>(z)/static_cast<float>(a_iVertsLength-1));
+			a_rVertices.back().position = AIE::vec4( xPos-fHalfWidth, yPos, zPos-fHalfHeight, 1.0f );
 		
-			float u = x == 0 ? 0 : (xPos - translation.x)/m_fWidth;
-			float v = z == 0 ? 0 : (zPos - translation.z)/m_fHeight;
-			m_aoVertices[z*m_iVertsLength + x].uv = AIE::vec2( u, v );
+			float u = x == 0 ? 0 : (xPos - a_vTranslation.x)/a_fWidth;
+			float v = z == 0 ? 0 : (zPos - a_vTranslation.z)/a_fHeight;
+			a_rVertices.back().uv = AIE::vec2( u, v );
 		}
 	}
 
-	for( int z = 0; z < m_iVertsLength-1; ++z )
+	for( int z = 0; z < a_iVertsLength-1; ++z )
 	{
-		for( int x = 0; x < m_iVertsWidth-1; ++x )
+		for( int x = 0; x < a_iVertsWidth-1; ++x )
 		{
-			m_auiIndex.push_back( (z*m_iVertsWidth)+x );
-			m_auiIndex.push_back( ((z*m_iVertsWidth)+x) + 1 );
-			m_auiIndex.push_back( ((z+1)*m_iVertsWidth)+x );
+			a_rIndices.push_back( (z*a_iVertsWidth)+x );
+			a_rIndices.push_back( ((z*a_iVertsWidth)+x) + 1 );
+			a_rIndices.push_back( ((z+1)*a_iVertsWidth)+x );
 		
-			m_auiIndex.push_back( ((z*m_iVertsWidth)+x) + 1 );
-			m_auiIndex.push_back( ((z+1)*m_iVertsWidth)+x + 1 );
-			m_auiIndex.push_back( ((z+1)*m_iVertsWidth)+x );
+			a_rIndices.push_back( ((z*a_iVertsWidth)+x) + 1 );
+			a_rIndices.push_back( ((z+1)*a_iVertsWidth)+x + 1 );
+			a_rIndices.push_back( ((z+1)*a_iVertsWidth)+x );
 		}
 	}
-
-	CreateBuffers();
 }
 
 void PlaneNode::Update( float a_fDeltaTime )
@@ -1,4 +1,5 @@
 #include "QuadMesh.h"
+#include "GLStateCache.h"
 
 QuadMesh::QuadMesh()
 {	
@@ -33,7 +34,7 @@ void QuadMesh::Init()
 	glGenBuffers(1, &m_uiIBO);
 	glGenVertexArrays(1, &m_uiVAO);
 
-	glBindVertexArray(m_uiVAO);
+	GetGLState().BindVertexArray(m_uiVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, m_uiVBO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_uiIBO);
 
@@ -46,7 +47,7 @@ void QuadMesh::Init()
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(AIE::Vertex), ((char*)0) + 16);
 
 	//Unbind vertex array
-	glBindVertexArray(0);
+	GetGLState().BindVertexArray(0);
 }
 
 void QuadMesh::Update()
@@ -55,18 +56,18 @@ void QuadMesh::Update()
 
 void QuadMesh::Draw()
 {
-	glActiveTexture( GL_TEXTURE0 );
-	glBindTexture( GL_TEXTURE_2D, m_uiTextureID );
+	GetGLState().ActiveTexture( GL_TEXTURE0 );
+	GetGLState().BindTexture( GL_TEXTURE_2D, m_uiTextureID );
 	if( m_iSecondaryTextureID != 0 )
 	{
-		glActiveTexture( GL_TEXTURE1 );
-		glBindTexture( GL_TEXTURE_2D, m_iSecondaryTextureID );
+		GetGLState().ActiveTexture( GL_TEXTURE1 );
+		GetGLState().BindTexture( GL_TEXTURE_2D, m_iSecondaryTextureID );
 	}
 	if( m_iDisplacementTexID != 0 )
 	{
-		glActiveTexture( GL_TEXTURE2 );
-		glBindTexture( GL_TEXTURE_2D, m_iDisplacementTexID );
+		GetGLState().ActiveTexture( GL_TEXTURE2 );
+		GetGLState().BindTexture( GL_TEXTURE_2D, m_iDisplacementTexID );
 	}
-	glBindVertexArray( m_uiVAO );
-	glDrawElements( GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0 );
+	GetGLState().BindVertexArray( m_uiVAO );
+	GetGLState().DrawElements( GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0 );
 }
@@ -0,0 +1,227 @@
+#include "RenderQueue.h"
+#include "MeshNode.h"
+#include "JobSystem.h"
+
+#include <string.h>
+
+static const unsigned int CULL_JOB_SIZE = 64;
+
+RenderQueue::RenderQueue()
+{
+	m_uiFreeSlot = INVALID_RENDER_HANDLE;
+	m_uiCulled = 0;
+	m_poCullFrustum = nullptr;
+	memset( m_auiPassStart, 0, sizeof(m_auiPassStart) );
+	memset( m_auiPassLive, 0, sizeof(m_auiPassLive) );
+
+	for( unsigned int i = 0; i < RENDER_PASS_COUNT; ++i )
+	{
+		m_aoPassStates[i].bDepthWrite	= true;
+		m_aoPassStates[i].bCullFace		= true;
+		m_aoPassStates[i].bWireframe	= false;
+	}
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+RenderHandle RenderQueue::Add( MeshNode* a_poNode, unsigned int a_uiShader, ERenderPass a_ePass )
+{
+	RenderHandle hNode = m_uiFreeSlot;
+	if( hNode != INVALID_RENDER_HANDLE )
+	{
+		m_uiFreeSlot = m_aoEntries[ hNode ].uiLiveIndex;
+	}
+	else
+	{
+		hNode = m_aoEntries.size();
+		m_aoEntries.push_back( QueueEntry() );
+	}
+
+	QueueEntry& rEntry	= m_aoEntries[ hNode ];
+	rEntry.poNode		= a_poNode;
+	rEntry.uiShader		= a_uiShader;
+	rEntry.ePass		= a_ePass;
+	rEntry.uiLiveIndex	= m_auiLive.size();
+	m_auiLive.push_back( hNode );
+	++m_auiPassLive[ a_ePass ];
+
+	return hNode;
+}
+
+void RenderQueue::Remove( RenderHandle a_hNode )
+{
+	if( a_hNode >= m_aoEntries.size() || m_aoEntries[ a_hNode ].poNode == nullptr )
+		return;
+
+	// move the last live slot into the hole
+	QueueEntry& rEntry = m_aoEntries[ a_hNode ];
+	unsigned int uiLast = m_auiLive.back();
+	m_auiLive[ rEntry.uiLiveIndex ] = uiLast;
+	m_aoEntries[ uiLast ].uiLiveIndex = rEntry.uiLiveIndex;
+	m_auiLive.pop_back();
+	--m_auiPassLive[ rEntry.ePass ];
+
+	rEntry.poNode		= nullptr;
+	rEntry.uiLiveIndex	= m_uiFreeSlot;
+	m_uiFreeSlot		= a_hNode;
+
+	// nothing left to draw, so nothing left to keep
+	if( m_auiLive.empty() )
+	{
+		m_oTextureSets.clear();
+		m_aoPackets.clear();
+		memset( m_auiPassStart, 0, sizeof(m_auiPassStart) );
+		m_uiCulled = 0;
+	}
+}
+
+unsigned int RenderQueue::GetTextureSet( MeshNode* a_poNode )
+{
+	unsigned long long ulTextures = ( (unsigned long long)( a_poNode->GetTexture()				& 0xfffff ) << 40 ) |
+									( (unsigned long long)( a_poNode->GetSecondaryTexture()		& 0xfffff ) << 20 ) |
+									( (unsigned long long)( a_poNode->GetDisplacementTexture()	& 0xfffff ) );
+
+	auto iter = m_oTextureSets.find( ulTextures );
+	if( iter != m_oTextureSets.end() )
+		return iter->second;
+
+	unsigned int uiSet = m_oTextureSets.size();
+	m_oTextureSets[ ulTextures ] = uiSet;
+	return uiSet;
+}
+
+unsigned long long RenderQueue::MakeKey( ERenderPass a_ePass, unsigned int a_uiShader, unsigned int a_uiTextureSet, float a_fDistanceSq )
+{
+	// a positive float's bits sort the same way as its value
+	unsigned int uiDepth;
+	memcpy( &uiDepth, &a_fDistanceSq, sizeof(uiDepth) );
+	if( a_ePass == RENDER_PASS_TRANSPARENT )
+		uiDepth = ~uiDepth;
+
+	return	( (unsigned long long)( a_ePass			& 0xf )		<< 60 ) |
+			( (unsigned long long)( a_uiShader		& 0xff )	<< 52 ) |
+			( (unsigned long long)( a_uiTextureSet	& 0xfffff )	<< 32 ) |
+			uiDepth;
+}
+
+void RenderQueue::CullRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pQueue )
+{
+	RenderQueue* poQueue = (RenderQueue*)a_pQueue;
+
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		MeshNode* poNode = poQueue->m_aoEntries[ poQueue->m_auiLive[i] ].poNode;
+
+		Bounds oBounds;
+		poNode->GetWorldBounds( oBounds );
+		if( !poQueue->m_poCullFrustum->IsVisible( oBounds ) )
+		{
+			poQueue->m_afDistanceSq[i] = -1.f;
+			continue;
+		}
+
+		const AIE::vec4& vPosition = poNode->UsesModelMatrix() ? poNode->GetModelMatrix().row3 : poNode->GetResolvedWorldTransform().row3;
+		AIE::vec4 vOffset = AIE::vec4( poQueue->m_vCullCameraPos - vPosition );
+		poQueue->m_afDistanceSq[i] = vOffset.x * vOffset.x + vOffset.y * vOffset.y + vOffset.z * vOffset.z;
+	}
+}
+
+void RenderQueue::Sort( const AIE::vec4& a_vCameraPos, const Frustum& a_rFrustum )
+{
+	m_aoPackets.resize( m_auiLive.size() );
+	m_afDistanceSq.resize( m_auiLive.size() );
+
+	// resolving a transform writes to the node and its parents, so it's done
+	// here before the jobs, which only read them
+	for( unsigned int i = 0; i < m_auiLive.size(); ++i )
+	{
+		m_aoEntries[ m_auiLive[i] ].poNode->GetWorldTransform();
+	}
+
+	m_vCullCameraPos = a_vCameraPos;
+	m_poCullFrustum = &a_rFrustum;
+	GetJobSystem().ParallelFor( m_auiLive.size(), CULL_JOB_SIZE, CullRange, this );
+	m_poCullFrustum = nullptr;
+
+	// texture sets are numbered here rather than in the jobs, so they come
+	// out the same every run
+	unsigned int uiPackets = 0;
+	unsigned int auiPassCounts[ RENDER_PASS_COUNT ] = { 0 };
+	for( unsigned int i = 0; i < m_auiLive.size(); ++i )
+	{
+		if( m_afDistanceSq[i] < 0.f )
+			continue;
+
+		QueueEntry& rEntry = m_aoEntries[ m_auiLive[i] ];
+
+		DrawPacket& rPacket	= m_aoPackets[ uiPackets++ ];
+		rPacket.ulKey		= MakeKey( rEntry.ePass, rEntry.uiShader, GetTextureSet( rEntry.poNode ), m_afDistanceSq[i] );
+		rPacket.poNode		= rEntry.poNode;
+		rPacket.uiShader	= rEntry.uiShader;
+
+		++auiPassCounts[ rEntry.ePass ];
+	}
+
+	m_uiCulled = m_auiLive.size() - uiPackets;
+	m_aoPackets.resize( uiPackets );
+
+	m_auiPassStart[0] = 0;
+	for( unsigned int i = 0; i < RENDER_PASS_COUNT; ++i )
+	{
+		m_auiPassStart[ i + 1 ] = m_auiPassStart[i] + auiPassCounts[i];
+	}
+
+	RadixSort( m_aoPackets, m_aoScratch );
+}
+
+void RenderQueue::GetPassRange( ERenderPass a_eFirst, ERenderPass a_eLast, unsigned int& a_uiBegin, unsigned int& a_uiEnd ) const
+{
+	a_uiBegin	= m_auiPassStart[ a_eFirst ];
+	a_uiEnd		= m_auiPassStart[ a_eLast + 1 ];
+}
+
+void RenderQueue::RadixSort( std::vector<DrawPacket>& a_rPackets, std::vector<DrawPacket>& a_rScratch )
+{
+	unsigned int uiCount = a_rPackets.size();
+	if( uiCount < 2 )
+		return;
+
+	a_rScratch.resize( uiCount );
+	DrawPacket* pSource	= &a_rPackets[0];
+	DrawPacket* pDest	= &a_rScratch[0];
+
+	for( unsigned int uiShift = 0; uiShift < 64; uiShift += 8 )
+	{
+		unsigned int auiOffsets[256] = { 0 };
+		for( unsigned int i = 0; i < uiCount; ++i )
+		{
+			++auiOffsets[ ( pSource[i].ulKey >> uiShift ) & 0xff ];
+		}
+
+		// every key has the same byte here, the order wouldn't change
+		if( auiOffsets[ ( pSource[0].ulKey >> uiShift ) & 0xff ] == uiCount )
+			continue;
+
+		unsigned int uiTotal = 0;
+		for( unsigned int i = 0; i < 256; ++i )
+		{
+			unsigned int uiBucket = auiOffsets[i];
+			auiOffsets[i] = uiTotal;
+			uiTotal += uiBucket;
+		}
+
+		for( unsigned int i = 0; i < uiCount; ++i )
+		{
+			pDest[ auiOffsets[ ( pSource[i].ulKey >> uiShift ) & 0xff ]++ ] = pSource[i];
+		}
+
+		DrawPacket* pSwap = pSource;
+		pSource = pDest;
+		pDest = pSwap;
+	}
+
+	if( pSource != &a_rPackets[0] )
+		memcpy( &a_rPackets[0], pSource, uiCount * sizeof(DrawPacket) );
+}
@@ -0,0 +1,190 @@
+#include "RenderTargetPool.h"
+#include "GLStateCache.h"
+
+#include <stdio.h>
+
+// free targets left alone this many frames are given back to the driver
+static const unsigned int TARGET_IDLE_FRAMES = 120;
+
+RenderTargetPool::RenderTargetPool()
+{
+	m_uiWidth	= 1280;
+	m_uiHeight	= 720;
+	m_uiFrame	= 0;
+	m_uiGeneration	= 0;
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+	for( unsigned int i = 0; i < m_apoTargets.size(); ++i )
+	{
+		DestroyTarget( m_apoTargets[i] );
+	}
+	m_apoTargets.clear();
+}
+
+void RenderTargetPool::Resize( unsigned int a_uiWidth, unsigned int a_uiHeight )
+{
+	if( a_uiWidth == m_uiWidth && a_uiHeight == m_uiHeight )
+		return;
+
+	m_uiWidth	= a_uiWidth;
+	m_uiHeight	= a_uiHeight;
+	++m_uiGeneration;
+
+	// anything still held keeps working at the old size until released
+	std::vector<RenderTarget*> apoKept;
+	for( unsigned int i = 0; i < m_apoTargets.size(); ++i )
+	{
+		if( m_apoTargets[i]->bInUse )
+			apoKept.push_back( m_apoTargets[i] );
+		else
+			DestroyTarget( m_apoTargets[i] );
+	}
+	m_apoTargets.swap( apoKept );
+}
+
+RenderTargetDesc RenderTargetPool::ScreenDesc( GLenum a_eFormat, unsigned int a_uiDivisor, bool a_bDepth ) const
+{
+	RenderTargetDesc oDesc;
+	oDesc.eFormat	= a_eFormat;
+	oDesc.uiWidth	= m_uiWidth / a_uiDivisor;
+	oDesc.uiHeight	= m_uiHeight / a_uiDivisor;
+	oDesc.bDepth	= a_bDepth;
+
+	if( oDesc.uiWidth == 0 )	oDesc.uiWidth = 1;
+	if( oDesc.uiHeight == 0 )	oDesc.uiHeight = 1;
+
+	return oDesc;
+}
+
+RenderTarget* RenderTargetPool::Acquire( const RenderTargetDesc& a_rDesc )
+{
+	RenderTarget* poTarget = nullptr;
+	for( unsigned int i = 0; i < m_apoTargets.size(); ++i )
+	{
+		if( !m_apoTargets[i]->bInUse && m_apoTargets[i]->oDesc == a_rDesc )
+		{
+			poTarget = m_apoTargets[i];
+			break;
+		}
+	}
+
+	if( poTarget == nullptr )
+	{
+		poTarget = CreateTarget( a_rDesc );
+		m_apoTargets.push_back( poTarget );
+	}
+
+	poTarget->bInUse			= true;
+	poTarget->uiLastUsedFrame	= m_uiFrame;
+	return poTarget;
+}
+
+void RenderTargetPool::Release( RenderTarget* a_poTarget )
+{
+	if( a_poTarget == nullptr )
+		return;
+
+	a_poTarget->bInUse = false;
+
+	// held across a resize, there's no one left to hand it to
+	if( a_poTarget->uiGeneration != m_uiGeneration )
+	{
+		for( unsigned int i = 0; i < m_apoTargets.size(); ++i )
+		{
+			if( m_apoTargets[i] == a_poTarget )
+			{
+				m_apoTargets.erase( m_apoTargets.begin() + i );
+				break;
+			}
+		}
+		DestroyTarget( a_poTarget );
+	}
+}
+
+void RenderTargetPool::Bind( RenderTarget* a_poTarget ) const
+{
+	if( a_poTarget == nullptr )
+	{
+		GetGLState().BindFramebuffer( GL_FRAMEBUFFER, 0 );
+		GetGLState().Viewport( 0, 0, m_uiWidth, m_uiHeight );
+		return;
+	}
+
+	GetGLState().BindFramebuffer( GL_FRAMEBUFFER, a_poTarget->uiFBO );
+	GetGLState().Viewport( 0, 0, a_poTarget->oDesc.uiWidth, a_poTarget->oDesc.uiHeight );
+}
+
+void RenderTargetPool::BeginFrame()
+{
+	++m_uiFrame;
+
+	for( unsigned int i = 0; i < m_apoTargets.size(); )
+	{
+		RenderTarget* poTarget = m_apoTargets[i];
+		if( !poTarget->bInUse && m_uiFrame - poTarget->uiLastUsedFrame > TARGET_IDLE_FRAMES )
+		{
+			DestroyTarget( poTarget );
+			m_apoTargets.erase( m_apoTargets.begin() + i );
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+RenderTarget* RenderTargetPool::CreateTarget( const RenderTargetDesc& a_rDesc )
+{
+	RenderTarget* poTarget = new RenderTarget();
+	poTarget->oDesc				= a_rDesc;
+	poTarget->uiDepth			= 0;
+	poTarget->fTexelWidth		= 1.f / a_rDesc.uiWidth;
+	poTarget->fTexelHeight		= 1.f / a_rDesc.uiHeight;
+	poTarget->bInUse			= false;
+	poTarget->uiLastUsedFrame	= m_uiFrame;
+	poTarget->uiGeneration		= m_uiGeneration;
+
+	// texture object to hold the frame buffer's rendered data, the data
+	// pointer is null so format and type only need to be valid
+	glGenTextures	( 1, &poTarget->uiTexture );
+	GetGLState().BindTexture( GL_TEXTURE_2D, poTarget->uiTexture );
+	glTexImage2D	( GL_TEXTURE_2D, 0, a_rDesc.eFormat, a_rDesc.uiWidth, a_rDesc.uiHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0 );
+	glTexParameterf	( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameterf	( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	glTexParameteri	( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri	( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	GetGLState().BindTexture( GL_TEXTURE_2D, 0 );
+
+	if( a_rDesc.bDepth )
+	{
+		glGenRenderbuffers		( 1, &poTarget->uiDepth );
+		glBindRenderbuffer		( GL_RENDERBUFFER, poTarget->uiDepth );
+		glRenderbufferStorage	( GL_RENDERBUFFER, GL_DEPTH_COMPONENT, a_rDesc.uiWidth, a_rDesc.uiHeight );
+		glBindRenderbuffer		( GL_RENDERBUFFER, 0 );
+	}
+
+	glGenFramebuffers		( 1, &poTarget->uiFBO );
+	glBindFramebuffer		( GL_FRAMEBUFFER, poTarget->uiFBO );
+	glFramebufferTexture2D	( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, poTarget->uiTexture, 0 );
+	if( poTarget->uiDepth != 0 )
+		glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, poTarget->uiDepth );
+
+	if( glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE )
+		printf( "Error creating %ux%u frame buffer!\n", a_rDesc.uiWidth, a_rDesc.uiHeight );
+
+	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+
+	return poTarget;
+}
+
+void RenderTargetPool::DestroyTarget( RenderTarget* a_poTarget )
+{
+	glDeleteFramebuffers( 1, &a_poTarget->uiFBO );
+	GetGLState().DeleteTextures( 1, &a_poTarget->uiTexture );
+	if( a_poTarget->uiDepth != 0 )
+		glDeleteRenderbuffers( 1, &a_poTarget->uiDepth );
+
+	delete a_poTarget;
+}
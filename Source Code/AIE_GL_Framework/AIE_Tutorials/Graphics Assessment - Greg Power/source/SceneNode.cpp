@@ -14,6 +14,8 @@ SceneNode::SceneNode( AIE::vec4 a_translation, SceneNode *a_pParent )
 											0.f, 0.f, 0.f, 1.f	);
 
 	m_localTransform.row3	= a_translation;
+	m_worldTransform		= m_localTransform;
+	m_bWorldDirty			= true;
 	m_pParent				= a_pParent;
 
 	if( m_pParent != nullptr )
@@ -26,11 +28,51 @@ SceneNode::~SceneNode()
 		//m_pParent->DeregisterChild( this );
 }
 
-AIE::mat4 SceneNode::GetWorldTransform()
+// only recomputed after this node or an ancestor has moved, an ancestor
+// that is also dirty is brought up to date first
+const AIE::mat4& SceneNode::GetWorldTransform()
 {
-	if( m_pParent != nullptr )
-		return m_localTransform * m_pParent->GetWorldTransform();
-	return m_localTransform;
+	if( m_bWorldDirty )
+	{
+		if( m_pParent != nullptr )
+			m_worldTransform = m_localTransform * m_pParent->GetWorldTransform();
+		else
+			m_worldTransform = m_localTransform;
+		m_bWorldDirty = false;
+	}
+	return m_worldTransform;
+}
+
+// brings this node and every dirty node below it up to date in one pass,
+// parents are always resolved before their children
+void SceneNode::UpdateWorldTransforms()
+{
+	GetWorldTransform();
+
+	auto iter = m_listOfChildren.begin();
+	while( iter != m_listOfChildren.end() )
+	{
+		if( (*iter)->m_bWorldDirty )
+			(*iter)->UpdateWorldTransforms();
+		++iter;
+	}
+}
+
+void SceneNode::MarkWorldDirty()
+{
+	// a clean node's children are all clean, a dirty one's are all dirty
+	// already, so the walk stops at the first dirty node
+	if( m_bWorldDirty )
+		return;
+
+	m_bWorldDirty = true;
+
+	auto iter = m_listOfChildren.begin();
+	while( iter != m_listOfChildren.end() )
+	{
+		(*iter)->MarkWorldDirty();
+		++iter;
+	}
 }
 
 //void SceneNode::RotateNode( float a_fRad, const AIE::vec4& a_axis )
@@ -51,6 +93,7 @@ void SceneNode::RotateNode( Quaternion &a_qRot )
 void SceneNode::RegisterChild(SceneNode* a_child)
 {
 	m_listOfChildren.push_back( a_child );
+	a_child->MarkWorldDirty();
 }
 
 void SceneNode::DeregisterChild(SceneNode* a_child)
@@ -81,6 +124,10 @@ void SceneNode::DeleteAllChildren()
 
 void SceneNode::Update(float a_fDeltaTime)
 {
+	// the root refreshes the whole tree before anything below it is updated
+	if( m_pParent == nullptr )
+		UpdateWorldTransforms();
+
 	auto iter = m_listOfChildren.begin();
 	while( iter != m_listOfChildren.end() )
 	{
@@ -0,0 +1,261 @@
+#include "ShaderProgramCache.h"
+#include "GLStateCache.h"
+#include "Utilities.h"
+
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+	#include <direct.h>
+#else
+	#include <sys/stat.h>
+#endif
+
+// disable the warning for microsoft "safe" functions
+#pragma warning( disable : 4996 )
+
+const char* g_szShaderCacheDirectory = "./shadercache";
+const char* g_szShaderHeaderPath = "./shaders/frame_data.glsl";
+
+static const unsigned int CACHE_MAGIC	= 0x50454941;	// "AIEP"
+static const unsigned int CACHE_VERSION	= 1;
+
+struct ProgramBinaryHeader
+{
+	unsigned int		uiMagic;
+	unsigned int		uiVersion;
+	unsigned long long	ulKey;
+	GLenum				eFormat;
+	unsigned int		uiLength;
+};
+
+// FNV-1a, 64 bit so collisions between a few dozen programs aren't a concern
+static unsigned long long HashBytes( unsigned long long a_ulHash, const void* a_pData, unsigned int a_uiLength )
+{
+	const unsigned char* pBytes = (const unsigned char*)a_pData;
+	for( unsigned int i = 0; i < a_uiLength; ++i )
+	{
+		a_ulHash ^= pBytes[i];
+		a_ulHash *= 1099511628211ULL;
+	}
+	return a_ulHash;
+}
+
+// includes the terminator so "ab" + "c" and "a" + "bc" hash differently
+static unsigned long long HashString( unsigned long long a_ulHash, const char* a_szString )
+{
+	if( a_szString == nullptr )
+		a_szString = "";
+	return HashBytes( a_ulHash, a_szString, strlen( a_szString ) + 1 );
+}
+
+static bool ProgramBinariesSupported()
+{
+	if( !GLEW_ARB_get_program_binary && !GLEW_VERSION_4_1 )
+		return false;
+
+	GLint iNumFormats = 0;
+	glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &iNumFormats );
+	return iNumFormats > 0;
+}
+
+static GLuint LoadProgramBinary( const char* a_szPath, unsigned long long a_ulKey )
+{
+	FILE* pFile = fopen( a_szPath, "rb" );
+	if( pFile == nullptr )
+		return 0;
+
+	ProgramBinaryHeader oHeader;
+	std::vector<char> acBinary;
+
+	bool bValid = fread( &oHeader, sizeof(oHeader), 1, pFile ) == 1 &&
+				  oHeader.uiMagic == CACHE_MAGIC &&
+				  oHeader.uiVersion == CACHE_VERSION &&
+				  oHeader.ulKey == a_ulKey &&
+				  oHeader.uiLength > 0;
+
+	if( bValid )
+	{
+		acBinary.resize( oHeader.uiLength );
+		bValid = fread( &acBinary[0], 1, oHeader.uiLength, pFile ) == oHeader.uiLength;
+	}
+	fclose( pFile );
+
+	if( !bValid )
+		return 0;
+
+	GLuint uiProgram = glCreateProgram();
+	glProgramBinary( uiProgram, oHeader.eFormat, &acBinary[0], oHeader.uiLength );
+
+	// the driver can turn down a binary from an older build of itself
+	GLint iSuccess = GL_FALSE;
+	glGetProgramiv( uiProgram, GL_LINK_STATUS, &iSuccess );
+	if( iSuccess == GL_FALSE )
+	{
+		glDeleteProgram( uiProgram );
+		return 0;
+	}
+
+	return uiProgram;
+}
+
+static void SaveProgramBinary( const char* a_szPath, unsigned long long a_ulKey, GLuint a_uiProgram )
+{
+	GLint iLength = 0;
+	glGetProgramiv( a_uiProgram, GL_PROGRAM_BINARY_LENGTH, &iLength );
+	if( iLength <= 0 )
+	{
+		// some drivers only keep the binary if asked before linking
+		glProgramParameteri( a_uiProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+		glLinkProgram( a_uiProgram );
+		GetGLState().UseProgram( a_uiProgram );
+		glGetProgramiv( a_uiProgram, GL_PROGRAM_BINARY_LENGTH, &iLength );
+		if( iLength <= 0 )
+			return;
+	}
+
+	std::vector<char> acBinary( iLength );
+	GLsizei iWritten = 0;
+	GLenum eFormat = 0;
+	glGetProgramBinary( a_uiProgram, iLength, &iWritten, &eFormat, &acBinary[0] );
+	if( iWritten <= 0 )
+		return;
+
+#ifdef _WIN32
+	_mkdir( g_szShaderCacheDirectory );
+#else
+	mkdir( g_szShaderCacheDirectory, 0755 );
+#endif
+
+	// write beside it first so a crash can't leave half a blob behind
+	std::string sTempPath = std::string( a_szPath ) + ".tmp";
+	FILE* pFile = fopen( sTempPath.c_str(), "wb" );
+	if( pFile == nullptr )
+		return;
+
+	ProgramBinaryHeader oHeader;
+	oHeader.uiMagic		= CACHE_MAGIC;
+	oHeader.uiVersion	= CACHE_VERSION;
+	oHeader.ulKey		= a_ulKey;
+	oHeader.eFormat		= eFormat;
+	oHeader.uiLength	= iWritten;
+
+	bool bWritten = fwrite( &oHeader, sizeof(oHeader), 1, pFile ) == 1 &&
+					fwrite( &acBinary[0], 1, iWritten, pFile ) == (size_t)iWritten;
+	fclose( pFile );
+
+	remove( a_szPath );
+	if( !bWritten || rename( sTempPath.c_str(), a_szPath ) != 0 )
+		remove( sTempPath.c_str() );
+}
+
+// LoadShader leaves the new program bound without the state cache seeing it
+static GLuint LoadUncachedShader( unsigned int a_uiInputAttributeCount, const char** a_aszInputAttributes,
+								  unsigned int a_uiOutputAttributeCount, const char** a_aszOutputAttributes,
+								  const char* a_szVertexShader, const char* a_szPixelShader,
+								  const char* a_szGeometryShader,
+								  const char* a_szTessellationControlShader, const char* a_szTessellationEvaluationShader )
+{
+	GLuint uiProgram = AIE::LoadShader( a_uiInputAttributeCount, a_aszInputAttributes, a_uiOutputAttributeCount, a_aszOutputAttributes,
+										a_szVertexShader, a_szPixelShader, a_szGeometryShader, a_szTessellationControlShader, a_szTessellationEvaluationShader );
+	GetGLState().Invalidate();
+	return uiProgram;
+}
+
+static GLuint LoadProgram( unsigned int a_uiInputAttributeCount, const char** a_aszInputAttributes,
+						   unsigned int a_uiOutputAttributeCount, const char** a_aszOutputAttributes,
+						   const char* a_szVertexShader, const char* a_szPixelShader,
+						   const char* a_szGeometryShader,
+						   const char* a_szTessellationControlShader, const char* a_szTessellationEvaluationShader )
+{
+	if( !ProgramBinariesSupported() )
+	{
+		return LoadUncachedShader( a_uiInputAttributeCount, a_aszInputAttributes, a_uiOutputAttributeCount, a_aszOutputAttributes,
+								a_szVertexShader, a_szPixelShader, a_szGeometryShader, a_szTessellationControlShader, a_szTessellationEvaluationShader );
+	}
+
+	const char* aszPaths[5] = { a_szVertexShader, a_szPixelShader, a_szGeometryShader, a_szTessellationControlShader, a_szTessellationEvaluationShader };
+	char*		apSources[5] = { nullptr, nullptr, nullptr, nullptr, nullptr };
+	for( unsigned int i = 0; i < 5; ++i )
+	{
+		if( aszPaths[i] != nullptr )
+			apSources[i] = AIE::LoadShaderSource( aszPaths[i] );
+	}
+
+	// LoadShader only uses tessellation when both stages are there
+	if( apSources[3] == nullptr || apSources[4] == nullptr )
+	{
+		delete[] apSources[3];
+		delete[] apSources[4];
+		apSources[3] = apSources[4] = nullptr;
+	}
+
+	unsigned long long ulKey = 14695981039346656037ULL;
+	ulKey = HashString( ulKey, (const char*)glGetString( GL_VENDOR ) );
+	ulKey = HashString( ulKey, (const char*)glGetString( GL_RENDERER ) );
+	ulKey = HashString( ulKey, (const char*)glGetString( GL_VERSION ) );
+	for( unsigned int i = 0; i < 5; ++i )
+	{
+		ulKey = HashBytes( ulKey, &i, sizeof(i) );
+		ulKey = HashString( ulKey, apSources[i] );
+	}
+	for( unsigned int i = 0; i < a_uiInputAttributeCount; ++i )
+	{
+		ulKey = HashString( ulKey, a_aszInputAttributes[i] );
+	}
+	ulKey = HashBytes( ulKey, &a_uiOutputAttributeCount, sizeof(a_uiOutputAttributeCount) );
+	for( unsigned int i = 0; i < a_uiOutputAttributeCount; ++i )
+	{
+		ulKey = HashString( ulKey, a_aszOutputAttributes[i] );
+	}
+
+	bool bHaveStages = apSources[0] != nullptr && apSources[1] != nullptr;
+	for( unsigned int i = 0; i < 5; ++i )
+	{
+		delete[] apSources[i];
+	}
+
+	// let LoadShader report what's missing
+	if( !bHaveStages )
+	{
+		return LoadUncachedShader( a_uiInputAttributeCount, a_aszInputAttributes, a_uiOutputAttributeCount, a_aszOutputAttributes,
+								a_szVertexShader, a_szPixelShader, a_szGeometryShader, a_szTessellationControlShader, a_szTessellationEvaluationShader );
+	}
+
+	char szPath[256];
+	sprintf( szPath, "%s/%016llx.bin", g_szShaderCacheDirectory, ulKey );
+
+	GLuint uiProgram = LoadProgramBinary( szPath, ulKey );
+	if( uiProgram != 0 )
+	{
+		GetGLState().UseProgram( uiProgram );
+		return uiProgram;
+	}
+
+	uiProgram = LoadUncachedShader( a_uiInputAttributeCount, a_aszInputAttributes, a_uiOutputAttributeCount, a_aszOutputAttributes,
+								 a_szVertexShader, a_szPixelShader, a_szGeometryShader, a_szTessellationControlShader, a_szTessellationEvaluationShader );
+	if( uiProgram != 0 )
+		SaveProgramBinary( szPath, ulKey, uiProgram );
+
+	return uiProgram;
+}
+
+GLuint LoadCachedShader( unsigned int a_uiInputAttributeCount, const char** a_aszInputAttributes,
+						 unsigned int a_uiOutputAttributeCount, const char** a_aszOutputAttributes,
+						 const char* a_szVertexShader, const char* a_szPixelShader,
+						 const char* a_szGeometryShader,
+						 const char* a_szTessellationControlShader, const char* a_szTessellationEvaluationShader )
+{
+	// the header is in the sources that are hashed as well as compiled, so
+	// editing it misses the cache like editing a stage does
+	char* szHeader = AIE::FileToBuffer( g_szShaderHeaderPath );
+	AIE::SetShaderHeader( szHeader );
+
+	GLuint uiProgram = LoadProgram( a_uiInputAttributeCount, a_aszInputAttributes, a_uiOutputAttributeCount, a_aszOutputAttributes,
+									a_szVertexShader, a_szPixelShader, a_szGeometryShader, a_szTessellationControlShader, a_szTessellationEvaluationShader );
+
+	AIE::SetShaderHeader( nullptr );
+	delete[] szHeader;
+	return uiProgram;
+}
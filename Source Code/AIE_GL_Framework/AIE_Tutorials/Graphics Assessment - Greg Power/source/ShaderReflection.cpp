@@ -0,0 +1,151 @@
+#include "ShaderReflection.h"
+
+#include <string.h>
+
+const char* g_aszUniformNames[ UNIFORM_HANDLE_COUNT ] =
+{
+	"Model",
+	"Colour",
+	"Distance",
+	"PassNumber",
+	"diffuseTexture",
+	"secondaryTexture",
+	"displacementTexture",
+	"normalTexture",
+	"specularTexture",
+	"Texture",
+	"SceneTexture",
+	"WaterBumpMap",
+	"RenderBuffer",
+	"materialDiffuse",
+	"boneArray",
+	"TexelSize",
+};
+
+ShaderReflection::ShaderReflection()
+{
+	m_uiProgram = 0;
+	for( unsigned int i = 0; i < UNIFORM_HANDLE_COUNT; ++i )
+	{
+		m_aiHandleLocations[i] = -1;
+	}
+}
+
+ShaderReflection::~ShaderReflection()
+{
+}
+
+void ShaderReflection::Reflect( GLuint a_uiProgram )
+{
+	m_uiProgram = a_uiProgram;
+	m_aoUniforms.clear();
+
+	GLint iUniformCount = 0;
+	GLint iMaxNameLength = 0;
+	glGetProgramiv( a_uiProgram, GL_ACTIVE_UNIFORMS, &iUniformCount );
+	glGetProgramiv( a_uiProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &iMaxNameLength );
+
+	std::vector<char> acName( iMaxNameLength + 1, 0 );
+	m_aoUniforms.reserve( iUniformCount );
+
+	for( GLint i = 0; i < iUniformCount; ++i )
+	{
+		UniformInfo oInfo;
+		GLsizei iLength = 0;
+		glGetActiveUniform( a_uiProgram, (GLuint)i, iMaxNameLength + 1, &iLength, &oInfo.iSize, &oInfo.eType, &acName[0] );
+		acName[ iLength ] = 0;
+
+		// uniform block members have no location of their own
+		oInfo.iLocation = glGetUniformLocation( a_uiProgram, &acName[0] );
+		if( oInfo.iLocation < 0 )
+		{
+			continue;
+		}
+
+		// arrays report as "name[0]", store the base name, anything past the
+		// first bracket is a struct member and part of the key
+		oInfo.sName.assign( &acName[0], GetBaseNameLength( &acName[0], iLength ) );
+		oInfo.uiHash	= HashName( oInfo.sName.c_str(), oInfo.sName.size() );
+		m_aoUniforms.push_back( oInfo );
+	}
+
+	BuildTable();
+
+	for( unsigned int i = 0; i < UNIFORM_HANDLE_COUNT; ++i )
+	{
+		m_aiHandleLocations[i] = FindLocation( g_aszUniformNames[i] );
+	}
+}
+
+GLint ShaderReflection::FindLocation( const char* a_szName ) const
+{
+	const UniformInfo* pInfo = FindUniform( a_szName );
+	return pInfo != nullptr ? pInfo->iLocation : -1;
+}
+
+const UniformInfo* ShaderReflection::FindUniform( const char* a_szName ) const
+{
+	if( m_auiTable.empty() )
+	{
+		return nullptr;
+	}
+
+	// "name[0]" is stored as "name"
+	unsigned int uiLength = GetBaseNameLength( a_szName, strlen( a_szName ) );
+	unsigned int uiHash = HashName( a_szName, uiLength );
+	unsigned int uiMask = m_auiTable.size() - 1;
+
+	for( unsigned int uiSlot = uiHash & uiMask; m_auiTable[ uiSlot ] != EMPTY_SLOT; uiSlot = (uiSlot + 1) & uiMask )
+	{
+		const UniformInfo& rInfo = m_aoUniforms[ m_auiTable[ uiSlot ] ];
+		if( rInfo.uiHash == uiHash && rInfo.sName.compare( 0, std::string::npos, a_szName, uiLength ) == 0 )
+		{
+			return &rInfo;
+		}
+	}
+	return nullptr;
+}
+
+// FNV-1a
+unsigned int ShaderReflection::HashName( const char* a_szName, unsigned int a_uiLength )
+{
+	unsigned int uiHash = 2166136261u;
+	for( unsigned int i = 0; i < a_uiLength; ++i )
+	{
+		uiHash ^= (unsigned char)a_szName[i];
+		uiHash *= 16777619u;
+	}
+	return uiHash;
+}
+
+unsigned int ShaderReflection::GetBaseNameLength( const char* a_szName, unsigned int a_uiLength )
+{
+	if( a_uiLength > 3 && strcmp( a_szName + a_uiLength - 3, "[0]" ) == 0 )
+	{
+		return a_uiLength - 3;
+	}
+	return a_uiLength;
+}
+
+void ShaderReflection::BuildTable()
+{
+	// keep the table at most half full
+	unsigned int uiTableSize = 8;
+	while( uiTableSize < m_aoUniforms.size() * 2 )
+	{
+		uiTableSize *= 2;
+	}
+
+	m_auiTable.assign( uiTableSize, EMPTY_SLOT );
+	unsigned int uiMask = uiTableSize - 1;
+
+	for( unsigned int i = 0; i < m_aoUniforms.size(); ++i )
+	{
+		unsigned int uiSlot = m_aoUniforms[i].uiHash & uiMask;
+		while( m_auiTable[ uiSlot ] != EMPTY_SLOT )
+		{
+			uiSlot = (uiSlot + 1) & uiMask;
+		}
+		m_auiTable[ uiSlot ] = i;
+	}
+}
@@ -0,0 +1,101 @@
+#include "SharedMesh.h"
+#include "PlaneNode.h"
+#include "CubeNode.h"
+
+#include <map>
+#include <vector>
+#include <stdio.h>
+
+static std::map<std::string, SharedMesh*>& GetRegistry()
+{
+	static std::map<std::string, SharedMesh*> s_oMeshes;
+	return s_oMeshes;
+}
+
+static SharedMesh* FindMesh( const std::string& a_sKey )
+{
+	std::map<std::string, SharedMesh*>& rMeshes = GetRegistry();
+
+	std::map<std::string, SharedMesh*>::iterator iter = rMeshes.find( a_sKey );
+	if( iter == rMeshes.end() )
+		return nullptr;
+
+	++iter->second->uiRefCount;
+	return iter->second;
+}
+
+static SharedMesh* RegisterMesh( const std::string& a_sKey, const std::vector<AIE::Vertex>& a_aoVertices, const std::vector<unsigned int>& a_auiIndices )
+{
+	SharedMesh* poMesh		= new SharedMesh();
+	poMesh->uiNumVerts		= a_aoVertices.size();
+	poMesh->uiNumIndices	= a_auiIndices.size();
+	poMesh->uiRefCount		= 1;
+	poMesh->sKey			= a_sKey;
+	ComputeBounds( &a_aoVertices[0].position, a_aoVertices.size(), sizeof(AIE::Vertex), poMesh->oBounds );
+
+	glGenBuffers( 1, &poMesh->uiVBO );
+	glGenBuffers( 1, &poMesh->uiIBO );
+
+	glBindBuffer( GL_ARRAY_BUFFER,			poMesh->uiVBO );
+	glBufferData( GL_ARRAY_BUFFER,			poMesh->uiNumVerts		* sizeof(AIE::Vertex),	&a_aoVertices[0],	GL_STATIC_DRAW );
+	glBindBuffer( GL_ARRAY_BUFFER,			0 );
+
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER,	poMesh->uiIBO );
+	glBufferData( GL_ELEMENT_ARRAY_BUFFER,	poMesh->uiNumIndices	* sizeof(unsigned int),	&a_auiIndices[0],	GL_STATIC_DRAW );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER,	0 );
+
+	GetRegistry()[ a_sKey ] = poMesh;
+	return poMesh;
+}
+
+SharedMesh* AcquirePlaneMesh( int a_iVertsWidth, int a_iVertsLength )
+{
+	// same clamp as PlaneNode
+	if( a_iVertsWidth < 2 )
+		a_iVertsWidth = 2;
+	if( a_iVertsLength < 2 )
+		a_iVertsLength = 2;
+
+	char szKey[32];
+	sprintf( szKey, "plane|%d|%d", a_iVertsWidth, a_iVertsLength );
+
+	SharedMesh* poMesh = FindMesh( szKey );
+	if( poMesh != nullptr )
+		return poMesh;
+
+	std::vector<AIE::Vertex>	aoVertices;
+	std::vector<unsigned int>	auiIndices;
+	PlaneNode::BuildGeometry( 1.f, 1.f, a_iVertsWidth, a_iVertsLength, AIE::vec4( 0.f, 0.f, 0.f, 1.f ), aoVertices, auiIndices );
+
+	return RegisterMesh( szKey, aoVertices, auiIndices );
+}
+
+SharedMesh* AcquireCubeMesh()
+{
+	SharedMesh* poMesh = FindMesh( "cube" );
+	if( poMesh != nullptr )
+		return poMesh;
+
+	std::vector<AIE::Vertex>	aoVertices;
+	std::vector<unsigned int>	auiIndices;
+	CubeNode::BuildGeometry( 1.f, AIE::vec4( 0.f, 0.f, 0.f, 1.f ), aoVertices, auiIndices );
+
+	return RegisterMesh( "cube", aoVertices, auiIndices );
+}
+
+void ReleaseSharedMesh( SharedMesh* a_poMesh )
+{
+	if( a_poMesh == nullptr || --a_poMesh->uiRefCount > 0 )
+		return;
+
+	GetRegistry().erase( a_poMesh->sKey );
+
+	glDeleteBuffers( 1, &a_poMesh->uiVBO );
+	glDeleteBuffers( 1, &a_poMesh->uiIBO );
+	delete a_poMesh;
+}
+
+unsigned int GetSharedMeshCount()
+{
+	return GetRegistry().size();
+}
@@ -0,0 +1,149 @@
+#include "SkeletonAnimator.h"
+
+SkeletonAnimator::SkeletonAnimator()
+{
+	m_pSkeleton		= nullptr;
+	m_pAnimation	= nullptr;
+}
+
+SkeletonAnimator::~SkeletonAnimator()
+{
+}
+
+void SkeletonAnimator::SetAnimation( FBXSkeleton* a_pSkeleton, const FBXAnimation* a_pAnimation )
+{
+	m_pSkeleton		= a_pSkeleton;
+	m_pAnimation	= a_pAnimation;
+
+	m_auiCursors.assign( a_pAnimation != nullptr ? a_pAnimation->m_trackCount : 0, 0 );
+}
+
+void SkeletonAnimator::Evaluate( float a_fTime, bool a_bLoop, float a_fFPS )
+{
+	if( m_pSkeleton == nullptr )
+	{
+		return;
+	}
+
+	if( m_pAnimation != nullptr )
+	{
+		// determine frame we're on
+		int iAnimFrames			= m_pAnimation->m_endFrame - m_pAnimation->m_startFrame;
+		float fAnimDuration		= iAnimFrames / a_fFPS;
+
+		// get time through frame
+		float fFrameTime = 0.f;
+		if( a_bLoop )
+		{
+			fFrameTime = Maxf( fmod( a_fTime, fAnimDuration ), 0.f );
+		}
+		else
+		{
+			fFrameTime = Minf( Maxf( a_fTime, 0.f ), fAnimDuration );
+		}
+
+		unsigned int uiFrame = m_pAnimation->m_startFrame + (unsigned int)( fFrameTime * a_fFPS );
+
+		for( unsigned int i = 0; i < m_pAnimation->m_trackCount; ++i )
+		{
+			const FBXTrack& rTrack = m_pAnimation->m_tracks[i];
+
+			// need a pair of keyframes either side of the frame
+			if( rTrack.m_keyframeCount < 2 ||
+				uiFrame < rTrack.m_keyframes[0].m_key ||
+				uiFrame > rTrack.m_keyframes[ rTrack.m_keyframeCount - 1 ].m_key )
+			{
+				continue;
+			}
+
+			m_auiCursors[i] = FindKeyFrame( rTrack, m_auiCursors[i], uiFrame );
+
+			const FBXKeyFrame& rStart	= rTrack.m_keyframes[ m_auiCursors[i] ];
+			const FBXKeyFrame& rEnd		= rTrack.m_keyframes[ m_auiCursors[i] + 1 ];
+
+			float fStartTime	= (rStart.m_key - m_pAnimation->m_startFrame) / a_fFPS;
+			float fEndTime		= (rEnd.m_key - m_pAnimation->m_startFrame) / a_fFPS;
+			float fScale		= Maxf( 0.f, Minf( 1.f, (fFrameTime - fStartTime) / (fEndTime - fStartTime) ) );
+
+			vec4 vTranslation	= rStart.m_translation * (1.f - fScale) + rEnd.m_translation * fScale;
+			vec4 vScale			= rStart.m_scale * (1.f - fScale) + rEnd.m_scale * fScale;
+
+			// keyframes store rotations as x,y,z,w
+			Quaternion qStart( rStart.m_rotation.w, rStart.m_rotation.x, rStart.m_rotation.y, rStart.m_rotation.z );
+			Quaternion qEnd( rEnd.m_rotation.w, rEnd.m_rotation.x, rEnd.m_rotation.y, rEnd.m_rotation.z );
+			Quaternion qRotation = Quaternion::Slerp( qStart, qEnd, fScale ).Normalize();
+
+			Node* pNode = m_pSkeleton->m_nodes[ rTrack.m_boneIndex ];
+			ComposeTQS( vTranslation, qRotation, vScale, pNode->m_localTransform );
+
+			// tracks are stored parent first, so the parent's global is already up to date
+			if( pNode->m_parent != nullptr )
+			{
+				pNode->m_globalTransform = pNode->m_localTransform * pNode->m_parent->m_globalTransform;
+			}
+			else
+			{
+				pNode->m_globalTransform = pNode->m_localTransform;
+			}
+		}
+	}
+
+	// update bones, removing the Z axis fix as well
+	static const mat4 M( 1,0,0,0, 0,1,0,0, 0,0,-1,0, 0,0,0,1 );
+	for( unsigned int i = 0; i < m_pSkeleton->m_boneCount; ++i )
+	{
+		m_pSkeleton->m_bones[i] = m_pSkeleton->m_bindPoses[i] * m_pSkeleton->m_nodes[i]->m_globalTransform * M;
+	}
+}
+
+// returns the index of the keyframe that starts the pair containing a_uiFrame
+unsigned int SkeletonAnimator::FindKeyFrame( const FBXTrack& a_rTrack, unsigned int a_uiCursor, unsigned int a_uiFrame ) const
+{
+	const FBXKeyFrame* pKeys	= a_rTrack.m_keyframes;
+	unsigned int uiLast			= a_rTrack.m_keyframeCount - 1;
+
+	// still inside the same pair, or stepped into the next one
+	if( a_uiCursor < uiLast && pKeys[ a_uiCursor ].m_key <= a_uiFrame )
+	{
+		if( pKeys[ a_uiCursor + 1 ].m_key >= a_uiFrame )
+		{
+			return a_uiCursor;
+		}
+		if( a_uiCursor + 1 < uiLast && pKeys[ a_uiCursor + 2 ].m_key >= a_uiFrame )
+		{
+			return a_uiCursor + 1;
+		}
+	}
+
+	// seeked or looped, binary search for the first pair ending at or after the frame
+	unsigned int uiLow	= 0;
+	unsigned int uiHigh	= uiLast - 1;
+	while( uiLow < uiHigh )
+	{
+		unsigned int uiMid = (uiLow + uiHigh) / 2;
+		if( pKeys[ uiMid + 1 ].m_key < a_uiFrame )
+		{
+			uiLow = uiMid + 1;
+		}
+		else
+		{
+			uiHigh = uiMid;
+		}
+	}
+	return uiLow;
+}
+
+// builds Scale * Rotation * Translation for row vectors, matching FbxAMatrix::SetTQS
+void SkeletonAnimator::ComposeTQS( const vec4& a_vTranslation, const Quaternion& a_qRotation, const vec4& a_vScale, mat4& a_rOut ) const
+{
+	float x = a_qRotation.x, y = a_qRotation.y, z = a_qRotation.z, w = a_qRotation.w;
+
+	float xx = x * x, yy = y * y, zz = z * z;
+	float xy = x * y, xz = x * z, yz = y * z;
+	float wx = w * x, wy = w * y, wz = w * z;
+
+	a_rOut.row0 = vec4( (1.f - 2.f * (yy + zz)) * a_vScale.x, 2.f * (xy + wz) * a_vScale.x, 2.f * (xz - wy) * a_vScale.x, 0.f );
+	a_rOut.row1 = vec4( 2.f * (xy - wz) * a_vScale.y, (1.f - 2.f * (xx + zz)) * a_vScale.y, 2.f * (yz + wx) * a_vScale.y, 0.f );
+	a_rOut.row2 = vec4( 2.f * (xz + wy) * a_vScale.z, 2.f * (yz - wx) * a_vScale.z, (1.f - 2.f * (xx + yy)) * a_vScale.z, 0.f );
+	a_rOut.row3 = vec4( a_vTranslation.x, a_vTranslation.y, a_vTranslation.z, 1.f );
+}
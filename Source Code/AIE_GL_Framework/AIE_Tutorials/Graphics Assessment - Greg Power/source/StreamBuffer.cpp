@@ -0,0 +1,275 @@
+#include "StreamBuffer.h"
+#include "GLStateCache.h"
+
+#include <GL\glfw.h>
+#include <string.h>
+
+// the glew this builds against predates GL 4.4, glBufferStorage is found
+// at run time
+#ifndef GL_MAP_PERSISTENT_BIT
+	#define GL_MAP_PERSISTENT_BIT	0x0040
+	#define GL_MAP_COHERENT_BIT		0x0080
+#endif
+
+typedef void (GLAPIENTRY *BufferStorageFunction)( GLenum, GLsizeiptr, const GLvoid*, GLbitfield );
+
+GLsync GLFenceSource::Insert()
+{
+	return glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+bool GLFenceSource::Wait( GLsync a_pFence, GLuint64 a_ulTimeout )
+{
+	// the flush makes sure the fence reaches the GPU rather than waiting on
+	// something never sent
+	GLenum eResult = glClientWaitSync( a_pFence, GL_SYNC_FLUSH_COMMANDS_BIT, a_ulTimeout );
+	return eResult == GL_ALREADY_SIGNALED || eResult == GL_CONDITION_SATISFIED;
+}
+
+void GLFenceSource::Delete( GLsync a_pFence )
+{
+	glDeleteSync( a_pFence );
+}
+
+RingAllocator::RingAllocator( IFenceSource* a_poFences )
+{
+	m_poFences = a_poFences;
+	memset( m_apFences, 0, sizeof(m_apFences) );
+	m_uiSegmentCount = 0;
+	m_uiSegmentSize = 0;
+	m_uiSegment = 0;
+	m_uiUsed = 0;
+	m_bInSegment = false;
+	m_uiStalls = 0;
+	m_uiFailures = 0;
+}
+
+RingAllocator::~RingAllocator()
+{
+	Reset();
+}
+
+void RingAllocator::Init( unsigned int a_uiSegmentSize, unsigned int a_uiSegmentCount )
+{
+	Reset();
+
+	if( a_uiSegmentCount > STREAM_SEGMENT_COUNT )
+		a_uiSegmentCount = STREAM_SEGMENT_COUNT;
+
+	m_uiSegmentCount = a_uiSegmentCount;
+	m_uiSegmentSize = a_uiSegmentSize;
+	// the first BeginSegment moves on to segment 0
+	m_uiSegment = a_uiSegmentCount > 0 ? a_uiSegmentCount - 1 : 0;
+	m_uiStalls = 0;
+	m_uiFailures = 0;
+}
+
+void RingAllocator::Reset()
+{
+	for( unsigned int i = 0; i < STREAM_SEGMENT_COUNT; ++i )
+	{
+		if( m_apFences[i] != 0 )
+		{
+			m_poFences->Delete( m_apFences[i] );
+			m_apFences[i] = 0;
+		}
+	}
+	m_uiUsed = 0;
+	m_bInSegment = false;
+}
+
+bool RingAllocator::BeginSegment( GLuint64 a_ulTimeout )
+{
+	if( m_uiSegmentCount == 0 )
+		return false;
+
+	if( m_bInSegment )
+		EndSegment();
+
+	m_uiSegment = ( m_uiSegment + 1 ) % m_uiSegmentCount;
+	m_uiUsed = 0;
+	m_bInSegment = true;
+
+	GLsync pFence = m_apFences[ m_uiSegment ];
+	if( pFence == 0 )
+		return true;
+
+	// a fence that hasn't passed yet means the CPU got a whole ring ahead
+	bool bFinished = m_poFences->Wait( pFence, 0 );
+	if( !bFinished )
+	{
+		++m_uiStalls;
+		bFinished = m_poFences->Wait( pFence, a_ulTimeout );
+	}
+
+	m_poFences->Delete( pFence );
+	m_apFences[ m_uiSegment ] = 0;
+	return bFinished;
+}
+
+unsigned int RingAllocator::Allocate( unsigned int a_uiSize, unsigned int a_uiAlignment )
+{
+	if( !m_bInSegment )
+	{
+		++m_uiFailures;
+		return NO_SPACE;
+	}
+
+	if( a_uiAlignment == 0 )
+		a_uiAlignment = 1;
+
+	unsigned int uiStart = GetSegmentStart();
+	unsigned int uiOffset = uiStart + m_uiUsed;
+	uiOffset = ( ( uiOffset + a_uiAlignment - 1 ) / a_uiAlignment ) * a_uiAlignment;
+
+	if( uiOffset - uiStart > m_uiSegmentSize || a_uiSize > m_uiSegmentSize - ( uiOffset - uiStart ) )
+	{
+		++m_uiFailures;
+		return NO_SPACE;
+	}
+
+	m_uiUsed = uiOffset - uiStart + a_uiSize;
+	return uiOffset;
+}
+
+void RingAllocator::EndSegment()
+{
+	if( !m_bInSegment )
+		return;
+
+	m_apFences[ m_uiSegment ] = m_poFences->Insert();
+	m_bInSegment = false;
+}
+
+StreamBuffer::StreamBuffer()
+	: m_oRing( &m_oFences )
+{
+	m_uiBuffer = 0;
+	m_pucMapped = nullptr;
+	m_bPersistent = false;
+	m_bInFrame = false;
+	m_uiFrame = 0;
+}
+
+StreamBuffer::~StreamBuffer()
+{
+}
+
+bool StreamBuffer::Create( unsigned int a_uiSegmentSize )
+{
+	Destroy();
+
+	m_oRing.Init( a_uiSegmentSize );
+	unsigned int uiSize = m_oRing.GetSize();
+
+	int iMajor = 0, iMinor = 0, iRevision = 0;
+	glfwGetGLVersion( &iMajor, &iMinor, &iRevision );
+	bool bHasStorage = iMajor > 4 || ( iMajor == 4 && iMinor >= 4 ) || glfwExtensionSupported( "GL_ARB_buffer_storage" ) == GL_TRUE;
+	BufferStorageFunction pfnBufferStorage = bHasStorage ? (BufferStorageFunction)glfwGetProcAddress( "glBufferStorage" ) : nullptr;
+
+	glGenBuffers( 1, &m_uiBuffer );
+	GetGLState().BindBuffer( GL_ARRAY_BUFFER, m_uiBuffer );
+
+	if( pfnBufferStorage != nullptr )
+	{
+		GLbitfield uiFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		pfnBufferStorage( GL_ARRAY_BUFFER, uiSize, nullptr, uiFlags );
+		m_pucMapped = (unsigned char*)glMapBufferRange( GL_ARRAY_BUFFER, 0, uiSize, uiFlags );
+		m_bPersistent = m_pucMapped != nullptr;
+
+		// storage can't be respecified, so a failed map needs a new buffer
+		if( !m_bPersistent )
+		{
+			glDeleteBuffers( 1, &m_uiBuffer );
+			glGenBuffers( 1, &m_uiBuffer );
+			GetGLState().BindBuffer( GL_ARRAY_BUFFER, m_uiBuffer );
+		}
+	}
+
+	if( !m_bPersistent )
+		glBufferData( GL_ARRAY_BUFFER, uiSize, nullptr, GL_STREAM_DRAW );
+
+	GetGLState().BindBuffer( GL_ARRAY_BUFFER, 0 );
+	return m_uiBuffer != 0;
+}
+
+void StreamBuffer::Destroy()
+{
+	if( m_uiBuffer == 0 )
+		return;
+
+	if( m_pucMapped != nullptr )
+	{
+		GetGLState().BindBuffer( GL_ARRAY_BUFFER, m_uiBuffer );
+		glUnmapBuffer( GL_ARRAY_BUFFER );
+		GetGLState().BindBuffer( GL_ARRAY_BUFFER, 0 );
+	}
+	glDeleteBuffers( 1, &m_uiBuffer );
+	m_oRing.Reset();
+
+	m_uiBuffer = 0;
+	m_pucMapped = nullptr;
+	m_bPersistent = false;
+	m_bInFrame = false;
+}
+
+void StreamBuffer::BeginFrame()
+{
+	if( m_uiBuffer == 0 || m_bInFrame )
+		return;
+
+	m_oRing.BeginSegment();
+	m_bInFrame = true;
+	++m_uiFrame;
+
+	if( m_bPersistent )
+		return;
+
+	// the fence already says the GPU is done with the segment, so the
+	// driver needn't check
+	GetGLState().BindBuffer( GL_ARRAY_BUFFER, m_uiBuffer );
+	m_pucMapped = (unsigned char*)glMapBufferRange( GL_ARRAY_BUFFER, m_oRing.GetSegmentStart(), m_oRing.GetSegmentSize(),
+													GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT );
+	GetGLState().BindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+void* StreamBuffer::Allocate( unsigned int a_uiSize, unsigned int a_uiAlignment, unsigned int& a_ruiOffset )
+{
+	if( !m_bInFrame || m_pucMapped == nullptr )
+		return nullptr;
+
+	unsigned int uiOffset = m_oRing.Allocate( a_uiSize, a_uiAlignment );
+	if( uiOffset == RingAllocator::NO_SPACE )
+		return nullptr;
+
+	a_ruiOffset = uiOffset;
+	return m_bPersistent ? m_pucMapped + uiOffset : m_pucMapped + ( uiOffset - m_oRing.GetSegmentStart() );
+}
+
+void StreamBuffer::Flush()
+{
+	// a coherent mapping is seen by the GPU as it's written
+	if( m_bPersistent || m_pucMapped == nullptr )
+		return;
+
+	GetGLState().BindBuffer( GL_ARRAY_BUFFER, m_uiBuffer );
+	glUnmapBuffer( GL_ARRAY_BUFFER );
+	GetGLState().BindBuffer( GL_ARRAY_BUFFER, 0 );
+	m_pucMapped = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+	if( !m_bInFrame )
+		return;
+
+	Flush();
+	m_oRing.EndSegment();
+	m_bInFrame = false;
+}
+
+StreamBuffer& GetStreamBuffer()
+{
+	static StreamBuffer s_oStreamBuffer;
+	return s_oStreamBuffer;
+}
@@ -1,5 +1,5 @@
 #include "TerrainNode.h"
-#include "PerlinNoise2D.h"
+#include "HeightfieldGenerator.h"
 
 TerrainNode::TerrainNode( float a_fWidth, float a_fLength, float a_fHeightScale, int a_iVertsWidth, int a_iVertsLength, AIE::vec4 a_translation, SceneNode *a_pParent ) 
 	: MeshNode( a_translation, a_pParent )
@@ -34,40 +34,46 @@ void TerrainNode::BuildVertsIndices()
 	int iNumTris = ((m_iVertsWidth-1) * (m_iVertsLength-1)) * 2;
 	m_iNumIndices = iNumTris * 3;
 
+	// heights for the whole grid up front, spread over all cores
+	std::vector<float> afHeights( m_iNumVerts );
+	GenerateHeightfield( &afHeights[0], m_iVertsWidth, m_iVertsLength, 0.75f, 6, m_fHeightScale );
+
+	m_aoVertices.resize( m_iNumVerts );
+	m_auiIndex.resize( m_iNumIndices );
+
 	for( int z = 0; z < m_iVertsLength; ++z )
 	{
 		for( int x = 0; x < m_iVertsWidth; ++x )
 		{
-			m_aoVertices.push_back( AIE::Vertex() );
+			int iVertex = z*m_iVertsWidth + x;
 
 			float xPos = translation.x;
-			float yPos = translation.y;
+			float yPos = afHeights[ iVertex ];
 			float zPos = translation.z;
 
 			xPos += x == 0 ? 0 : m_fWidth * (static_cast<float>(x)/static_cast<float>(m_iVertsWidth-1));
 			zPos += z == 0 ? 0 : m_fLength * (static_cast<float>(z)/static_cast<float>(m_iVertsLength-1));
 
-			yPos = PerlinNoise2D( x*(1.f/m_iVertsWidth), z*(1.f/m_iVertsLength), 0.75f, 6 ) * m_fHeightScale;
-
-			m_aoVertices[z*m_iVertsLength + x].position = AIE::vec4( xPos-fHalfWidth, yPos, zPos-fHalfLength, 1.0f );
+			m_aoVertices[ iVertex ].position = AIE::vec4( xPos-fHalfWidth, yPos, zPos-fHalfLength, 1.0f );
 		
 			float u = x == 0 ? 0 : (xPos - translation.x)/m_fWidth;
 			float v = z == 0 ? 0 : (zPos - translation.z)/m_fLength;
-			m_aoVertices[z*m_iVertsLength + x].uv = AIE::vec2( u, v );
+			m_aoVertices[ iVertex ].uv = AIE::vec2( u, v );
 		}
 	}
 
+	int iIndex = 0;
 	for( int z = 0; z < m_iVertsLength-1; ++z )
 	{
 		for( int x = 0; x < m_iVertsWidth-1; ++x )
 		{
-			m_auiIndex.push_back( (z*m_iVertsWidth)+x );
-			m_auiIndex.push_back( ((z*m_iVertsWidth)+x) + 1 );
-			m_auiIndex.push_back( ((z+1)*m_iVertsWidth)+x );
+			m_auiIndex[ iIndex++ ] = (z*m_iVertsWidth)+x;
+			m_auiIndex[ iIndex++ ] = ((z*m_iVertsWidth)+x) + 1;
+			m_auiIndex[ iIndex++ ] = ((z+1)*m_iVertsWidth)+x;
 		
-			m_auiIndex.push_back( ((z*m_iVertsWidth)+x) + 1 );
-			m_auiIndex.push_back( ((z+1)*m_iVertsWidth)+x + 1 );
-			m_auiIndex.push_back( ((z+1)*m_iVertsWidth)+x );
+			m_auiIndex[ iIndex++ ] = ((z*m_iVertsWidth)+x) + 1;
+			m_auiIndex[ iIndex++ ] = ((z+1)*m_iVertsWidth)+x + 1;
+			m_auiIndex[ iIndex++ ] = ((z+1)*m_iVertsWidth)+x;
 		}
 	}
 
@@ -0,0 +1,103 @@
+#include "TextureArray.h"
+#include "GLStateCache.h"
+
+#include <FreeImage.h>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+// 32 bit copy of the image, or null
+static FIBITMAP* LoadBitmap32( const char* a_szPath )
+{
+	FIBITMAP* pBitmap = nullptr;
+
+	FREE_IMAGE_FORMAT fif = FreeImage_GetFileType( a_szPath, 0 );
+	if( fif != FIF_UNKNOWN && FreeImage_FIFSupportsReading( fif ) )
+	{
+		pBitmap = FreeImage_Load( fif, a_szPath );
+	}
+
+	if( pBitmap == nullptr )
+	{
+		printf( "Error: Failed to load image '%s'!\n", a_szPath );
+		return nullptr;
+	}
+
+	if( FreeImage_GetImageType( pBitmap ) != FIT_BITMAP )
+	{
+		FIBITMAP* pStandard = FreeImage_ConvertToStandardType( pBitmap );
+		FreeImage_Unload( pBitmap );
+		pBitmap = pStandard;
+	}
+	if( pBitmap != nullptr && FreeImage_GetBPP( pBitmap ) != 32 )
+	{
+		FIBITMAP* p32 = FreeImage_ConvertTo32Bits( pBitmap );
+		FreeImage_Unload( pBitmap );
+		pBitmap = p32;
+	}
+	if( pBitmap == nullptr )
+		printf( "Error: Failed to convert image '%s'!\n", a_szPath );
+
+	return pBitmap;
+}
+
+GLuint LoadTextureArray( const char** a_aszPaths, unsigned int a_uiCount, unsigned int a_uiFormat )
+{
+	if( a_uiCount == 0 )
+		return 0;
+
+	FIBITMAP* pFirst = LoadBitmap32( a_aszPaths[0] );
+	if( pFirst == nullptr )
+		return 0;
+
+	unsigned int uiWidth	= FreeImage_GetWidth( pFirst );
+	unsigned int uiHeight	= FreeImage_GetHeight( pFirst );
+	unsigned int uiLayerBytes = uiWidth * uiHeight * 4;
+
+	// every layer is tightly packed one after the other, which is what
+	// glTexImage3D reads
+	std::vector<unsigned char> aucData( uiLayerBytes * a_uiCount, 0 );
+
+	for( unsigned int i = 0; i < a_uiCount; ++i )
+	{
+		FIBITMAP* pBitmap = i == 0 ? pFirst : LoadBitmap32( a_aszPaths[i] );
+		if( pBitmap == nullptr )
+			continue;
+
+		if( FreeImage_GetWidth( pBitmap ) != uiWidth || FreeImage_GetHeight( pBitmap ) != uiHeight )
+		{
+			FIBITMAP* pScaled = FreeImage_Rescale( pBitmap, uiWidth, uiHeight, FILTER_BILINEAR );
+			FreeImage_Unload( pBitmap );
+			pBitmap = pScaled;
+			if( pBitmap == nullptr )
+				continue;
+		}
+
+		unsigned char* pLayer = &aucData[ i * uiLayerBytes ];
+		for( unsigned int y = 0; y < uiHeight; ++y )
+		{
+			memcpy( pLayer + y * uiWidth * 4, FreeImage_GetScanLine( pBitmap, y ), uiWidth * 4 );
+		}
+		FreeImage_Unload( pBitmap );
+	}
+
+	GLuint uiTextureID = 0;
+	glGenTextures( 1, &uiTextureID );
+	GetGLState().BindTexture( GL_TEXTURE_2D_ARRAY, uiTextureID );
+	glTexImage3D( GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, uiWidth, uiHeight, a_uiCount, 0, a_uiFormat, GL_UNSIGNED_BYTE, &aucData[0] );
+	glGenerateMipmap( GL_TEXTURE_2D_ARRAY );
+
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT );
+	glTexParameteri( GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT );
+	GetGLState().BindTexture( GL_TEXTURE_2D_ARRAY, 0 );
+
+	return uiTextureID;
+}
+
+void ReleaseTextureArray( GLuint a_uiTextureID )
+{
+	if( a_uiTextureID != 0 )
+		GetGLState().DeleteTextures( 1, &a_uiTextureID );
+}
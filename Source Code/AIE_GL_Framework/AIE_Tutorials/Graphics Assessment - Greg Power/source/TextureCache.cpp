@@ -0,0 +1,192 @@
+#include "TextureCache.h"
+#include "GLStateCache.h"
+#include "AsyncTextureLoader.h"
+#include "Utilities.h"
+
+#include <vector>
+#include <stdio.h>
+#include <ctype.h>
+
+GLuint GLTextureBackend::CreateTexture( const char* a_szPath, unsigned int a_uiFormat, unsigned int& a_uiBytes )
+{
+	// size comes through SetTextureBytes once the upload happens
+	if( GetTextureLoader().IsRunning() )
+	{
+		a_uiBytes = 0;
+		return GetTextureLoader().Request( a_szPath, a_uiFormat );
+	}
+
+	unsigned int uiWidth = 0, uiHeight = 0;
+	GLuint uiTextureID = AIE::LoadTexture( a_szPath, a_uiFormat, &uiWidth, &uiHeight );
+	// it binds the texture to upload it, out of the state cache's sight
+	GetGLState().Invalidate();
+
+	// LoadTexture always uploads as GL_RGBA
+	a_uiBytes = uiWidth * uiHeight * 4;
+	return uiTextureID;
+}
+
+void GLTextureBackend::DestroyTexture( GLuint a_uiTextureID )
+{
+	GetTextureLoader().Cancel( a_uiTextureID );
+	GetGLState().DeleteTextures( 1, &a_uiTextureID );
+}
+
+TextureCache::TextureCache( ITextureBackend* a_poBackend )
+{
+	m_poBackend			= a_poBackend;
+	m_uiHits			= 0;
+	m_uiMisses			= 0;
+	m_uiResidentBytes	= 0;
+}
+
+TextureCache::~TextureCache()
+{
+	// anything still referenced here outlived the GL context, leave it be
+	if( !m_oEntries.empty() )
+		printf( "TextureCache: %u textures still referenced\n", (unsigned int)m_oEntries.size() );
+}
+
+GLuint TextureCache::Acquire( const char* a_szPath, unsigned int a_uiFormat )
+{
+	char szFormat[16];
+	sprintf( szFormat, "|%x", a_uiFormat );
+	std::string sKey = CanonicalPath( a_szPath ) + szFormat;
+
+	std::map<std::string, TextureEntry>::iterator iter = m_oEntries.find( sKey );
+	if( iter != m_oEntries.end() )
+	{
+		++m_uiHits;
+		++iter->second.uiRefCount;
+		return iter->second.uiTextureID;
+	}
+
+	++m_uiMisses;
+
+	TextureEntry oEntry;
+	oEntry.uiRefCount	= 1;
+	oEntry.uiBytes		= 0;
+	oEntry.uiTextureID	= m_poBackend->CreateTexture( a_szPath, a_uiFormat, oEntry.uiBytes );
+
+	// failed loads aren't cached so a later call can try again
+	if( oEntry.uiTextureID == 0 )
+		return 0;
+
+	m_oEntries[ sKey ]					= oEntry;
+	m_oKeysByID[ oEntry.uiTextureID ]	= sKey;
+	m_uiResidentBytes					+= oEntry.uiBytes;
+
+	return oEntry.uiTextureID;
+}
+
+void TextureCache::Release( GLuint a_uiTextureID )
+{
+	if( a_uiTextureID == 0 )
+		return;
+
+	std::map<GLuint, std::string>::iterator keyIter = m_oKeysByID.find( a_uiTextureID );
+	if( keyIter == m_oKeysByID.end() )
+	{
+		// not one of ours, it may be a render target or a texture array that
+		// still has an owner
+		printf( "TextureCache: texture %u wasn't acquired from the cache, not releasing it\n", a_uiTextureID );
+		return;
+	}
+
+	std::map<std::string, TextureEntry>::iterator iter = m_oEntries.find( keyIter->second );
+	if( --iter->second.uiRefCount > 0 )
+		return;
+
+	m_uiResidentBytes -= iter->second.uiBytes;
+	m_poBackend->DestroyTexture( a_uiTextureID );
+
+	m_oEntries.erase( iter );
+	m_oKeysByID.erase( keyIter );
+}
+
+unsigned int TextureCache::GetRefCount( GLuint a_uiTextureID ) const
+{
+	std::map<GLuint, std::string>::const_iterator keyIter = m_oKeysByID.find( a_uiTextureID );
+	if( keyIter == m_oKeysByID.end() )
+		return 0;
+
+	return m_oEntries.find( keyIter->second )->second.uiRefCount;
+}
+
+void TextureCache::SetTextureBytes( GLuint a_uiTextureID, unsigned int a_uiBytes )
+{
+	std::map<GLuint, std::string>::iterator keyIter = m_oKeysByID.find( a_uiTextureID );
+	if( keyIter == m_oKeysByID.end() )
+		return;
+
+	TextureEntry& rEntry = m_oEntries[ keyIter->second ];
+	m_uiResidentBytes	= m_uiResidentBytes - rEntry.uiBytes + a_uiBytes;
+	rEntry.uiBytes		= a_uiBytes;
+}
+
+std::string TextureCache::CanonicalPath( const char* a_szPath )
+{
+	std::vector<std::string> asSegments;
+	std::string sSegment;
+
+	for( const char* c = a_szPath; ; ++c )
+	{
+		if( *c == '/' || *c == '\\' || *c == 0 )
+		{
+			if( sSegment == ".." && !asSegments.empty() && asSegments.back() != ".." )
+				asSegments.pop_back();
+			else if( !sSegment.empty() && sSegment != "." )
+				asSegments.push_back( sSegment );
+
+			sSegment.clear();
+			if( *c == 0 )
+				break;
+		}
+		else
+		{
+			// paths on windows aren't case sensitive
+			sSegment += (char)tolower( (unsigned char)*c );
+		}
+	}
+
+	std::string sPath;
+	if( a_szPath[0] == '/' || a_szPath[0] == '\\' )
+		sPath += '/';
+
+	for( unsigned int i = 0; i < asSegments.size(); ++i )
+	{
+		if( i > 0 )
+			sPath += '/';
+		sPath += asSegments[i];
+	}
+	return sPath;
+}
+
+static void OnTextureLoaded( GLuint a_uiTextureID, unsigned int a_uiBytes )
+{
+	GetTextureCache().SetTextureBytes( a_uiTextureID, a_uiBytes );
+}
+
+TextureCache& GetTextureCache()
+{
+	static GLTextureBackend	s_oBackend;
+	static TextureCache		s_oCache( &s_oBackend );
+	static bool				s_bHooked = false;
+
+	if( !s_bHooked )
+	{
+		GetTextureLoader().SetLoadedCallback( OnTextureLoaded );
+		s_bHooked = true;
+	}
+	return s_oCache;
+}
+
+GLuint AcquireTexture( const char* a_szPath, unsigned int a_uiFormat )
+{
+	return GetTextureCache().Acquire( a_szPath, a_uiFormat );
+}
+
+void ReleaseTexture( GLuint a_uiTextureID )
+{
+	GetTextureCache().Release( a_uiTextureID );
+}
@@ -0,0 +1,36 @@
+#ifndef _TESTS_H_
+#define _TESTS_H_
+
+#include <stdio.h>
+
+// Headless checks of the game's systems, nothing here opens a window or
+// needs a GL context. Each returns how many of its checks failed.
+int		TestBlurKernel();
+int		TestDrawCommandList();
+int		TestFrameUniforms();
+int		TestFrustum();
+int		TestGLStateCache();
+int		TestHeightfield();
+int		TestJobSystem();
+int		TestParticleStore();
+int		TestRingAllocator();
+int		TestShaderReflection();
+int		TestTextureCache();
+int		TestVertexWelder();
+
+// timings only, with -bench
+void	BenchmarkJobSystem();
+void	BenchmarkParticleStore();
+
+// counts and reports a failed check
+inline bool Check( bool a_bPassed, const char* a_szWhat, int& a_riFailures )
+{
+	if( !a_bPassed )
+	{
+		printf( "  FAILED: %s\n", a_szWhat );
+		++a_riFailures;
+	}
+	return a_bPassed;
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "Tests.h"
+#include "BlurPyramid.h"
+
+#include <math.h>
+
+static const unsigned int	SIGNAL_LENGTH	= 64;
+static const float			KERNEL_EPSILON	= 1e-5f;
+
+// clamped to the edge, as the blur's textures are
+static float GetTexel( const std::vector<float>& a_rSignal, int a_iIndex )
+{
+	if( a_iIndex < 0 )
+		a_iIndex = 0;
+	if( a_iIndex >= (int)a_rSignal.size() )
+		a_iIndex = (int)a_rSignal.size() - 1;
+	return a_rSignal[ a_iIndex ];
+}
+
+// what a linearly filtered fetch at a_fPosition returns
+static float SampleLinear( const std::vector<float>& a_rSignal, float a_fPosition )
+{
+	float fFloor = floorf( a_fPosition );
+	float fBlend = a_fPosition - fFloor;
+	int iIndex = (int)fFloor;
+	return ( 1.f - fBlend ) * GetTexel( a_rSignal, iIndex ) + fBlend * GetTexel( a_rSignal, iIndex + 1 );
+}
+
+// every texel of the kernel fetched on its own
+static void BlurDiscrete( const std::vector<float>& a_rSignal, const std::vector<float>& a_rWeights, std::vector<float>& a_rResult )
+{
+	a_rResult.resize( a_rSignal.size() );
+	for( int x = 0; x < (int)a_rSignal.size(); ++x )
+	{
+		float fSum = a_rWeights[0] * a_rSignal[x];
+		for( int i = 1; i < (int)a_rWeights.size(); ++i )
+		{
+			fSum += a_rWeights[i] * ( GetTexel( a_rSignal, x - i ) + GetTexel( a_rSignal, x + i ) );
+		}
+		a_rResult[x] = fSum;
+	}
+}
+
+// the merged taps, as blur_fragment.glsl fetches them
+static void BlurLinear( const std::vector<float>& a_rSignal, const BlurKernel& a_rKernel, std::vector<float>& a_rResult )
+{
+	a_rResult.resize( a_rSignal.size() );
+	for( int x = 0; x < (int)a_rSignal.size(); ++x )
+	{
+		float fSum = a_rKernel.afWeights[0] * SampleLinear( a_rSignal, x + a_rKernel.afOffsets[0] );
+		for( unsigned int i = 1; i < a_rKernel.afOffsets.size(); ++i )
+		{
+			fSum += a_rKernel.afWeights[i] * ( SampleLinear( a_rSignal, x - a_rKernel.afOffsets[i] ) + SampleLinear( a_rSignal, x + a_rKernel.afOffsets[i] ) );
+		}
+		a_rResult[x] = fSum;
+	}
+}
+
+static float GetLargestDifference( const std::vector<float>& a_rA, const std::vector<float>& a_rB )
+{
+	float fLargest = 0.f;
+	for( unsigned int i = 0; i < a_rA.size(); ++i )
+	{
+		float fDifference = fabsf( a_rA[i] - a_rB[i] );
+		if( fDifference > fLargest )
+			fLargest = fDifference;
+	}
+	return fLargest;
+}
+
+int TestBlurKernel()
+{
+	printf( "BlurKernel\n" );
+	int iFailures = 0;
+
+	std::vector<float> afImpulse( SIGNAL_LENGTH, 0.f );
+	afImpulse[ SIGNAL_LENGTH / 2 ] = 1.f;
+
+	std::vector<float> afRamp( SIGNAL_LENGTH );
+	for( unsigned int i = 0; i < SIGNAL_LENGTH; ++i )
+	{
+		afRamp[i] = (float)i / SIGNAL_LENGTH;
+	}
+
+	// odd radii leave a last texel with no pair, even ones don't
+	const unsigned int auiRadii[] = { 1, 2, 3, 4, 5, 8, 13, 14 };
+	for( unsigned int r = 0; r < sizeof(auiRadii) / sizeof(auiRadii[0]); ++r )
+	{
+		unsigned int uiRadius = auiRadii[r];
+		char acWhat[128];
+
+		std::vector<float> afWeights;
+		BuildGaussianWeights( uiRadius, 0.5f + uiRadius * 0.5f, afWeights );
+
+		float fTotal = afWeights[0];
+		for( unsigned int i = 1; i < afWeights.size(); ++i )
+		{
+			fTotal += 2.f * afWeights[i];
+		}
+		sprintf( acWhat, "radius %u weights sum to 1", uiRadius );
+		Check( fabsf( fTotal - 1.f ) < KERNEL_EPSILON, acWhat, iFailures );
+
+		BlurKernel oKernel;
+		BuildLinearKernel( afWeights, oKernel );
+		sprintf( acWhat, "radius %u has 1 + (r + 1) / 2 taps", uiRadius );
+		Check( oKernel.afOffsets.size() == 1 + ( uiRadius + 1 ) / 2 && oKernel.afWeights.size() == oKernel.afOffsets.size(), acWhat, iFailures );
+
+		std::vector<float> afDiscrete, afLinear;
+
+		BlurDiscrete( afImpulse, afWeights, afDiscrete );
+		BlurLinear( afImpulse, oKernel, afLinear );
+		sprintf( acWhat, "radius %u impulse matches the full kernel", uiRadius );
+		Check( GetLargestDifference( afDiscrete, afLinear ) < KERNEL_EPSILON, acWhat, iFailures );
+
+		BlurDiscrete( afRamp, afWeights, afDiscrete );
+		BlurLinear( afRamp, oKernel, afLinear );
+		sprintf( acWhat, "radius %u ramp matches the full kernel", uiRadius );
+		Check( GetLargestDifference( afDiscrete, afLinear ) < KERNEL_EPSILON, acWhat, iFailures );
+	}
+
+	return iFailures;
+}
@@ -0,0 +1,114 @@
+#include "Tests.h"
+#include "DrawCommandList.h"
+#include "RenderQueue.h"
+#include "MeshNode.h"
+#include "JobSystem.h"
+
+static const unsigned int TEST_GROUPS			= 16;
+static const unsigned int TEST_NODES_PER_GROUP	= 256;
+static const unsigned int TEST_ROUNDS			= 50;
+
+// The same scene every time for the same round. Every group moves, so each
+// queued node is dirty and shares a dirty parent with the rest of its group
+// when Sort runs.
+static void MoveGroups( std::vector<SceneNode*>& a_rGroups, unsigned int a_uiRound )
+{
+	for( unsigned int i = 0; i < a_rGroups.size(); ++i )
+	{
+		a_rGroups[i]->TranslateNode( AIE::vec4( (float)i, (float)a_uiRound, (float)( ( i * 7 + a_uiRound ) % 11 ), 1.f ) );
+	}
+}
+
+// Sorts and packs every round, returning each round's hash. Also checks the
+// parallel pack against a serial one of the same packets, and every
+// command's distance against its node's transform resolved afterwards.
+static void BuildRounds( RenderQueue& a_rQueue, std::vector<SceneNode*>& a_rGroups, std::vector<unsigned long long>& a_rHashes, int& a_riFailures )
+{
+	const AIE::vec4 vCameraPos( 3.f, 5.f, -7.f, 1.f );
+	const AIE::vec4 vDefaultColour( 0.5f, 0.5f, 0.5f, 1.f );
+	Frustum oEverything;
+
+	DrawCommandList oParallel;
+	DrawCommandList oSerial;
+
+	a_rHashes.clear();
+	for( unsigned int uiRound = 0; uiRound < TEST_ROUNDS; ++uiRound )
+	{
+		MoveGroups( a_rGroups, uiRound );
+
+		a_rQueue.Sort( vCameraPos, oEverything );
+		const std::vector<DrawPacket>& rPackets = a_rQueue.GetPackets();
+		oParallel.Build( rPackets, vCameraPos, vDefaultColour, true );
+		oSerial.Build( rPackets, vCameraPos, vDefaultColour, false );
+
+		Check( oParallel.GetCommands().size() == rPackets.size(), "a command per packet", a_riFailures );
+		Check( oParallel.GetHash() == oSerial.GetHash(), "parallel and serial packs match", a_riFailures );
+
+		unsigned int uiStale = 0;
+		for( unsigned int i = 0; i < rPackets.size(); ++i )
+		{
+			float fDistance = AIE::vec4( vCameraPos - rPackets[i].poNode->GetWorldTransform().row3 ).Magnitude();
+			if( oParallel.GetCommands()[i].fDistance != fDistance )
+				++uiStale;
+		}
+		Check( uiStale == 0, "distances from up to date transforms", a_riFailures );
+
+		a_rHashes.push_back( oParallel.GetHash() );
+	}
+}
+
+int TestDrawCommandList()
+{
+	printf( "DrawCommandList\n" );
+	int iFailures = 0;
+
+	// MeshNode's destructor deletes its GL objects and there's no context
+	// here, so the nodes are left for the process to clean up
+	SceneNode* poRoot = new SceneNode( AIE::vec4( 0.f, 0.f, 0.f, 1.f ) );
+	std::vector<SceneNode*> apoGroups;
+	RenderQueue oQueue;
+
+	for( unsigned int g = 0; g < TEST_GROUPS; ++g )
+	{
+		SceneNode* poGroup = new SceneNode( AIE::vec4( 0.f, 0.f, 0.f, 1.f ), poRoot );
+		apoGroups.push_back( poGroup );
+
+		for( unsigned int n = 0; n < TEST_NODES_PER_GROUP; ++n )
+		{
+			MeshNode* poNode = new MeshNode( AIE::vec4( (float)n, 0.f, (float)g, 1.f ), poGroup );
+
+			// every third node takes the shared colour
+			if( n % 3 != 0 )
+				poNode->SetColour( AIE::vec4( 1.f, (float)n / TEST_NODES_PER_GROUP, (float)g / TEST_GROUPS, 1.f ) );
+			poNode->SetTexture( 1 + n % 5 );
+			poNode->SetSecondaryTexture( n % 2 );
+
+			oQueue.Add( poNode, n % 4, (ERenderPass)( n % RENDER_PASS_COUNT ) );
+		}
+	}
+
+	std::vector<unsigned long long> aulParallel;
+	GetJobSystem().Start();
+	BuildRounds( oQueue, apoGroups, aulParallel, iFailures );
+	GetJobSystem().Stop();
+
+	// without workers Sort and Build run everything on this thread
+	std::vector<unsigned long long> aulSerial;
+	BuildRounds( oQueue, apoGroups, aulSerial, iFailures );
+
+	Check( aulParallel == aulSerial, "job system and single thread rounds match", iFailures );
+
+	// culled or not, every queued node counts toward its pass
+	unsigned int uiPerPass = TEST_GROUPS * TEST_NODES_PER_GROUP / RENDER_PASS_COUNT;
+	bool bCounts = true;
+	for( unsigned int p = 0; p < RENDER_PASS_COUNT; ++p )
+		bCounts = bCounts && oQueue.GetPassCount( (ERenderPass)p ) == uiPerPass;
+	Check( bCounts, "nodes counted per pass", iFailures );
+
+	// handles are slots in add order, the second node went in the transparent pass
+	oQueue.Remove( 1 );
+	oQueue.Remove( 1 );
+	Check( oQueue.GetPassCount( RENDER_PASS_TRANSPARENT ) == uiPerPass - 1 && oQueue.GetPassCount( RENDER_PASS_OPAQUE ) == uiPerPass, "removed node leaves its pass once", iFailures );
+
+	return iFailures;
+}
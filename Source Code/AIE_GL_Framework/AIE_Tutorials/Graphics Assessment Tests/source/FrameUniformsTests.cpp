@@ -0,0 +1,250 @@
+#include "Tests.h"
+#include "FrameUniforms.h"
+#include "ShaderProgramCache.h"
+#include "Utilities.h"
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+// relative to the project directory the tests run in
+static const char* TEST_RESOURCE_DIRECTORY = "../../resources/";
+
+struct Std140Member
+{
+	std::string	sName;
+	GLint		iOffset;
+};
+
+// what the stub driver reports for the program being bound
+struct StubProgram
+{
+	bool						bHasBlock;
+	GLint						iBlockSize;
+	std::vector<Std140Member>	aoMembers;
+	unsigned int				uiBindings;
+};
+
+static StubProgram s_oProgram;
+
+static GLuint GLAPIENTRY StubGetUniformBlockIndex( GLuint, const GLchar* a_szName )
+{
+	return s_oProgram.bHasBlock && strcmp( a_szName, "FrameData" ) == 0 ? 0 : GL_INVALID_INDEX;
+}
+
+static void GLAPIENTRY StubUniformBlockBinding( GLuint, GLuint, GLuint )
+{
+	++s_oProgram.uiBindings;
+}
+
+static void GLAPIENTRY StubGetActiveUniformBlockiv( GLuint, GLuint, GLenum a_ePName, GLint* a_piParams )
+{
+	*a_piParams = a_ePName == GL_UNIFORM_BLOCK_DATA_SIZE ? s_oProgram.iBlockSize : 0;
+}
+
+static void GLAPIENTRY StubGetUniformIndices( GLuint, GLsizei a_iCount, const GLchar** a_aszNames, GLuint* a_auiIndices )
+{
+	for( GLsizei i = 0; i < a_iCount; ++i )
+	{
+		a_auiIndices[i] = GL_INVALID_INDEX;
+		for( unsigned int j = 0; j < s_oProgram.aoMembers.size(); ++j )
+		{
+			if( s_oProgram.aoMembers[j].sName == a_aszNames[i] )
+				a_auiIndices[i] = j;
+		}
+	}
+}
+
+static void GLAPIENTRY StubGetActiveUniformsiv( GLuint, GLsizei a_iCount, const GLuint* a_auiIndices, GLenum a_ePName, GLint* a_piParams )
+{
+	for( GLsizei i = 0; i < a_iCount; ++i )
+		a_piParams[i] = a_ePName == GL_UNIFORM_OFFSET ? s_oProgram.aoMembers[ a_auiIndices[i] ].iOffset : 0;
+}
+
+// std140 base alignment and size of the types a block of plain members can use
+static bool GetStd140Type( const char* a_szType, GLint& a_riAlignment, GLint& a_riSize )
+{
+	if( strcmp( a_szType, "float" ) == 0 || strcmp( a_szType, "int" ) == 0 || strcmp( a_szType, "uint" ) == 0 )
+		a_riAlignment = 4, a_riSize = 4;
+	else if( strcmp( a_szType, "vec2" ) == 0 )
+		a_riAlignment = 8, a_riSize = 8;
+	else if( strcmp( a_szType, "vec3" ) == 0 )
+		a_riAlignment = 16, a_riSize = 12;
+	else if( strcmp( a_szType, "vec4" ) == 0 )
+		a_riAlignment = 16, a_riSize = 16;
+	else if( strcmp( a_szType, "mat4" ) == 0 )
+		a_riAlignment = 16, a_riSize = 64;
+	else
+		return false;
+	return true;
+}
+
+// Lays out the members of a_szSource's FrameData block by the std140 rules
+// the way a driver would. Returns the block's size, or -1 if the block isn't
+// there or holds a type it doesn't know.
+static GLint LayoutFrameData( const char* a_szSource, std::vector<Std140Member>& a_raoMembers )
+{
+	a_raoMembers.clear();
+
+	const char* szBlock = strstr( a_szSource, "uniform FrameData" );
+	if( szBlock == nullptr || ( szBlock = strchr( szBlock, '{' ) ) == nullptr )
+		return -1;
+
+	GLint iOffset = 0;
+	const char* szMember = szBlock + 1;
+	while( true )
+	{
+		szMember += strspn( szMember, " \t\r\n" );
+		if( *szMember == '}' )
+			break;
+
+		char acType[32], acName[64];
+		GLint iAlignment, iSize;
+		if( sscanf( szMember, "%31s %63[^; \t\r\n]", acType, acName ) != 2 || !GetStd140Type( acType, iAlignment, iSize ) )
+			return -1;
+
+		iOffset = ( iOffset + iAlignment - 1 ) / iAlignment * iAlignment;
+		Std140Member oMember;
+		oMember.sName	= acName;
+		oMember.iOffset	= iOffset;
+		a_raoMembers.push_back( oMember );
+		iOffset += iSize;
+
+		szMember = strchr( szMember, ';' );
+		if( szMember == nullptr )
+			return -1;
+		++szMember;
+	}
+
+	// the block's size rounds up to a vec4
+	return ( iOffset + 15 ) / 16 * 16;
+}
+
+// what a stage looks like once the loader has spliced the header in
+static void TestSplice( int& a_riFailures )
+{
+	std::string sHeaderPath = std::string( TEST_RESOURCE_DIRECTORY ) + g_szShaderHeaderPath;
+	std::string sStagePath = std::string( TEST_RESOURCE_DIRECTORY ) + "shaders/basic_vertex.glsl";
+
+	char* szHeader = AIE::FileToBuffer( sHeaderPath.c_str() );
+	char* szStage = AIE::FileToBuffer( sStagePath.c_str() );
+	if( !Check( szHeader != nullptr && szStage != nullptr, "header and stage load", a_riFailures ) )
+	{
+		delete[] szHeader;
+		delete[] szStage;
+		return;
+	}
+
+	AIE::SetShaderHeader( szHeader );
+	char* szSpliced = AIE::LoadShaderSource( sStagePath.c_str() );
+	AIE::SetShaderHeader( nullptr );
+	char* szPlain = AIE::LoadShaderSource( sStagePath.c_str() );
+
+	const char* szVersion = "#version 400\n";
+	std::string sExpected = std::string( szVersion ) + szHeader + "\n#line 2\n" + ( szStage + strlen( szVersion ) );
+	Check( strncmp( szStage, szVersion, strlen( szVersion ) ) == 0, "stage starts with its version", a_riFailures );
+	Check( szSpliced != nullptr && sExpected == szSpliced, "header goes after the version line", a_riFailures );
+	Check( szPlain != nullptr && strcmp( szPlain, szStage ) == 0, "no header leaves the stage as it is", a_riFailures );
+
+	// the stage only gets the block through the header
+	Check( strstr( szStage, "FrameData" ) == nullptr, "stage doesn't declare FrameData itself", a_riFailures );
+	std::vector<Std140Member> aoMembers;
+	Check( szSpliced != nullptr && LayoutFrameData( szSpliced, aoMembers ) == (GLint)sizeof(FrameUniforms), "spliced stage has the whole block", a_riFailures );
+
+	delete[] szHeader;
+	delete[] szStage;
+	delete[] szSpliced;
+	delete[] szPlain;
+}
+
+// the std140 layout of the shared declaration against FrameUniforms, through
+// the same check BindFrameUniformBlock makes of a driver's offsets
+static void TestLayout( int& a_riFailures )
+{
+	std::string sHeaderPath = std::string( TEST_RESOURCE_DIRECTORY ) + g_szShaderHeaderPath;
+	char* szHeader = AIE::FileToBuffer( sHeaderPath.c_str() );
+	if( !Check( szHeader != nullptr, "header loads", a_riFailures ) )
+		return;
+
+	std::vector<Std140Member> aoLayout;
+	GLint iBlockSize = LayoutFrameData( szHeader, aoLayout );
+	delete[] szHeader;
+
+	Check( iBlockSize == (GLint)sizeof(FrameUniforms), "std140 size of FrameData is the struct's", a_riFailures );
+	if( !Check( aoLayout.size() == 13, "FrameData has 13 members", a_riFailures ) )
+		return;
+
+	const GLint aiExpected[] =
+	{
+		offsetof( FrameUniforms, mProjection	),
+		offsetof( FrameUniforms, mView			),
+		offsetof( FrameUniforms, mCameraMat		),
+		offsetof( FrameUniforms, vCameraPos		),
+		offsetof( FrameUniforms, vAmbientColour	),
+		offsetof( FrameUniforms, vDirLightDir	),
+		offsetof( FrameUniforms, vDirLightCol	),
+		offsetof( FrameUniforms, vPointLightPos	),
+		offsetof( FrameUniforms, vPointLightCol	),
+		offsetof( FrameUniforms, vSpotLightPos	),
+		offsetof( FrameUniforms, vSpotLightDir	),
+		offsetof( FrameUniforms, vSpotLightCol	),
+		offsetof( FrameUniforms, fTime			),
+	};
+	for( unsigned int i = 0; i < aoLayout.size(); ++i )
+	{
+		char acWhat[128];
+		sprintf( acWhat, "%s at %i matches the struct", aoLayout[i].sName.c_str(), aoLayout[i].iOffset );
+		Check( aoLayout[i].iOffset == aiExpected[i], acWhat, a_riFailures );
+	}
+
+	// BindFrameUniformBlock against a driver that packs the block by the rules
+	PFNGLGETUNIFORMBLOCKINDEXPROC		pfnGetUniformBlockIndex		= __glewGetUniformBlockIndex;
+	PFNGLUNIFORMBLOCKBINDINGPROC		pfnUniformBlockBinding		= __glewUniformBlockBinding;
+	PFNGLGETACTIVEUNIFORMBLOCKIVPROC	pfnGetActiveUniformBlockiv	= __glewGetActiveUniformBlockiv;
+	PFNGLGETUNIFORMINDICESPROC			pfnGetUniformIndices		= __glewGetUniformIndices;
+	PFNGLGETACTIVEUNIFORMSIVPROC		pfnGetActiveUniformsiv		= __glewGetActiveUniformsiv;
+	__glewGetUniformBlockIndex		= StubGetUniformBlockIndex;
+	__glewUniformBlockBinding		= StubUniformBlockBinding;
+	__glewGetActiveUniformBlockiv	= StubGetActiveUniformBlockiv;
+	__glewGetUniformIndices			= StubGetUniformIndices;
+	__glewGetActiveUniformsiv		= StubGetActiveUniformsiv;
+
+	s_oProgram.bHasBlock	= true;
+	s_oProgram.iBlockSize	= iBlockSize;
+	s_oProgram.aoMembers	= aoLayout;
+	s_oProgram.uiBindings	= 0;
+	Check( BindFrameUniformBlock( 1 ), "std140 packing passes the bind check", a_riFailures );
+	Check( s_oProgram.uiBindings == 1, "block is tied to its binding", a_riFailures );
+
+	// and the check notices when they part
+	s_oProgram.aoMembers.back().iOffset += 4;
+	Check( !BindFrameUniformBlock( 1 ), "a moved member fails the bind check", a_riFailures );
+	s_oProgram.aoMembers = aoLayout;
+	s_oProgram.iBlockSize += 16;
+	Check( !BindFrameUniformBlock( 1 ), "a different size fails the bind check", a_riFailures );
+	s_oProgram.iBlockSize = iBlockSize;
+	s_oProgram.aoMembers.erase( s_oProgram.aoMembers.begin() + 4 );
+	Check( !BindFrameUniformBlock( 1 ), "a missing member fails the bind check", a_riFailures );
+
+	s_oProgram.bHasBlock	= false;
+	s_oProgram.uiBindings	= 0;
+	Check( BindFrameUniformBlock( 1 ) && s_oProgram.uiBindings == 0, "a program without the block is left alone", a_riFailures );
+
+	__glewGetUniformBlockIndex		= pfnGetUniformBlockIndex;
+	__glewUniformBlockBinding		= pfnUniformBlockBinding;
+	__glewGetActiveUniformBlockiv	= pfnGetActiveUniformBlockiv;
+	__glewGetUniformIndices			= pfnGetUniformIndices;
+	__glewGetActiveUniformsiv		= pfnGetActiveUniformsiv;
+}
+
+int TestFrameUniforms()
+{
+	printf( "FrameUniforms\n" );
+	int iFailures = 0;
+
+	TestSplice( iFailures );
+	TestLayout( iFailures );
+
+	return iFailures;
+}
@@ -0,0 +1,105 @@
+#include "Tests.h"
+#include "Frustum.h"
+
+static Bounds MakeBounds( const AIE::vec4& a_vMin, const AIE::vec4& a_vMax, const AIE::vec4& a_vCentre, float a_fRadius )
+{
+	Bounds oBounds;
+	oBounds.vMin	= a_vMin;
+	oBounds.vMax	= a_vMax;
+	oBounds.vCentre	= a_vCentre;
+	oBounds.fRadius	= a_fRadius;
+	return oBounds;
+}
+
+// x in [-2, 2], y in [-3, 3] and z in [-11, -1], every plane known exactly
+static void TestOrthographic( int& a_riFailures )
+{
+	AIE::mat4 mProjection;
+	mProjection.Orthographic( -2.f, 2.f, 3.f, -3.f, 1.f, 11.f );
+	Frustum oFrustum;
+	oFrustum.Extract( mProjection );
+
+	Check( oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, -6.f, 1.f ), 0.5f ), "ortho sphere inside", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 5.f, 0.f, -6.f, 1.f ), 1.f ), "ortho sphere outside +x", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 0.f, -4.5f, -6.f, 1.f ), 1.f ), "ortho sphere outside -y", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, -13.f, 1.f ), 1.f ), "ortho sphere beyond far", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, 1.f, 1.f ), 1.f ), "ortho sphere before near", a_riFailures );
+	Check( oFrustum.TestSphere( AIE::vec4( 2.5f, 0.f, -6.f, 1.f ), 1.f ), "ortho sphere straddling x", a_riFailures );
+	Check( oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, -11.5f, 1.f ), 1.f ), "ortho sphere straddling far", a_riFailures );
+
+	// normalised planes make the radius a distance, 1 unit past a side
+	// only passes with a radius of more than 1
+	Check( !oFrustum.TestSphere( AIE::vec4( 3.f, 0.f, -6.f, 1.f ), 0.9f ), "ortho sphere 0.1 short of the plane", a_riFailures );
+	Check( oFrustum.TestSphere( AIE::vec4( 3.f, 0.f, -6.f, 1.f ), 1.1f ), "ortho sphere 0.1 over the plane", a_riFailures );
+
+	Check( oFrustum.TestAABB( AIE::vec4( -1.f, -1.f, -7.f, 1.f ), AIE::vec4( 1.f, 1.f, -5.f, 1.f ) ), "ortho box inside", a_riFailures );
+	Check( !oFrustum.TestAABB( AIE::vec4( 2.5f, -1.f, -7.f, 1.f ), AIE::vec4( 3.5f, 1.f, -5.f, 1.f ) ), "ortho box outside +x", a_riFailures );
+	Check( !oFrustum.TestAABB( AIE::vec4( -1.f, -1.f, -20.f, 1.f ), AIE::vec4( 1.f, 1.f, -12.f, 1.f ) ), "ortho box beyond far", a_riFailures );
+	Check( oFrustum.TestAABB( AIE::vec4( 1.5f, -1.f, -7.f, 1.f ), AIE::vec4( 2.5f, 1.f, -5.f, 1.f ) ), "ortho box straddling x", a_riFailures );
+	Check( oFrustum.TestAABB( AIE::vec4( -100.f, -100.f, -100.f, 1.f ), AIE::vec4( 100.f, 100.f, 100.f, 1.f ) ), "ortho box around everything", a_riFailures );
+
+	// the sphere reaches in past the corner, the box doesn't
+	Bounds oCorner = MakeBounds( AIE::vec4( 2.2f, 3.2f, -6.1f, 1.f ), AIE::vec4( 2.4f, 3.4f, -5.9f, 1.f ), AIE::vec4( 2.3f, 3.3f, -6.f, 1.f ), 0.6f );
+	Check( oFrustum.TestSphere( oCorner.vCentre, oCorner.fRadius ), "ortho corner sphere overlaps", a_riFailures );
+	Check( !oFrustum.IsVisible( oCorner ), "ortho corner box culls what the sphere doesn't", a_riFailures );
+}
+
+// looking down +z with a 90 degree square view, the sides are x = +/-z and
+// y = +/-z, the far plane is at 100
+static void TestPerspective( int& a_riFailures )
+{
+	AIE::mat4 mProjection;
+	mProjection.Perspective( AIE::PI / 2.f, 1.f, 1.f, 100.f );
+	Frustum oFrustum;
+	oFrustum.Extract( mProjection );
+
+	Check( oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, 50.f, 1.f ), 1.f ), "perspective sphere inside", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, -10.f, 1.f ), 1.f ), "perspective sphere behind", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, 200.f, 1.f ), 1.f ), "perspective sphere beyond far", a_riFailures );
+	Check( oFrustum.TestSphere( AIE::vec4( 52.f, 0.f, 50.f, 1.f ), 5.f ), "perspective sphere straddling x", a_riFailures );
+
+	// (60, 0, 50) is 10 / sqrt(2), about 7.07, outside x = z
+	Check( !oFrustum.TestSphere( AIE::vec4( 60.f, 0.f, 50.f, 1.f ), 7.f ), "perspective sphere short of a slanted plane", a_riFailures );
+	Check( oFrustum.TestSphere( AIE::vec4( 60.f, 0.f, 50.f, 1.f ), 7.2f ), "perspective sphere over a slanted plane", a_riFailures );
+
+	Check( oFrustum.TestAABB( AIE::vec4( -1.f, -1.f, 49.f, 1.f ), AIE::vec4( 1.f, 1.f, 51.f, 1.f ) ), "perspective box inside", a_riFailures );
+	Check( !oFrustum.TestAABB( AIE::vec4( 55.f, -1.f, 49.f, 1.f ), AIE::vec4( 57.f, 1.f, 51.f, 1.f ) ), "perspective box outside", a_riFailures );
+	Check( oFrustum.TestAABB( AIE::vec4( 49.f, -1.f, 49.f, 1.f ), AIE::vec4( 52.f, 1.f, 51.f, 1.f ) ), "perspective box straddling", a_riFailures );
+	Check( !oFrustum.TestAABB( AIE::vec4( -1.f, -1.f, -20.f, 1.f ), AIE::vec4( 1.f, 1.f, -10.f, 1.f ) ), "perspective box behind", a_riFailures );
+}
+
+// the two planes past the six are inside everything, before and after an
+// Extract, and a second Extract leaves nothing of the first
+static void TestPadding( int& a_riFailures )
+{
+	Frustum oEmpty;
+	Check( oEmpty.TestSphere( AIE::vec4( 1e6f, -1e6f, 1e6f, 1.f ), 0.f ), "no planes culls no sphere", a_riFailures );
+	Check( oEmpty.TestAABB( AIE::vec4( 1e6f, 1e6f, 1e6f, 1.f ), AIE::vec4( 1e6f, 1e6f, 1e6f, 1.f ) ), "no planes culls no box", a_riFailures );
+
+	AIE::mat4 mProjection;
+	mProjection.Orthographic( -2.f, 2.f, 3.f, -3.f, 1.f, 11.f );
+	Frustum oFrustum;
+	oFrustum.Extract( mProjection );
+
+	// a point and a flat box on the middle of the volume, anything the
+	// padding planes got wrong would show as a cull with no reach to spare
+	Check( oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, -6.f, 1.f ), 0.f ), "point sphere in the middle", a_riFailures );
+	Check( oFrustum.TestAABB( AIE::vec4( 0.f, 0.f, -6.f, 1.f ), AIE::vec4( 0.f, 0.f, -6.f, 1.f ) ), "point box in the middle", a_riFailures );
+
+	mProjection.Orthographic( 8.f, 12.f, 3.f, -3.f, 1.f, 11.f );
+	oFrustum.Extract( mProjection );
+	Check( oFrustum.TestSphere( AIE::vec4( 10.f, 0.f, -6.f, 1.f ), 0.f ), "second extract moves the planes", a_riFailures );
+	Check( !oFrustum.TestSphere( AIE::vec4( 0.f, 0.f, -6.f, 1.f ), 0.f ), "second extract drops the first", a_riFailures );
+}
+
+int TestFrustum()
+{
+	printf( "Frustum\n" );
+	int iFailures = 0;
+
+	TestOrthographic( iFailures );
+	TestPerspective( iFailures );
+	TestPadding( iFailures );
+
+	return iFailures;
+}
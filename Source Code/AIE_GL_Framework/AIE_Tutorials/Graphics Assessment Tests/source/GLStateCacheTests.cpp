@@ -0,0 +1,197 @@
+#include "Tests.h"
+#include "GLStateCache.h"
+
+#include <string.h>
+
+// what reached the mock table, the function pointers carry no context so
+// it's kept here
+struct MockGLCalls
+{
+	unsigned int	uiUseProgram;
+	unsigned int	uiBindVertexArray;
+	unsigned int	uiActiveTexture;
+	unsigned int	uiBindTexture;
+	unsigned int	uiEnable;
+	unsigned int	uiDisable;
+	unsigned int	uiDepthMask;
+	unsigned int	uiBlendFunc;
+	unsigned int	uiDeleteTextures;
+	unsigned int	uiDeleteVertexArrays;
+};
+
+static MockGLCalls s_oCalls;
+
+static void GLAPIENTRY MockUseProgram( GLuint )									{ ++s_oCalls.uiUseProgram; }
+static void GLAPIENTRY MockBindVertexArray( GLuint )							{ ++s_oCalls.uiBindVertexArray; }
+static void GLAPIENTRY MockActiveTexture( GLenum )								{ ++s_oCalls.uiActiveTexture; }
+static void GLAPIENTRY MockBindTexture( GLenum, GLuint )						{ ++s_oCalls.uiBindTexture; }
+static void GLAPIENTRY MockEnable( GLenum )										{ ++s_oCalls.uiEnable; }
+static void GLAPIENTRY MockDisable( GLenum )									{ ++s_oCalls.uiDisable; }
+static void GLAPIENTRY MockDepthMask( GLboolean )								{ ++s_oCalls.uiDepthMask; }
+static void GLAPIENTRY MockBlendFunc( GLenum, GLenum )							{ ++s_oCalls.uiBlendFunc; }
+static void GLAPIENTRY MockDeleteTextures( GLsizei, const GLuint* )				{ ++s_oCalls.uiDeleteTextures; }
+static void GLAPIENTRY MockDeleteVertexArrays( GLsizei, const GLuint* )		{ ++s_oCalls.uiDeleteVertexArrays; }
+
+// the default table with the state calls counted instead of made
+static GLStateFunctions GetMockFunctions()
+{
+	GLStateFunctions oFunctions = GetDefaultGLFunctions();
+	oFunctions.pfnUseProgram			= MockUseProgram;
+	oFunctions.pfnBindVertexArray		= MockBindVertexArray;
+	oFunctions.pfnActiveTexture			= MockActiveTexture;
+	oFunctions.pfnBindTexture			= MockBindTexture;
+	oFunctions.pfnEnable				= MockEnable;
+	oFunctions.pfnDisable				= MockDisable;
+	oFunctions.pfnDepthMask				= MockDepthMask;
+	oFunctions.pfnBlendFunc				= MockBlendFunc;
+	oFunctions.pfnDeleteTextures		= MockDeleteTextures;
+	oFunctions.pfnDeleteVertexArrays	= MockDeleteVertexArrays;
+	return oFunctions;
+}
+
+static void TestRedundant( GLStateCache& a_rCache, int& a_riFailures )
+{
+	memset( &s_oCalls, 0, sizeof(s_oCalls) );
+	a_rCache.BeginFrame();
+
+	a_rCache.UseProgram( 3 );
+	a_rCache.UseProgram( 3 );
+	a_rCache.UseProgram( 4 );
+	Check( s_oCalls.uiUseProgram == 2, "repeated program is skipped", a_riFailures );
+
+	a_rCache.BindVertexArray( 7 );
+	a_rCache.BindVertexArray( 7 );
+	a_rCache.BindVertexArray( 0 );
+	a_rCache.BindVertexArray( 0 );
+	Check( s_oCalls.uiBindVertexArray == 2, "repeated vertex array is skipped", a_riFailures );
+
+	// bindings are per unit and per target
+	a_rCache.ActiveTexture( GL_TEXTURE0 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 10 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 10 );
+	a_rCache.BindTexture( GL_TEXTURE_CUBE_MAP, 10 );
+	a_rCache.ActiveTexture( GL_TEXTURE1 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 10 );
+	a_rCache.ActiveTexture( GL_TEXTURE0 );
+	a_rCache.ActiveTexture( GL_TEXTURE0 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 10 );
+	Check( s_oCalls.uiActiveTexture == 3, "repeated active unit is skipped", a_riFailures );
+	Check( s_oCalls.uiBindTexture == 3, "texture kept per unit and target", a_riFailures );
+
+	// targets and units past what's cached always go through
+	a_rCache.BindTexture( GL_TEXTURE_3D, 10 );
+	a_rCache.BindTexture( GL_TEXTURE_3D, 10 );
+	a_rCache.ActiveTexture( GL_TEXTURE0 + MAX_CACHED_TEXTURE_UNITS );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 10 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 10 );
+	Check( s_oCalls.uiBindTexture == 7, "uncached targets and units pass through", a_riFailures );
+
+	a_rCache.Enable( GL_BLEND );
+	a_rCache.Enable( GL_BLEND );
+	a_rCache.Disable( GL_BLEND );
+	a_rCache.Disable( GL_BLEND );
+	a_rCache.Enable( GL_SCISSOR_TEST );
+	a_rCache.Enable( GL_SCISSOR_TEST );
+	Check( s_oCalls.uiEnable == 3 && s_oCalls.uiDisable == 1, "capabilities filtered, uncached ones passed", a_riFailures );
+
+	a_rCache.DepthMask( GL_TRUE );
+	a_rCache.DepthMask( GL_TRUE );
+	a_rCache.BlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	a_rCache.BlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	a_rCache.BlendFunc( GL_SRC_ALPHA, GL_ONE );
+	Check( s_oCalls.uiDepthMask == 1 && s_oCalls.uiBlendFunc == 2, "depth mask and blend func filtered", a_riFailures );
+
+	// the counts agree with what got through
+	const GLStateStats& rStats = a_rCache.GetFrameStats();
+	Check( rStats.auiIssued[ GL_STATE_CALL_PROGRAM ] == 2 && rStats.auiSkipped[ GL_STATE_CALL_PROGRAM ] == 1, "program counts", a_riFailures );
+	Check( rStats.auiIssued[ GL_STATE_CALL_TEXTURE ] == 7 && rStats.auiSkipped[ GL_STATE_CALL_TEXTURE ] == 2, "texture counts", a_riFailures );
+	Check( rStats.auiIssued[ GL_STATE_CALL_CAPABILITY ] == 4 && rStats.auiSkipped[ GL_STATE_CALL_CAPABILITY ] == 2, "capability counts", a_riFailures );
+
+	unsigned int uiMade =	s_oCalls.uiUseProgram + s_oCalls.uiBindVertexArray + s_oCalls.uiActiveTexture + s_oCalls.uiBindTexture +
+							s_oCalls.uiEnable + s_oCalls.uiDisable + s_oCalls.uiDepthMask + s_oCalls.uiBlendFunc;
+	Check( rStats.GetIssued() == uiMade, "every issued call reached GL", a_riFailures );
+	Check( rStats.GetSkipped() == 10, "every skipped call counted", a_riFailures );
+
+	a_rCache.BeginFrame();
+	Check( a_rCache.GetLastFrameStats().GetIssued() == uiMade && a_rCache.GetFrameStats().GetIssued() == 0, "begin frame keeps the last counts", a_riFailures );
+}
+
+static void TestInvalidate( GLStateCache& a_rCache, int& a_riFailures )
+{
+	a_rCache.UseProgram( 5 );
+	a_rCache.ActiveTexture( GL_TEXTURE2 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 20 );
+	a_rCache.Enable( GL_CULL_FACE );
+
+	memset( &s_oCalls, 0, sizeof(s_oCalls) );
+	a_rCache.Invalidate();
+	a_rCache.UseProgram( 5 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 20 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 20 );
+	a_rCache.ActiveTexture( GL_TEXTURE2 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 20 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 20 );
+	a_rCache.Enable( GL_CULL_FACE );
+	Check( s_oCalls.uiUseProgram == 1, "program goes through after invalidate", a_riFailures );
+	Check( s_oCalls.uiActiveTexture == 1, "active unit goes through after invalidate", a_riFailures );
+	Check( s_oCalls.uiBindTexture == 3, "textures pass through until the unit is known", a_riFailures );
+	Check( s_oCalls.uiEnable == 1, "capability goes through after invalidate", a_riFailures );
+
+	// swapping the table starts from nothing as well
+	GLStateFunctions oMock = GetMockFunctions();
+	a_rCache.SetFunctions( &oMock );
+	memset( &s_oCalls, 0, sizeof(s_oCalls) );
+	a_rCache.UseProgram( 5 );
+	Check( s_oCalls.uiUseProgram == 1, "program goes through after a new table", a_riFailures );
+}
+
+static void TestDelete( GLStateCache& a_rCache, int& a_riFailures )
+{
+	a_rCache.ActiveTexture( GL_TEXTURE0 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 30 );
+	a_rCache.ActiveTexture( GL_TEXTURE3 );
+	a_rCache.BindTexture( GL_TEXTURE_2D_ARRAY, 30 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 31 );
+	a_rCache.BindVertexArray( 40 );
+
+	memset( &s_oCalls, 0, sizeof(s_oCalls) );
+	GLuint auiTextures[] = { 0, 30 };
+	a_rCache.DeleteTextures( 2, auiTextures );
+	GLuint uiVertexArray = 40;
+	a_rCache.DeleteVertexArrays( 1, &uiVertexArray );
+	Check( s_oCalls.uiDeleteTextures == 1 && s_oCalls.uiDeleteVertexArrays == 1, "deletes are passed on", a_riFailures );
+
+	// GL reuses the names, the new objects must still be bound
+	a_rCache.BindTexture( GL_TEXTURE_2D_ARRAY, 30 );
+	a_rCache.ActiveTexture( GL_TEXTURE0 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 30 );
+	a_rCache.BindVertexArray( 40 );
+	Check( s_oCalls.uiBindTexture == 2, "a deleted texture is forgotten on every unit", a_riFailures );
+	Check( s_oCalls.uiBindVertexArray == 1, "a deleted vertex array is forgotten", a_riFailures );
+
+	// bindings of other textures are kept
+	a_rCache.ActiveTexture( GL_TEXTURE3 );
+	a_rCache.BindTexture( GL_TEXTURE_2D, 31 );
+	Check( s_oCalls.uiBindTexture == 2, "other textures stay bound", a_riFailures );
+
+	GLuint uiOther = 41;
+	a_rCache.DeleteVertexArrays( 1, &uiOther );
+	a_rCache.BindVertexArray( 40 );
+	Check( s_oCalls.uiBindVertexArray == 1, "deleting another vertex array keeps the binding", a_riFailures );
+}
+
+int TestGLStateCache()
+{
+	printf( "GLStateCache\n" );
+	int iFailures = 0;
+
+	GLStateFunctions oMock = GetMockFunctions();
+	GLStateCache oCache;
+	oCache.SetFunctions( &oMock );
+
+	TestRedundant( oCache, iFailures );
+	TestInvalidate( oCache, iFailures );
+	TestDelete( oCache, iFailures );
+
+	return iFailures;
+}
@@ -0,0 +1,67 @@
+#include "Tests.h"
+#include "HeightfieldGenerator.h"
+#include "JobSystem.h"
+
+#include <vector>
+#include <string.h>
+
+// The noise has no seed of its own, the persistence and octave count are
+// what pick one terrain over another
+struct NoiseSettings
+{
+	float	fPersistence;
+	int		iNumOctaves;
+	float	fHeightScale;
+};
+
+static const NoiseSettings s_aoSettings[] =
+{
+	{ 0.75f,	6,					160.f	},	// what TerrainNode uses
+	{ 0.5f,		1,					1.f		},
+	{ 0.9f,		11,					37.5f	},
+	{ 0.3f,		MAX_NOISE_OCTAVES,	-2.f	},
+};
+
+// widths either side of a multiple of the SIMD step and lengths either side
+// of a multiple of the job tile
+static const int s_aaiSizes[][2] =
+{
+	{ 1, 1 }, { 3, 5 }, { 4, 8 }, { 7, 9 }, { 17, 31 }, { 64, 64 }, { 100, 100 }, { 129, 65 },
+};
+
+static void CompareSizes( const char* a_szWhen, int& a_riFailures )
+{
+	for( unsigned int s = 0; s < sizeof(s_aoSettings) / sizeof(s_aoSettings[0]); ++s )
+	{
+		const NoiseSettings& rSettings = s_aoSettings[s];
+		for( unsigned int z = 0; z < sizeof(s_aaiSizes) / sizeof(s_aaiSizes[0]); ++z )
+		{
+			int iWidth	= s_aaiSizes[z][0];
+			int iLength	= s_aaiSizes[z][1];
+
+			// filled with something neither fills in to catch missed rows
+			std::vector<float> afBatched( iWidth * iLength, -12345.f );
+			std::vector<float> afScalar( iWidth * iLength, 54321.f );
+			GenerateHeightfield( &afBatched[0], iWidth, iLength, rSettings.fPersistence, rSettings.iNumOctaves, rSettings.fHeightScale );
+			GenerateHeightfieldScalar( &afScalar[0], iWidth, iLength, rSettings.fPersistence, rSettings.iNumOctaves, rSettings.fHeightScale );
+
+			char acWhat[128];
+			sprintf( acWhat, "%s, %ix%i with %i octaves at %g matches the scalar heights", a_szWhen, iWidth, iLength, rSettings.iNumOctaves, rSettings.fPersistence );
+			Check( memcmp( &afBatched[0], &afScalar[0], afBatched.size() * sizeof(float) ) == 0, acWhat, a_riFailures );
+		}
+	}
+}
+
+int TestHeightfield()
+{
+	printf( "Heightfield\n" );
+	int iFailures = 0;
+
+	GetJobSystem().Start();
+	CompareSizes( "job system", iFailures );
+	GetJobSystem().Stop();
+
+	CompareSizes( "single thread", iFailures );
+
+	return iFailures;
+}
@@ -0,0 +1,348 @@
+#include "Tests.h"
+#include "JobSystem.h"
+
+#include <intrin.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#pragma intrinsic( _InterlockedIncrement, _InterlockedDecrement, _InterlockedExchange )
+
+static const unsigned int	QUEUE_TEST_JOBS		= 200000;
+static const unsigned int	QUEUE_TEST_THIEVES	= 3;
+static const unsigned int	TREE_TEST_ROUNDS	= 200;
+static const unsigned int	TREE_TEST_PARENTS	= 50;
+static const unsigned int	TREE_TEST_CHILDREN	= 20;
+static const unsigned int	NESTED_OUTER_COUNT	= 32;
+static const unsigned int	NESTED_INNER_COUNT	= 256;
+static const unsigned int	NESTED_INNER_GRAIN	= 16;
+static const unsigned int	STOP_TEST_JOBS		= 2000;
+static const unsigned int	BENCHMARK_COUNT		= 1 << 18;
+
+//////////////////////////////////////////////////////////////////////////
+// one owner pushing and popping while thieves steal, every job has to come
+// out exactly once
+struct QueueTest
+{
+	WorkStealingQueue	oQueue;
+	Job*				aoJobs;
+	volatile long		lTaken;
+	volatile long		lDone;
+};
+
+// lUnfinished counts how often a job came out, it should end at 1
+static void TakeJob( QueueTest* a_poTest, Job* a_poJob )
+{
+	_InterlockedIncrement( &a_poJob->lUnfinished );
+	_InterlockedIncrement( &a_poTest->lTaken );
+}
+
+static void GLFWCALL QueueThief( void* a_pTest )
+{
+	QueueTest* poTest = (QueueTest*)a_pTest;
+
+	// the owner is only done once it has emptied the queue, so nothing
+	// stolen after that means there's nothing left
+	for( ;; )
+	{
+		bool bDone = poTest->lDone != 0;
+		Job* poJob = poTest->oQueue.Steal();
+		if( poJob != nullptr )
+			TakeJob( poTest, poJob );
+		else if( bDone )
+			break;
+	}
+}
+
+static void TestQueueContention( int& a_riFailures )
+{
+	QueueTest* poTest = new QueueTest;
+	poTest->aoJobs	= new Job[ QUEUE_TEST_JOBS ];
+	poTest->lTaken	= 0;
+	poTest->lDone	= 0;
+	for( unsigned int i = 0; i < QUEUE_TEST_JOBS; ++i )
+	{
+		poTest->aoJobs[i].lUnfinished = 0;
+	}
+
+	GLFWthread aiThieves[ QUEUE_TEST_THIEVES ];
+	for( unsigned int i = 0; i < QUEUE_TEST_THIEVES; ++i )
+	{
+		aiThieves[i] = glfwCreateThread( QueueThief, poTest );
+	}
+
+	// pushes in bursts and pops every third job back, never letting more
+	// than half the ring be in the queue at once
+	unsigned int uiPushed = 0;
+	while( uiPushed < QUEUE_TEST_JOBS )
+	{
+		if( (long)uiPushed - poTest->lTaken > (long)( MAX_JOBS_PER_THREAD / 2 ) )
+		{
+			Job* poJob = poTest->oQueue.Pop();
+			if( poJob != nullptr )
+				TakeJob( poTest, poJob );
+			continue;
+		}
+
+		unsigned int uiBurst = 1 + uiPushed % 61;
+		for( unsigned int i = 0; i < uiBurst && uiPushed < QUEUE_TEST_JOBS; ++i )
+		{
+			poTest->oQueue.Push( &poTest->aoJobs[ uiPushed++ ] );
+		}
+
+		for( unsigned int i = 0; i < uiBurst / 3; ++i )
+		{
+			Job* poJob = poTest->oQueue.Pop();
+			if( poJob != nullptr )
+				TakeJob( poTest, poJob );
+		}
+	}
+
+	// the owner races the thieves for what's left
+	Job* poJob = poTest->oQueue.Pop();
+	while( poJob != nullptr )
+	{
+		TakeJob( poTest, poJob );
+		poJob = poTest->oQueue.Pop();
+	}
+	_InterlockedExchange( &poTest->lDone, 1 );
+
+	for( unsigned int i = 0; i < QUEUE_TEST_THIEVES; ++i )
+	{
+		if( aiThieves[i] >= 0 )
+			glfwWaitThread( aiThieves[i], GLFW_WAIT );
+	}
+
+	unsigned int uiWrong = 0;
+	for( unsigned int i = 0; i < QUEUE_TEST_JOBS; ++i )
+	{
+		if( poTest->aoJobs[i].lUnfinished != 1 )
+			++uiWrong;
+	}
+	Check( uiWrong == 0, "every queued job taken exactly once", a_riFailures );
+	Check( poTest->lTaken == (long)QUEUE_TEST_JOBS, "as many jobs taken as pushed", a_riFailures );
+
+	delete[] poTest->aoJobs;
+	delete poTest;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static volatile long s_lLeaves = 0;
+
+static void LeafJob( Job* a_poJob, const void* a_pData )
+{
+	_InterlockedIncrement( &s_lLeaves );
+}
+
+// children are made from inside the parent, so from whichever thread took it
+static void ParentJob( Job* a_poJob, const void* a_pData )
+{
+	JobSystem& rJobs = GetJobSystem();
+	for( unsigned int i = 0; i < TREE_TEST_CHILDREN; ++i )
+	{
+		rJobs.Run( rJobs.CreateChildJob( a_poJob, LeafJob ) );
+	}
+}
+
+static void TestJobTrees( int& a_riFailures )
+{
+	JobSystem& rJobs = GetJobSystem();
+
+	unsigned int uiWrongRounds = 0;
+	for( unsigned int uiRound = 0; uiRound < TREE_TEST_ROUNDS; ++uiRound )
+	{
+		s_lLeaves = 0;
+
+		Job* poRoot = rJobs.CreateJob( LeafJob );
+		for( unsigned int i = 0; i < TREE_TEST_PARENTS; ++i )
+		{
+			rJobs.Run( rJobs.CreateChildJob( poRoot, ParentJob ) );
+		}
+		rJobs.Run( poRoot );
+		rJobs.Wait( poRoot );
+
+		if( s_lLeaves != (long)( 1 + TREE_TEST_PARENTS * TREE_TEST_CHILDREN ) )
+			++uiWrongRounds;
+	}
+	Check( uiWrongRounds == 0, "a waited on job's whole tree has run", a_riFailures );
+}
+
+//////////////////////////////////////////////////////////////////////////
+struct NestedTest
+{
+	volatile long	aalHits[ NESTED_OUTER_COUNT ][ NESTED_INNER_COUNT ];
+	volatile long	lGrainsWrong;
+};
+
+struct NestedRow
+{
+	NestedTest*		poTest;
+	unsigned int	uiRow;
+};
+
+static void InnerRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pRow )
+{
+	NestedRow* poRow = (NestedRow*)a_pRow;
+
+	if( a_uiBegin % NESTED_INNER_GRAIN != 0 || a_uiEnd - a_uiBegin > NESTED_INNER_GRAIN )
+		_InterlockedIncrement( &poRow->poTest->lGrainsWrong );
+
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		_InterlockedIncrement( &poRow->poTest->aalHits[ poRow->uiRow ][i] );
+	}
+}
+
+// a ParallelFor from inside a ParallelFor's range, on a worker or not
+static void OuterRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pTest )
+{
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		NestedRow oRow;
+		oRow.poTest	= (NestedTest*)a_pTest;
+		oRow.uiRow	= i;
+		GetJobSystem().ParallelFor( NESTED_INNER_COUNT, NESTED_INNER_GRAIN, InnerRange, &oRow );
+	}
+}
+
+static void TestNestedParallelFor( int& a_riFailures )
+{
+	NestedTest* poTest = new NestedTest;
+	memset( (void*)poTest, 0, sizeof(NestedTest) );
+
+	GetJobSystem().ParallelFor( NESTED_OUTER_COUNT, 1, OuterRange, poTest );
+
+	unsigned int uiWrong = 0;
+	for( unsigned int i = 0; i < NESTED_OUTER_COUNT; ++i )
+	{
+		for( unsigned int j = 0; j < NESTED_INNER_COUNT; ++j )
+		{
+			if( poTest->aalHits[i][j] != 1 )
+				++uiWrong;
+		}
+	}
+	Check( uiWrong == 0, "nested ParallelFor covers every index once", a_riFailures );
+	Check( poTest->lGrainsWrong == 0, "nested ranges start on a grain and fit in one", a_riFailures );
+
+	delete poTest;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static volatile long s_lSlowRun = 0;
+
+static void SlowJob( Job* a_poJob, const void* a_pData )
+{
+	glfwSleep( 0.001 );
+	_InterlockedIncrement( &s_lSlowRun );
+}
+
+static std::vector<long> s_alHits;
+
+static void HitRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pData )
+{
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		_InterlockedIncrement( &s_alHits[i] );
+	}
+}
+
+// Stop doesn't wait on what's queued, it lets each worker finish the job
+// it's on and leaves the rest. A restart has to begin from empty queues.
+static void TestStopWithQueuedJobs( int& a_riFailures )
+{
+	JobSystem& rJobs = GetJobSystem();
+
+	s_lSlowRun = 0;
+	for( unsigned int i = 0; i < STOP_TEST_JOBS; ++i )
+	{
+		rJobs.Run( rJobs.CreateJob( SlowJob ) );
+	}
+	rJobs.Stop();
+
+	long lRun = s_lSlowRun;
+	Check( !rJobs.IsRunning(), "Stop returns with jobs still queued", a_riFailures );
+	Check( lRun < (long)STOP_TEST_JOBS, "queued jobs left behind by Stop", a_riFailures );
+
+	// nothing left behind may run after Stop has returned
+	glfwSleep( 0.05 );
+	Check( s_lSlowRun == lRun, "no job runs after Stop", a_riFailures );
+
+	rJobs.Start();
+	s_alHits.assign( 100000, 0 );
+	rJobs.ParallelFor( (unsigned int)s_alHits.size(), 64, HitRange, nullptr );
+
+	unsigned int uiWrong = 0;
+	for( unsigned int i = 0; i < s_alHits.size(); ++i )
+	{
+		if( s_alHits[i] != 1 )
+			++uiWrong;
+	}
+	Check( uiWrong == 0, "a restarted job system runs a ParallelFor", a_riFailures );
+}
+
+int TestJobSystem()
+{
+	printf( "JobSystem\n" );
+	int iFailures = 0;
+
+	TestQueueContention( iFailures );
+
+	GetJobSystem().Start();
+	TestJobTrees( iFailures );
+	TestNestedParallelFor( iFailures );
+	TestStopWithQueuedJobs( iFailures );
+	GetJobSystem().Stop();
+
+	return iFailures;
+}
+
+//////////////////////////////////////////////////////////////////////////
+static void BenchmarkRange( unsigned int a_uiBegin, unsigned int a_uiEnd, void* a_pData )
+{
+	float* pfValues = (float*)a_pData;
+	for( unsigned int i = a_uiBegin; i < a_uiEnd; ++i )
+	{
+		float fValue = pfValues[i];
+		for( unsigned int j = 0; j < 200; ++j )
+		{
+			fValue = sinf( fValue ) + 1.f;
+		}
+		pfValues[i] = fValue;
+	}
+}
+
+void BenchmarkJobSystem()
+{
+	printf( "JobSystem scaling, %u items\n", BENCHMARK_COUNT );
+
+	JobSystem& rJobs = GetJobSystem();
+	std::vector<float> afValues( BENCHMARK_COUNT, 0.5f );
+
+	unsigned int uiProcessors = (unsigned int)glfwGetNumberOfProcessors();
+	if( uiProcessors > MAX_JOB_THREADS )
+		uiProcessors = MAX_JOB_THREADS;
+
+	double dSingle = 0.0;
+	for( unsigned int uiThreads = 1; uiThreads <= uiProcessors; uiThreads *= 2 )
+	{
+		// one thread is the calling thread on its own
+		if( uiThreads > 1 )
+			rJobs.Start( uiThreads - 1 );
+
+		// the best of a few runs, the first warms the workers up
+		double dBest = 0.0;
+		for( unsigned int uiRun = 0; uiRun < 5; ++uiRun )
+		{
+			double dStart = glfwGetTime();
+			rJobs.ParallelFor( (unsigned int)afValues.size(), 1024, BenchmarkRange, &afValues[0] );
+			double dTime = glfwGetTime() - dStart;
+			if( uiRun == 0 || dTime < dBest )
+				dBest = dTime;
+		}
+		rJobs.Stop();
+
+		if( uiThreads == 1 )
+			dSingle = dBest;
+		printf( "  %2u threads: %8.2f ms, %5.2fx\n", uiThreads, dBest * 1000.0, dSingle / dBest );
+	}
+}
@@ -0,0 +1,113 @@
+#include "Tests.h"
+#include "ParticleStore.h"
+
+#include <GL\glfw.h>
+#include <string.h>
+
+static const unsigned int TEST_PARTICLES		= 1000;
+static const unsigned int BENCHMARK_PARTICLES	= 1 << 18;
+static const unsigned int BENCHMARK_STEPS		= 100;
+
+// the same spread of particles every time, some already out of energy
+static void FillStore( ParticleStore& a_rStore, unsigned int a_uiCount )
+{
+	a_rStore.Allocate( a_uiCount );
+	for( unsigned int i = 0; i < a_uiCount; ++i )
+	{
+		float fValue = (float)( ( i * 37 ) % 101 ) / 101.f;
+		a_rStore.afPosX[i]		= fValue * 10.f - 5.f;
+		a_rStore.afPosY[i]		= fValue * 3.f;
+		a_rStore.afPosZ[i]		= 5.f - fValue * 7.f;
+		a_rStore.afVelX[i]		= fValue - 0.5f;
+		a_rStore.afVelY[i]		= fValue * 2.f;
+		a_rStore.afVelZ[i]		= 0.25f - fValue;
+		a_rStore.afEnergy[i]	= fValue * 4.f - 0.5f;
+		a_rStore.afAlpha[i]		= 0.f;
+	}
+}
+
+// every stream the kernel writes, compared bit for bit
+static bool StoresMatch( const ParticleStore& a_rA, const ParticleStore& a_rB )
+{
+	size_t uiBytes = a_rA.uiCount * sizeof(float);
+	return a_rA.uiCount == a_rB.uiCount &&
+		memcmp( a_rA.afPosX, a_rB.afPosX, uiBytes ) == 0 &&
+		memcmp( a_rA.afPosY, a_rB.afPosY, uiBytes ) == 0 &&
+		memcmp( a_rA.afPosZ, a_rB.afPosZ, uiBytes ) == 0 &&
+		memcmp( a_rA.afVelX, a_rB.afVelX, uiBytes ) == 0 &&
+		memcmp( a_rA.afVelY, a_rB.afVelY, uiBytes ) == 0 &&
+		memcmp( a_rA.afVelZ, a_rB.afVelZ, uiBytes ) == 0 &&
+		memcmp( a_rA.afEnergy, a_rB.afEnergy, uiBytes ) == 0 &&
+		memcmp( a_rA.afAlpha, a_rB.afAlpha, uiBytes ) == 0;
+}
+
+static ParticleStep GetStep()
+{
+	ParticleStep oStep;
+	oStep.vAcceleration	= AIE::vec4( 0.3f, -9.8f, 0.1f, 0.f );
+	oStep.fDeltaTime	= 1.f / 60.f;
+	oStep.fAlphaScale	= 0.5f;
+	oStep.fAlphaMax		= 0.4f;
+	return oStep;
+}
+
+int TestParticleStore()
+{
+	printf( "ParticleStore\n" );
+	int iFailures = 0;
+
+	ParticleStep oStep = GetStep();
+
+	// ranges that start and end part way through a SIMD step, as well as
+	// whole ones and ones too short to hold a step
+	const unsigned int auiRanges[][2] = { { 0, TEST_PARTICLES }, { 0, 3 }, { 1, 2 }, { 3, 9 }, { 5, 514 }, { 6, 994 } };
+	for( unsigned int r = 0; r < sizeof(auiRanges) / sizeof(auiRanges[0]); ++r )
+	{
+		ParticleStore oSimd, oScalar;
+		FillStore( oSimd, TEST_PARTICLES );
+		FillStore( oScalar, TEST_PARTICLES );
+
+		for( unsigned int uiStep = 0; uiStep < 10; ++uiStep )
+		{
+			IntegrateParticles( oSimd, auiRanges[r][0], auiRanges[r][1], oStep );
+			IntegrateParticlesScalar( oScalar, auiRanges[r][0], auiRanges[r][1], oStep );
+		}
+
+		char acWhat[128];
+		sprintf( acWhat, "%u particles from %u match the scalar step", auiRanges[r][1], auiRanges[r][0] );
+		Check( StoresMatch( oSimd, oScalar ), acWhat, iFailures );
+	}
+
+	return iFailures;
+}
+
+void BenchmarkParticleStore()
+{
+	printf( "IntegrateParticles, %u particles\n", BENCHMARK_PARTICLES );
+
+	ParticleStep oStep = GetStep();
+	ParticleStore oStore;
+	FillStore( oStore, BENCHMARK_PARTICLES );
+
+	// the best of a few runs of each, the first warms the cache up
+	double dScalar = 0.0, dSimd = 0.0;
+	for( unsigned int uiRun = 0; uiRun < 5; ++uiRun )
+	{
+		double dStart = glfwGetTime();
+		for( unsigned int i = 0; i < BENCHMARK_STEPS; ++i )
+			IntegrateParticlesScalar( oStore, 0, BENCHMARK_PARTICLES, oStep );
+		double dTime = glfwGetTime() - dStart;
+		if( uiRun == 0 || dTime < dScalar )
+			dScalar = dTime;
+
+		dStart = glfwGetTime();
+		for( unsigned int i = 0; i < BENCHMARK_STEPS; ++i )
+			IntegrateParticles( oStore, 0, BENCHMARK_PARTICLES, oStep );
+		dTime = glfwGetTime() - dStart;
+		if( uiRun == 0 || dTime < dSimd )
+			dSimd = dTime;
+	}
+
+	printf( "  scalar: %8.2f ms a step\n", dScalar * 1000.0 / BENCHMARK_STEPS );
+	printf( "  SIMD:   %8.2f ms a step, %5.2fx\n", dSimd * 1000.0 / BENCHMARK_STEPS, dScalar / dSimd );
+}
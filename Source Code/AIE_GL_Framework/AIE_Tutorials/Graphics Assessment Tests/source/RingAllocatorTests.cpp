@@ -0,0 +1,155 @@
+#include "Tests.h"
+#include "StreamBuffer.h"
+
+#include <vector>
+
+// Fences the test signals itself. Any fence inserted is unsignalled until
+// Signal, unless the GPU is set to catch up during a wait with a timeout.
+class FakeFenceSource : public IFenceSource
+{
+public:
+	FakeFenceSource() : m_uiInserted( 0 ), m_uiWaits( 0 ), m_uiDeleted( 0 ), m_bCatchUp( false ) {}
+
+	GLsync Insert()
+	{
+		++m_uiInserted;
+		m_abSignalled.push_back( false );
+		return (GLsync)(size_t)m_uiInserted;
+	}
+
+	bool Wait( GLsync a_pFence, GLuint64 a_ulTimeout )
+	{
+		++m_uiWaits;
+		unsigned int uiIndex = (unsigned int)(size_t)a_pFence - 1;
+		if( a_ulTimeout > 0 && m_bCatchUp )
+			m_abSignalled[ uiIndex ] = true;
+		return m_abSignalled[ uiIndex ];
+	}
+
+	void Delete( GLsync a_pFence )
+	{
+		++m_uiDeleted;
+	}
+
+	void SignalAll()
+	{
+		for( unsigned int i = 0; i < m_abSignalled.size(); ++i )
+			m_abSignalled[i] = true;
+	}
+
+	unsigned int GetLive() const { return m_uiInserted - m_uiDeleted; }
+
+	unsigned int		m_uiInserted;
+	unsigned int		m_uiWaits;
+	unsigned int		m_uiDeleted;
+	bool				m_bCatchUp;		// fences signal while waited on with a timeout
+	std::vector<bool>	m_abSignalled;
+};
+
+static const unsigned int TEST_SEGMENT_SIZE = 100;
+
+static void TestAllocate( int& a_riFailures )
+{
+	FakeFenceSource oFences;
+	RingAllocator oRing( &oFences );
+	oRing.Init( TEST_SEGMENT_SIZE, 3 );
+
+	Check( oRing.Allocate( 4, 4 ) == RingAllocator::NO_SPACE, "nothing before the first segment", a_riFailures );
+
+	Check( oRing.BeginSegment(), "first segment is free", a_riFailures );
+	Check( oRing.GetSegment() == 0 && oRing.GetSegmentStart() == 0, "first segment is segment 0", a_riFailures );
+	Check( oRing.Allocate( 10, 1 ) == 0, "first allocation at the start", a_riFailures );
+	Check( oRing.Allocate( 7, 6 ) == 12, "alignment of 6 rounds 10 up to 12", a_riFailures );
+	Check( oRing.Allocate( 5, 7 ) == 21, "alignment of 7 rounds 19 up to 21", a_riFailures );
+	Check( oRing.Allocate( 3, 0 ) == 26, "alignment of 0 is treated as 1", a_riFailures );
+	Check( oRing.GetUsed() == 29, "used counts the padding", a_riFailures );
+
+	Check( oRing.Allocate( 72, 1 ) == RingAllocator::NO_SPACE, "one byte too many is turned down", a_riFailures );
+	Check( oRing.GetFailures() == 2, "turned down allocations are counted", a_riFailures );
+	Check( oRing.Allocate( 71, 1 ) == 29, "exactly the rest fits", a_riFailures );
+	Check( oRing.Allocate( 0, 1 ) == 100, "an empty allocation fits at the end", a_riFailures );
+	Check( oRing.Allocate( 0, 3 ) == RingAllocator::NO_SPACE, "aligning past the end is turned down", a_riFailures );
+	oRing.EndSegment();
+
+	// alignment is from the start of the whole buffer, not the segment
+	oRing.BeginSegment();
+	Check( oRing.GetSegmentStart() == TEST_SEGMENT_SIZE, "second segment starts after the first", a_riFailures );
+	Check( oRing.Allocate( 1, 6 ) == 102, "alignment of 6 in the second segment", a_riFailures );
+	Check( oRing.Allocate( 1, 64 ) == 128, "alignment of 64 in the second segment", a_riFailures );
+	oRing.EndSegment();
+
+	oRing.Reset();
+	Check( oFences.GetLive() == 0, "reset deletes the fences still out", a_riFailures );
+}
+
+static void TestWrap( int& a_riFailures )
+{
+	FakeFenceSource oFences;
+	RingAllocator oRing( &oFences );
+	oRing.Init( TEST_SEGMENT_SIZE, 3 );
+
+	// the first time round there's nothing to wait for
+	for( unsigned int i = 0; i < 3; ++i )
+	{
+		Check( oRing.BeginSegment(), "unfenced segment is free", a_riFailures );
+		Check( oRing.GetSegment() == i, "segments are used in turn", a_riFailures );
+		oRing.EndSegment();
+	}
+	Check( oFences.m_uiInserted == 3 && oFences.m_uiWaits == 0, "a fence per segment and no waits", a_riFailures );
+
+	// back round to segment 0, whose frame the GPU has finished
+	oFences.SignalAll();
+	Check( oRing.BeginSegment(), "signalled segment is free", a_riFailures );
+	Check( oRing.GetSegment() == 0 && oRing.GetSegmentStart() == 0, "wraps round to segment 0", a_riFailures );
+	Check( oRing.GetStalls() == 0 && oFences.m_uiWaits == 1, "a signalled fence takes one wait", a_riFailures );
+	Check( oFences.m_uiDeleted == 1, "the passed fence is deleted", a_riFailures );
+	Check( oRing.GetUsed() == 0 && oRing.Allocate( TEST_SEGMENT_SIZE, 1 ) == 0, "the wrapped segment is empty again", a_riFailures );
+
+	// beginning without ending fences the segment on the way
+	oRing.BeginSegment();
+	Check( oFences.m_uiInserted == 4, "begin ends the open segment", a_riFailures );
+	oRing.EndSegment();
+	oRing.EndSegment();
+	Check( oFences.m_uiInserted == 5, "ending twice fences once", a_riFailures );
+}
+
+static void TestStall( int& a_riFailures )
+{
+	FakeFenceSource oFences;
+	RingAllocator oRing( &oFences );
+	oRing.Init( TEST_SEGMENT_SIZE, 2 );
+
+	oRing.BeginSegment();
+	oRing.EndSegment();
+	oRing.BeginSegment();
+	oRing.EndSegment();
+
+	// segment 0's fence never signals, the timeout runs out
+	Check( !oRing.BeginSegment( 1000 ), "an unsignalled fence times out", a_riFailures );
+	Check( oRing.GetStalls() == 1, "the stall is counted", a_riFailures );
+	Check( oFences.m_uiWaits == 2, "a poll then a wait with the timeout", a_riFailures );
+	Check( oFences.m_uiDeleted == 1, "the timed out fence is deleted anyway", a_riFailures );
+	Check( oRing.GetSegment() == 0 && oRing.Allocate( 8, 8 ) == 0, "the segment is used anyway", a_riFailures );
+	oRing.EndSegment();
+
+	// segment 1 catches up while it's waited on
+	oFences.m_bCatchUp = true;
+	Check( oRing.BeginSegment( 1000 ), "a fence that signals in the wait is free", a_riFailures );
+	Check( oRing.GetStalls() == 2, "catching up still counts as a stall", a_riFailures );
+	oRing.EndSegment();
+
+	oRing.Reset();
+	Check( oFences.GetLive() == 0, "no fences left after reset", a_riFailures );
+}
+
+int TestRingAllocator()
+{
+	printf( "RingAllocator\n" );
+	int iFailures = 0;
+
+	TestAllocate( iFailures );
+	TestWrap( iFailures );
+	TestStall( iFailures );
+
+	return iFailures;
+}
@@ -0,0 +1,162 @@
+#include "Tests.h"
+#include "ShaderReflection.h"
+
+#include <vector>
+#include <string.h>
+
+// what the stub driver reports for the program being reflected, in the
+// order glGetActiveUniform hands them out
+struct StubUniform
+{
+	const char*	szName;
+	GLenum		eType;
+	GLint		iSize;
+	GLint		iLocation;
+};
+
+static std::vector<StubUniform>	s_aoUniforms;
+static unsigned int				s_uiLocationCalls;
+
+static void GLAPIENTRY StubGetProgramiv( GLuint, GLenum a_ePName, GLint* a_piParams )
+{
+	*a_piParams = 0;
+	if( a_ePName == GL_ACTIVE_UNIFORMS )
+	{
+		*a_piParams = (GLint)s_aoUniforms.size();
+	}
+	else if( a_ePName == GL_ACTIVE_UNIFORM_MAX_LENGTH )
+	{
+		// counts the terminator, as drivers do
+		for( unsigned int i = 0; i < s_aoUniforms.size(); ++i )
+		{
+			GLint iLength = (GLint)strlen( s_aoUniforms[i].szName ) + 1;
+			*a_piParams = iLength > *a_piParams ? iLength : *a_piParams;
+		}
+	}
+}
+
+static void GLAPIENTRY StubGetActiveUniform( GLuint, GLuint a_uiIndex, GLsizei a_iBufSize, GLsizei* a_piLength, GLint* a_piSize, GLenum* a_peType, GLchar* a_szName )
+{
+	const StubUniform& rUniform = s_aoUniforms[ a_uiIndex ];
+	GLsizei iLength = (GLsizei)strlen( rUniform.szName );
+	iLength = iLength < a_iBufSize ? iLength : a_iBufSize - 1;
+	memcpy( a_szName, rUniform.szName, iLength );
+	a_szName[ iLength ] = 0;
+	*a_piLength	= iLength;
+	*a_piSize	= rUniform.iSize;
+	*a_peType	= rUniform.eType;
+}
+
+static GLint GLAPIENTRY StubGetUniformLocation( GLuint, const GLchar* a_szName )
+{
+	++s_uiLocationCalls;
+	for( unsigned int i = 0; i < s_aoUniforms.size(); ++i )
+	{
+		if( strcmp( s_aoUniforms[i].szName, a_szName ) == 0 )
+			return s_aoUniforms[i].iLocation;
+	}
+	return -1;
+}
+
+static void TestNames( int& a_riFailures )
+{
+	const StubUniform aoUniforms[] =
+	{
+		{ "Model",					GL_FLOAT_MAT4,	1,	0	},
+		{ "boneArray[0]",			GL_FLOAT_MAT4,	32,	1	},
+		{ "lights[0].colour",		GL_FLOAT_VEC4,	1,	33	},
+		{ "lights[0].position",		GL_FLOAT_VEC4,	1,	34	},
+		{ "lights[1].colour",		GL_FLOAT_VEC4,	1,	35	},
+		{ "lights[1].position",		GL_FLOAT_VEC4,	1,	36	},
+		{ "material.weights[0]",	GL_FLOAT,		4,	37	},
+		{ "Projection",				GL_FLOAT_MAT4,	1,	-1	},	// a FrameData member
+		{ "diffuseTexture",			GL_SAMPLER_2D,	1,	41	},
+	};
+	s_aoUniforms.assign( aoUniforms, aoUniforms + sizeof(aoUniforms) / sizeof(aoUniforms[0]) );
+
+	ShaderReflection oReflection;
+	s_uiLocationCalls = 0;
+	oReflection.Reflect( 7 );
+	unsigned int uiReflectCalls = s_uiLocationCalls;
+
+	Check( oReflection.GetProgram() == 7, "program is kept", a_riFailures );
+	Check( oReflection.GetUniformCount() == 8, "block members are skipped", a_riFailures );
+	Check( oReflection.FindUniform( "Projection" ) == nullptr, "block member can't be found", a_riFailures );
+
+	// struct array members keep their whole name and don't collide
+	Check( oReflection.FindLocation( "lights[0].colour" ) == 33, "lights[0].colour", a_riFailures );
+	Check( oReflection.FindLocation( "lights[0].position" ) == 34, "lights[0].position", a_riFailures );
+	Check( oReflection.FindLocation( "lights[1].colour" ) == 35, "lights[1].colour", a_riFailures );
+	Check( oReflection.FindLocation( "lights[1].position" ) == 36, "lights[1].position", a_riFailures );
+	Check( oReflection.FindLocation( "lights" ) == -1 && oReflection.FindLocation( "lights[0]" ) == -1, "struct array has no base entry", a_riFailures );
+
+	// plain arrays are found by their base name or their first element
+	const UniformInfo* pBones = oReflection.FindUniform( "boneArray" );
+	Check( pBones != nullptr && pBones->sName == "boneArray" && pBones->iSize == 32 && pBones->eType == GL_FLOAT_MAT4, "array under its base name", a_riFailures );
+	Check( oReflection.FindUniform( "boneArray[0]" ) == pBones, "first element finds the array", a_riFailures );
+	Check( oReflection.FindLocation( "boneArray[1]" ) == -1, "later elements aren't entries", a_riFailures );
+	Check( oReflection.FindLocation( "material.weights" ) == 37, "array member of a struct", a_riFailures );
+
+	// handles resolve through the same table
+	Check( oReflection.GetLocation( UNIFORM_MODEL ) == 0, "Model handle", a_riFailures );
+	Check( oReflection.GetLocation( UNIFORM_BONE_ARRAY ) == 1, "boneArray handle", a_riFailures );
+	Check( oReflection.GetLocation( UNIFORM_DIFFUSE_TEXTURE ) == 41, "diffuseTexture handle", a_riFailures );
+	Check( oReflection.GetLocation( UNIFORM_COLOUR ) == -1, "unused handle is -1", a_riFailures );
+	Check( oReflection.FindLocation( "Mode" ) == -1 && oReflection.FindLocation( "" ) == -1, "unknown names are -1", a_riFailures );
+
+	// lookups after Reflect() never reach GL
+	Check( uiReflectCalls == s_aoUniforms.size() && s_uiLocationCalls == uiReflectCalls, "only Reflect() asks GL", a_riFailures );
+
+	// reflecting another program starts over
+	s_aoUniforms.resize( 1 );
+	oReflection.Reflect( 8 );
+	Check( oReflection.GetUniformCount() == 1 && oReflection.GetLocation( UNIFORM_BONE_ARRAY ) == -1, "reflect again replaces the uniforms", a_riFailures );
+	Check( oReflection.FindUniform( "lights[0].colour" ) == nullptr, "old uniforms are gone", a_riFailures );
+}
+
+// enough uniforms that the table grows well past its starting size
+static void TestGrowth( int& a_riFailures )
+{
+	static char s_aacNames[64][32];
+	s_aoUniforms.clear();
+	for( unsigned int i = 0; i < 64; ++i )
+	{
+		sprintf( s_aacNames[i], "lights[%u].colour", i );
+		StubUniform oUniform = { s_aacNames[i], GL_FLOAT_VEC4, 1, (GLint)( 100 + i ) };
+		s_aoUniforms.push_back( oUniform );
+	}
+
+	ShaderReflection oReflection;
+	oReflection.Reflect( 9 );
+	Check( oReflection.GetUniformCount() == 64, "64 uniforms reflected", a_riFailures );
+
+	unsigned int uiFound = 0;
+	for( unsigned int i = 0; i < 64; ++i )
+	{
+		uiFound += oReflection.FindLocation( s_aacNames[i] ) == (GLint)( 100 + i ) ? 1 : 0;
+	}
+	Check( uiFound == 64, "every element found at its own location", a_riFailures );
+}
+
+int TestShaderReflection()
+{
+	printf( "ShaderReflection\n" );
+	int iFailures = 0;
+
+	PFNGLGETPROGRAMIVPROC			pfnGetProgramiv			= __glewGetProgramiv;
+	PFNGLGETACTIVEUNIFORMPROC		pfnGetActiveUniform		= __glewGetActiveUniform;
+	PFNGLGETUNIFORMLOCATIONPROC		pfnGetUniformLocation	= __glewGetUniformLocation;
+	__glewGetProgramiv			= StubGetProgramiv;
+	__glewGetActiveUniform		= StubGetActiveUniform;
+	__glewGetUniformLocation	= StubGetUniformLocation;
+
+	TestNames( iFailures );
+	TestGrowth( iFailures );
+
+	__glewGetProgramiv			= pfnGetProgramiv;
+	__glewGetActiveUniform		= pfnGetActiveUniform;
+	__glewGetUniformLocation	= pfnGetUniformLocation;
+	s_aoUniforms.clear();
+
+	return iFailures;
+}
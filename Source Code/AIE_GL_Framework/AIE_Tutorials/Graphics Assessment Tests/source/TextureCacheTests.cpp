@@ -0,0 +1,116 @@
+#include "Tests.h"
+#include "TextureCache.h"
+
+#include <map>
+#include <string>
+
+// Hands out ids in order and remembers what's alive. Paths starting with
+// "missing" fail to load, the size of each texture is 1000 times its id.
+class FakeTextureBackend : public ITextureBackend
+{
+public:
+	FakeTextureBackend() : m_uiNextID( 1 ), m_uiCreated( 0 ), m_uiDestroyed( 0 ) {}
+
+	GLuint CreateTexture( const char* a_szPath, unsigned int a_uiFormat, unsigned int& a_uiBytes )
+	{
+		++m_uiCreated;
+		if( std::string( a_szPath ).compare( 0, 7, "missing" ) == 0 )
+			return 0;
+
+		GLuint uiTextureID = m_uiNextID++;
+		a_uiBytes = uiTextureID * 1000;
+		m_oLive[ uiTextureID ] = a_szPath;
+		return uiTextureID;
+	}
+
+	void DestroyTexture( GLuint a_uiTextureID )
+	{
+		++m_uiDestroyed;
+		m_oLive.erase( a_uiTextureID );
+	}
+
+	bool IsLive( GLuint a_uiTextureID ) const	{ return m_oLive.find( a_uiTextureID ) != m_oLive.end(); }
+
+	GLuint							m_uiNextID;
+	unsigned int					m_uiCreated;
+	unsigned int					m_uiDestroyed;
+	std::map<GLuint, std::string>	m_oLive;
+};
+
+static void TestRefCounting( int& a_riFailures )
+{
+	FakeTextureBackend oBackend;
+	TextureCache oCache( &oBackend );
+
+	GLuint uiFirst = oCache.Acquire( "./images/Rock.png" );
+	Check( uiFirst == 1 && oCache.GetRefCount( uiFirst ) == 1, "first acquire creates", a_riFailures );
+
+	// the same image through a different spelling of its path
+	Check( oCache.Acquire( "images\\rock.PNG" ) == uiFirst, "canonical path finds the same texture", a_riFailures );
+	Check( oCache.Acquire( "./images/../images/./rock.png" ) == uiFirst, "dot segments fold away", a_riFailures );
+	Check( oCache.GetRefCount( uiFirst ) == 3, "each acquire counts a reference", a_riFailures );
+	Check( oBackend.m_uiCreated == 1 && oCache.GetHits() == 2 && oCache.GetMisses() == 1, "hits and misses", a_riFailures );
+
+	// a different upload format is a different texture
+	GLuint uiBGRA = oCache.Acquire( "./images/rock.png", GL_BGRA );
+	Check( uiBGRA != uiFirst && oCache.GetResidentCount() == 2, "format is part of the key", a_riFailures );
+	Check( oCache.GetResidentBytes() == 3000, "resident bytes add up", a_riFailures );
+
+	oCache.Release( uiFirst );
+	oCache.Release( uiFirst );
+	Check( oBackend.IsLive( uiFirst ) && oCache.GetRefCount( uiFirst ) == 1, "texture kept while referenced", a_riFailures );
+	oCache.Release( uiFirst );
+	Check( !oBackend.IsLive( uiFirst ) && oCache.GetRefCount( uiFirst ) == 0, "last release destroys", a_riFailures );
+	Check( oCache.GetResidentCount() == 1 && oCache.GetResidentBytes() == 2000, "destroyed texture leaves the totals", a_riFailures );
+
+	// gone from the cache, so acquiring it again loads it again
+	GLuint uiAgain = oCache.Acquire( "./images/rock.png" );
+	Check( uiAgain != uiFirst && oBackend.m_uiCreated == 3, "released texture loads again", a_riFailures );
+
+	// a late size replaces the one from the load
+	oCache.SetTextureBytes( uiAgain, 500 );
+	Check( oCache.GetResidentBytes() == 2500, "late size replaces the first", a_riFailures );
+
+	oCache.Release( uiAgain );
+	oCache.Release( uiBGRA );
+	Check( oCache.GetResidentCount() == 0 && oCache.GetResidentBytes() == 0 && oBackend.m_oLive.empty(), "everything released", a_riFailures );
+}
+
+static void TestUnknownRelease( int& a_riFailures )
+{
+	FakeTextureBackend oBackend;
+	TextureCache oCache( &oBackend );
+
+	GLuint uiOwned = oCache.Acquire( "./images/owned.png" );
+
+	// a render target or texture array the caller made itself, in the
+	// backend but never through the cache
+	unsigned int uiBytes = 0;
+	GLuint uiForeign = oBackend.CreateTexture( "./targets/blur", GL_RGBA, uiBytes );
+
+	oCache.Release( uiForeign );
+	Check( oBackend.IsLive( uiForeign ), "unknown id isn't destroyed", a_riFailures );
+	oCache.Release( 12345 );
+	oCache.Release( 0 );
+	Check( oBackend.m_uiDestroyed == 0, "unknown and 0 ids destroy nothing", a_riFailures );
+	Check( oCache.GetRefCount( uiOwned ) == 1 && oCache.GetResidentCount() == 1, "cache untouched by unknown ids", a_riFailures );
+
+	// a failed load isn't cached, the next acquire tries again
+	Check( oCache.Acquire( "missing.png" ) == 0, "failed load gives 0", a_riFailures );
+	Check( oCache.Acquire( "missing.png" ) == 0 && oCache.GetMisses() == 3, "failed load isn't cached", a_riFailures );
+	Check( oCache.GetResidentCount() == 1, "failed load isn't resident", a_riFailures );
+
+	oCache.Release( uiOwned );
+	Check( !oBackend.IsLive( uiOwned ) && oBackend.IsLive( uiForeign ), "only the owned texture is destroyed", a_riFailures );
+}
+
+int TestTextureCache()
+{
+	printf( "TextureCache\n" );
+	int iFailures = 0;
+
+	TestRefCounting( iFailures );
+	TestUnknownRelease( iFailures );
+
+	return iFailures;
+}
@@ -0,0 +1,200 @@
+#include "Tests.h"
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <vector>
+
+using AIE::FBXVertex;
+using AIE::FBXVertexWelder;
+
+// what FBXScene welds with unless it's told otherwise
+static const float IMPORT_TOLERANCE = 0.0001f;
+
+// the components the welder compares with a tolerance of 0
+static bool SameVertex( const FBXVertex& a_rLHS, const FBXVertex& a_rRHS )
+{
+	const AIE::vec4* pLHS = &a_rLHS.position;
+	const AIE::vec4* pRHS = &a_rRHS.position;
+	for( int i = 0; i < 7; ++i )
+	{
+		if( pLHS[i].x != pRHS[i].x || pLHS[i].y != pRHS[i].y || pLHS[i].z != pRHS[i].z )
+			return false;
+	}
+	return a_rLHS.uv.x == a_rRHS.uv.x && a_rLHS.uv.y == a_rRHS.uv.y && a_rLHS.uv2.x == a_rRHS.uv2.x && a_rLHS.uv2.y == a_rRHS.uv2.y;
+}
+
+// The importer's old path, a search of every vertex so far for the first
+// one that matches. With the import tolerance that's FBXVertex::operator==.
+static void WeldLinear( const std::vector<FBXVertex>& a_raoStream, bool a_bExact, std::vector<FBXVertex>& a_raoVertices, std::vector<unsigned int>& a_rauiIndices )
+{
+	for( unsigned int i = 0; i < a_raoStream.size(); ++i )
+	{
+		std::vector<FBXVertex>::iterator iter = a_raoVertices.end();
+		if( a_bExact )
+		{
+			for( iter = a_raoVertices.begin(); iter != a_raoVertices.end() && !SameVertex( *iter, a_raoStream[i] ); ++iter ) {}
+		}
+		else
+		{
+			FBXVertex oVertex = a_raoStream[i];
+			iter = std::find( a_raoVertices.begin(), a_raoVertices.end(), oVertex );
+		}
+
+		if( iter == a_raoVertices.end() )
+		{
+			a_rauiIndices.push_back( a_raoVertices.size() );
+			a_raoVertices.push_back( a_raoStream[i] );
+		}
+		else
+		{
+			a_rauiIndices.push_back( iter - a_raoVertices.begin() );
+		}
+	}
+}
+
+static void WeldHashed( const std::vector<FBXVertex>& a_raoStream, float a_fTolerance, std::vector<FBXVertex>& a_raoVertices, std::vector<unsigned int>& a_rauiIndices )
+{
+	// no expected count, so the table has to grow
+	FBXVertexWelder oWelder( a_raoVertices, a_fTolerance );
+	for( unsigned int i = 0; i < a_raoStream.size(); ++i )
+	{
+		a_rauiIndices.push_back( oWelder.AddVertGetIndex( a_raoStream[i] ) );
+	}
+}
+
+static FBXVertex MakeVertex( float a_fX, float a_fY, float a_fZ, float a_fU, float a_fV )
+{
+	FBXVertex oVertex;
+	oVertex.position	= AIE::vec4( a_fX, a_fY, a_fZ, 1.f );
+	oVertex.normal		= AIE::vec4( 0.f, 1.f, 0.f, 0.f );
+	oVertex.uv			= AIE::vec2( a_fU, a_fV );
+	oVertex.fbxControlPointIndex = 0;
+	return oVertex;
+}
+
+// Two triangles per quad of an a_iSize square grid, every corner emitted for
+// each triangle using it the way ExtractMesh reads polygon vertices. The
+// last column repeats the first's positions with its own UVs, a seam.
+static void MakeGrid( int a_iSize, float a_fJitter, std::vector<FBXVertex>& a_raoStream )
+{
+	static const int aaiCorners[6][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } };
+
+	unsigned int uiSeed = 12345;
+	for( int z = 0; z < a_iSize; ++z )
+	{
+		for( int x = 0; x < a_iSize; ++x )
+		{
+			for( int c = 0; c < 6; ++c )
+			{
+				int iX = x + aaiCorners[c][0];
+				int iZ = z + aaiCorners[c][1];
+
+				// moves each corner a different way each time it's emitted
+				uiSeed = uiSeed * 1664525u + 1013904223u;
+				float fJitter = a_fJitter * ( (float)( uiSeed >> 8 ) / 16777216.f - 0.5f );
+
+				float fX = (float)( iX % a_iSize ) + fJitter;
+				a_raoStream.push_back( MakeVertex( fX, 0.f, (float)iZ, (float)iX / a_iSize, (float)iZ / a_iSize ) );
+			}
+		}
+	}
+}
+
+static void CompareWelds( const char* a_szWhat, const std::vector<FBXVertex>& a_raoStream, float a_fTolerance, unsigned int a_uiExpected, int& a_riFailures )
+{
+	std::vector<FBXVertex> aoLinear, aoHashed;
+	std::vector<unsigned int> auiLinear, auiHashed;
+	WeldLinear( a_raoStream, a_fTolerance == 0.f, aoLinear, auiLinear );
+	WeldHashed( a_raoStream, a_fTolerance, aoHashed, auiHashed );
+
+	char acWhat[128];
+	sprintf( acWhat, "%s welds to %u vertices", a_szWhat, a_uiExpected );
+	Check( aoHashed.size() == a_uiExpected && aoLinear.size() == a_uiExpected, acWhat, a_riFailures );
+
+	sprintf( acWhat, "%s index buffer matches the linear search", a_szWhat );
+	Check( auiHashed == auiLinear, acWhat, a_riFailures );
+
+	bool bSameVertices = aoHashed.size() == aoLinear.size();
+	for( unsigned int i = 0; bSameVertices && i < aoHashed.size(); ++i )
+		bSameVertices = SameVertex( aoHashed[i], aoLinear[i] );
+	sprintf( acWhat, "%s vertex buffer matches the linear search", a_szWhat );
+	Check( bSameVertices, acWhat, a_riFailures );
+
+	// drawing the welded buffers gives back what went in
+	bool bRoundTrip = auiHashed.size() == a_raoStream.size();
+	for( unsigned int i = 0; bRoundTrip && i < auiHashed.size(); ++i )
+	{
+		FBXVertex oWelded = aoHashed[ auiHashed[i] ];
+		bRoundTrip = a_fTolerance == 0.f ? SameVertex( oWelded, a_raoStream[i] ) : oWelded == a_raoStream[i];
+	}
+	sprintf( acWhat, "%s welded buffers give back the stream", a_szWhat );
+	Check( bRoundTrip, acWhat, a_riFailures );
+}
+
+static void TestDuplicates( int& a_riFailures )
+{
+	const int iSize = 24;
+	// the seam column is already there as column 0, with other UVs
+	unsigned int uiUnique = ( iSize + 1 ) * ( iSize + 1 );
+
+	std::vector<FBXVertex> aoStream;
+	MakeGrid( iSize, 0.f, aoStream );
+	CompareWelds( "exact grid", aoStream, 0.f, uiUnique, a_riFailures );
+	CompareWelds( "grid at import tolerance", aoStream, IMPORT_TOLERANCE, uiUnique, a_riFailures );
+
+	// copies of a corner land within 0.4 of the tolerance of each other, so
+	// they all still weld
+	std::vector<FBXVertex> aoJittered;
+	MakeGrid( iSize, IMPORT_TOLERANCE * 0.4f, aoJittered );
+	CompareWelds( "jittered grid", aoJittered, IMPORT_TOLERANCE, uiUnique, a_riFailures );
+
+	// -0 compares equal to 0, so it has to hash the same
+	std::vector<FBXVertex> aoZeroes;
+	aoZeroes.push_back( MakeVertex( 0.f, 1.f, 2.f, 0.f, 0.f ) );
+	aoZeroes.push_back( MakeVertex( -0.f, 1.f, 2.f, -0.f, 0.f ) );
+	CompareWelds( "signed zero", aoZeroes, 0.f, 1, a_riFailures );
+}
+
+static void TestToleranceEdges( int& a_riFailures )
+{
+	const float fTolerance = IMPORT_TOLERANCE;
+	std::vector<FBXVertex> aoStream;
+
+	// two vertices past the tolerance from each other, the older one in the
+	// cell searched last
+	aoStream.push_back( MakeVertex( 10.f * fTolerance + 1.6f * fTolerance, 0.f, 0.f, 0.f, 0.f ) );
+	aoStream.push_back( MakeVertex( 10.f * fTolerance - 0.3f * fTolerance, 0.f, 0.f, 0.f, 0.f ) );
+	// the other side of a cell boundary from the second, well within the tolerance
+	aoStream.push_back( MakeVertex( 10.f * fTolerance + 0.3f * fTolerance, 0.f, 0.f, 0.f, 0.f ) );
+	// within the tolerance of both, the first wins as it would in a search
+	aoStream.push_back( MakeVertex( 10.f * fTolerance + 0.65f * fTolerance, 0.f, 0.f, 0.f, 0.f ) );
+	// the next cell down on z
+	aoStream.push_back( MakeVertex( 10.f * fTolerance - 0.3f * fTolerance, 0.4f * fTolerance, -0.4f * fTolerance, 0.f, 0.f ) );
+	// same position, UVs apart by more than the tolerance
+	aoStream.push_back( MakeVertex( 10.f * fTolerance - 0.3f * fTolerance, 0.f, 0.f, 2.f * fTolerance, 0.f ) );
+	// and over the origin, where cells go negative
+	aoStream.push_back( MakeVertex( -0.2f * fTolerance, 0.f, 0.f, 0.f, 0.f ) );
+	aoStream.push_back( MakeVertex( 0.2f * fTolerance, 0.f, 0.f, 0.f, 0.f ) );
+
+	CompareWelds( "tolerance edges", aoStream, fTolerance, 4, a_riFailures );
+
+	std::vector<FBXVertex> aoVertices;
+	std::vector<unsigned int> auiIndices;
+	WeldHashed( aoStream, fTolerance, aoVertices, auiIndices );
+	const unsigned int auiExpected[] = { 0, 1, 1, 0, 1, 2, 3, 3 };
+	Check( auiIndices.size() == 8 && std::equal( auiIndices.begin(), auiIndices.end(), auiExpected ), "lowest match within tolerance", a_riFailures );
+
+	// with no tolerance none of those are the same vertex
+	CompareWelds( "tolerance edges exactly", aoStream, 0.f, 8, a_riFailures );
+}
+
+int TestVertexWelder()
+{
+	printf( "VertexWelder\n" );
+	int iFailures = 0;
+
+	TestDuplicates( iFailures );
+	TestToleranceEdges( iFailures );
+
+	return iFailures;
+}
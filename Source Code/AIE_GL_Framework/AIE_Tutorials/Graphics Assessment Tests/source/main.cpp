@@ -0,0 +1,43 @@
+#include "Tests.h"
+#include "JobSystem.h"
+
+#include <string.h>
+
+int main( int argc, char** argv )
+{
+	// the job system's threads come from GLFW, no window is opened
+	if( glfwInit() != GL_TRUE )
+	{
+		printf( "Unable to initialise GLFW\n" );
+		return 1;
+	}
+
+	int iFailures = 0;
+	iFailures += TestBlurKernel();
+	iFailures += TestJobSystem();
+	iFailures += TestFrustum();
+	iFailures += TestGLStateCache();
+	iFailures += TestDrawCommandList();
+	iFailures += TestParticleStore();
+	iFailures += TestRingAllocator();
+	iFailures += TestFrameUniforms();
+	iFailures += TestHeightfield();
+	iFailures += TestTextureCache();
+	iFailures += TestShaderReflection();
+	iFailures += TestVertexWelder();
+
+	if( argc > 1 && strcmp( argv[1], "-bench" ) == 0 )
+	{
+		BenchmarkJobSystem();
+		BenchmarkParticleStore();
+	}
+
+	glfwTerminate();
+
+	if( iFailures == 0 )
+		printf( "All tests passed\n" );
+	else
+		printf( "%i checks failed\n", iFailures );
+
+	return iFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,695 @@
+//////////////////////////////////////////////////////////////////////////
+// Author:	Conan Bourke
+// Date:	January 5 2013
+// Brief:	Saving and memory mapped loading of version 2 .aie files
+//////////////////////////////////////////////////////////////////////////
+#include "AIEFormat.h"
+
+namespace AIE
+{
+	namespace AIEFile
+	{
+		// accumulates the blobs of the DATA chunk while records are built
+		struct DataWriter
+		{
+			DataWriter() : size(0) {}
+
+			unsigned long long Add(const void* a_data, unsigned long long a_size)
+			{
+				unsigned long long offset = Align(size);
+				Blob blob = { a_data, offset, a_size };
+				blobs.push_back(blob);
+				size = offset + a_size;
+				return offset;
+			}
+
+			struct Blob
+			{
+				const void*			data;
+				unsigned long long	offset;
+				unsigned long long	size;
+			};
+
+			std::vector<Blob>	blobs;
+			unsigned long long	size;
+		};
+
+		// writes zeros up to the next aligned position
+		static void Pad(FILE* a_file, unsigned long long& a_position)
+		{
+			static const char zeros[ALIGNMENT] = {};
+			unsigned long long aligned = Align(a_position);
+			fwrite(zeros,1,(size_t)(aligned - a_position),a_file);
+			a_position = aligned;
+		}
+
+		// a chunk's records, or nullptr if its count doesn't fit in its size
+		template <typename T>
+		static T* GetRecords(char* a_base, const Chunk* a_chunk)
+		{
+			if ((unsigned long long)a_chunk->count * sizeof(T) > a_chunk->size)
+				return nullptr;
+			return (T*)(a_base + a_chunk->offset);
+		}
+
+		// true if a_count things starting at a_first fit within a_total
+		static bool InRange(unsigned long long a_first, unsigned long long a_count, unsigned long long a_total)
+		{
+			return a_first <= a_total && a_count <= a_total - a_first;
+		}
+
+		// true if an offset is where the writer would have put it, so the
+		// view can be cast through it
+		static bool IsAligned(unsigned long long a_offset)
+		{
+			return (a_offset & (ALIGNMENT - 1)) == 0;
+		}
+
+		// true if a name read from a file ends within its array
+		static bool IsTerminated(const char* a_name)
+		{
+			return memchr(a_name,0,MAX_PATH) != nullptr;
+		}
+
+		// checks every index and offset in the records against the chunk or
+		// blob it refers to, before anything is built from them
+		static bool CheckRecords(char* a_base, const Chunk* const* a_chunks)
+		{
+			const FBXMaterial* materials = GetRecords<const FBXMaterial>(a_base,a_chunks[MATERIALS]);
+			const NodeRecord* nodes = GetRecords<const NodeRecord>(a_base,a_chunks[NODES]);
+			const unsigned int* children = GetRecords<const unsigned int>(a_base,a_chunks[CHILDREN]);
+			const MeshRecord* meshes = GetRecords<const MeshRecord>(a_base,a_chunks[MESHES]);
+			const SkeletonRecord* skeletons = GetRecords<const SkeletonRecord>(a_base,a_chunks[SKELETONS]);
+			const unsigned int* bones = GetRecords<const unsigned int>(a_base,a_chunks[BONES]);
+			const AnimationRecord* animations = GetRecords<const AnimationRecord>(a_base,a_chunks[ANIMATIONS]);
+			const TrackRecord* tracks = GetRecords<const TrackRecord>(a_base,a_chunks[TRACKS]);
+
+			if (a_chunks[SCENE]->count < 1 ||
+				GetRecords<const vec4>(a_base,a_chunks[SCENE]) == nullptr ||
+				materials == nullptr || nodes == nullptr || children == nullptr ||
+				meshes == nullptr || skeletons == nullptr || bones == nullptr ||
+				animations == nullptr || tracks == nullptr ||
+				GetRecords<const LightRecord>(a_base,a_chunks[LIGHTS]) == nullptr ||
+				GetRecords<const CameraRecord>(a_base,a_chunks[CAMERAS]) == nullptr)
+				return false;
+
+			const char* blobs = a_base + a_chunks[DATA]->offset;
+			unsigned long long blobSize = a_chunks[DATA]->size;
+			unsigned int nodeCount = a_chunks[NODES]->count;
+
+			for ( unsigned int i = 0 ; i < a_chunks[MATERIALS]->count ; ++i )
+			{
+				if (!IsTerminated(materials[i].name))
+					return false;
+			}
+
+			for ( unsigned int i = 0 ; i < a_chunks[CHILDREN]->count ; ++i )
+			{
+				if (children[i] >= nodeCount)
+					return false;
+			}
+
+			for ( unsigned int i = 0 ; i < a_chunks[MESHES]->count ; ++i )
+			{
+				const MeshRecord& mesh = meshes[i];
+				if (mesh.material < -1 ||
+					mesh.material >= (int)a_chunks[MATERIALS]->count ||
+					!IsAligned(mesh.vertexOffset) ||
+					!IsAligned(mesh.indexOffset) ||
+					!InRange(mesh.vertexOffset,(unsigned long long)mesh.vertexCount * sizeof(FBXVertex),blobSize) ||
+					!InRange(mesh.indexOffset,(unsigned long long)mesh.indexCount * sizeof(unsigned int),blobSize))
+					return false;
+
+				const unsigned int* indices = (const unsigned int*)(blobs + mesh.indexOffset);
+				for ( unsigned int j = 0 ; j < mesh.indexCount ; ++j )
+				{
+					if (indices[j] >= mesh.vertexCount)
+						return false;
+				}
+			}
+
+			// parents come first, so a node's parent is already built when it is,
+			// and node 0 is the only root so nothing is left out of the tree
+			for ( unsigned int i = 0 ; i < nodeCount ; ++i )
+			{
+				const NodeRecord& node = nodes[i];
+				if (!IsTerminated(node.name) ||
+					node.parent < -1 ||
+					node.parent >= (int)i ||
+					(node.parent == -1 && i != 0) ||
+					!InRange(node.firstChild,node.childCount,a_chunks[CHILDREN]->count))
+					return false;
+
+				switch (node.type)
+				{
+				case Node::MESH:	if (node.dataIndex >= a_chunks[MESHES]->count) return false;	break;
+				case Node::LIGHT:	if (node.dataIndex >= a_chunks[LIGHTS]->count) return false;	break;
+				case Node::CAMERA:	if (node.dataIndex >= a_chunks[CAMERAS]->count) return false;	break;
+				default:	break;
+				};
+			}
+
+			// animations aren't tied to a skeleton in the file, so a track's bone
+			// has to be in every skeleton that could play it
+			unsigned int fewestBones = 0xffffffff;
+			for ( unsigned int i = 0 ; i < a_chunks[SKELETONS]->count ; ++i )
+			{
+				const SkeletonRecord& skeleton = skeletons[i];
+				if (!InRange(skeleton.firstBone,skeleton.boneCount,a_chunks[BONES]->count) ||
+					!IsAligned(skeleton.bindPoseOffset) ||
+					!InRange(skeleton.bindPoseOffset,(unsigned long long)skeleton.boneCount * sizeof(mat4),blobSize))
+					return false;
+
+				if (skeleton.boneCount < fewestBones)
+					fewestBones = skeleton.boneCount;
+			}
+
+			for ( unsigned int i = 0 ; i < a_chunks[BONES]->count ; ++i )
+			{
+				if (bones[i] >= nodeCount)
+					return false;
+			}
+
+			for ( unsigned int i = 0 ; i < a_chunks[ANIMATIONS]->count ; ++i )
+			{
+				const AnimationRecord& animation = animations[i];
+				if (!IsTerminated(animation.name) ||
+					!InRange(animation.firstTrack,animation.trackCount,a_chunks[TRACKS]->count))
+					return false;
+			}
+
+			for ( unsigned int i = 0 ; i < a_chunks[TRACKS]->count ; ++i )
+			{
+				const TrackRecord& track = tracks[i];
+				if (track.boneIndex >= fewestBones ||
+					!IsAligned(track.keyframeOffset) ||
+					!InRange(track.keyframeOffset,(unsigned long long)track.keyframeCount * sizeof(FBXKeyFrame),blobSize))
+					return false;
+			}
+
+			return true;
+		}
+
+		// flattens the node tree so that parents come before their children
+		static void FlattenNodes(Node* a_node, std::vector<Node*>& a_nodes, std::map<Node*,unsigned int>& a_indices)
+		{
+			a_indices[ a_node ] = a_nodes.size();
+			a_nodes.push_back(a_node);
+
+			for each (Node* n in a_node->m_children)
+				FlattenNodes(n,a_nodes,a_indices);
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	bool FBXScene::SaveAIE(const char* a_filename)
+	{
+		using namespace AIEFile;
+
+		if (m_root == nullptr)
+			return false;
+
+		DataWriter data;
+
+		// materials, indexed in map order
+		std::vector<FBXMaterial> materials;
+		std::map<FBXMaterial*,int> materialIndices;
+		materials.reserve(m_materials.size());
+		for each (auto m in m_materials)
+		{
+			materialIndices[ m.second ] = materials.size();
+			materials.push_back(*m.second);
+
+			// texture IDs belong to the application that loaded them
+			memset(materials.back().textureIDs,0,sizeof(materials.back().textureIDs));
+		}
+
+		// nodes and their type specific data
+		std::vector<Node*> nodeList;
+		std::map<Node*,unsigned int> nodeIndices;
+		nodeList.reserve(NodeCount(m_root));
+		FlattenNodes(m_root,nodeList,nodeIndices);
+
+		std::vector<NodeRecord> nodes(nodeList.size());
+		std::vector<unsigned int> children;
+		std::vector<MeshRecord> meshes;
+		std::vector<LightRecord> lights;
+		std::vector<CameraRecord> cameras;
+
+		for ( unsigned int i = 0 ; i < nodeList.size() ; ++i )
+		{
+			Node* pNode = nodeList[i];
+			NodeRecord& record = nodes[i];
+
+			memset(&record,0,sizeof(NodeRecord));
+			record.localTransform = pNode->m_localTransform;
+			record.globalTransform = pNode->m_globalTransform;
+			strncpy(record.name,pNode->m_name,MAX_PATH);
+			record.type = pNode->m_nodeType;
+			record.parent = pNode->m_parent != nullptr ? (int)nodeIndices[ pNode->m_parent ] : -1;
+			record.firstChild = children.size();
+			record.childCount = pNode->m_children.size();
+
+			for each (Node* n in pNode->m_children)
+				children.push_back(nodeIndices[ n ]);
+
+			switch (pNode->m_nodeType)
+			{
+			case Node::MESH:
+				{
+					FBXMeshNode* pMesh = (FBXMeshNode*)pNode;
+					MeshRecord mesh = {};
+					mesh.vertexCount = pMesh->m_vertices.size();
+					mesh.indexCount = pMesh->m_indices.size();
+					mesh.vertexOffset = data.Add(pMesh->m_vertices.data(),mesh.vertexCount * sizeof(FBXVertex));
+					mesh.indexOffset = data.Add(pMesh->m_indices.data(),mesh.indexCount * sizeof(unsigned int));
+					mesh.material = pMesh->m_material != nullptr ? materialIndices[ pMesh->m_material ] : -1;
+
+					record.dataIndex = meshes.size();
+					meshes.push_back(mesh);
+					break;
+				}
+			case Node::LIGHT:
+				{
+					FBXLightNode* pLight = (FBXLightNode*)pNode;
+					LightRecord light = {};
+					light.colour = pLight->m_colour;
+					light.attenuation = pLight->m_attenuation;
+					light.type = pLight->m_type;
+					light.on = pLight->m_on ? 1 : 0;
+					light.innerAngle = pLight->m_innerAngle;
+					light.outerAngle = pLight->m_outerAngle;
+
+					record.dataIndex = lights.size();
+					lights.push_back(light);
+					break;
+				}
+			case Node::CAMERA:
+				{
+					FBXCameraNode* pCamera = (FBXCameraNode*)pNode;
+					CameraRecord camera = {};
+					camera.viewMatrix = pCamera->m_viewMatrix;
+					camera.aspectRatio = pCamera->m_aspectRatio;
+					camera.fieldOfView = pCamera->m_fieldOfView;
+					camera.nearPlane = pCamera->m_near;
+					camera.farPlane = pCamera->m_far;
+
+					record.dataIndex = cameras.size();
+					cameras.push_back(camera);
+					break;
+				}
+			default:	break;
+			};
+		}
+
+		// skeletons reference their bones by node index
+		std::vector<SkeletonRecord> skeletons;
+		std::vector<unsigned int> bones;
+		for each (FBXSkeleton* s in m_skeletons)
+		{
+			SkeletonRecord skeleton = {};
+			skeleton.boneCount = s->m_boneCount;
+			skeleton.firstBone = bones.size();
+			skeleton.bindPoseOffset = data.Add(s->m_bindPoses,s->m_boneCount * sizeof(mat4));
+
+			for ( unsigned int i = 0 ; i < s->m_boneCount ; ++i )
+				bones.push_back(nodeIndices[ s->m_nodes[i] ]);
+
+			skeletons.push_back(skeleton);
+		}
+
+		// animations and their tracks
+		std::vector<AnimationRecord> animations;
+		std::vector<TrackRecord> tracks;
+		for each (auto a in m_animations)
+		{
+			AnimationRecord animation = {};
+			strncpy(animation.name,a.second->m_name,MAX_PATH);
+			animation.startFrame = a.second->m_startFrame;
+			animation.endFrame = a.second->m_endFrame;
+			animation.trackCount = a.second->m_trackCount;
+			animation.firstTrack = tracks.size();
+
+			for ( unsigned int i = 0 ; i < a.second->m_trackCount ; ++i )
+			{
+				const FBXTrack& t = a.second->m_tracks[i];
+				TrackRecord track = {};
+				track.boneIndex = t.m_boneIndex;
+				track.keyframeCount = t.m_keyframeCount;
+				track.keyframeOffset = data.Add(t.m_keyframes,t.m_keyframeCount * sizeof(FBXKeyFrame));
+				tracks.push_back(track);
+			}
+
+			animations.push_back(animation);
+		}
+
+		// chunk table, laid out after the header
+		Chunk chunks[ChunkType_Count];
+		memset(chunks,0,sizeof(chunks));
+
+		const void* chunkData[ChunkType_Count] = {
+			&m_ambientLight,
+			materials.data(),
+			nodes.data(),
+			children.data(),
+			meshes.data(),
+			lights.data(),
+			cameras.data(),
+			skeletons.data(),
+			bones.data(),
+			animations.data(),
+			tracks.data(),
+			nullptr,
+		};
+
+		unsigned int counts[ChunkType_Count] = {
+			1,
+			materials.size(),
+			nodes.size(),
+			children.size(),
+			meshes.size(),
+			lights.size(),
+			cameras.size(),
+			skeletons.size(),
+			bones.size(),
+			animations.size(),
+			tracks.size(),
+			data.blobs.size(),
+		};
+
+		unsigned long long strides[ChunkType_Count] = {
+			sizeof(vec4),
+			sizeof(FBXMaterial),
+			sizeof(NodeRecord),
+			sizeof(unsigned int),
+			sizeof(MeshRecord),
+			sizeof(LightRecord),
+			sizeof(CameraRecord),
+			sizeof(SkeletonRecord),
+			sizeof(unsigned int),
+			sizeof(AnimationRecord),
+			sizeof(TrackRecord),
+			0,
+		};
+
+		unsigned long long offset = Align(sizeof(Header) + sizeof(chunks));
+		for ( unsigned int i = 0 ; i < ChunkType_Count ; ++i )
+		{
+			chunks[i].type = i;
+			chunks[i].count = counts[i];
+			chunks[i].offset = offset;
+			chunks[i].size = i == DATA ? data.size : counts[i] * strides[i];
+			offset = Align(offset + chunks[i].size);
+		}
+
+		Header header = {};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.chunkCount = ChunkType_Count;
+		header.fileSize = chunks[DATA].offset + chunks[DATA].size;
+		header.chunkTableOffset = sizeof(Header);
+
+		FILE* pFile = fopen(a_filename,"wb");
+		if (pFile == nullptr)
+		{
+			printf("Unable to open %s for writing\n",a_filename);
+			return false;
+		}
+
+		unsigned long long position = 0;
+		fwrite(&header,sizeof(Header),1,pFile);
+		fwrite(chunks,sizeof(chunks),1,pFile);
+		position += sizeof(Header) + sizeof(chunks);
+
+		for ( unsigned int i = 0 ; i < DATA ; ++i )
+		{
+			Pad(pFile,position);
+			fwrite(chunkData[i],1,(size_t)chunks[i].size,pFile);
+			position += chunks[i].size;
+		}
+
+		// bulk data, each blob aligned within the DATA chunk
+		Pad(pFile,position);
+		for each (const DataWriter::Blob& blob in data.blobs)
+		{
+			Pad(pFile,position);
+			fwrite(blob.data,1,(size_t)blob.size,pFile);
+			position += blob.size;
+		}
+
+		fclose(pFile);
+
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	bool FBXScene::LoadAIEv2(const char* a_filename)
+	{
+		using namespace AIEFile;
+
+		HANDLE hFile = CreateFileA(a_filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			printf("Unable to open %s\n",a_filename);
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(hFile,&fileSize);
+
+		// copy-on-write so that materials can be given texture IDs in place
+		m_mappedFile = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		CloseHandle(hFile);
+
+		if (m_mappedFile == nullptr)
+		{
+			printf("Unable to map %s\n",a_filename);
+			return false;
+		}
+
+		m_mappedView = (const char*)MapViewOfFile(m_mappedFile, FILE_MAP_COPY, 0, 0, 0);
+		m_mappedSize = fileSize.QuadPart;
+
+		if (m_mappedView == nullptr)
+		{
+			printf("Unable to map %s\n",a_filename);
+			UnmapAIE();
+			return false;
+		}
+
+		// validate header and chunk table before touching anything else
+		const Header* header = (const Header*)m_mappedView;
+		if (m_mappedSize < sizeof(Header) ||
+			header->magic != MAGIC ||
+			header->version != VERSION ||
+			header->fileSize != m_mappedSize ||
+			!InRange(header->chunkTableOffset,(unsigned long long)header->chunkCount * sizeof(Chunk),m_mappedSize))
+		{
+			printf("%s is not a valid version %u .aie file\n",a_filename,VERSION);
+			UnmapAIE();
+			return false;
+		}
+
+		const Chunk* chunks[ChunkType_Count] = {};
+		const Chunk* table = (const Chunk*)(m_mappedView + header->chunkTableOffset);
+		for ( unsigned int i = 0 ; i < header->chunkCount ; ++i )
+		{
+			if (!InRange(table[i].offset,table[i].size,m_mappedSize) ||
+				!IsAligned(table[i].offset))
+			{
+				printf("%s has a corrupt chunk table\n",a_filename);
+				UnmapAIE();
+				return false;
+			}
+
+			// unknown chunks are skipped so that later versions can add more
+			if (table[i].type < ChunkType_Count)
+				chunks[ table[i].type ] = &table[i];
+		}
+
+		for ( unsigned int i = 0 ; i < ChunkType_Count ; ++i )
+		{
+			if (chunks[i] == nullptr)
+			{
+				printf("%s is missing chunk %u\n",a_filename,i);
+				UnmapAIE();
+				return false;
+			}
+		}
+
+		char* base = (char*)m_mappedView;
+		char* blobs = base + chunks[DATA]->offset;
+
+		if (!CheckRecords(base,chunks))
+		{
+			printf("%s has corrupt records\n",a_filename);
+			UnmapAIE();
+			return false;
+		}
+
+		// ambient light
+		m_ambientLight = *GetRecords<vec4>(base,chunks[SCENE]);
+
+		// materials are used directly from the mapped view
+		FBXMaterial* materials = GetRecords<FBXMaterial>(base,chunks[MATERIALS]);
+		for ( unsigned int i = 0 ; i < chunks[MATERIALS]->count ; ++i )
+			m_materials[ materials[i].name ] = &materials[i];
+
+		// create nodes, parents always appear before their children
+		const NodeRecord* nodeRecords = GetRecords<const NodeRecord>(base,chunks[NODES]);
+		const unsigned int* children = GetRecords<const unsigned int>(base,chunks[CHILDREN]);
+		const MeshRecord* meshRecords = GetRecords<const MeshRecord>(base,chunks[MESHES]);
+		const LightRecord* lightRecords = GetRecords<const LightRecord>(base,chunks[LIGHTS]);
+		const CameraRecord* cameraRecords = GetRecords<const CameraRecord>(base,chunks[CAMERAS]);
+
+		unsigned int nodeCount = chunks[NODES]->count;
+		std::vector<Node*> nodes(nodeCount,nullptr);
+
+		for ( unsigned int i = 0 ; i < nodeCount ; ++i )
+		{
+			const NodeRecord& record = nodeRecords[i];
+			Node* pNode = nullptr;
+
+			switch (record.type)
+			{
+			case Node::MESH:
+				{
+					const MeshRecord& mesh = meshRecords[ record.dataIndex ];
+					const FBXVertex* vertices = (const FBXVertex*)(blobs + mesh.vertexOffset);
+					const unsigned int* indices = (const unsigned int*)(blobs + mesh.indexOffset);
+
+					FBXMeshNode* pMesh = new FBXMeshNode();
+					pMesh->m_material = mesh.material >= 0 ? &materials[ mesh.material ] : nullptr;
+					pMesh->m_vertices.assign(vertices,vertices + mesh.vertexCount);
+					pMesh->m_indices.assign(indices,indices + mesh.indexCount);
+
+					pNode = pMesh;
+					m_meshes[ record.name ] = pMesh;
+					break;
+				}
+			case Node::LIGHT:
+				{
+					const LightRecord& light = lightRecords[ record.dataIndex ];
+
+					FBXLightNode* pLight = new FBXLightNode();
+					pLight->m_type = (FBXLightNode::LightType)light.type;
+					pLight->m_on = light.on != 0;
+					pLight->m_colour = light.colour;
+					pLight->m_innerAngle = light.innerAngle;
+					pLight->m_outerAngle = light.outerAngle;
+					pLight->m_attenuation = light.attenuation;
+
+					pNode = pLight;
+					m_lights[ record.name ] = pLight;
+					break;
+				}
+			case Node::CAMERA:
+				{
+					const CameraRecord& camera = cameraRecords[ record.dataIndex ];
+
+					FBXCameraNode* pCamera = new FBXCameraNode();
+					pCamera->m_aspectRatio = camera.aspectRatio;
+					pCamera->m_fieldOfView = camera.fieldOfView;
+					pCamera->m_near = camera.nearPlane;
+					pCamera->m_far = camera.farPlane;
+					pCamera->m_viewMatrix = camera.viewMatrix;
+
+					pNode = pCamera;
+					m_cameras[ record.name ] = pCamera;
+					break;
+				}
+			default:
+				{
+					pNode = new Node();
+					break;
+				}
+			};
+
+			strncpy(pNode->m_name,record.name,MAX_PATH);
+			pNode->m_localTransform = record.localTransform;
+			pNode->m_globalTransform = record.globalTransform;
+			pNode->m_parent = record.parent >= 0 ? nodes[ record.parent ] : nullptr;
+			pNode->m_children.reserve(record.childCount);
+
+			if (pNode->m_parent != nullptr)
+				pNode->m_parent->m_children.push_back(pNode);
+
+			nodes[i] = pNode;
+		}
+
+		m_root = nodeCount > 0 ? nodes[0] : nullptr;
+
+		// skeletons
+		const SkeletonRecord* skeletonRecords = GetRecords<const SkeletonRecord>(base,chunks[SKELETONS]);
+		const unsigned int* bones = GetRecords<const unsigned int>(base,chunks[BONES]);
+
+		for ( unsigned int i = 0 ; i < chunks[SKELETONS]->count ; ++i )
+		{
+			const SkeletonRecord& record = skeletonRecords[i];
+
+			FBXSkeleton* s = new FBXSkeleton();
+			s->m_boneCount = record.boneCount;
+			s->m_bindPoses = new mat4[ s->m_boneCount ];
+			s->m_bones = new mat4[ s->m_boneCount ];
+			s->m_nodes = new Node * [ s->m_boneCount ];
+
+			memcpy(s->m_bindPoses,blobs + record.bindPoseOffset,sizeof(mat4) * s->m_boneCount);
+			for ( unsigned int j = 0 ; j < s->m_boneCount ; ++j )
+				s->m_nodes[j] = nodes[ bones[ record.firstBone + j ] ];
+
+			m_skeletons.push_back(s);
+		}
+
+		// animations, keyframes are used directly from the mapped view
+		const AnimationRecord* animationRecords = GetRecords<const AnimationRecord>(base,chunks[ANIMATIONS]);
+		const TrackRecord* trackRecords = GetRecords<const TrackRecord>(base,chunks[TRACKS]);
+
+		for ( unsigned int i = 0 ; i < chunks[ANIMATIONS]->count ; ++i )
+		{
+			const AnimationRecord& record = animationRecords[i];
+
+			FBXAnimation* anim = new FBXAnimation();
+			strncpy(anim->m_name,record.name,MAX_PATH);
+			anim->m_startFrame = record.startFrame;
+			anim->m_endFrame = record.endFrame;
+			anim->m_trackCount = record.trackCount;
+			anim->m_tracks = new FBXTrack[ anim->m_trackCount ];
+
+			for ( unsigned int j = 0 ; j < anim->m_trackCount ; ++j )
+			{
+				const TrackRecord& track = trackRecords[ record.firstTrack + j ];
+				anim->m_tracks[j].m_boneIndex = track.boneIndex;
+				anim->m_tracks[j].m_keyframeCount = track.keyframeCount;
+				anim->m_tracks[j].m_keyframes = (FBXKeyFrame*)(blobs + track.keyframeOffset);
+			}
+
+			m_animations[ anim->m_name ] = anim;
+		}
+
+		return true;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	void FBXScene::UnmapAIE()
+	{
+		if (m_mappedView != nullptr)
+			UnmapViewOfFile(m_mappedView);
+		if (m_mappedFile != nullptr)
+			CloseHandle(m_mappedFile);
+
+		m_mappedFile = nullptr;
+		m_mappedView = nullptr;
+		m_mappedSize = 0;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	bool FBXScene::IsMapped(const void* a_pointer) const
+	{
+		const char* p = (const char*)a_pointer;
+		return (m_mappedView != nullptr &&
+				p >= m_mappedView &&
+				p < m_mappedView + m_mappedSize);
+	}
+
+} // namespace AIE
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////
+// Author:	Conan Bourke
+// Date:	January 5 2013
+// Brief:	On disk layout of version 2 .aie scene files.
+//
+//			A header is followed by a table of chunks. Each chunk is an
+//			array of fixed size records. Records refer to each other by
+//			index and to bulk data (vertices, indices, bind poses and
+//			keyframes) by 64-bit offsets relative to the start of the DATA
+//			chunk. All chunks and data blobs start on a 16 byte boundary, so
+//			the file can be mapped and used without parsing, and it reads the
+//			same from 32-bit and 64-bit builds.
+//////////////////////////////////////////////////////////////////////////
+#ifndef __AIEFORMAT_H_
+#define __AIEFORMAT_H_
+//////////////////////////////////////////////////////////////////////////
+#include "FBXLoader.h"
+
+//////////////////////////////////////////////////////////////////////////
+namespace AIE
+{
+	namespace AIEFile
+	{
+		// "AIE2" when read as little endian
+		const unsigned int	MAGIC		= 0x32454941;
+		const unsigned int	VERSION		= 2;
+		const unsigned int	ALIGNMENT	= 16;
+
+		inline unsigned long long Align(unsigned long long a_value)
+		{
+			return (a_value + (ALIGNMENT - 1)) & ~(unsigned long long)(ALIGNMENT - 1);
+		}
+
+		enum ChunkType : unsigned int
+		{
+			SCENE = 0,		// single vec4 ambient light
+			MATERIALS,		// FBXMaterial
+			NODES,			// NodeRecord, parents always before children
+			CHILDREN,		// unsigned int node indices
+			MESHES,			// MeshRecord
+			LIGHTS,			// LightRecord
+			CAMERAS,		// CameraRecord
+			SKELETONS,		// SkeletonRecord
+			BONES,			// unsigned int node indices
+			ANIMATIONS,		// AnimationRecord
+			TRACKS,			// TrackRecord
+			DATA,			// aligned blobs
+
+			ChunkType_Count
+		};
+
+		struct Header
+		{
+			unsigned int		magic;
+			unsigned int		version;
+			unsigned int		chunkCount;
+			unsigned int		padding;
+			unsigned long long	fileSize;
+			unsigned long long	chunkTableOffset;
+		};
+
+		struct Chunk
+		{
+			unsigned long long	offset;		// from the start of the file
+			unsigned long long	size;
+			unsigned int		type;
+			unsigned int		count;
+			unsigned int		padding[2];
+		};
+
+		struct NodeRecord
+		{
+			mat4				localTransform;
+			mat4				globalTransform;
+			char				name[MAX_PATH];
+			unsigned int		type;
+			int					parent;		// -1 for the root
+			unsigned int		firstChild;	// into CHILDREN
+			unsigned int		childCount;
+			unsigned int		dataIndex;	// into MESHES, LIGHTS or CAMERAS
+		};
+
+		struct MeshRecord
+		{
+			unsigned long long	vertexOffset;
+			unsigned long long	indexOffset;
+			unsigned int		vertexCount;
+			unsigned int		indexCount;
+			int					material;	// -1 for none
+			unsigned int		padding;
+		};
+
+		struct LightRecord
+		{
+			vec4				colour;
+			vec4				attenuation;
+			unsigned int		type;
+			unsigned int		on;
+			float				innerAngle;
+			float				outerAngle;
+		};
+
+		struct CameraRecord
+		{
+			mat4				viewMatrix;
+			float				aspectRatio;
+			float				fieldOfView;
+			float				nearPlane;
+			float				farPlane;
+		};
+
+		struct SkeletonRecord
+		{
+			unsigned long long	bindPoseOffset;
+			unsigned int		boneCount;
+			unsigned int		firstBone;	// into BONES
+		};
+
+		struct AnimationRecord
+		{
+			char				name[MAX_PATH];
+			unsigned int		startFrame;
+			unsigned int		endFrame;
+			unsigned int		trackCount;
+			unsigned int		firstTrack;	// into TRACKS
+		};
+
+		struct TrackRecord
+		{
+			unsigned long long	keyframeOffset;
+			unsigned int		boneIndex;
+			unsigned int		keyframeCount;
+		};
+
+	} // namespace AIEFile
+
+} // namespace AIE
+
+//////////////////////////////////////////////////////////////////////////
+#endif // __AIEFORMAT_H_
+//////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,8 @@
 // Brief:	Classes to load an FBX scene for use
 //////////////////////////////////////////////////////////////////////////
 #include "FBXLoader.h"
+#include "VertexWelder.h"
+#include "AIEFormat.h"
 #include <fbxsdk.h>
 #include <algorithm>
 #include <set>
@@ -145,18 +147,23 @@ namespace AIE
 		delete m_root;
 		m_root = nullptr;
 
+		// materials and keyframes loaded from a version 2 file live in the mapped view
 		for each (auto m in m_materials)
-			delete m.second;
+			if (!IsMapped(m.second))
+				delete m.second;
 		for each (auto s in m_skeletons)
 			delete s;
 		for each (auto a in m_animations)
 		{
 			for (unsigned int i = 0 ; i < a.second->m_trackCount ; ++i )
-				delete[] a.second->m_tracks[i].m_keyframes;
+				if (!IsMapped(a.second->m_tracks[i].m_keyframes))
+					delete[] a.second->m_tracks[i].m_keyframes;
 			delete[] a.second->m_tracks;
 			delete a.second;
 		}
 
+		UnmapAIE();
+
 		m_meshes.clear();
 		m_lights.clear();
 		m_cameras.clear();
@@ -186,7 +193,7 @@ namespace AIE
 	}
 
 	//////////////////////////////////////////////////////////////////////////
-	bool FBXScene::Load(const char* a_filename)
+	bool FBXScene::Load(const char* a_filename, float a_weldTolerance)
 	{
 		if (m_root != nullptr)
 		{
@@ -194,6 +201,8 @@ namespace AIE
 			return false;
 		}
 
+		m_weldTolerance = a_weldTolerance;
+
 		FbxManager* lSdkManager = nullptr;
 		FbxScene* lScene = nullptr;
 
@@ -463,6 +472,8 @@ namespace AIE
 
 		FBXVertex vertex;
 		unsigned int vertexIndex[4] = {};
+
+		FBXVertexWelder welder(a_mesh->m_vertices, m_weldTolerance, fbxMesh->GetPolygonVertexCount());
 		
 		int vertexId = 0;
 		for (i = 0; i < lPolygonCount; i++)
@@ -672,7 +683,7 @@ namespace AIE
 				}
 
 				// add to 
-				vertexIndex[j] = AddVertGetIndex(a_mesh->m_vertices,vertex);
+				vertexIndex[j] = welder.AddVertGetIndex(vertex);
 				vertexId++;
 			}
 
@@ -708,59 +719,96 @@ namespace AIE
 		FbxCluster* lCluster;
 		char name[MAX_PATH];
 
-		int vertCount = a_mesh->m_vertices.size();
+		unsigned int vertCount = a_mesh->m_vertices.size();
 
 		FbxSkin* pSkin = (FbxSkin *) pGeometry->GetDeformer(0, FbxDeformer::eSkin);
 
-		if (pSkin != nullptr)
+		if (pSkin == nullptr)
+			return;
+
+		// build a control point -> vertex list index (compressed sparse rows)
+		// so that each cluster weight only visits the verts that use it.
+		// verts from bad polygons have a control point of -1 and are left
+		// out, so they get no influences
+		int lControlPointCount = pGeometry->GetControlPointsCount();
+
+		std::vector<unsigned int> rowOffsets(lControlPointCount + 1, 0);
+		for ( unsigned int v = 0 ; v < vertCount ; ++v )
 		{
-			lClusterCount = pSkin->GetClusterCount();
-			for (j = 0; j != lClusterCount; ++j)
-			{
-				lCluster = pSkin->GetCluster(j);
-				if (lCluster->GetLink() == nullptr)
-					continue;
+			int controlPoint = a_mesh->m_vertices[v].fbxControlPointIndex;
+			if (controlPoint >= 0 && controlPoint < lControlPointCount)
+				++rowOffsets[ controlPoint + 1 ];
+		}
+		for ( i = 0 ; i < lControlPointCount ; ++i )
+			rowOffsets[i + 1] += rowOffsets[i];
 
-				strncpy(name,lCluster->GetLink()->GetName(),MAX_PATH);
-				int boneIndex = g_Assistor->boneIndexList[name];
+		std::vector<unsigned int> rowVerts(vertCount);
+		std::vector<unsigned int> rowFill(rowOffsets.begin(), rowOffsets.end() - 1);
+		for ( unsigned int v = 0 ; v < vertCount ; ++v )
+		{
+			int controlPoint = a_mesh->m_vertices[v].fbxControlPointIndex;
+			if (controlPoint >= 0 && controlPoint < lControlPointCount)
+				rowVerts[ rowFill[ controlPoint ]++ ] = v;
+		}
+
+		lClusterCount = pSkin->GetClusterCount();
+		for (j = 0; j != lClusterCount; ++j)
+		{
+			lCluster = pSkin->GetCluster(j);
+			if (lCluster->GetLink() == nullptr)
+				continue;
 
-				int lIndexCount = lCluster->GetControlPointIndicesCount();
-				int* lIndices = lCluster->GetControlPointIndices();
-				double* lWeights = lCluster->GetControlPointWeights();
+			strncpy(name,lCluster->GetLink()->GetName(),MAX_PATH);
+			int boneIndex = g_Assistor->boneIndexList[name];
 
-				for (k = 0; k < lIndexCount; k++)
+			int lIndexCount = lCluster->GetControlPointIndicesCount();
+			int* lIndices = lCluster->GetControlPointIndices();
+			double* lWeights = lCluster->GetControlPointWeights();
+
+			for (k = 0; k < lIndexCount; k++)
+			{
+				float weight = (float)lWeights[k];
+				if (weight <= 0 ||
+					lIndices[k] < 0 || lIndices[k] >= lControlPointCount)
+					continue;
+
+				for ( unsigned int r = rowOffsets[ lIndices[k] ] ; r < rowOffsets[ lIndices[k] + 1 ] ; ++r )
 				{
-					// find vert using this bone
-					for ( i = 0 ; i < vertCount ; ++i )
+					// keep the 4 largest influences, sorted largest first
+					FBXVertex& vertex = a_mesh->m_vertices[ rowVerts[r] ];
+					float* weights = &vertex.weights.x;
+					float* indices = &vertex.indices.x;
+
+					int slot = 4;
+					while (slot > 0 && weights[slot - 1] < weight)
+						--slot;
+					if (slot == 4)
+						continue;
+
+					for ( int s = 3 ; s > slot ; --s )
 					{
-						if (a_mesh->m_vertices[i].fbxControlPointIndex == lIndices[k])
-						{
-							// add weight and index
-							if (a_mesh->m_vertices[i].weights.x == 0)
-							{
-								a_mesh->m_vertices[i].weights.x = (float) lWeights[k];
-								a_mesh->m_vertices[i].indices.x = (float)boneIndex;
-							}
-							else if (a_mesh->m_vertices[i].weights.y == 0)
-							{
-								a_mesh->m_vertices[i].weights.y = (float) lWeights[k];
-								a_mesh->m_vertices[i].indices.y = (float)boneIndex;
-							}
-							else if (a_mesh->m_vertices[i].weights.z == 0)
-							{
-								a_mesh->m_vertices[i].weights.z = (float) lWeights[k];
-								a_mesh->m_vertices[i].indices.z = (float)boneIndex;
-							}
-							else
-							{
-								a_mesh->m_vertices[i].weights.w = (float) lWeights[k];
-								a_mesh->m_vertices[i].indices.w = (float)boneIndex;
-							}
-						}
+						weights[s] = weights[s - 1];
+						indices[s] = indices[s - 1];
 					}
+					weights[slot] = weight;
+					indices[slot] = (float)boneIndex;
 				}
 			}
 		}
+
+		// normalise what was kept so dropped influences don't shrink the vertex
+		for ( unsigned int v = 0 ; v < vertCount ; ++v )
+		{
+			vec4& weights = a_mesh->m_vertices[v].weights;
+			float total = weights.x + weights.y + weights.z + weights.w;
+			if (total > 0)
+			{
+				weights.x /= total;
+				weights.y /= total;
+				weights.z /= total;
+				weights.w /= total;
+			}
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -1429,20 +1477,6 @@ namespace AIE
 			m_bones[ i ] = m_bindPoses[ i ] * m_nodes[ i ]->m_globalTransform * M;
 	}
 
-	//////////////////////////////////////////////////////////////////////////
-	// SLOWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWW
-	// TODO: Find a faster way to only add unique verts :(
-	unsigned int FBXScene::AddVertGetIndex(std::vector<FBXVertex>& a_vertices, const FBXVertex& a_vertex)
-	{
-		auto oIter = std::find(a_vertices.begin(),a_vertices.end(),a_vertex);
-		if (oIter != a_vertices.end())
-		{
-			return oIter - a_vertices.begin();
-		}
-		a_vertices.push_back(a_vertex);
-		return a_vertices.size() - 1;
-	}
-
 	//////////////////////////////////////////////////////////////////////////
 	void FBXScene::CalculateTangentsBinormals(std::vector<FBXVertex>& a_vertices, const std::vector<unsigned int>& a_indices)
 	{
@@ -1524,180 +1558,41 @@ namespace AIE
 	}
 
 	//////////////////////////////////////////////////////////////////////////
-	bool FBXScene::SaveAIE(const char* a_filename)
+	bool FBXScene::LoadAIE(const char* a_filename)
 	{
-		FILE* pFile = fopen(a_filename,"wb");
-
-		unsigned int i = 0, j = 0;
-		unsigned int uiAddress = 0;
-
-		// ambient light
-		fwrite(&m_ambientLight,sizeof(vec4),1,pFile);
-
-		// material count
-		unsigned int uiCount = m_materials.size();
-		fwrite(&uiCount,sizeof(unsigned int),1,pFile);
-
-		// for each material
-		for each (auto m in m_materials)
+		if (m_root != nullptr)
 		{
-			uiAddress = (unsigned int)m.second;
-
-			// write pointer address
-			fwrite(&uiAddress,sizeof(unsigned int),1,pFile);
-			// write material data
-			fwrite(m.second,sizeof(FBXMaterial),1,pFile);
+			printf("Scene already loaded!\n");
+			return false;
 		}
 
-		// write node count
-		uiCount = NodeCount(m_root);
-		fwrite(&uiCount,sizeof(unsigned int),1,pFile);
-		SaveNode(m_root, pFile);
-
-		// write skeleton count
-		uiCount = m_skeletons.size();
-		fwrite(&uiCount,sizeof(unsigned int),1,pFile);
-
-		// write skeleton data (nodes as pointer addresses)
-		for each (FBXSkeleton* s in m_skeletons)
+		FILE* pFile = fopen(a_filename,"rb");
+		if (pFile == nullptr)
 		{
-			fwrite(&s->m_boneCount,sizeof(unsigned int),1,pFile);
-			fwrite(s->m_bindPoses,sizeof(mat4),s->m_boneCount,pFile);
-			fwrite(s->m_nodes,sizeof(Node*),s->m_boneCount,pFile);
+			printf("Unable to open %s\n",a_filename);
+			return false;
 		}
 
-		// animation count
-		uiCount = m_animations.size();
-		fwrite(&uiCount,sizeof(unsigned int),1,pFile);
+		// version 2 files start with a magic number, version 1 files with the ambient light
+		unsigned int uiMagic = 0;
+		fread(&uiMagic,sizeof(unsigned int),1,pFile);
 
-		for each (auto a in m_animations)
+		if (uiMagic == AIEFile::MAGIC)
 		{
-			// write anim data, then each track in order
-			fwrite(a.second->m_name,sizeof(char),MAX_PATH,pFile);
-			fwrite(&a.second->m_startFrame,sizeof(unsigned int),1,pFile);
-			fwrite(&a.second->m_endFrame,sizeof(unsigned int),1,pFile);
-			fwrite(&a.second->m_trackCount,sizeof(unsigned int),1,pFile);
-
-			// each track writes keyframes in order
-			for ( i = 0 ; i < a.second->m_trackCount ; ++i )
-			{
-				fwrite(&a.second->m_tracks[i].m_boneIndex,sizeof(unsigned int),1,pFile);
-				fwrite(&a.second->m_tracks[i].m_keyframeCount,sizeof(unsigned int),1,pFile);
-				fwrite(a.second->m_tracks[i].m_keyframes,sizeof(FBXKeyFrame),a.second->m_tracks[i].m_keyframeCount,pFile);				
-			}
+			fclose(pFile);
+			return LoadAIEv2(a_filename);
 		}
 
+		rewind(pFile);
+		bool bResult = LoadAIEv1(pFile);
 		fclose(pFile);
 
-		return true;
+		return bResult;
 	}
 
 	//////////////////////////////////////////////////////////////////////////
-	void FBXScene::SaveNode(Node* a_node, FILE* a_file)
-	{
-		// write pointer address
-		unsigned int uiAddress = (unsigned int)a_node;
-		fwrite(&uiAddress,sizeof(unsigned int),1,a_file);
-
-		// write type
-		fwrite(&a_node->m_nodeType,sizeof(unsigned int),1,a_file);
-
-		// write name
-		fwrite(a_node->m_name,sizeof(char),MAX_PATH,a_file);
-
-		uiAddress = (unsigned int)a_node->m_parent;
-		fwrite(&uiAddress,sizeof(unsigned int),1,a_file);
-
-		// save transforms
-		fwrite(&a_node->m_localTransform,sizeof(mat4),1,a_file);
-		fwrite(&a_node->m_globalTransform,sizeof(mat4),1,a_file);
-
-		// write type specific data
-		switch (a_node->m_nodeType)
-		{
-		case Node::MESH:	SaveMeshData((FBXMeshNode*)a_node,a_file);		break;
-		case Node::LIGHT:	SaveLightData((FBXLightNode*)a_node,a_file);	break;
-		case Node::CAMERA:	SaveCameraData((FBXCameraNode*)a_node,a_file);	break;
-		default:	break;
-		};
-
-		// write child count
-		unsigned int uiCount = a_node->m_children.size();
-		fwrite(&uiCount,sizeof(unsigned int),1,a_file);
-
-		// write child pointer addresses
-		for each (Node* n in a_node->m_children)
-		{
-			uiAddress = (unsigned int)n;
-			fwrite(&uiAddress,sizeof(unsigned int),1,a_file);
-		}
-
-		// write child nodes
-		for each (Node* n in a_node->m_children)
-		{
-			SaveNode(n,a_file);
-		}
-	}
-
-	void FBXScene::SaveMeshData(FBXMeshNode* a_mesh, FILE* a_file)
+	bool FBXScene::LoadAIEv1(FILE* pFile)
 	{
-		// write material address
-		unsigned int uiAddress = (unsigned int)a_mesh->m_material;
-		fwrite(&uiAddress,sizeof(unsigned int),1,a_file);
-
-		// write vertex count
-		unsigned int uiCount = a_mesh->m_vertices.size();
-		fwrite(&uiCount,sizeof(unsigned int),1,a_file);
-
-		// write vertices
-		fwrite(a_mesh->m_vertices.data(),sizeof(FBXVertex),uiCount,a_file);
-
-		// write index count
-		uiCount = a_mesh->m_indices.size();
-		fwrite(&uiCount,sizeof(unsigned int),1,a_file);
-
-		// write indices
-		fwrite(a_mesh->m_indices.data(),sizeof(unsigned int),uiCount,a_file);
-	}
-
-	void FBXScene::SaveLightData(FBXLightNode* a_light, FILE* a_file)
-	{
-		// save light type
-		unsigned int uiValue = a_light->m_type;
-		fwrite(&uiValue,sizeof(unsigned int),1,a_file);
-
-		// save if on / off (as unsigned int for packing)
-		uiValue = a_light->m_on ? 1 : 0;
-		fwrite(&uiValue,sizeof(unsigned int),1,a_file);
-
-		// save colour
-		fwrite(&a_light->m_colour,sizeof(vec4),1,a_file);
-
-		// save both angles
-		fwrite(&a_light->m_innerAngle,sizeof(float),1,a_file);
-		fwrite(&a_light->m_outerAngle,sizeof(float),1,a_file);
-
-		// save attenuation
-		fwrite(&a_light->m_attenuation,sizeof(vec4),1,a_file);
-	}
-
-	void FBXScene::SaveCameraData(FBXCameraNode* a_camera, FILE* a_file)
-	{
-		// save aspect, FOV, near, far
-		fwrite(&a_camera->m_aspectRatio,sizeof(float),1,a_file);
-		fwrite(&a_camera->m_fieldOfView,sizeof(float),1,a_file);
-		fwrite(&a_camera->m_near,sizeof(float),1,a_file);
-		fwrite(&a_camera->m_far,sizeof(float),1,a_file);
-
-		// save view matrix
-		fwrite(&a_camera->m_viewMatrix,sizeof(mat4),1,a_file);
-	}
-
-	//////////////////////////////////////////////////////////////////////////
-	bool FBXScene::LoadAIE(const char* a_filename)
-	{
-		FILE* pFile = fopen(a_filename,"rb");
-
 		unsigned int i = 0, j = 0;
 		unsigned int uiAddress = 0, type = Node::NODE;
 
@@ -1788,8 +1683,6 @@ namespace AIE
 			m_animations[ anim->m_name ] = anim;
 		}
 
-		fclose(pFile);
-
 		return true;
 	}
 
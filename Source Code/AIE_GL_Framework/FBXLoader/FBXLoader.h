@@ -271,17 +271,21 @@ namespace AIE
 	{
 	public:
 
-		FBXScene() : m_root(nullptr) {}
+		FBXScene() : m_root(nullptr), m_weldTolerance(0.0001f), 
+			m_mappedFile(nullptr), m_mappedView(nullptr), m_mappedSize(0) {}
 		~FBXScene() 
 		{
 			Unload();
 		}
 
 		// must unload a scene before loading a new one over top
-		bool			Load(const char* a_filename);
+		// vertices within a_weldTolerance of each other are merged, 0 only merges exact matches
+		bool			Load(const char* a_filename, float a_weldTolerance = 0.0001f);
 		void			Unload();
 
 		// save/load from binary format that does not need to be parsed
+		// saving always writes version 2, loading accepts version 1 or 2
+		// a version 2 file stays mapped until the scene is unloaded
 		bool			SaveAIE(const char* a_filename);
 		bool			LoadAIE(const char* a_filename);
 
@@ -334,13 +338,15 @@ namespace AIE
 		FBXMaterial*	ExtractMaterial(void* a_mesh);
 
 		// helpers used for building meshes
-		unsigned int AddVertGetIndex(std::vector<FBXVertex>& a_vertices, const FBXVertex& a_vertex);
 		void CalculateTangentsBinormals(std::vector<FBXVertex>& a_vertices, const std::vector<unsigned int>& a_indices);
 
-		void	SaveNode(Node* a_node, FILE* a_file);
-		void	SaveMeshData(FBXMeshNode* a_mesh, FILE* a_file);
-		void	SaveLightData(FBXLightNode* a_light, FILE* a_file);
-		void	SaveCameraData(FBXCameraNode* a_camera, FILE* a_file);
+		// version 2 memory mapped format, see AIEFormat.h
+		bool	LoadAIEv2(const char* a_filename);
+		void	UnmapAIE();
+		bool	IsMapped(const void* a_pointer) const;
+
+		// version 1 format, only readable by 32-bit builds as it stores pointer addresses
+		bool	LoadAIEv1(FILE* a_file);
 
 		void	LoadNode(std::map<unsigned int,Node*>& nodes, std::map<unsigned int, FBXMaterial*>& materials, FILE* a_file);
 		void	LoadMeshData(FBXMeshNode* a_mesh, std::map<unsigned int, FBXMaterial*>& materials, FILE* a_file);
@@ -357,6 +363,13 @@ namespace AIE
 
 		std::string								m_path;
 
+		float									m_weldTolerance;
+
+		// mapped .aie file, materials and keyframes point directly into the view
+		HANDLE									m_mappedFile;
+		const char*								m_mappedView;
+		unsigned long long						m_mappedSize;
+
 		vec4									m_ambientLight;
 		std::map<std::string,FBXMeshNode*>		m_meshes;
 		std::map<std::string,FBXLightNode*>		m_lights;
@@ -0,0 +1,266 @@
+//////////////////////////////////////////////////////////////////////////
+// Author:	Conan Bourke
+// Date:	January 5 2013
+// Brief:	Hash based vertex welding used while building FBX meshes
+//////////////////////////////////////////////////////////////////////////
+#include "VertexWelder.h"
+#include <math.h>
+
+namespace AIE
+{
+	//////////////////////////////////////////////////////////////////////////
+	FBXVertexWelder::FBXVertexWelder(std::vector<FBXVertex>& a_vertices, float a_tolerance, unsigned int a_expectedCount)
+		: m_vertices(a_vertices), m_tolerance(a_tolerance > 0 ? a_tolerance : 0), m_used(0)
+	{
+		// keep the table at most half full
+		unsigned int capacity = 64;
+		while (capacity < a_expectedCount * 2)
+			capacity <<= 1;
+
+		Slot empty;
+		empty.hash = 0;
+		empty.index = EMPTY_SLOT;
+		empty.cell[0] = empty.cell[1] = empty.cell[2] = 0;
+		m_slots.assign(capacity, empty);
+
+		m_vertices.reserve(a_expectedCount);
+		if (m_tolerance > 0)
+			m_next.reserve(a_expectedCount);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	unsigned int FBXVertexWelder::AddVertGetIndex(const FBXVertex& a_vertex)
+	{
+		unsigned int index = (unsigned int)m_vertices.size();
+
+		if (m_tolerance == 0)
+		{
+			unsigned int hash = HashExact(a_vertex);
+			unsigned int found = FindExact(a_vertex, hash);
+			if (found != EMPTY_SLOT)
+				return found;
+
+			m_vertices.push_back(a_vertex);
+
+			Slot slot;
+			slot.hash = hash;
+			slot.index = index;
+			slot.cell[0] = slot.cell[1] = slot.cell[2] = 0;
+			Insert(slot);
+			return index;
+		}
+
+		long long cell[3];
+		Quantize(a_vertex.position, cell);
+
+		// a match within tolerance can sit at most one cell away on each axis
+		unsigned int best = EMPTY_SLOT;
+		long long neighbour[3];
+		for (int x = -1; x <= 1; ++x)
+		{
+			neighbour[0] = cell[0] + x;
+			for (int y = -1; y <= 1; ++y)
+			{
+				neighbour[1] = cell[1] + y;
+				for (int z = -1; z <= 1; ++z)
+				{
+					neighbour[2] = cell[2] + z;
+					best = FindInCell(a_vertex, neighbour, best);
+				}
+			}
+		}
+
+		if (best != EMPTY_SLOT)
+			return best;
+
+		m_vertices.push_back(a_vertex);
+
+		// link into the cell's chain, or start a new cell
+		unsigned int hash = HashCell(cell);
+		unsigned int slotIndex = FindCellSlot(cell, hash);
+		if (slotIndex != EMPTY_SLOT)
+		{
+			m_next.push_back(m_slots[slotIndex].index);
+			m_slots[slotIndex].index = index;
+		}
+		else
+		{
+			m_next.push_back(EMPTY_SLOT);
+
+			Slot slot;
+			slot.hash = hash;
+			slot.index = index;
+			slot.cell[0] = cell[0];
+			slot.cell[1] = cell[1];
+			slot.cell[2] = cell[2];
+			Insert(slot);
+		}
+
+		return index;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	unsigned int FBXVertexWelder::FindExact(const FBXVertex& a_vertex, unsigned int a_hash) const
+	{
+		unsigned int mask = m_slots.size() - 1;
+		for (unsigned int i = a_hash & mask ; m_slots[i].index != EMPTY_SLOT ; i = (i + 1) & mask)
+		{
+			if (m_slots[i].hash == a_hash &&
+				EqualExact(m_vertices[m_slots[i].index], a_vertex))
+				return m_slots[i].index;
+		}
+		return EMPTY_SLOT;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	unsigned int FBXVertexWelder::FindInCell(const FBXVertex& a_vertex, const long long* a_cell, unsigned int a_best) const
+	{
+		unsigned int slotIndex = FindCellSlot(a_cell, HashCell(a_cell));
+		if (slotIndex == EMPTY_SLOT)
+			return a_best;
+
+		// chains are newest first, so walk them fully to find the lowest index
+		for (unsigned int i = m_slots[slotIndex].index ; i != EMPTY_SLOT ; i = m_next[i])
+		{
+			if (i < a_best &&
+				EqualTolerance(m_vertices[i], a_vertex))
+				a_best = i;
+		}
+		return a_best;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	unsigned int FBXVertexWelder::FindCellSlot(const long long* a_cell, unsigned int a_hash) const
+	{
+		unsigned int mask = m_slots.size() - 1;
+		for (unsigned int i = a_hash & mask ; m_slots[i].index != EMPTY_SLOT ; i = (i + 1) & mask)
+		{
+			const Slot& slot = m_slots[i];
+			if (slot.hash == a_hash &&
+				slot.cell[0] == a_cell[0] &&
+				slot.cell[1] == a_cell[1] &&
+				slot.cell[2] == a_cell[2])
+				return i;
+		}
+		return EMPTY_SLOT;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	void FBXVertexWelder::Insert(const Slot& a_slot)
+	{
+		if ((m_used + 1) * 2 > m_slots.size())
+			Grow();
+
+		unsigned int mask = m_slots.size() - 1;
+		unsigned int i = a_slot.hash & mask;
+		while (m_slots[i].index != EMPTY_SLOT)
+			i = (i + 1) & mask;
+
+		m_slots[i] = a_slot;
+		++m_used;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	void FBXVertexWelder::Grow()
+	{
+		std::vector<Slot> old;
+		old.swap(m_slots);
+
+		Slot empty = old[0];
+		empty.index = EMPTY_SLOT;
+		m_slots.assign(old.size() * 2, empty);
+
+		unsigned int mask = m_slots.size() - 1;
+		for each (const Slot& slot in old)
+		{
+			if (slot.index == EMPTY_SLOT)
+				continue;
+
+			unsigned int i = slot.hash & mask;
+			while (m_slots[i].index != EMPTY_SLOT)
+				i = (i + 1) & mask;
+			m_slots[i] = slot;
+		}
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// compares the same components as FBXVertex::operator== (XYZ of each vec4)
+	bool FBXVertexWelder::EqualExact(const FBXVertex& a_lhs, const FBXVertex& a_rhs) const
+	{
+		const vec4* lhs = &a_lhs.position;
+		const vec4* rhs = &a_rhs.position;
+		for (int i = 0 ; i < 7 ; ++i)
+		{
+			if (lhs[i].x != rhs[i].x ||
+				lhs[i].y != rhs[i].y ||
+				lhs[i].z != rhs[i].z)
+				return false;
+		}
+		return (a_lhs.uv.x == a_rhs.uv.x && a_lhs.uv.y == a_rhs.uv.y &&
+				a_lhs.uv2.x == a_rhs.uv2.x && a_lhs.uv2.y == a_rhs.uv2.y);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	bool FBXVertexWelder::EqualTolerance(const FBXVertex& a_lhs, const FBXVertex& a_rhs) const
+	{
+		return (EqualWithinTolerance(a_lhs.position,a_rhs.position,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.colour,a_rhs.colour,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.normal,a_rhs.normal,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.tangent,a_rhs.tangent,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.binormal,a_rhs.binormal,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.indices,a_rhs.indices,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.weights,a_rhs.weights,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.uv,a_rhs.uv,m_tolerance) &&
+				EqualWithinTolerance(a_lhs.uv2,a_rhs.uv2,m_tolerance));
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	// FNV-1a over the bit patterns of the compared components.
+	// Adding 0 folds -0 into +0 so that values which compare equal hash equal.
+	unsigned int FBXVertexWelder::HashExact(const FBXVertex& a_vertex) const
+	{
+		union
+		{
+			float			f[25];
+			unsigned int	bits[25];
+		} values;
+
+		const vec4* v = &a_vertex.position;
+		for (int i = 0 ; i < 7 ; ++i)
+		{
+			values.f[i * 3 + 0] = v[i].x + 0.0f;
+			values.f[i * 3 + 1] = v[i].y + 0.0f;
+			values.f[i * 3 + 2] = v[i].z + 0.0f;
+		}
+		values.f[21] = a_vertex.uv.x + 0.0f;
+		values.f[22] = a_vertex.uv.y + 0.0f;
+		values.f[23] = a_vertex.uv2.x + 0.0f;
+		values.f[24] = a_vertex.uv2.y + 0.0f;
+
+		unsigned int hash = 2166136261u;
+		for (int i = 0 ; i < 25 ; ++i)
+		{
+			hash ^= values.bits[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	void FBXVertexWelder::Quantize(const vec4& a_position, long long* a_cell) const
+	{
+		a_cell[0] = (long long)floor((double)a_position.x / m_tolerance);
+		a_cell[1] = (long long)floor((double)a_position.y / m_tolerance);
+		a_cell[2] = (long long)floor((double)a_position.z / m_tolerance);
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+	unsigned int FBXVertexWelder::HashCell(const long long* a_cell)
+	{
+		unsigned long long hash = (unsigned long long)a_cell[0] * 73856093ull;
+		hash ^= (unsigned long long)a_cell[1] * 19349663ull;
+		hash ^= (unsigned long long)a_cell[2] * 83492791ull;
+		return (unsigned int)(hash ^ (hash >> 32));
+	}
+
+} // namespace AIE
@@ -0,0 +1,79 @@
+//////////////////////////////////////////////////////////////////////////
+// Author:	Conan Bourke
+// Date:	January 5 2013
+// Brief:	Hash based vertex welding used while building FBX meshes.
+//			Replaces the linear std::find search over a mesh's vertices.
+//////////////////////////////////////////////////////////////////////////
+#ifndef __VERTEXWELDER_H_
+#define __VERTEXWELDER_H_
+//////////////////////////////////////////////////////////////////////////
+#include "FBXLoader.h"
+
+//////////////////////////////////////////////////////////////////////////
+namespace AIE
+{
+	// Open addressing hash table that maps vertices to their index within
+	// a vertex array, adding the vertex if no match exists yet.
+	//
+	// With a tolerance of 0 vertices are keyed on the bit pattern of every
+	// attribute that FBXVertex::operator== compares and must match exactly.
+	// With a tolerance above 0 vertices are keyed on their position quantized
+	// to cells of tolerance size, and the neighbouring cells are searched with
+	// the same per attribute tolerance test as FBXVertex::operator==.
+	// Either way the lowest matching index is returned, so the index buffer
+	// is identical to one built with a linear search.
+	// The vertex array must start empty and only be added to via the welder.
+	class FBXVertexWelder
+	{
+	public:
+
+		FBXVertexWelder(std::vector<FBXVertex>& a_vertices, float a_tolerance = 0, unsigned int a_expectedCount = 0);
+		~FBXVertexWelder() {}
+
+		unsigned int	AddVertGetIndex(const FBXVertex& a_vertex);
+
+	private:
+
+		struct Slot
+		{
+			unsigned int	hash;
+			unsigned int	index;		// vertex index, or head of the cell's chain
+			long long		cell[3];	// only used when welding with a tolerance
+		};
+
+		enum : unsigned int { EMPTY_SLOT = 0xffffffff };
+
+		unsigned int	FindExact(const FBXVertex& a_vertex, unsigned int a_hash) const;
+		unsigned int	FindInCell(const FBXVertex& a_vertex, const long long* a_cell, unsigned int a_best) const;
+		unsigned int	FindCellSlot(const long long* a_cell, unsigned int a_hash) const;
+
+		void			Insert(const Slot& a_slot);
+		void			Grow();
+
+		bool			EqualExact(const FBXVertex& a_lhs, const FBXVertex& a_rhs) const;
+		bool			EqualTolerance(const FBXVertex& a_lhs, const FBXVertex& a_rhs) const;
+
+		unsigned int	HashExact(const FBXVertex& a_vertex) const;
+		void			Quantize(const vec4& a_position, long long* a_cell) const;
+
+		static unsigned int	HashCell(const long long* a_cell);
+
+		std::vector<FBXVertex>&		m_vertices;
+		float						m_tolerance;
+
+		std::vector<Slot>			m_slots;
+		unsigned int				m_used;
+
+		// per vertex link to the next vertex in the same cell
+		std::vector<unsigned int>	m_next;
+
+		// non-copyable
+		FBXVertexWelder(const FBXVertexWelder&);
+		FBXVertexWelder& operator = (const FBXVertexWelder&);
+	};
+
+} // namespace AIE
+
+//////////////////////////////////////////////////////////////////////////
+#endif // __VERTEXWELDER_H_
+//////////////////////////////////////////////////////////////////////////
@@ -51,6 +51,13 @@ unsigned int LoadShader(unsigned int a_uiInputAttributeCount, const char** a_asz
 // helper function for loading shader code into memory
 char* FileToBuffer(const char* a_szPath);
 
+// code spliced in after the #version line of every stage LoadShader reads, for
+// declarations shared by all programs. nullptr for none, the text isn't copied
+void SetShaderHeader(const char* a_szHeader);
+
+// loads a stage's code like FileToBuffer with the shader header spliced in
+char* LoadShaderSource(const char* a_szPath);
+
 // builds a textured plane out of 2 triangles and fills in the vertex array, vertex buffer, and index buffer
 void Build3DPlane(float a_fSize, unsigned int& a_ruiVAO, unsigned int& a_ruiVBO, unsigned int& a_ruiIBO);
 
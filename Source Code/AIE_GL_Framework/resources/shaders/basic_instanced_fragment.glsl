@@ -0,0 +1,13 @@
+#version 400
+
+in vec2 vUV;
+flat in float vLayer;
+
+out vec4 outColour;
+
+uniform sampler2DArray diffuseTexture;
+
+void main()
+{
+	outColour.rgba = texture( diffuseTexture, vec3( vUV, vLayer ) ).bgra;
+}
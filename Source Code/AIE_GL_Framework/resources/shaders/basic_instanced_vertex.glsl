@@ -0,0 +1,17 @@
+#version 400
+
+in vec4 Position;
+in vec2 UV;
+in vec2 InstanceLayers;
+in mat4 InstanceModel;
+
+out vec2 vUV;
+flat out float vLayer;
+
+void main()
+{
+	vUV		= UV;
+	vLayer	= InstanceLayers.x;
+
+	gl_Position = Projection * View * InstanceModel * Position;
+}
@@ -0,0 +1,18 @@
+#version 400
+
+in vec2 vUV;
+out vec4 outColour;
+
+uniform sampler2D	SourceTexture;
+uniform vec2		TexelSize;		// of the source
+
+// four bilinear fetches one texel out from the centre, each the average of
+// a 2x2 block, cover 4x4 source texels for every texel written
+void main()
+{
+	outColour  = texture2D( SourceTexture, vUV + vec2(-TexelSize.x, -TexelSize.y) );
+	outColour += texture2D( SourceTexture, vUV + vec2( TexelSize.x, -TexelSize.y) );
+	outColour += texture2D( SourceTexture, vUV + vec2(-TexelSize.x,  TexelSize.y) );
+	outColour += texture2D( SourceTexture, vUV + vec2( TexelSize.x,  TexelSize.y) );
+	outColour *= 0.25;
+}
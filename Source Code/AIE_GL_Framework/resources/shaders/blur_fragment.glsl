@@ -0,0 +1,28 @@
+#version 400
+
+#define MAX_BLUR_TAPS 8
+
+in vec2 vUV;
+out vec4 outColour;
+
+uniform sampler2D	SourceTexture;
+uniform vec2		TexelStep;		// one texel along the blur direction
+
+// one side of the kernel from BuildLinearKernel, tap 0 is the centre
+uniform int			TapCount;
+uniform float		BlurOffsets[MAX_BLUR_TAPS];
+uniform float		BlurWeights[MAX_BLUR_TAPS];
+
+void main()
+{
+	vec4 sum = texture2D( SourceTexture, vUV ) * BlurWeights[0];
+
+	for( int i = 1; i < TapCount; ++i )
+	{
+		vec2 offset = TexelStep * BlurOffsets[i];
+		sum += texture2D( SourceTexture, vUV + offset ) * BlurWeights[i];
+		sum += texture2D( SourceTexture, vUV - offset ) * BlurWeights[i];
+	}
+
+	outColour = sum;
+}
@@ -0,0 +1,26 @@
+#version 400
+
+in vec2 vUV;
+out vec4 outColour;
+
+uniform sampler2D	SourceTexture;	// this level, blurred
+uniform sampler2D	CoarseTexture;	// the level below, already upsampled into
+uniform vec2		TexelSize;		// of the coarse level
+uniform float		UpsampleBlend;
+
+void main()
+{
+	// 3x3 tent over the coarse level so its texels don't show as blocks
+	vec4 coarse = texture2D( CoarseTexture, vUV ) * 4.0;
+	coarse += texture2D( CoarseTexture, vUV + vec2(-TexelSize.x, 0.0) ) * 2.0;
+	coarse += texture2D( CoarseTexture, vUV + vec2( TexelSize.x, 0.0) ) * 2.0;
+	coarse += texture2D( CoarseTexture, vUV + vec2(0.0, -TexelSize.y) ) * 2.0;
+	coarse += texture2D( CoarseTexture, vUV + vec2(0.0,  TexelSize.y) ) * 2.0;
+	coarse += texture2D( CoarseTexture, vUV + vec2(-TexelSize.x, -TexelSize.y) );
+	coarse += texture2D( CoarseTexture, vUV + vec2( TexelSize.x, -TexelSize.y) );
+	coarse += texture2D( CoarseTexture, vUV + vec2(-TexelSize.x,  TexelSize.y) );
+	coarse += texture2D( CoarseTexture, vUV + vec2( TexelSize.x,  TexelSize.y) );
+	coarse /= 16.0;
+
+	outColour = mix( texture2D( SourceTexture, vUV ), coarse, UpsampleBlend );
+}
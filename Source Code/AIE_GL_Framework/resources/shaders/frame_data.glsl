@@ -0,0 +1,20 @@
+// Per frame values shared by every program. The shader loader splices this
+// in after the #version line of each stage, so it's the only declaration of
+// the block. The CPU side is FrameUniforms in FrameUniforms.h, keep the two
+// in the same order.
+layout(std140) uniform FrameData
+{
+	mat4	Projection;
+	mat4	View;
+	mat4	CameraMat;
+	vec4	CameraPos;
+	vec4	ambientColour;
+	vec4	dirLightDir;
+	vec4	dirLightCol;
+	vec4	pointLightPos;
+	vec4	pointLightCol;
+	vec4	spotLightPos;
+	vec4	spotLightDir;
+	vec4	spotLightCol;
+	float	Time;
+};
@@ -10,10 +10,8 @@ out vec4 vCol;
 
 uniform sampler2D diffuseTexture;
 //uniform sampler2D normalTexture;
-uniform mat4 Projection;
-uniform mat4 View;
+
 uniform mat4 Model;
-uniform float Time;
 
 void main()
 {
@@ -7,7 +7,6 @@ in vec4 gCol;
 
 out vec4 outColour;
 
-uniform float Time;
 uniform float Distance;
 uniform sampler2D diffuseTexture;
 uniform sampler2D secondaryTexture;
@@ -0,0 +1,32 @@
+#version 400
+
+in vec2 vUV;
+flat in vec2 vLayers;
+flat in float vDistance;
+
+out vec4 outColour;
+
+uniform sampler2DArray diffuseTexture;
+uniform sampler2DArray secondaryTexture;
+uniform vec4 Colour;
+
+void main()
+{
+	vec4 diffuse	= texture( diffuseTexture,		vec3( vUV, vLayers.x ) ).bgra;
+	vec4 secondary	= texture( secondaryTexture,	vec3( vUV, vLayers.y ) ).bgra;
+
+	outColour.rgba = diffuse;
+	outColour.rgb -= Colour.rgb;
+
+	float dist = vDistance;
+	if( dist < 50 )
+		outColour.rgba = secondary;
+
+	else if( dist < 90 )
+	{
+		dist = (dist - 50)/ 40;
+		outColour.rgba = diffuse * dist;
+		outColour.rgba += secondary * (1 - dist);
+		outColour.rgb -= (Colour.rgb * dist);
+	}
+}
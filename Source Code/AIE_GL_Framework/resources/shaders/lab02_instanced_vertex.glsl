@@ -0,0 +1,31 @@
+#version 400
+
+in vec4 Position;
+in vec2 UV;
+in vec2 InstanceLayers;
+in mat4 InstanceModel;
+
+out vec2 vUV;
+flat out vec2 vLayers;
+flat out float vDistance;
+
+void main()
+{
+	vUV		= UV;
+	vLayers	= InstanceLayers;
+
+	// what Distance held for the painting as a node of its own
+	vDistance = distance( CameraPos.xyz, InstanceModel[3].xyz );
+
+	vec4 worldPosition = InstanceModel * Position;
+
+	if( vDistance < 50 )
+		worldPosition.y += sin(Time + worldPosition.x*0.04);
+	else if( vDistance < 90 )
+	{
+		float dist = (vDistance - 50)/ 40;
+		worldPosition.y += sin(Time + worldPosition.x*0.04) * (1 - dist);
+	}
+
+	gl_Position = Projection * View * worldPosition;
+}
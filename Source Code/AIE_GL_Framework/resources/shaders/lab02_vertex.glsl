@@ -8,12 +8,10 @@ out vec4 vScreenPosition;
 out vec2 vUV;
 
 uniform sampler2D diffuseTexture;
-uniform mat4 Projection;
-uniform mat4 View;
+
 uniform mat4 Model;
 uniform float Distance;
 
-uniform float Time;
 
 void main()
 {
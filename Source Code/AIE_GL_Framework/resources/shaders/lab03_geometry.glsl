@@ -14,26 +14,29 @@ out vec2 gUV;
 out vec4 gCol;
 out vec4 gNormal;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
-uniform float Time;
 
 void main()
 {
-	mat4 pvmMatrix = Projection * View * Model;
+	mat4 pvMatrix = Projection * View;
 
-	vec4 norm = vec4( cross(	teWorldPosition[0].xyz - teWorldPosition[1].xyz,
-								teWorldPosition[2].xyz - teWorldPosition[0].xyz ), 0 );
-	norm = normalize( norm );
+	// the sphere moves through Model, so the normal and the lit position come
+	// from the moved triangle rather than the model space one
+	vec4 aWorldPosition[3];
+	for( int i=0; i<3; ++i )
+	{
+		aWorldPosition[i] = Model * teWorldPosition[i];
+	}
 
-	gNormal = norm;
+	vec4 norm = vec4( cross(	aWorldPosition[0].xyz - aWorldPosition[1].xyz,
+								aWorldPosition[2].xyz - aWorldPosition[0].xyz ), 0 );
+	norm = normalize( norm );
 
 	for( int i=0; i<3; ++i )
 	{
-		
-		gl_Position		= pvmMatrix * ( teWorldPosition[i] + (norm * (.5 + sin(Time*2)/2 ) ));
-		gWorldPosition	= teWorldPosition[i];
+		gl_Position		= pvMatrix * ( aWorldPosition[i] + (norm * (.5 + sin(Time*2)/2 ) ));
+		gWorldPosition	= aWorldPosition[i];
+		gNormal			= norm;
 		gUV				= teUV[i];
 		EmitVertex();
 	}
@@ -8,8 +8,6 @@ in vec4 vWorldPosition[];
 out vec2 tcUV[];
 out vec4 tcWorldPosition[];
 
-uniform float Time;
-uniform vec4 CameraPos;
 uniform sampler2D diffuseTexture;
 uniform sampler2D secondaryTexture;
 uniform vec4 Colour;
@@ -8,7 +8,6 @@ in vec4 gNormal;
 
 out vec4 outColour;
 
-uniform mat4 View;
 uniform sampler2D diffuseTexture;
 uniform vec4 Colour;
 
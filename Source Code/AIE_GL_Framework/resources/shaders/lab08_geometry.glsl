@@ -15,10 +15,7 @@ out vec2 gUV;
 out vec4 gCol;
 out vec4 gNormal;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
-uniform float Time;
 
 void main()
 {
@@ -27,7 +24,7 @@ void main()
 	for( int i=0; i<3; ++i )
 	{
 		gl_Position		= pvmMatrix * ( teWorldPosition[i] );
-		gWorldPosition	= teWorldPosition[i];
+		gWorldPosition	= Model * teWorldPosition[i];
 		gUV				= teUV[i];
 		gNormal			= teNormal[i];
 
@@ -16,7 +16,6 @@ uniform vec4 materialDiffuse;
 uniform sampler2D diffuseTexture;
 uniform sampler2D normalTexture;
 uniform sampler2D specularTexture;
-uniform vec4 CamPos;
 
 // directional light
 uniform vec4 light0Dir;
@@ -57,7 +56,7 @@ lightDir0			= normalize( lightDir0 );
 	vec3 R = (2 * vNormal * dot(normalize(lightDir0), vNormal) - normalize(lightDir0) );
 
 	//Vector from surface to camera
-	vec3 V = normalize( CamPos.xyz - vSurfacePos.xyz );
+	vec3 V = normalize( CameraPos.xyz - vSurfacePos.xyz );
 	float RdotV = clamp( dot(R, V), 0, 1 );
 	outColour.rgb += pow(RdotV, 20) * lightCol;
 
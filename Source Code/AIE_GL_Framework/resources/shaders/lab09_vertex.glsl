@@ -18,10 +18,7 @@ out vec2 vUV;
 out vec4 vCameraPos;
 out vec4 vSurfacePos;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
-uniform vec4 CamPos;
 
 uniform mat4 boneArray[73];
 
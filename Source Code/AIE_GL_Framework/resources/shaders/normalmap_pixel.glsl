@@ -12,27 +12,10 @@ in vec4 vSurfacePos;
 out vec4 outColour;
 
 uniform vec4 materialDiffuse;
-uniform vec4 ambientColour;
 
 uniform sampler2D diffuseTexture;
 uniform sampler2D normalTexture;
 uniform sampler2D specularTexture;
-uniform vec4 CamPos;
-
-uniform float time;
-
-// directional light
-uniform vec4 dirLightDir;
-uniform vec4 dirLightCol;
-
-// point light
-uniform vec4 pointLightPos;
-uniform vec4 pointLightCol;
-
-// spot light
-uniform vec4 spotLightPos;
-uniform vec4 spotLightDir;
-uniform vec4 spotLightCol;
 
 void main()
 {
@@ -62,7 +45,7 @@ void main()
 
 //===Specular Lighting===//
 	vec3 R			= (2 * normal * dot(normalize(dirLightDir.rgb), normal) - normalize(dirLightDir.rgb) ); //Light's reflection vector
-	vec3 V			= normalize( CamPos.xyz - vSurfacePos.xyz ); //Vector from surface to camera
+	vec3 V			= normalize( CameraPos.xyz - vSurfacePos.xyz ); //Vector from surface to camera
 	float RdotV		= clamp( dot(R, V), 0, 1 );
 	outColour.rgb	+= SpecTexture * pow(RdotV, 20) * dirLightCol.rgb;
 
@@ -78,7 +61,7 @@ void main()
 
 	//===Specular Lighting===//
 	R				= (2 * normal * dot(normalize(pointLightDir.rgb), normal) - normalize(pointLightDir.rgb) ); //Light's reflection vector
-	V				= normalize( CamPos.xyz - vSurfacePos.xyz ); //Vector from surface to camera
+	V				= normalize( CameraPos.xyz - vSurfacePos.xyz ); //Vector from surface to camera
 	RdotV			= clamp( dot(R, V), 0, 1 );
 	vec3 specTerm	= SpecTexture * pow(RdotV, 20) * pointLightCol.rgb;
 
@@ -118,7 +101,7 @@ void main()
 
 			//===Specular Lighting===//
 			R				= (2 * normal * dot(normalize(spotLightDir.rgb), normal) - normalize(spotLightDir.rgb) ); //Light's reflection vector
-			V				= normalize( CamPos.xyz - vSurfacePos.xyz ); //Vector from surface to camera
+			V				= normalize( CameraPos.xyz - vSurfacePos.xyz ); //Vector from surface to camera
 			RdotV			= clamp( dot(R, V), 0, 1 );
 			specTerm		= SpecTexture * pow(RdotV, 20) * spotLightCol.rgb;
 
@@ -11,11 +11,8 @@ in float vAlpha[];
 out vec2 gUV;
 out float gAlpha;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
 
-uniform mat4 CameraMat;
 
 void main()
 {
@@ -10,8 +10,7 @@ out vec2 vSize;
 out float vAlpha;
 
 uniform sampler2D diffuseTexture;
-uniform mat4 Projection;
-uniform mat4 View;
+
 uniform mat4 Model;
 
 void main()
@@ -10,8 +10,6 @@ out vec4 outColour;
 uniform sampler2D diffuseTexture;
 uniform sampler2D renderBuffer;
 
-uniform float Time;
-
 void main()
 {
 	vec4 lightDir1 = vec4( 4, 1, 0, 0 );
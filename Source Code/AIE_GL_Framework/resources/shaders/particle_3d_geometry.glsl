@@ -14,12 +14,8 @@ out vec4 gColour;
 out float gAlpha;
 out vec3 gNormal;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
-uniform mat4 CameraMat;
 
-uniform float Time;
 
 void main()
 {
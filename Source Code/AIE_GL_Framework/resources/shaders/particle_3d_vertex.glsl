@@ -12,8 +12,7 @@ out vec4 vColour;
 out float vAlpha;
 
 uniform sampler2D diffuseTexture;
-uniform mat4 Projection;
-uniform mat4 View;
+
 uniform mat4 Model;
 
 void main()
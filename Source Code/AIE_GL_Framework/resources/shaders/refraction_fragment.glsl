@@ -10,7 +10,6 @@ out vec4 outColour;
 uniform sampler2D Texture;
 uniform sampler2D SceneTexture;
 uniform sampler2D WaterBumpMap;
-uniform float Time;
 
 void main()
 {
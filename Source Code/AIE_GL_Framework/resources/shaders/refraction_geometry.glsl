@@ -13,10 +13,7 @@ out vec4 gScreenPosition;
 out vec2 gUV;
 out vec4 gCol;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
-uniform float Time;
 
 void main()
 {
@@ -7,8 +7,6 @@ out vec4 vWorldPosition;
 out vec4 vScreenPosition;
 out vec2 vUV;
 
-uniform mat4 Projection;
-uniform mat4 View;
 uniform mat4 Model;
 
 void main()
@@ -8,6 +8,7 @@
 #include <Gl/glfw.h>
 #include <FreeImage.h>
 #include <stdio.h>
+#include <string.h>
 #include <random>
 
 #include "Utilities.h"
@@ -17,6 +18,7 @@
 #pragma warning( disable : 4996 )
 
 static double s_dPrevTime = 0;
+static const char* s_szShaderHeader = nullptr;
 
 //////////////////////////////////////////////////////////////////////////
 void AIE::ResetTimer()
@@ -389,11 +391,11 @@ unsigned int AIE::LoadShader(unsigned int a_uiInputAttributeCount, const char**
 	GLchar acLog[256];
 
 	// load files into char buffers
-	char* vsSource = FileToBuffer(a_szVertexShader);
-	char* fsSource = FileToBuffer(a_szPixelShader);
-	char* gsSource = a_szGeometryShader == nullptr ? nullptr : FileToBuffer(a_szGeometryShader);
-	char* tcsSource = a_szTessellationControlShader == nullptr ? nullptr : FileToBuffer(a_szTessellationControlShader);
-	char* tesSource = a_szTessellationEvaluationShader == nullptr ? nullptr : FileToBuffer(a_szTessellationEvaluationShader);
+	char* vsSource = LoadShaderSource(a_szVertexShader);
+	char* fsSource = LoadShaderSource(a_szPixelShader);
+	char* gsSource = a_szGeometryShader == nullptr ? nullptr : LoadShaderSource(a_szGeometryShader);
+	char* tcsSource = a_szTessellationControlShader == nullptr ? nullptr : LoadShaderSource(a_szTessellationControlShader);
+	char* tesSource = a_szTessellationEvaluationShader == nullptr ? nullptr : LoadShaderSource(a_szTessellationEvaluationShader);
 
 	// must have vertex and pixel
 	if (vsSource == nullptr || fsSource == nullptr)
@@ -529,14 +531,12 @@ unsigned int AIE::LoadShader(unsigned int a_uiInputAttributeCount, const char**
 
 	glUseProgram(uiProgramHandle);
 
-	free(vsSource);
-	free(fsSource);
-	if (gsSource != nullptr)
-		free(gsSource);
-	if (tcsSource != nullptr)
-		free(tcsSource);
-	if (tesSource != nullptr)
-		free(tesSource);
+	// the buffers come from new[]
+	delete[] vsSource;
+	delete[] fsSource;
+	delete[] gsSource;
+	delete[] tcsSource;
+	delete[] tesSource;
 
 	return uiProgramHandle;
 }
@@ -566,6 +566,47 @@ char* AIE::FileToBuffer(const char* a_sPath)
 	return acBuffer;
 }
 
+//////////////////////////////////////////////////////////////////////////
+void AIE::SetShaderHeader(const char* a_szHeader)
+{
+	s_szShaderHeader = a_szHeader;
+}
+
+//////////////////////////////////////////////////////////////////////////
+char* AIE::LoadShaderSource(const char* a_szPath)
+{
+	char* acSource = FileToBuffer(a_szPath);
+	if (acSource == nullptr || s_szShaderHeader == nullptr)
+		return acSource;
+
+	// #version has to come before anything else
+	const char* szBody = acSource;
+	unsigned int uiBodyLine = 1;
+	if (strncmp(acSource, "#version", 8) == 0)
+	{
+		const char* szNewLine = strchr(acSource, '\n');
+		szBody = szNewLine == nullptr ? acSource + strlen(acSource) : szNewLine + 1;
+		uiBodyLine = 2;
+	}
+
+	// #line keeps compile errors pointing at the stage's own lines
+	char acLine[32];
+	sprintf(acLine, "\n#line %u\n", uiBodyLine);
+
+	unsigned int uiVersionLength = (unsigned int)(szBody - acSource);
+	unsigned int uiLength = uiVersionLength + strlen(s_szShaderHeader) + strlen(acLine) + strlen(szBody);
+
+	char* acSpliced = new char[uiLength + 1];
+	memcpy(acSpliced, acSource, uiVersionLength);
+	acSpliced[uiVersionLength] = 0;
+	strcat(acSpliced, s_szShaderHeader);
+	strcat(acSpliced, acLine);
+	strcat(acSpliced, szBody);
+
+	delete[] acSource;
+	return acSpliced;
+}
+
 //////////////////////////////////////////////////////////////////////////
 void AIE::FreeMovement(float a_fDeltaTime, AIE::mat4& a_rmFrame, float a_fSpeed, const AIE::vec4& a_rvUp /* = vec4 */)
 {